@@ -0,0 +1,103 @@
+// auto generated by configure
+#ifndef SRS_AUTO_HEADER_HPP
+#define SRS_AUTO_HEADER_HPP
+
+#define SRS_AUTO_BUILD_TS "1792193895"
+#define SRS_AUTO_BUILD_DATE "2026-10-16 23:38:15"
+#define SRS_AUTO_UNAME "Linux vm 6.18.44-fc-v130 #1 SMP PREEMPT_DYNAMIC @0 x86_64 GNU/Linux"
+#define SRS_AUTO_USER_CONFIGURE "--x86-x64  --with-ssl --use-sys-ssl --with-utest --with-librtmp --with-research --without-http-callback --without-nginx --without-ffmpeg --without-transcode --without-ingest"
+#define SRS_AUTO_CONFIGURE "--prefix=/usr/local/srs --with-hls --with-hds --with-dvr --without-nginx --with-ssl --without-ffmpeg --without-transcode --without-ingest --with-stat --without-http-callback --with-http-server --with-stream-caster --with-kafka --with-http-api --with-librtmp --with-research --with-utest --without-gperf --without-gmc --without-gmd --without-gmp --without-gcp --without-gprof --without-arm-ubuntu12 --without-mips-ubuntu12 --log-trace"
+
+#define SRS_X86_X64
+#define SRS_X86_X64_BOOL true
+#undef SRS_EXPORT_LIBRTMP
+
+#undef SRS_AUTO_EMBEDED_TOOL_CHAIN
+#define SRS_AUTO_EMBEDED_TOOL_CHAIN_BOOL false
+
+#define SRS_AUTO_HTTP_CORE
+#define SRS_AUTO_HTTP_CORE_BOOL true
+#define SRS_AUTO_HTTP_SERVER
+#define SRS_AUTO_HTTP_SERVER_BOOL true
+#define SRS_AUTO_STREAM_CASTER
+#define SRS_AUTO_STREAM_CASTER_BOOL true
+#define SRS_AUTO_KAFKA
+#define SRS_AUTO_KAFKA_BOOL true
+#define SRS_AUTO_HTTP_API
+#define SRS_AUTO_HTTP_API_BOOL true
+#undef SRS_AUTO_NGINX
+#define SRS_AUTO_NGINX_BOOL false
+#define SRS_AUTO_DVR
+#define SRS_AUTO_DVR_BOOL true
+#define SRS_AUTO_HLS
+#define SRS_AUTO_HLS_BOOL true
+#define SRS_AUTO_HDS
+#define SRS_AUTO_HDS_BOOL true
+#undef SRS_AUTO_HTTP_CALLBACK
+#define SRS_AUTO_HTTP_CALLBACK_BOOL false
+#define SRS_AUTO_SSL
+#define SRS_AUTO_SSL_BOOL true
+#undef SRS_AUTO_MEM_WATCH
+#define SRS_AUTO_MEM_WATCH_BOOL false
+#undef SRS_AUTO_FFMPEG_TOOL
+#define SRS_AUTO_FFMPEG_TOOL_BOOL false
+#undef SRS_AUTO_FFMPEG_STUB
+#define SRS_AUTO_FFMPEG_STUB_BOOL false
+#undef SRS_AUTO_TRANSCODE
+#define SRS_AUTO_TRANSCODE_BOOL false
+#undef SRS_AUTO_INGEST
+#define SRS_AUTO_INGEST_BOOL false
+#define SRS_AUTO_STAT
+#define SRS_AUTO_STAT_BOOL true
+#undef SRS_AUTO_GPERF
+#define SRS_AUTO_GPERF_BOOL false
+#undef SRS_AUTO_GPERF_MC
+#define SRS_AUTO_GPERF_MC_BOOL false
+#undef SRS_AUTO_GPERF_MD
+#define SRS_AUTO_GPERF_MD_BOOL false
+#undef SRS_AUTO_GPERF_MP
+#define SRS_AUTO_GPERF_MP_BOOL false
+#undef SRS_AUTO_GPERF_CP
+#define SRS_AUTO_GPERF_CP_BOOL false
+#undef SRS_AUTO_EMBEDED_CPU
+#define SRS_AUTO_EMBEDED_CPU_BOOL false
+#undef SRS_AUTO_ARM_UBUNTU12
+#define SRS_AUTO_ARM_UBUNTU12_BOOL false
+#undef SRS_AUTO_MIPS_UBUNTU12
+#define SRS_AUTO_MIPS_UBUNTU12_BOOL false
+
+#undef SRS_AUTO_VERBOSE
+#define SRS_AUTO_VERBOSE_BOOL false
+#undef SRS_AUTO_INFO
+#define SRS_AUTO_INFO_BOOL false
+#define SRS_AUTO_TRACE
+#define SRS_AUTO_TRACE_BOOL true
+
+#define SRS_AUTO_PREFIX "/usr/local/srs"
+
+#define SRS_AUTO_CONSTRIBUTORS "\
+winlin<winlin@vip.126.com> \
+wenjie.zhao<740936897@qq.com> \
+xiangcheng.liu<liuxc0116@foxmail.com> \
+naijia.liu<youngcow@youngcow.net> \
+alcoholyi<alcoholyi@qq.com> \
+byteman<wangchen2011@gmail.com> \
+chad.wang<chad.wang.cn@gmail.com> \
+suhetao<suhetao@gmail.com> \
+Johnny<fengjihu@163.com> \
+karthikeyan<keyanmca@gmail.com> \
+StevenLiu<lq@chinaffmpeg.org> \
+zhengfl<zhengfl_1989@126.com> \
+tufang14<breadbean1449@gmail.com> \
+allspace<allspace@gmail.com> \
+niesongsong<nie950@gmail.com> \
+rudeb0t<nimrod@themanxgroup.tw> \
+CallMeNP<np.liamg@gmail.com> \
+synote<synote@qq.com> \
+lovecat<littlefawn@163.com> \
+panda1986<542638787@qq.com> \
+YueHonghui<hongf.yue@hotmail.com> \
+"
+
+#endif
+
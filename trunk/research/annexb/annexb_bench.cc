@@ -0,0 +1,255 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/**
+# build srs first, then build the bench:
+make
+# bench the raw h264 stream, for example, 1080p extracted by ffmpeg:
+#   ffmpeg -i 1080p.mp4 -c:v copy -bsf:v h264_mp4toannexb -f h264 1080p.h264
+./annexb_bench 1080p.h264
+# or bench the generated 1080p-like access units, 150KB I and 20KB P frames.
+./annexb_bench
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_utility.hpp>
+
+ISrsLog* _srs_log = new ISrsLog();
+ISrsThreadContext* _srs_context = new ISrsThreadContext();
+
+// the max NALUs of an access unit.
+#define MAX_NALUS 1024
+// the total bytes to scan for each algorithm.
+#define BENCH_BYTES (512LL * 1024 * 1024)
+
+int64_t now_us()
+{
+    timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000000LL + now.tv_usec;
+}
+
+/**
+* the previous algorithm, check the start code for each byte.
+*/
+int split_by_bytes(char* data, int size, char** nalus, int* sizes, int max)
+{
+    SrsBuffer stream;
+    if (stream.initialize(data, size) != ERROR_SUCCESS) {
+        return 0;
+    }
+    
+    int nb_nalus = 0;
+    while (!stream.empty() && nb_nalus < max) {
+        int nb_start_code = 0;
+        if (!srs_avc_startswith_annexb(&stream, &nb_start_code)) {
+            break;
+        }
+        stream.skip(nb_start_code);
+        
+        char* p = stream.data() + stream.pos();
+        while (!stream.empty()) {
+            if (srs_avc_startswith_annexb(&stream, NULL)) {
+                break;
+            }
+            stream.skip(1);
+        }
+        
+        char* pp = stream.data() + stream.pos();
+        if (pp > p) {
+            nalus[nb_nalus] = p;
+            sizes[nb_nalus] = (int)(pp - p);
+            nb_nalus++;
+        }
+    }
+    
+    return nb_nalus;
+}
+
+int split_by_scanner(char* data, int size, char** nalus, int* sizes, int max)
+{
+    return srs_avc_split_annexb(data, size, nalus, sizes, max);
+}
+
+/**
+* load the access units from raw h264 stream, an access unit starts at AUD,
+* SPS, or the slice which first_mb_in_slice is 0.
+*/
+bool load_access_units(const char* file, std::vector<std::string>& aus)
+{
+    FILE* f = fopen(file, "rb");
+    if (!f) {
+        return false;
+    }
+    
+    std::string raw;
+    char buf[65536];
+    size_t nread;
+    while ((nread = fread(buf, 1, sizeof(buf), f)) > 0) {
+        raw.append(buf, nread);
+    }
+    fclose(f);
+    
+    char* data = (char*)raw.data();
+    char* end = data + raw.length();
+    
+    int nb_start_code = 0;
+    char* p = srs_avc_find_annexb(data, end, &nb_start_code);
+    char* au = p;
+    bool has_slice = false;
+    
+    while (p < end) {
+        char* nalu = p + nb_start_code;
+        char* next = srs_avc_find_annexb(nalu, end, &nb_start_code);
+        
+        if (nalu < end) {
+            int type = nalu[0] & 0x1f;
+            bool first_slice = (type == 1 || type == 5) && nalu + 1 < end && (nalu[1] & 0x80);
+            if (has_slice && (type == 9 || type == 7 || first_slice)) {
+                aus.push_back(std::string(au, p - au));
+                au = p;
+                has_slice = false;
+            }
+            has_slice = has_slice || type == 1 || type == 5;
+        }
+        
+        p = next;
+    }
+    if (end > au) {
+        aus.push_back(std::string(au, end - au));
+    }
+    
+    return !aus.empty();
+}
+
+/**
+* generate the 1080p-like access units, a gop of 150KB I and 20KB P frames,
+* the payload is random without start code, like the emulation prevention.
+*/
+void generate_access_units(std::vector<std::string>& aus)
+{
+    srand(0);
+    
+    for (int i = 0; i < 60; i++) {
+        std::string au;
+        
+        // AUD, SPS and PPS.
+        au.append("\x00\x00\x00\x01\x09\xf0", 6);
+        if (i == 0) {
+            au.append("\x00\x00\x00\x01\x67\x64\x00\x28\xac\xd9\x40\x78\x02\x27\xe5\x84", 16);
+            au.append("\x00\x00\x00\x01\x68\xeb\xe3\xcb\x22\xc0", 10);
+        }
+        
+        // 4 slices of frame.
+        int size = (i == 0? 150 : 20) * 1024 / 4;
+        for (int j = 0; j < 4; j++) {
+            au.append("\x00\x00\x01", 3);
+            au.append(1, (char)(i == 0? 0x65 : 0x41));
+            
+            int zeros = 0;
+            for (int k = 0; k < size; k++) {
+                char v = (char)(rand() % 4 == 0? 0x00 : rand());
+                // emulation prevention, never 00 00 0x where x<=3.
+                if (zeros >= 2 && (unsigned char)v <= 0x03) {
+                    au.append(1, (char)0x03);
+                    zeros = 0;
+                }
+                zeros = v == 0x00? zeros + 1 : 0;
+                au.append(1, v);
+            }
+        }
+        
+        aus.push_back(au);
+    }
+}
+
+typedef int (*split_func)(char* data, int size, char** nalus, int* sizes, int max);
+
+int64_t bench(const char* name, split_func split, std::vector<std::string>& aus, int64_t total)
+{
+    char* nalus[MAX_NALUS];
+    int sizes[MAX_NALUS];
+    
+    int64_t nb_bytes = 0;
+    int64_t nb_aus = 0;
+    int64_t nb_nalus = 0;
+    
+    int64_t start = now_us();
+    while (nb_bytes < total) {
+        for (int i = 0; i < (int)aus.size(); i++) {
+            std::string& au = aus[i];
+            nb_nalus += split((char*)au.data(), (int)au.length(), nalus, sizes, MAX_NALUS);
+            nb_bytes += au.length();
+            nb_aus++;
+        }
+    }
+    int64_t elapsed = srs_max(1, now_us() - start);
+    
+    printf("%-8s %8.1f MB/s, %8.1f us/AU, aus=%"PRId64", nalus=%"PRId64", elapsed=%.2fs\n",
+        name, nb_bytes / 1024.0 / 1024.0 / (elapsed / 1000000.0), (double)elapsed / nb_aus,
+        nb_aus, nb_nalus, elapsed / 1000000.0);
+    
+    return nb_nalus;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> aus;
+    
+    if (argc > 1) {
+        if (!load_access_units(argv[1], aus)) {
+            printf("load %s failed\n", argv[1]);
+            return -1;
+        }
+        printf("load %d access units from %s\n", (int)aus.size(), argv[1]);
+    } else {
+        generate_access_units(aus);
+        printf("generate %d 1080p-like access units\n", (int)aus.size());
+    }
+    
+#if defined(__SSE2__)
+    printf("scanner: SSE2\n");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    printf("scanner: NEON\n");
+#else
+    printf("scanner: scalar\n");
+#endif
+    
+    int64_t expect = bench("bytes", split_by_bytes, aus, BENCH_BYTES);
+    int64_t actual = bench("scanner", split_by_scanner, aus, BENCH_BYTES);
+    
+    if (expect != actual) {
+        printf("mismatch nalus, expect=%"PRId64", actual=%"PRId64"\n", expect, actual);
+        return -1;
+    }
+    
+    return 0;
+}
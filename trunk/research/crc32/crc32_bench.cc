@@ -0,0 +1,120 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/**
+# build srs first, then build the bench:
+make
+# bench the crc32 of the sizes of PSI, kafka message and message set.
+./crc32_bench
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+
+ISrsLog* _srs_log = new ISrsLog();
+ISrsThreadContext* _srs_context = new ISrsThreadContext();
+
+// the byte-at-a-time crc32 of srs kernel.
+extern unsigned int __mpegts_crc32(const u_int8_t *data, int len);
+extern u_int32_t __crc32_ieee(u_int32_t init, const u_int8_t* buf, size_t nb_buf);
+
+// the total bytes to calc for each algorithm.
+#define BENCH_BYTES (256LL * 1024 * 1024)
+
+int64_t now_us()
+{
+    timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000000LL + now.tv_usec;
+}
+
+u_int32_t mpegts_by_bytes(u_int8_t* p, int size)
+{
+    return __mpegts_crc32(p, size);
+}
+
+u_int32_t mpegts_by_srs(u_int8_t* p, int size)
+{
+    return srs_crc32_mpegts(p, size);
+}
+
+u_int32_t ieee_by_bytes(u_int8_t* p, int size)
+{
+    return __crc32_ieee(0, p, size);
+}
+
+u_int32_t ieee_by_srs(u_int8_t* p, int size)
+{
+    return srs_crc32_ieee(p, size);
+}
+
+typedef u_int32_t (*crc32_func)(u_int8_t* p, int size);
+
+u_int32_t bench(const char* name, crc32_func crc32, u_int8_t* data, int size)
+{
+    u_int32_t v = 0;
+    int64_t nb_bytes = 0;
+    
+    int64_t start = now_us();
+    while (nb_bytes < BENCH_BYTES) {
+        v ^= crc32(data, size);
+        nb_bytes += size;
+    }
+    int64_t elapsed = srs_max(1, now_us() - start);
+    
+    printf("%-16s size=%-6d %8.1f MB/s\n", name, size, nb_bytes / 1024.0 / 1024.0 / (elapsed / 1000000.0));
+    
+    return v;
+}
+
+int main(int argc, char** argv)
+{
+    printf("crc32 ieee kernel: %s\n", srs_crc32_ieee_kernel());
+    
+    // the PAT/PMT section, the kafka message and message set.
+    int sizes[] = {32, 188, 1024, 65536};
+    
+    u_int8_t* data = new u_int8_t[65536];
+    for (int i = 0; i < 65536; i++) {
+        data[i] = (u_int8_t)rand();
+    }
+    
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(int)); i++) {
+        int size = sizes[i];
+        
+        if (bench("mpegts bytes", mpegts_by_bytes, data, size) != bench("mpegts srs", mpegts_by_srs, data, size)) {
+            printf("mismatch mpegts crc32, size=%d\n", size);
+            return -1;
+        }
+        if (bench("ieee bytes", ieee_by_bytes, data, size) != bench("ieee srs", ieee_by_srs, data, size)) {
+            printf("mismatch ieee crc32, size=%d\n", size);
+            return -1;
+        }
+    }
+    
+    delete[] data;
+    
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/**
+# build srs with ssl first, then build the bench:
+make
+# bench the server side of complex handshake, in st, by pool and offload.
+./handshake_bench
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_rtmp_handshake.hpp>
+#include <srs_app_handshake.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_server.hpp>
+
+using namespace _srs_internal;
+
+ISrsLog* _srs_log = new ISrsLog();
+ISrsThreadContext* _srs_context = new ISrsThreadContext();
+// the app objects required by the pool.
+SrsConfig* _srs_config = NULL;
+SrsServer* _srs_server = NULL;
+
+// the number of handshakes for each mode.
+#define BENCH_HANDSHAKES 3000
+// the DH keys of pool.
+#define BENCH_POOL_KEYS 256
+
+// the pool of app, hooked to protocol by _srs_handshake_pool.
+SrsHandshakePool* pool = NULL;
+
+/**
+* the waiter by pthread cond, for the bench never use st.
+*/
+class BenchWaiter : public ISrsHandshakeWaiter
+{
+private:
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+public:
+    BenchWaiter() {
+        pthread_mutex_init(&lock, NULL);
+        pthread_cond_init(&cond, NULL);
+    }
+    virtual ~BenchWaiter() {
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&lock);
+    }
+public:
+    virtual void wait() {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 1000 * 1000;
+        if (ts.tv_nsec >= 1000 * 1000 * 1000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000 * 1000 * 1000;
+        }
+        
+        pthread_mutex_lock(&lock);
+        pthread_cond_timedwait(&cond, &lock, &ts);
+        pthread_mutex_unlock(&lock);
+    }
+    virtual void notify() {
+        pthread_mutex_lock(&lock);
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+};
+
+int64_t now_us(clockid_t clock)
+{
+    timespec now;
+    clock_gettime(clock, &now);
+    return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+/**
+* the server side of complex handshake, @see SrsComplexHandshake::handshake_with_client
+*/
+int server_handshake(char* c0c1, char* s0s1s2)
+{
+    int ret = ERROR_SUCCESS;
+    bool is_valid = false;
+    
+    c1s1 c1;
+    if ((ret = c1.parse(c0c1 + 1, 1536, srs_schema0)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = c1.c1_validate_digest(is_valid)) != ERROR_SUCCESS || !is_valid) {
+        return ERROR_RTMP_TRY_SIMPLE_HS;
+    }
+    
+    c1s1 s1;
+    if ((ret = s1.s1_create(&c1)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = s1.s1_validate_digest(is_valid)) != ERROR_SUCCESS || !is_valid) {
+        return ERROR_RTMP_TRY_SIMPLE_HS;
+    }
+    
+    c2s2 s2;
+    if ((ret = s2.s2_create(&c1)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = s2.s2_validate(&c1, is_valid)) != ERROR_SUCCESS || !is_valid) {
+        return ERROR_RTMP_TRY_SIMPLE_HS;
+    }
+    
+    if ((ret = s1.dump(s0s1s2 + 1, 1536)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = s2.dump(s0s1s2 + 1537, 1536)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    return ret;
+}
+
+int bench(const char* name, char* c0c1)
+{
+    int ret = ERROR_SUCCESS;
+    
+    char s0s1s2[3073];
+    
+    int64_t start = now_us(CLOCK_MONOTONIC);
+    int64_t start_cpu = now_us(CLOCK_THREAD_CPUTIME_ID);
+    
+    for (int i = 0; i < BENCH_HANDSHAKES; i++) {
+        if ((ret = server_handshake(c0c1, s0s1s2)) != ERROR_SUCCESS) {
+            printf("%s: handshake failed. ret=%d\n", name, ret);
+            return ret;
+        }
+    }
+    
+    int64_t elapsed = srs_max(1, now_us(CLOCK_MONOTONIC) - start);
+    int64_t elapsed_cpu = srs_max(1, now_us(CLOCK_THREAD_CPUTIME_ID) - start_cpu);
+    
+    printf("%-8s %8.1f hs/s, %8.1f hs/s per core of st, %6.1f us/hs of st",
+        name, BENCH_HANDSHAKES / (elapsed / 1000000.0), BENCH_HANDSHAKES / (elapsed_cpu / 1000000.0),
+        (double)elapsed_cpu / BENCH_HANDSHAKES);
+    if (pool) {
+        printf(", hits=%"PRId64", misses=%"PRId64, pool->nb_hits, pool->nb_misses);
+    }
+    printf("\n");
+    
+    return ret;
+}
+
+// start the pool and wait for it full.
+int start_pool(ISrsHandshakeWaiter* waiter)
+{
+    int ret = ERROR_SUCCESS;
+    
+    pool = new SrsHandshakePool();
+    if ((ret = pool->initialize(BENCH_POOL_KEYS, waiter)) != ERROR_SUCCESS) {
+        srs_freep(pool);
+        return ret;
+    }
+    
+    // the burst of clients after the pool is full.
+    for (;;) {
+        SrsDH* dh = pool->fetch_dh();
+        if (dh) {
+            srs_freep(dh);
+            break;
+        }
+        usleep(10 * 1000);
+    }
+    usleep(BENCH_POOL_KEYS * 2 * 1000);
+    pool->nb_hits = pool->nb_misses = 0;
+    _srs_handshake_pool = pool;
+    
+    return ret;
+}
+
+void stop_pool()
+{
+    _srs_handshake_pool = NULL;
+    srs_freep(pool);
+}
+
+int main(int argc, char** argv)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // the c0c1 of client, @see SrsComplexHandshake::handshake_with_server
+    char c0c1[1537];
+    c0c1[0] = 0x03;
+    
+    c1s1 c1;
+    if ((ret = c1.c1_create(srs_schema0)) != ERROR_SUCCESS) {
+        printf("create c1 failed. ret=%d\n", ret);
+        return ret;
+    }
+    if ((ret = c1.dump(c0c1 + 1, 1536)) != ERROR_SUCCESS) {
+        printf("dump c1 failed. ret=%d\n", ret);
+        return ret;
+    }
+    
+    // generate the DH key in st for each handshake.
+    if ((ret = bench("st", c0c1)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // fetch the DH key from pool, compute the shared key in st.
+    if ((ret = start_pool(NULL)) != ERROR_SUCCESS) {
+        printf("start pool failed. ret=%d\n", ret);
+        return ret;
+    }
+    if ((ret = bench("pool", c0c1)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    stop_pool();
+    
+    // fetch the DH key from pool, compute the shared key in pthread.
+    BenchWaiter waiter;
+    if ((ret = start_pool(&waiter)) != ERROR_SUCCESS) {
+        printf("start pool failed. ret=%d\n", ret);
+        return ret;
+    }
+    if ((ret = bench("offload", c0c1)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    stop_pool();
+    
+    return ret;
+}
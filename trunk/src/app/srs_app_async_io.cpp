@@ -0,0 +1,850 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <srs_app_async_io.hpp>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_core_performance.hpp>
+
+// the sleep interval when the completion thread of async io error.
+#define SRS_AUTO_ASYNC_IO_SLEEP_US 100000
+
+ISrsAsyncIoTask::ISrsAsyncIoTask()
+{
+    key = -1;
+}
+
+ISrsAsyncIoTask::~ISrsAsyncIoTask()
+{
+}
+
+int ISrsAsyncIoTask::nb_bytes()
+{
+    return 0;
+}
+
+SrsAsyncIoFile::SrsAsyncIoFile(string p, bool a)
+{
+    path = p;
+    fd = -1;
+    append = a;
+    failed = false;
+    dontneed = false;
+    written = synced = dropped = 0;
+}
+
+SrsAsyncIoFile::~SrsAsyncIoFile()
+{
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void SrsAsyncIoFile::writeback(int64_t offset, int size, bool closing)
+{
+    written = srs_max(written, offset + size);
+    
+#if !defined(SRS_OSX) && SRS_PERF_ASYNC_IO_WRITEBACK > 0
+    if (fd < 0 || failed) {
+        return;
+    }
+    
+    // in append mode, the file may not start from 0.
+    if (append && synced == 0 && dropped == 0) {
+        synced = dropped = offset;
+    }
+    
+    if (!closing && written - synced < SRS_PERF_ASYNC_IO_WRITEBACK) {
+        return;
+    }
+    
+    // the pages written back last time are on disk now, drop them.
+    int64_t previous = synced;
+    if (dontneed && previous > dropped) {
+        ::sync_file_range(fd, (off64_t)dropped, (off64_t)(previous - dropped),
+            SYNC_FILE_RANGE_WAIT_BEFORE|SYNC_FILE_RANGE_WRITE|SYNC_FILE_RANGE_WAIT_AFTER);
+        ::posix_fadvise(fd, (off_t)dropped, (off_t)(previous - dropped), POSIX_FADV_DONTNEED);
+        dropped = previous;
+    }
+    
+    // start to write back the dirty pages, never wait.
+    if (written > synced) {
+        ::sync_file_range(fd, (off64_t)synced, (off64_t)(written - synced), SYNC_FILE_RANGE_WRITE);
+        synced = written;
+    }
+    
+    // when closing, wait for all pages on disk and drop them.
+    if (closing && dontneed && written > dropped) {
+        ::sync_file_range(fd, (off64_t)dropped, (off64_t)(written - dropped),
+            SYNC_FILE_RANGE_WAIT_BEFORE|SYNC_FILE_RANGE_WRITE|SYNC_FILE_RANGE_WAIT_AFTER);
+        ::posix_fadvise(fd, (off_t)dropped, (off_t)(written - dropped), POSIX_FADV_DONTNEED);
+        dropped = written;
+    }
+#endif
+}
+
+SrsAsyncIoOpenTask::SrsAsyncIoOpenTask(SrsAsyncIoFile* f)
+{
+    file = f;
+}
+
+SrsAsyncIoOpenTask::~SrsAsyncIoOpenTask()
+{
+}
+
+int SrsAsyncIoOpenTask::call()
+{
+    int ret = ERROR_SUCCESS;
+    
+    int flags = O_CREAT|O_WRONLY|O_TRUNC;
+    if (file->append) {
+        flags = O_APPEND|O_WRONLY;
+    }
+    mode_t mode = S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH;
+    
+    if ((file->fd = ::open(file->path.c_str(), flags, mode)) < 0) {
+        file->failed = true;
+        ret = ERROR_SYSTEM_FILE_OPENE;
+        return ret;
+    }
+    
+    return ret;
+}
+
+string SrsAsyncIoOpenTask::to_string()
+{
+    return "open " + file->path;
+}
+
+SrsAsyncIoWriteTask::SrsAsyncIoWriteTask(SrsAsyncIoFile* f, int64_t o, char* b, int s)
+{
+    file = f;
+    offset = o;
+    buf = b;
+    size = s;
+}
+
+SrsAsyncIoWriteTask::~SrsAsyncIoWriteTask()
+{
+    srs_freepa(buf);
+}
+
+int SrsAsyncIoWriteTask::call()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // ignore when open or write failed, which is already reported.
+    if (file->failed) {
+        return ret;
+    }
+    
+    char* p = buf;
+    int left = size;
+    int64_t pos = offset;
+    while (left > 0) {
+        ssize_t nwrite;
+        if (file->append) {
+            nwrite = ::write(file->fd, p, left);
+        } else {
+            nwrite = ::pwrite(file->fd, p, left, (off_t)pos);
+        }
+        
+        if (nwrite < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nwrite < 0) {
+            file->failed = true;
+            ret = ERROR_SYSTEM_FILE_WRITE;
+            return ret;
+        }
+        
+        p += nwrite;
+        left -= (int)nwrite;
+        pos += nwrite;
+    }
+    
+    file->writeback(offset, size, false);
+    
+    return ret;
+}
+
+string SrsAsyncIoWriteTask::to_string()
+{
+    return "write " + file->path;
+}
+
+int SrsAsyncIoWriteTask::nb_bytes()
+{
+    return size;
+}
+
+SrsAsyncIoCloseTask::SrsAsyncIoCloseTask(SrsAsyncIoFile* f)
+{
+    file = f;
+}
+
+SrsAsyncIoCloseTask::~SrsAsyncIoCloseTask()
+{
+    srs_freep(file);
+}
+
+int SrsAsyncIoCloseTask::call()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (file->fd < 0) {
+        return ret;
+    }
+    
+    file->writeback(0, 0, true);
+    
+    int fd = file->fd;
+    file->fd = -1;
+    
+    if (::close(fd) < 0) {
+        ret = ERROR_SYSTEM_FILE_CLOSE;
+        return ret;
+    }
+    
+    return ret;
+}
+
+string SrsAsyncIoCloseTask::to_string()
+{
+    return "close " + file->path;
+}
+
+SrsAsyncIoRenameTask::SrsAsyncIoRenameTask(string f, string t)
+{
+    from = f;
+    to = t;
+}
+
+SrsAsyncIoRenameTask::~SrsAsyncIoRenameTask()
+{
+}
+
+int SrsAsyncIoRenameTask::call()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (::rename(from.c_str(), to.c_str()) < 0) {
+        ret = ERROR_SYSTEM_FILE_RENAME;
+        return ret;
+    }
+    
+    return ret;
+}
+
+string SrsAsyncIoRenameTask::to_string()
+{
+    return "rename " + from + " => " + to;
+}
+
+SrsAsyncIoUnlinkTask::SrsAsyncIoUnlinkTask(string p)
+{
+    path = p;
+}
+
+SrsAsyncIoUnlinkTask::~SrsAsyncIoUnlinkTask()
+{
+}
+
+int SrsAsyncIoUnlinkTask::call()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (::unlink(path.c_str()) < 0) {
+        ret = ERROR_SYSTEM_FILE_UNLINK;
+        return ret;
+    }
+    
+    return ret;
+}
+
+string SrsAsyncIoUnlinkTask::to_string()
+{
+    return "unlink " + path;
+}
+
+SrsAsyncIoWorker::SrsAsyncIoWorker(SrsAsyncIo* o)
+{
+    io = o;
+    started = false;
+    quit = false;
+    submitted = completed = 0;
+    nb_pending = nb_drops = 0;
+    
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+SrsAsyncIoWorker::~SrsAsyncIoWorker()
+{
+    stop();
+    
+    std::deque<ISrsAsyncIoTask*>::iterator it;
+    for (it = tasks.begin(); it != tasks.end(); ++it) {
+        ISrsAsyncIoTask* task = *it;
+        srs_freep(task);
+    }
+    tasks.clear();
+    
+    std::vector< std::pair<ISrsAsyncIoTask*, int> >::iterator dit;
+    for (dit = done.begin(); dit != done.end(); ++dit) {
+        ISrsAsyncIoTask* task = dit->first;
+        srs_freep(task);
+    }
+    done.clear();
+    
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&lock);
+}
+
+int SrsAsyncIoWorker::start()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (pthread_create(&tid, NULL, SrsAsyncIoWorker::worker_pthread, this) != 0) {
+        ret = ERROR_SYSTEM_CREATE_THREAD;
+        srs_error("create async io worker failed. ret=%d", ret);
+        return ret;
+    }
+    started = true;
+    
+    return ret;
+}
+
+void SrsAsyncIoWorker::stop()
+{
+    if (!started) {
+        return;
+    }
+    
+    pthread_mutex_lock(&lock);
+    quit = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+    
+    pthread_join(tid, NULL);
+    started = false;
+}
+
+void SrsAsyncIoWorker::push(ISrsAsyncIoTask* t)
+{
+    pthread_mutex_lock(&lock);
+    tasks.push_back(t);
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+}
+
+void SrsAsyncIoWorker::swap_done(std::vector< std::pair<ISrsAsyncIoTask*, int> >& completed_tasks)
+{
+    pthread_mutex_lock(&lock);
+    completed_tasks.swap(done);
+    pthread_mutex_unlock(&lock);
+}
+
+void* SrsAsyncIoWorker::worker_pthread(void* arg)
+{
+    SrsAsyncIoWorker* worker = (SrsAsyncIoWorker*)arg;
+    worker->do_cycle();
+    return NULL;
+}
+
+void SrsAsyncIoWorker::do_cycle()
+{
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        while (tasks.empty() && !quit) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        
+        // quit when all tasks executed.
+        if (tasks.empty()) {
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+        
+        ISrsAsyncIoTask* task = tasks.front();
+        tasks.pop_front();
+        pthread_mutex_unlock(&lock);
+        
+        int ret = task->call();
+        
+        // only notify st when the first task done,
+        // for st will fetch all completed tasks.
+        pthread_mutex_lock(&lock);
+        bool should_notify = done.empty();
+        done.push_back(std::make_pair(task, ret));
+        pthread_mutex_unlock(&lock);
+        
+        if (should_notify) {
+            io->notify();
+        }
+    }
+}
+
+int SrsAsyncIo::nb_keys = 0;
+
+SrsAsyncIo::SrsAsyncIo()
+{
+    pthread = new SrsReusableThread("aio", this, SRS_AUTO_ASYNC_IO_SLEEP_US);
+    done_pipe[0] = done_pipe[1] = -1;
+    done_stfd = NULL;
+    done_cond = st_cond_new();
+}
+
+SrsAsyncIo::~SrsAsyncIo()
+{
+    stop();
+    
+    srs_freep(pthread);
+    
+    if (done_stfd) {
+        srs_close_stfd(done_stfd);
+        done_pipe[0] = -1;
+    }
+    if (done_pipe[0] >= 0) {
+        ::close(done_pipe[0]);
+    }
+    if (done_pipe[1] >= 0) {
+        ::close(done_pipe[1]);
+    }
+    
+    st_cond_destroy(done_cond);
+}
+
+int SrsAsyncIo::initialize(int nb_workers)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // execute the tasks in st thread.
+    if (nb_workers <= 0) {
+        srs_trace("async io: no workers, write files in st");
+        return ret;
+    }
+    
+    if (pipe(done_pipe) < 0) {
+        ret = ERROR_SYSTEM_CREATE_PIPE;
+        srs_error("create async io pipe failed. ret=%d", ret);
+        return ret;
+    }
+    
+    if ((done_stfd = st_netfd_open(done_pipe[0])) == NULL) {
+        ret = ERROR_SYSTEM_CREATE_PIPE;
+        srs_error("create async io st pipe failed. ret=%d", ret);
+        return ret;
+    }
+    
+    for (int i = 0; i < nb_workers; i++) {
+        SrsAsyncIoWorker* worker = new SrsAsyncIoWorker(this);
+        workers.push_back(worker);
+        
+        if ((ret = worker->start()) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    if ((ret = pthread->start()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    srs_trace("async io: start %d workers", nb_workers);
+    
+    return ret;
+}
+
+void SrsAsyncIo::stop()
+{
+    if (workers.empty()) {
+        return;
+    }
+    
+    // wait for all submitted tasks to be executed.
+    std::vector<SrsAsyncIoWorker*>::iterator it;
+    for (it = workers.begin(); it != workers.end(); ++it) {
+        SrsAsyncIoWorker* worker = *it;
+        worker->stop();
+    }
+    
+    pthread->stop();
+    on_completed();
+    
+    for (it = workers.begin(); it != workers.end(); ++it) {
+        SrsAsyncIoWorker* worker = *it;
+        srs_freep(worker);
+    }
+    workers.clear();
+    
+    // wakeup the waiting threads.
+    st_cond_broadcast(done_cond);
+}
+
+int SrsAsyncIo::alloc_key()
+{
+    return nb_keys++;
+}
+
+int SrsAsyncIo::execute(int key, ISrsAsyncIoTask* t)
+{
+    int ret = ERROR_SUCCESS;
+    
+    t->key = key;
+    
+    // execute in st thread when no workers.
+    if (workers.empty()) {
+        on_task_done(t, t->call());
+        srs_freep(t);
+        return ret;
+    }
+    
+    SrsAsyncIoWorker* worker = workers.at(key % (int)workers.size());
+    
+    // drop the write when disk stalls, never eat up the memory.
+    int size = t->nb_bytes();
+    if (size > 0 && worker->nb_pending + size > SRS_PERF_ASYNC_IO_MAX_PENDING) {
+        ret = ERROR_SYSTEM_ASYNC_IO_FULL;
+        worker->nb_drops++;
+        srs_warn("async io full, drop %s, size=%d, pending=%"PRId64", drops=%"PRId64". ret=%d",
+            t->to_string().c_str(), size, worker->nb_pending, worker->nb_drops, ret);
+        srs_freep(t);
+        return ret;
+    }
+    
+    worker->nb_pending += size;
+    worker->submitted++;
+    worker->push(t);
+    
+    return ret;
+}
+
+int SrsAsyncIo::fetch_error(int key)
+{
+    if (errors.empty()) {
+        return ERROR_SUCCESS;
+    }
+    
+    std::map<int, int>::iterator it = errors.find(key);
+    if (it == errors.end()) {
+        return ERROR_SUCCESS;
+    }
+    
+    int ret = it->second;
+    errors.erase(it);
+    
+    return ret;
+}
+
+int64_t SrsAsyncIo::sequence(int key)
+{
+    if (workers.empty()) {
+        return 0;
+    }
+    
+    SrsAsyncIoWorker* worker = workers.at(key % (int)workers.size());
+    return worker->submitted;
+}
+
+void SrsAsyncIo::wait(int key, int64_t seq)
+{
+    while (!workers.empty()) {
+        SrsAsyncIoWorker* worker = workers.at(key % (int)workers.size());
+        if (worker->completed >= seq) {
+            break;
+        }
+        
+        st_cond_wait(done_cond);
+    }
+}
+
+void SrsAsyncIo::notify()
+{
+    char v = 0;
+    
+    // the pipe is never full, for worker only notify once before st fetch.
+    ssize_t nwrite = ::write(done_pipe[1], &v, 1);
+    (void)nwrite;
+}
+
+int SrsAsyncIo::cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    char buf[64];
+    while (pthread->can_loop()) {
+        ssize_t nread = st_read(done_stfd, buf, sizeof(buf), ST_UTIME_NO_TIMEOUT);
+        if (nread <= 0) {
+            return ret;
+        }
+        
+        on_completed();
+    }
+    
+    return ret;
+}
+
+void SrsAsyncIo::on_completed()
+{
+    bool has_completed = false;
+    
+    std::vector<SrsAsyncIoWorker*>::iterator it;
+    for (it = workers.begin(); it != workers.end(); ++it) {
+        SrsAsyncIoWorker* worker = *it;
+        
+        std::vector< std::pair<ISrsAsyncIoTask*, int> > tasks;
+        worker->swap_done(tasks);
+        
+        std::vector< std::pair<ISrsAsyncIoTask*, int> >::iterator dit;
+        for (dit = tasks.begin(); dit != tasks.end(); ++dit) {
+            ISrsAsyncIoTask* task = dit->first;
+            
+            on_task_done(task, dit->second);
+            worker->nb_pending -= task->nb_bytes();
+            srs_freep(task);
+            
+            worker->completed++;
+            has_completed = true;
+        }
+    }
+    
+    if (has_completed) {
+        st_cond_broadcast(done_cond);
+    }
+}
+
+void SrsAsyncIo::on_task_done(ISrsAsyncIoTask* task, int ret)
+{
+    if (ret == ERROR_SUCCESS) {
+        return;
+    }
+    
+    // the expired file maybe already removed, ignore.
+    if (ret == ERROR_SYSTEM_FILE_UNLINK) {
+        srs_warn("ignore async io %s, ret=%d", task->to_string().c_str(), ret);
+        return;
+    }
+    srs_error("async io %s failed. ret=%d", task->to_string().c_str(), ret);
+    
+    // only keep the first error, the following tasks of file are ignored.
+    if (errors.find(task->key) == errors.end()) {
+        errors[task->key] = ret;
+    }
+}
+
+SrsAsyncFileWriter::SrsAsyncFileWriter(int k)
+{
+    key = k;
+    file = NULL;
+    offset = 0;
+    buffer = NULL;
+    nb_buffer = 0;
+    dontneed = false;
+    dropped = false;
+}
+
+SrsAsyncFileWriter::~SrsAsyncFileWriter()
+{
+    close();
+    srs_freepa(buffer);
+}
+
+int SrsAsyncFileWriter::open(string p)
+{
+    return do_open(p, false);
+}
+
+int SrsAsyncFileWriter::open_append(string p)
+{
+    return do_open(p, true);
+}
+
+void SrsAsyncFileWriter::close()
+{
+    if (!file) {
+        return;
+    }
+    
+    // the close task owns the file.
+    SrsAsyncIoFile* f = file;
+    flush();
+    file = NULL;
+    
+    _srs_async_io->execute(key, new SrsAsyncIoCloseTask(f));
+}
+
+bool SrsAsyncFileWriter::is_open()
+{
+    return file != NULL;
+}
+
+void SrsAsyncFileWriter::lseek(int64_t o)
+{
+    flush();
+    offset = o;
+}
+
+int64_t SrsAsyncFileWriter::tellg()
+{
+    return offset;
+}
+
+int SrsAsyncFileWriter::write(void* buf, size_t count, ssize_t* pnwrite)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!file) {
+        ret = ERROR_SYSTEM_FILE_WRITE;
+        srs_error("write to file failed, not opened. ret=%d", ret);
+        return ret;
+    }
+    
+    // the previous tasks of stream failed, for example, open or rename.
+    if ((ret = _srs_async_io->fetch_error(key)) != ERROR_SUCCESS) {
+        srs_error("write to %s failed, async io error. ret=%d", file->path.c_str(), ret);
+        return ret;
+    }
+    
+    char* p = (char*)buf;
+    int left = (int)count;
+    while (left > 0) {
+        if (!buffer) {
+            buffer = new char[SRS_PERF_ASYNC_IO_BUFFER];
+        }
+        
+        int size = srs_min(left, SRS_PERF_ASYNC_IO_BUFFER - nb_buffer);
+        memcpy(buffer + nb_buffer, p, size);
+        nb_buffer += size;
+        offset += size;
+        p += size;
+        left -= size;
+        
+        if (nb_buffer >= SRS_PERF_ASYNC_IO_BUFFER && (ret = flush()) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    if (pnwrite != NULL) {
+        *pnwrite = (ssize_t)count;
+    }
+    
+    return ret;
+}
+
+int SrsAsyncFileWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
+{
+    return write_iovs(iov, iovcnt, pnwrite);
+}
+
+void SrsAsyncFileWriter::set_dontneed(bool v)
+{
+    dontneed = v;
+}
+
+int SrsAsyncFileWriter::do_open(string p, bool append)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (file) {
+        ret = ERROR_SYSTEM_FILE_ALREADY_OPENED;
+        srs_error("file %s already opened. ret=%d", file->path.c_str(), ret);
+        return ret;
+    }
+    
+    // in append mode, the logical offset starts from the end of file.
+    offset = 0;
+    struct stat st;
+    if (append && ::stat(p.c_str(), &st) == 0) {
+        offset = (int64_t)st.st_size;
+    }
+    
+    dropped = false;
+    file = new SrsAsyncIoFile(p, append);
+    file->dontneed = dontneed;
+    return _srs_async_io->execute(key, new SrsAsyncIoOpenTask(file));
+}
+
+int SrsAsyncFileWriter::flush()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (nb_buffer <= 0) {
+        return ret;
+    }
+    
+    // the write task owns the buffer.
+    char* b = buffer;
+    int size = nb_buffer;
+    buffer = NULL;
+    nb_buffer = 0;
+    
+    // the file is broken, the error is already returned.
+    if (dropped) {
+        srs_freepa(b);
+        return ret;
+    }
+    
+    if ((ret = _srs_async_io->execute(key, new SrsAsyncIoWriteTask(file, offset - size, b, size))) != ERROR_SUCCESS) {
+        dropped = true;
+        return ret;
+    }
+    
+    return ret;
+}
+
+// @global async file io, user must use srs_initialize_async_io to initialize it.
+SrsAsyncIo* _srs_async_io = NULL;
+
+int srs_initialize_async_io()
+{
+    int ret = ERROR_SUCCESS;
+    
+    _srs_async_io = new SrsAsyncIo();
+    
+    if ((ret = _srs_async_io->initialize(SRS_PERF_ASYNC_IO_WORKERS)) != ERROR_SUCCESS) {
+        srs_error("initialize the async io failed. ret=%d", ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+void srs_dispose_async_io()
+{
+    // stop the workers to flush all files to disk,
+    // but never free it, for the sources write files in st when destroy.
+    if (_srs_async_io) {
+        _srs_async_io->stop();
+    }
+}
+
@@ -0,0 +1,383 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef SRS_APP_ASYNC_IO_HPP
+#define SRS_APP_ASYNC_IO_HPP
+
+/*
+#include <srs_app_async_io.hpp>
+*/
+#include <srs_core.hpp>
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+#include <srs_app_st.hpp>
+#include <srs_app_thread.hpp>
+#include <srs_kernel_file.hpp>
+
+class SrsAsyncIo;
+
+/**
+ * the async file io task, for example, to write a buffer to file,
+ * to rename or unlink a file. the task is executed in the file io
+ * worker, which is a real thread(pthread), so a slow disk never
+ * block the st threads which deliver the media.
+ * @remark the call() is invoked in pthread, so it must never use st,
+ *       log, config or any other global object, only the system calls.
+ */
+class ISrsAsyncIoTask
+{
+public:
+    // the key of stream which submit the task, set by async io.
+    int key;
+public:
+    ISrsAsyncIoTask();
+    virtual ~ISrsAsyncIoTask();
+public:
+    /**
+     * execute the task in the file io worker.
+     * @remark the error is logged by st thread when task completed.
+     */
+    virtual int call() = 0;
+    /**
+     * convert task to string to describe it.
+     * used for logger.
+     */
+    virtual std::string to_string() = 0;
+    /**
+     * the bytes hold by task, to limit the pending bytes of worker.
+     * @remark default to 0, only the write task holds buffer.
+     */
+    virtual int nb_bytes();
+};
+
+/**
+ * the file shared by the async tasks of a file writer,
+ * the fd is only used by the file io worker, in the order of tasks.
+ */
+class SrsAsyncIoFile
+{
+public:
+    std::string path;
+    int fd;
+    // whether the file is opened in append mode.
+    bool append;
+    // whether the task of file failed, the error is already reported,
+    // so the following tasks of file are ignored.
+    bool failed;
+    // whether drop the pages of file from page cache once on disk.
+    bool dontneed;
+    // the end of bytes written, the bytes start to write back,
+    // and the bytes on disk and dropped from page cache.
+    int64_t written;
+    int64_t synced;
+    int64_t dropped;
+public:
+    SrsAsyncIoFile(std::string p, bool a);
+    virtual ~SrsAsyncIoFile();
+public:
+    /**
+     * when write bytes at offset, start to write back the dirty pages
+     * when over SRS_PERF_ASYNC_IO_WRITEBACK bytes, and drop the pages
+     * written back last time when dontneed.
+     * @param closing whether the file is closing, write back and drop all.
+     * @remark the writeback is advisory, the error is ignored.
+     */
+    virtual void writeback(int64_t offset, int size, bool closing);
+};
+
+/**
+ * open the file, in truncate or append mode.
+ */
+class SrsAsyncIoOpenTask : public ISrsAsyncIoTask
+{
+private:
+    SrsAsyncIoFile* file;
+public:
+    SrsAsyncIoOpenTask(SrsAsyncIoFile* f);
+    virtual ~SrsAsyncIoOpenTask();
+public:
+    virtual int call();
+    virtual std::string to_string();
+};
+
+/**
+ * write the buffer to file at offset, the task owns the buffer.
+ */
+class SrsAsyncIoWriteTask : public ISrsAsyncIoTask
+{
+private:
+    SrsAsyncIoFile* file;
+    int64_t offset;
+    char* buf;
+    int size;
+public:
+    SrsAsyncIoWriteTask(SrsAsyncIoFile* f, int64_t o, char* b, int s);
+    virtual ~SrsAsyncIoWriteTask();
+public:
+    virtual int call();
+    virtual std::string to_string();
+    virtual int nb_bytes();
+};
+
+/**
+ * close the file, the task owns the file and free it.
+ */
+class SrsAsyncIoCloseTask : public ISrsAsyncIoTask
+{
+private:
+    SrsAsyncIoFile* file;
+public:
+    SrsAsyncIoCloseTask(SrsAsyncIoFile* f);
+    virtual ~SrsAsyncIoCloseTask();
+public:
+    virtual int call();
+    virtual std::string to_string();
+};
+
+/**
+ * rename the file, for example, the tmp ts to ts.
+ */
+class SrsAsyncIoRenameTask : public ISrsAsyncIoTask
+{
+private:
+    std::string from;
+    std::string to;
+public:
+    SrsAsyncIoRenameTask(std::string f, std::string t);
+    virtual ~SrsAsyncIoRenameTask();
+public:
+    virtual int call();
+    virtual std::string to_string();
+};
+
+/**
+ * unlink the file, for example, the expired ts.
+ */
+class SrsAsyncIoUnlinkTask : public ISrsAsyncIoTask
+{
+private:
+    std::string path;
+public:
+    SrsAsyncIoUnlinkTask(std::string p);
+    virtual ~SrsAsyncIoUnlinkTask();
+public:
+    virtual int call();
+    virtual std::string to_string();
+};
+
+/**
+ * the file io worker, a pthread to execute the tasks in fifo,
+ * and notify the st thread of async io by pipe when tasks completed.
+ */
+class SrsAsyncIoWorker
+{
+private:
+    SrsAsyncIo* io;
+    pthread_t tid;
+    bool started;
+    // the fields protected by lock, shared by st and pthread.
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool quit;
+    std::deque<ISrsAsyncIoTask*> tasks;
+    std::vector< std::pair<ISrsAsyncIoTask*, int> > done;
+public:
+    // the sequence of the last submitted and completed task,
+    // only used in st thread.
+    int64_t submitted;
+    int64_t completed;
+    // the bytes of tasks submitted but not completed, and the number
+    // of tasks dropped when over SRS_PERF_ASYNC_IO_MAX_PENDING,
+    // only used in st thread.
+    int64_t nb_pending;
+    int64_t nb_drops;
+public:
+    SrsAsyncIoWorker(SrsAsyncIo* o);
+    virtual ~SrsAsyncIoWorker();
+public:
+    virtual int start();
+    /**
+     * stop the worker, wait for all tasks to be executed.
+     */
+    virtual void stop();
+    /**
+     * submit the task to worker, in st thread.
+     */
+    virtual void push(ISrsAsyncIoTask* t);
+    /**
+     * fetch the completed tasks with its ret, in st thread.
+     */
+    virtual void swap_done(std::vector< std::pair<ISrsAsyncIoTask*, int> >& completed_tasks);
+private:
+    static void* worker_pthread(void* arg);
+    virtual void do_cycle();
+};
+
+/**
+ * the async file io for HLS, DVR and HDS, which write files in pthreads.
+ * each stream alloc a key, all tasks of a key are executed in the same
+ * worker in order, so the ts is written before renamed, and the m3u8
+ * is updated after the ts renamed.
+ * when task completed, the worker notify the st thread by pipe, which
+ * log the error of task, and wakeup the waiting st threads.
+ * the error of task is kept for its key, which is fetched and returned to
+ * the muxer by the next write of stream, for example, the ts failed to open
+ * or rename.
+ * @remark when no workers, the task is executed in st thread directly.
+ */
+class SrsAsyncIo : public ISrsReusableThreadHandler
+{
+private:
+    SrsReusableThread* pthread;
+    std::vector<SrsAsyncIoWorker*> workers;
+    // the number of keys allocated, shared by all async io.
+    static int nb_keys;
+    // the pipe to notify st when tasks completed.
+    int done_pipe[2];
+    st_netfd_t done_stfd;
+    // signal when tasks completed.
+    st_cond_t done_cond;
+    // the first error of tasks for each key, not fetched yet.
+    std::map<int, int> errors;
+public:
+    SrsAsyncIo();
+    virtual ~SrsAsyncIo();
+public:
+    /**
+     * initialize and start the workers.
+     * @param nb_workers the number of workers, 0 to write files in st.
+     */
+    virtual int initialize(int nb_workers);
+    /**
+     * stop all workers, wait for the submitted tasks to be executed,
+     * then execute the tasks in st thread directly.
+     */
+    virtual void stop();
+    /**
+     * alloc a key for stream, the tasks of key are executed in order.
+     * @remark the key never depends on the global async io, so the stream
+     *       is able to create before the async io initialized, for example,
+     *       the hls muxer in utest.
+     */
+    static int alloc_key();
+    /**
+     * submit the task of key to worker, the task is freed when completed.
+     * @return ERROR_SYSTEM_ASYNC_IO_FULL when the pending bytes of worker
+     *       over SRS_PERF_ASYNC_IO_MAX_PENDING, the task is dropped and freed.
+     * @remark the io error is kept when completed, use fetch_error to get it.
+     */
+    virtual int execute(int key, ISrsAsyncIoTask* t);
+    /**
+     * fetch and clear the error of completed tasks of key.
+     * @remark the error of unlink is ignored, for the file maybe not exists.
+     */
+    virtual int fetch_error(int key);
+    /**
+     * get the sequence of the last submitted task of key,
+     * which can be used to wait for the tasks to complete.
+     */
+    virtual int64_t sequence(int key);
+    /**
+     * wait util the tasks of key before sequence completed,
+     * for example, the http hooks wait for the ts file written.
+     * @remark it cause the st thread switch, never use it in media path.
+     */
+    virtual void wait(int key, int64_t seq);
+    /**
+     * notify the st thread that tasks completed, in pthread.
+     */
+    virtual void notify();
+// interface ISrsReusableThreadHandler
+public:
+    virtual int cycle();
+private:
+    virtual void on_completed();
+    virtual void on_task_done(ISrsAsyncIoTask* task, int ret);
+};
+
+/**
+ * the file writer to write file in file io worker,
+ * the writes are buffered then submit to worker in order,
+ * so the write never block st, and the tellg/lseek use the
+ * logical offset of file.
+ * @remark the io error of stream is returned by the next write, and when
+ *       the write dropped for worker is full, the file is broken, so all
+ *       the following writes of file are dropped.
+ */
+class SrsAsyncFileWriter : public SrsFileWriter
+{
+private:
+    int key;
+    SrsAsyncIoFile* file;
+    // the logical offset of file, including the buffered bytes.
+    int64_t offset;
+    // the buffer to write, and the buffered bytes.
+    char* buffer;
+    int nb_buffer;
+    // whether drop the pages of file once on disk.
+    bool dontneed;
+    // whether the write of file dropped, ignore the following writes.
+    bool dropped;
+public:
+    SrsAsyncFileWriter(int k);
+    virtual ~SrsAsyncFileWriter();
+public:
+    virtual int open(std::string p);
+    virtual int open_append(std::string p);
+    virtual void close();
+public:
+    virtual bool is_open();
+    virtual void lseek(int64_t o);
+    virtual int64_t tellg();
+public:
+    virtual int write(void* buf, size_t count, ssize_t* pnwrite);
+    /**
+     * copy the iovs to buffer, which is written in a syscall by worker.
+     */
+    virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+    /**
+     * the file is never read again, for example, the dvr flv, so
+     * drop its pages from page cache once on disk.
+     * @remark must be set before open.
+     */
+    virtual void set_dontneed(bool v);
+private:
+    virtual int do_open(std::string p, bool append);
+    virtual int flush();
+};
+
+// @global async file io, user must use srs_initialize_async_io to initialize it.
+extern SrsAsyncIo* _srs_async_io;
+
+// initialize and dispose the global async file io.
+extern int srs_initialize_async_io();
+extern void srs_dispose_async_io();
+
+#endif
+
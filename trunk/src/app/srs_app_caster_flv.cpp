@@ -43,11 +43,13 @@ using namespace std;
 #include <srs_protocol_amf0.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_app_rtmp_conn.hpp>
+#include <srs_app_caster_publisher.hpp>
 
 #define SRS_HTTP_FLV_STREAM_BUFFER 4096
 
-SrsAppCasterFlv::SrsAppCasterFlv(SrsConfDirective* c)
+SrsAppCasterFlv::SrsAppCasterFlv(ISrsSourceHandler* h, SrsConfDirective* c)
 {
+    handler = h;
     http_mux = new SrsHttpServeMux();
     output = _srs_config->get_stream_caster_output(c);
 }
@@ -72,7 +74,7 @@ int SrsAppCasterFlv::on_tcp_client(st_netfd_t stfd)
     int ret = ERROR_SUCCESS;
     
     string ip = srs_get_peer_ip(st_netfd_fileno(stfd));
-    SrsHttpConn* conn = new SrsDynamicHttpConn(this, stfd, http_mux, ip);
+    SrsHttpConn* conn = new SrsDynamicHttpConn(handler, this, stfd, http_mux, ip);
     conns.push_back(conn);
     
     if ((ret = conn->start()) != ERROR_SUCCESS) {
@@ -116,10 +118,10 @@ int SrsAppCasterFlv::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     return conn->proxy(w, r, o);
 }
 
-SrsDynamicHttpConn::SrsDynamicHttpConn(IConnectionManager* cm, st_netfd_t fd, SrsHttpServeMux* m, string cip)
+SrsDynamicHttpConn::SrsDynamicHttpConn(ISrsSourceHandler* h, IConnectionManager* cm, st_netfd_t fd, SrsHttpServeMux* m, string cip)
     : SrsHttpConn(cm, fd, m, cip)
 {
-    sdk = new SrsSimpleRtmpClient();
+    sdk = new SrsCasterPublisher(h, this);
     pprint = SrsPithyPrint::create_caster();
 }
 
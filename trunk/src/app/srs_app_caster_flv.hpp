@@ -44,7 +44,8 @@ class SrsPithyPrint;
 class ISrsHttpResponseReader;
 class SrsFlvDecoder;
 class SrsTcpClient;
-class SrsSimpleRtmpClient;
+class SrsCasterPublisher;
+class ISrsSourceHandler;
 
 #include <srs_app_st.hpp>
 #include <srs_app_listener.hpp>
@@ -59,11 +60,12 @@ class SrsAppCasterFlv : virtual public ISrsTcpHandler
     , virtual public IConnectionManager, virtual public ISrsHttpHandler
 {
 private:
+    ISrsSourceHandler* handler;
     std::string output;
     SrsHttpServeMux* http_mux;
     std::vector<SrsHttpConn*> conns;
 public:
-    SrsAppCasterFlv(SrsConfDirective* c);
+    SrsAppCasterFlv(ISrsSourceHandler* h, SrsConfDirective* c);
     virtual ~SrsAppCasterFlv();
 public:
     virtual int initialize();
@@ -86,9 +88,9 @@ class SrsDynamicHttpConn : public SrsHttpConn
 private:
     std::string output;
     SrsPithyPrint* pprint;
-    SrsSimpleRtmpClient* sdk;
+    SrsCasterPublisher* sdk;
 public:
-    SrsDynamicHttpConn(IConnectionManager* cm, st_netfd_t fd, SrsHttpServeMux* m, std::string cip);
+    SrsDynamicHttpConn(ISrsSourceHandler* h, IConnectionManager* cm, st_netfd_t fd, SrsHttpServeMux* m, std::string cip);
     virtual ~SrsDynamicHttpConn();
 public:
     virtual int on_got_http_message(ISrsHttpMessage* msg);
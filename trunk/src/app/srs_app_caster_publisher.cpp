@@ -0,0 +1,519 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_app_caster_publisher.hpp>
+
+#ifdef SRS_AUTO_STREAM_CASTER
+
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_flv.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_core_autofree.hpp>
+#include <srs_rtmp_stack.hpp>
+#include <srs_protocol_amf0.hpp>
+#include <srs_protocol_utility.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_source.hpp>
+#include <srs_app_security.hpp>
+#include <srs_app_statistic.hpp>
+#include <srs_app_http_hooks.hpp>
+#include <srs_app_rtmp_conn.hpp>
+#include <srs_app_utility.hpp>
+#include <srs_app_worker.hpp>
+
+SrsCasterPublisher::SrsCasterPublisher(ISrsSourceHandler* h, SrsConnection* c)
+{
+    handler = h;
+    conn = c;
+    sdk = new SrsSimpleRtmpClient();
+    
+    req = NULL;
+    source = NULL;
+    security = new SrsSecurity();
+    cid = 0;
+    nb_recv_bytes = 0;
+    local_connected = false;
+    local_publishing = false;
+    expired = false;
+}
+
+SrsCasterPublisher::~SrsCasterPublisher()
+{
+    close();
+    
+    srs_freep(sdk);
+    srs_freep(security);
+}
+
+int SrsCasterPublisher::connect(string url, int64_t connect_timeout, int64_t stream_timeout)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // when ok, ignore.
+    if (connected()) {
+        return ret;
+    }
+    
+    // cleanup the expired publish.
+    close();
+    
+    // parse uri
+    SrsRequest* r = new SrsRequest();
+    srs_parse_rtmp_url(url, r->tcUrl, r->stream);
+    srs_discovery_tc_url(r->tcUrl, r->schema, r->host, r->vhost, r->app, r->port, r->param);
+    r->strip();
+    
+    // publish to other server by rtmp.
+    if (!is_local(r)) {
+        srs_freep(r);
+        return sdk->connect(url, connect_timeout, stream_timeout);
+    }
+    
+    // the caster publish as the rtmp client from loopback.
+    srs_freep(req);
+    req = r;
+    req->ip = "127.0.0.1";
+    cid = _srs_context->get_id();
+    nb_recv_bytes = 0;
+    expired = false;
+    
+    return local_connect();
+}
+
+bool SrsCasterPublisher::connected()
+{
+    if (req) {
+        return local_connected && !expired;
+    }
+    return sdk->connected();
+}
+
+void SrsCasterPublisher::close()
+{
+    sdk->close();
+    
+    if (!req) {
+        return;
+    }
+    
+    if (local_publishing) {
+        local_unpublish();
+    }
+    
+    if (local_connected) {
+        http_hooks_on_close();
+        local_connected = false;
+    }
+    
+    SrsStatistic::instance()->on_disconnect(cid);
+    
+    source = NULL;
+    srs_freep(req);
+}
+
+int SrsCasterPublisher::publish()
+{
+    if (!req) {
+        return sdk->publish();
+    }
+    return local_publish();
+}
+
+int SrsCasterPublisher::rtmp_create_msg(char type, u_int32_t timestamp, char* data, int size, SrsSharedPtrMessage** pmsg)
+{
+    if (!req) {
+        return sdk->rtmp_create_msg(type, timestamp, data, size, pmsg);
+    }
+    
+    *pmsg = NULL;
+    
+    int ret = ERROR_SUCCESS;
+    
+    if ((ret = srs_rtmp_create_msg(type, timestamp, data, size, 1, pmsg)) != ERROR_SUCCESS) {
+        srs_error("caster: create shared ptr msg failed. ret=%d", ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+int SrsCasterPublisher::send_and_free_message(SrsSharedPtrMessage* msg)
+{
+    if (!req) {
+        return sdk->send_and_free_message(msg);
+    }
+    
+    SrsAutoFree(SrsSharedPtrMessage, msg);
+    return local_send(msg);
+}
+
+void SrsCasterPublisher::expire()
+{
+    expired = true;
+    
+    if (conn) {
+        conn->expire();
+    }
+}
+
+bool SrsCasterPublisher::is_local(SrsRequest* r)
+{
+    // the edge proxy the publish to origin, by rtmp.
+    if (_srs_config->get_vhost_is_edge(r->vhost)) {
+        return false;
+    }
+    
+    string host = r->host;
+    if (host == "localhost") {
+        host = "127.0.0.1";
+    }
+    
+    vector<string>& ips = srs_get_local_ipv4_ips();
+    if (host != "127.0.0.1" && std::find(ips.begin(), ips.end(), host) == ips.end()) {
+        return false;
+    }
+    
+    // the port must be the rtmp port of server.
+    vector<string> ip_ports = _srs_config->get_listens();
+    for (int i = 0; i < (int)ip_ports.size(); i++) {
+        string ip;
+        int port;
+        srs_parse_endpoint(ip_ports[i], ip, port);
+        
+        if (port == r->port && (ip == "0.0.0.0" || ip == host)) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+int SrsCasterPublisher::local_connect()
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsConfDirective* vhost = _srs_config->get_vhost(req->vhost, true);
+    if (vhost == NULL) {
+        ret = ERROR_RTMP_VHOST_NOT_FOUND;
+        srs_error("caster: vhost %s not found. ret=%d", req->vhost.c_str(), ret);
+        return ret;
+    }
+    
+    if (!_srs_config->get_vhost_enabled(req->vhost)) {
+        ret = ERROR_RTMP_VHOST_NOT_FOUND;
+        srs_error("caster: vhost %s disabled. ret=%d", req->vhost.c_str(), ret);
+        return ret;
+    }
+    
+    if (req->vhost != vhost->arg0()) {
+        srs_trace("caster: vhost change from %s to %s", req->vhost.c_str(), vhost->arg0().c_str());
+        req->vhost = vhost->arg0();
+    }
+    
+    if ((ret = http_hooks_on_connect()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    local_connected = true;
+    
+    srs_trace("caster: connect local source, tcUrl=%s, stream=%s", req->tcUrl.c_str(), req->stream.c_str());
+    
+    return ret;
+}
+
+int SrsCasterPublisher::local_publish()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (local_publishing) {
+        return ret;
+    }
+    
+    // security check
+    if ((ret = security->check(SrsRtmpConnFMLEPublish, req->ip, req)) != ERROR_SUCCESS) {
+        srs_error("caster: security check failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // find a source to serve.
+    if ((ret = SrsSource::fetch_or_create(req, handler, &source)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    srs_assert(source != NULL);
+    
+    // update the statistic when source disconveried.
+    SrsStatistic* stat = SrsStatistic::instance();
+    if ((ret = stat->on_client(cid, req, this, SrsRtmpConnFMLEPublish)) != ERROR_SUCCESS) {
+        srs_error("caster: stat client failed. ret=%d", ret);
+        return ret;
+    }
+    source->set_cache(_srs_config->get_gop_cache(req->vhost));
+    
+    if ((ret = http_hooks_on_publish()) != ERROR_SUCCESS) {
+        srs_error("caster: http hook on_publish failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // pin the stream to current worker, and stop pull it from other worker.
+    if ((ret = SrsWorkers::instance()->on_publish(req)) != ERROR_SUCCESS) {
+        http_hooks_on_unpublish();
+        return ret;
+    }
+    source->worker_relay_stop();
+    
+    // when stream is busy, should never release it.
+    if (!source->can_publish(false)) {
+        ret = ERROR_SYSTEM_STREAM_BUSY;
+        srs_warn("caster: stream %s is already publishing. ret=%d", req->get_stream_url().c_str(), ret);
+        http_hooks_on_unpublish();
+        return ret;
+    }
+    
+    // whatever the publish, always release it.
+    // @see https://github.com/ossrs/srs/issues/474
+    local_publishing = true;
+    if ((ret = source->on_publish()) != ERROR_SUCCESS) {
+        srs_error("caster: notify publish failed. ret=%d", ret);
+        local_unpublish();
+        return ret;
+    }
+    
+    srs_trace("caster: publish local source %s", req->get_stream_url().c_str());
+    
+    return ret;
+}
+
+void SrsCasterPublisher::local_unpublish()
+{
+    local_publishing = false;
+    
+    source->on_unpublish();
+    SrsWorkers::instance()->on_unpublish(req);
+    
+    http_hooks_on_unpublish();
+}
+
+int SrsCasterPublisher::local_send(SrsSharedPtrMessage* msg)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!local_publishing) {
+        ret = ERROR_STREAM_CASTER_NOT_PUBLISH;
+        srs_error("caster: send to %s which not publish. ret=%d", req->get_stream_url().c_str(), ret);
+        return ret;
+    }
+    
+    // when kicked off by api, disconnect it.
+    if (expired) {
+        ret = ERROR_USER_DISCONNECT;
+        srs_error("caster: publish %s expired. ret=%d", req->get_stream_url().c_str(), ret);
+        return ret;
+    }
+    
+    nb_recv_bytes += msg->size;
+    
+    if (msg->is_audio()) {
+        return source->on_audio(msg);
+    }
+    if (msg->is_video()) {
+        return source->on_video(msg);
+    }
+    
+    // the script data of flv tag, process the onMetaData.
+    SrsBuffer stream;
+    if ((ret = stream.initialize(msg->payload, msg->size)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    std::string name;
+    if ((ret = srs_amf0_read_string(&stream, name)) != ERROR_SUCCESS) {
+        srs_error("caster: decode data name failed. ret=%d", ret);
+        return ret;
+    }
+    
+    if (name != SRS_CONSTS_RTMP_SET_DATAFRAME && name != SRS_CONSTS_RTMP_ON_METADATA) {
+        srs_info("caster: ignore AMF0 data message %s.", name.c_str());
+        return ret;
+    }
+    
+    SrsOnMetaDataPacket metadata;
+    stream.skip(-1 * stream.pos());
+    if ((ret = metadata.decode(&stream)) != ERROR_SUCCESS) {
+        srs_error("caster: decode onMetaData failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // the source only use the header of message, and encode the metadata.
+    SrsCommonMessage common;
+    common.header.initialize_amf0_script(msg->size, msg->stream_id);
+    common.header.timestamp = msg->timestamp;
+    common.size = msg->size;
+    
+    if ((ret = source->on_meta_data(&common, &metadata)) != ERROR_SUCCESS) {
+        srs_error("caster: process onMetaData failed. ret=%d", ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+int SrsCasterPublisher::http_hooks_on_connect()
+{
+    int ret = ERROR_SUCCESS;
+    
+#ifdef SRS_AUTO_HTTP_CALLBACK
+    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
+        return ret;
+    }
+    
+    // the http hooks will cause context switch,
+    // so we must copy all hooks for the on_connect may freed.
+    // @see https://github.com/ossrs/srs/issues/475
+    vector<string> hooks;
+    
+    if (true) {
+        SrsConfDirective* conf = _srs_config->get_vhost_on_connect(req->vhost);
+        
+        if (!conf) {
+            srs_info("ignore the empty http callback: on_connect");
+            return ret;
+        }
+        
+        hooks = conf->args;
+    }
+    
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        if ((ret = SrsHttpHooks::on_connect(url, req)) != ERROR_SUCCESS) {
+            srs_error("hook caster on_connect failed. url=%s, ret=%d", url.c_str(), ret);
+            return ret;
+        }
+    }
+#endif
+    
+    return ret;
+}
+
+void SrsCasterPublisher::http_hooks_on_close()
+{
+#ifdef SRS_AUTO_HTTP_CALLBACK
+    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
+        return;
+    }
+    
+    // the http hooks will cause context switch,
+    // so we must copy all hooks for the on_connect may freed.
+    // @see https://github.com/ossrs/srs/issues/475
+    vector<string> hooks;
+    
+    if (true) {
+        SrsConfDirective* conf = _srs_config->get_vhost_on_close(req->vhost);
+        
+        if (!conf) {
+            srs_info("ignore the empty http callback: on_close");
+            return;
+        }
+        
+        hooks = conf->args;
+    }
+    
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        SrsHttpHooks::on_close(url, req, 0, nb_recv_bytes);
+    }
+#endif
+}
+
+int SrsCasterPublisher::http_hooks_on_publish()
+{
+    int ret = ERROR_SUCCESS;
+    
+#ifdef SRS_AUTO_HTTP_CALLBACK
+    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
+        return ret;
+    }
+    
+    // the http hooks will cause context switch,
+    // so we must copy all hooks for the on_connect may freed.
+    // @see https://github.com/ossrs/srs/issues/475
+    vector<string> hooks;
+    
+    if (true) {
+        SrsConfDirective* conf = _srs_config->get_vhost_on_publish(req->vhost);
+        
+        if (!conf) {
+            srs_info("ignore the empty http callback: on_publish");
+            return ret;
+        }
+        
+        hooks = conf->args;
+    }
+    
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        if ((ret = SrsHttpHooks::on_publish(url, req)) != ERROR_SUCCESS) {
+            srs_error("hook caster on_publish failed. url=%s, ret=%d", url.c_str(), ret);
+            return ret;
+        }
+    }
+#endif
+    
+    return ret;
+}
+
+void SrsCasterPublisher::http_hooks_on_unpublish()
+{
+#ifdef SRS_AUTO_HTTP_CALLBACK
+    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
+        return;
+    }
+    
+    // the http hooks will cause context switch,
+    // so we must copy all hooks for the on_connect may freed.
+    // @see https://github.com/ossrs/srs/issues/475
+    vector<string> hooks;
+    
+    if (true) {
+        SrsConfDirective* conf = _srs_config->get_vhost_on_unpublish(req->vhost);
+        
+        if (!conf) {
+            srs_info("ignore the empty http callback: on_unpublish");
+            return;
+        }
+        
+        hooks = conf->args;
+    }
+    
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        SrsHttpHooks::on_unpublish(url, req);
+    }
+#endif
+}
+
+#endif
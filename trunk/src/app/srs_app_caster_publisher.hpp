@@ -0,0 +1,123 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_APP_CASTER_PUBLISHER_HPP
+#define SRS_APP_CASTER_PUBLISHER_HPP
+
+/*
+#include <srs_app_caster_publisher.hpp>
+*/
+
+#include <srs_core.hpp>
+
+#include <string>
+
+#include <srs_app_conn.hpp>
+
+#ifdef SRS_AUTO_STREAM_CASTER
+
+class SrsRequest;
+class SrsSource;
+class ISrsSourceHandler;
+class SrsConnection;
+class SrsSecurity;
+class SrsSharedPtrMessage;
+class SrsSimpleRtmpClient;
+
+/**
+ * the publisher of stream casters, to publish the flv tags converted from
+ * the input, for example, the MPEG-TS over UDP, RTSP and HTTP-FLV, to the
+ * output rtmp url.
+ * when the url is served by this server, feed the source directly, with the
+ * same hooks, stats and security as the rtmp publish, so the tags are never
+ * chunked, written to loopback, read, dechunked and parsed again.
+ * otherwise, for example, the url of other server or edge vhost, publish to
+ * the server by rtmp.
+ * the caster is kicked off by http api as the rtmp client, by expire the
+ * publisher, and it republish when connect again.
+ */
+class SrsCasterPublisher : virtual public ISrsExpire
+{
+private:
+    ISrsSourceHandler* handler;
+    SrsConnection* conn;
+    // the rtmp client, to publish to other server.
+    SrsSimpleRtmpClient* sdk;
+private:
+    // the request of local source, NULL when not local.
+    SrsRequest* req;
+    SrsSource* source;
+    SrsSecurity* security;
+    // the id of publisher, to stat the client.
+    int cid;
+    // the bytes published to source, for the on_close hook.
+    int64_t nb_recv_bytes;
+    // whether connected to the local source, that is the on_connect is ok.
+    bool local_connected;
+    // whether publishing to the local source.
+    bool local_publishing;
+    // whether kicked off, the local publish must quit ASAP.
+    bool expired;
+public:
+    /**
+     * @param h the handler of source, the server.
+     * @param c the connection of caster to expire with publisher, NULL for none.
+     */
+    SrsCasterPublisher(ISrsSourceHandler* h, SrsConnection* c);
+    virtual ~SrsCasterPublisher();
+public:
+    /**
+     * connect to the rtmp url, local source or other server.
+     */
+    virtual int connect(std::string url, int64_t connect_timeout, int64_t stream_timeout);
+    virtual bool connected();
+    virtual void close();
+    virtual int publish();
+public:
+    virtual int rtmp_create_msg(char type, u_int32_t timestamp, char* data, int size, SrsSharedPtrMessage** pmsg);
+    /**
+     * publish the message and free it.
+     */
+    virtual int send_and_free_message(SrsSharedPtrMessage* msg);
+// interface ISrsExpire
+public:
+    virtual void expire();
+protected:
+    /**
+     * whether the url is served by this server.
+     */
+    virtual bool is_local(SrsRequest* r);
+private:
+    virtual int local_connect();
+    virtual int local_publish();
+    virtual void local_unpublish();
+    virtual int local_send(SrsSharedPtrMessage* msg);
+    virtual int http_hooks_on_connect();
+    virtual void http_hooks_on_close();
+    virtual int http_hooks_on_publish();
+    virtual void http_hooks_on_unpublish();
+};
+
+#endif
+
+#endif
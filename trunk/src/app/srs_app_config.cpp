@@ -52,6 +52,7 @@ using namespace std;
 #include <srs_app_http_hooks.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_rtmp_stack.hpp>
+#include <srs_app_security.hpp>
 
 using namespace _srs_internal;
 
@@ -1117,6 +1118,59 @@ int SrsConfDirective::read_token(SrsConfigBuffer* buffer, vector<string>& args,
     return ret;
 }
 
+SrsVhostConfig::SrsVhostConfig(string v)
+{
+    vhost = v;
+    exists = enabled = is_edge = false;
+    gop_cache = atc = atc_auto = mix_correct = reduce_sequence_header = parse_sps = false;
+    queue_length = 0;
+    time_jitter = 0;
+    mr_enabled = false;
+    mr_sleep_ms = 0;
+    hls_enabled = false;
+    hls_dispose = 0;
+    dvr_enabled = dvr_wait_keyframe = false;
+    dvr_time_jitter = 0;
+    
+    security_enabled = false;
+    security_rules = new SrsSecurityRules();
+}
+
+SrsVhostConfig::~SrsVhostConfig()
+{
+    srs_freep(security_rules);
+}
+
+void SrsVhostConfig::compile(SrsConfig* conf)
+{
+    exists = conf->get_vhost(vhost, false) != NULL;
+    enabled = conf->get_vhost_enabled(vhost);
+    is_edge = conf->get_vhost_is_edge(vhost);
+    
+    gop_cache = conf->get_gop_cache(vhost);
+    queue_length = conf->get_queue_length(vhost);
+    atc = conf->get_atc(vhost);
+    atc_auto = conf->get_atc_auto(vhost);
+    time_jitter = conf->get_time_jitter(vhost);
+    mix_correct = conf->get_mix_correct(vhost);
+    reduce_sequence_header = conf->get_reduce_sequence_header(vhost);
+    parse_sps = conf->get_parse_sps(vhost);
+    
+    mr_enabled = conf->get_mr_enabled(vhost);
+    mr_sleep_ms = conf->get_mr_sleep_ms(vhost);
+    
+    hls_enabled = conf->get_hls_enabled(vhost);
+    hls_on_error = conf->get_hls_on_error(vhost);
+    hls_dispose = conf->get_hls_dispose(vhost);
+    
+    dvr_enabled = conf->get_dvr_enabled(vhost);
+    dvr_wait_keyframe = conf->get_dvr_wait_keyframe(vhost);
+    dvr_time_jitter = conf->get_dvr_time_jitter(vhost);
+    
+    security_enabled = conf->get_security_enabled(vhost);
+    security_rules->compile(conf->get_security_rules(vhost));
+}
+
 SrsConfig::SrsConfig()
 {
     dolphin = false;
@@ -1133,6 +1187,13 @@ SrsConfig::SrsConfig()
 SrsConfig::~SrsConfig()
 {
     srs_freep(root);
+    
+    std::map<std::string, SrsVhostConfig*>::iterator it;
+    for (it = vhost_configs.begin(); it != vhost_configs.end(); ++it) {
+        SrsVhostConfig* vconf = it->second;
+        srs_freep(vconf);
+    }
+    vhost_configs.clear();
 }
 
 bool SrsConfig::is_dolphin()
@@ -1472,6 +1533,9 @@ int SrsConfig::reload_conf(SrsConfig* conf)
     root = conf->root;
     conf->root = NULL;
     
+    // update the snapshot of vhosts before notify the handlers.
+    compile_vhost_configs();
+    
     // merge config.
     std::vector<ISrsReloadHandler*>::iterator it;
 
@@ -2165,6 +2229,8 @@ int SrsConfig::global_to_json(SrsJsonObject* obj)
                     sobj->set(sdir->name, sdir->dumps_arg0_to_str());
                 } else if (sdir->name == "dir") {
                     sobj->set(sdir->name, sdir->dumps_arg0_to_str());
+                } else if (sdir->name == "hls_ram_budget") {
+                    sobj->set(sdir->name, sdir->dumps_arg0_to_integer());
                 }
             }
             obj->set(dir->name, sobj);
@@ -2181,6 +2247,18 @@ int SrsConfig::global_to_json(SrsJsonObject* obj)
                 }
             }
             obj->set(dir->name, sobj);
+        } else if (dir->name == "rate_limit") {
+            SrsJsonObject* sobj = SrsJsonAny::object();
+            for (int j = 0; j < (int)dir->directives.size(); j++) {
+                SrsConfDirective* sdir = dir->directives.at(j);
+                if (sdir->name == "enabled") {
+                    sobj->set(sdir->name, sdir->dumps_arg0_to_boolean());
+                } else if (sdir->name == "connect_rate" || sdir->name == "connect_burst"
+                    || sdir->name == "play_rate" || sdir->name == "play_burst") {
+                    sobj->set(sdir->name, sdir->dumps_arg0_to_number());
+                }
+            }
+            obj->set(dir->name, sobj);
         } else if (dir->name == "stream_caster") {
             SrsJsonObject* sobj = SrsJsonAny::object();
             for (int j = 0; j < (int)dir->directives.size(); j++) {
@@ -2373,6 +2451,8 @@ int SrsConfig::vhost_to_json(SrsConfDirective* vhost, SrsJsonObject* obj)
                 cluster->set("mode", sdir->dumps_arg0_to_str());
             } else if (sdir->name == "origin") {
                 cluster->set("origin", sdir->dumps_arg0_to_str());
+            } else if (sdir->name == "balance") {
+                cluster->set("balance", sdir->dumps_arg0_to_str());
             } else if (sdir->name == "token_traverse") {
                 cluster->set("token_traverse", sdir->dumps_arg0_to_boolean());
             } else if (sdir->name == "vhost") {
@@ -2579,6 +2659,8 @@ int SrsConfig::vhost_to_json(SrsConfDirective* vhost, SrsJsonObject* obj)
                 http_hooks->set("on_unpublish", sdir->dumps_args());
             } else if (sdir->name == "on_play") {
                 http_hooks->set("on_play", sdir->dumps_args());
+            } else if (sdir->name == "on_play_cache_ttl") {
+                http_hooks->set("on_play_cache_ttl", sdir->dumps_arg0_to_integer());
             } else if (sdir->name == "on_stop") {
                 http_hooks->set("on_stop", sdir->dumps_args());
             } else if (sdir->name == "on_dvr") {
@@ -3059,6 +3141,8 @@ int SrsConfig::raw_create_vhost(string vhost, bool& applied)
     SrsConfDirective* conf = root->get_or_create("vhost", vhost);
     conf->get_or_create("enabled")->set_arg0("on");
     
+    compile_vhost_configs();
+    
     if ((ret = do_reload_vhost_added(vhost)) != ERROR_SUCCESS) {
         return ret;
     }
@@ -3078,6 +3162,8 @@ int SrsConfig::raw_update_vhost(string vhost, string name, bool& applied)
     SrsConfDirective* conf = root->get_or_create("vhost", vhost);
     conf->set_arg0(name);
     
+    compile_vhost_configs();
+    
     applied = true;
     
     return ret;
@@ -3097,6 +3183,8 @@ int SrsConfig::raw_delete_vhost(string vhost, bool& applied)
     root->remove(conf);
     srs_freep(conf);
     
+    compile_vhost_configs();
+    
     applied = true;
     
     return ret;
@@ -3111,6 +3199,8 @@ int SrsConfig::raw_disable_vhost(string vhost, bool& applied)
     SrsConfDirective* conf = root->get("vhost", vhost);
     conf->get_or_create("enabled")->set_arg0("off");
     
+    compile_vhost_configs();
+    
     if ((ret = do_reload_vhost_removed(vhost)) != ERROR_SUCCESS) {
         return ret;
     }
@@ -3129,6 +3219,8 @@ int SrsConfig::raw_enable_vhost(string vhost, bool& applied)
     SrsConfDirective* conf = root->get("vhost", vhost);
     conf->get_or_create("enabled")->set_arg0("on");
     
+    compile_vhost_configs();
+    
     if ((ret = do_reload_vhost_added(vhost)) != ERROR_SUCCESS) {
         return ret;
     }
@@ -3155,6 +3247,8 @@ int SrsConfig::raw_enable_dvr(string vhost, string stream, bool& applied)
         conf->args.push_back(stream);
     }
     
+    compile_vhost_configs();
+    
     if ((ret = do_reload_vhost_dvr_apply(vhost)) != ERROR_SUCCESS) {
         return ret;
     }
@@ -3183,6 +3277,8 @@ int SrsConfig::raw_disable_dvr(string vhost, string stream, bool& applied)
         conf->args.push_back("none");
     }
     
+    compile_vhost_configs();
+    
     if ((ret = do_reload_vhost_dvr_apply(vhost)) != ERROR_SUCCESS) {
         return ret;
     }
@@ -3548,6 +3644,7 @@ int SrsConfig::check_config()
             && n != "http_api" && n != "stats" && n != "vhost" && n != "pithy_print_ms"
             && n != "http_server" && n != "stream_caster" && n != "kafka"
             && n != "utc_time" && n != "work_dir" && n != "asprocess"
+            && n != "workers" && n != "rate_limit"
         ) {
             ret = ERROR_SYSTEM_CONFIG_INVALID;
             srs_error("unsupported directive %s, ret=%d", n.c_str(), ret);
@@ -3581,7 +3678,7 @@ int SrsConfig::check_config()
         SrsConfDirective* conf = root->get("http_server");
         for (int i = 0; conf && i < (int)conf->directives.size(); i++) {
             string n = conf->at(i)->name;
-            if (n != "enabled" && n != "listen" && n != "dir" && n != "crossdomain") {
+            if (n != "enabled" && n != "listen" && n != "dir" && n != "crossdomain" && n != "hls_ram_budget") {
                 ret = ERROR_SYSTEM_CONFIG_INVALID;
                 srs_error("unsupported http_stream directive %s, ret=%d", n.c_str(), ret);
                 return ret;
@@ -3599,6 +3696,19 @@ int SrsConfig::check_config()
             }
         }
     }
+    if (true) {
+        SrsConfDirective* conf = root->get("rate_limit");
+        for (int i = 0; conf && i < (int)conf->directives.size(); i++) {
+            string n = conf->at(i)->name;
+            if (n != "enabled" && n != "connect_rate" && n != "connect_burst"
+                && n != "play_rate" && n != "play_burst"
+            ) {
+                ret = ERROR_SYSTEM_CONFIG_INVALID;
+                srs_error("unsupported rate_limit directive %s, ret=%d", n.c_str(), ret);
+                return ret;
+            }
+        }
+    }
     if (true) {
         SrsConfDirective* conf = get_heartbeart();
         for (int i = 0; conf && i < (int)conf->directives.size(); i++) {
@@ -3867,7 +3977,7 @@ int SrsConfig::check_config()
             } else if (n == "cluster") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name.c_str();
-                    if (m != "mode" && m != "origin" && m != "token_traverse" && m != "vhost" && m != "debug_srs_upnode") {
+                    if (m != "mode" && m != "origin" && m != "balance" && m != "token_traverse" && m != "vhost" && m != "debug_srs_upnode") {
                         ret = ERROR_SYSTEM_CONFIG_INVALID;
                         srs_error("unsupported vhost cluster directive %s, ret=%d", m.c_str(), ret);
                         return ret;
@@ -3923,15 +4033,30 @@ int SrsConfig::check_config()
                     }
                     
                     // TODO: FIXME: remove it in future.
-                    if (m == "hls_storage" || m == "hls_mount") {
-                        srs_warn("HLS RAM is removed from SRS2 to SRS3+, please read https://github.com/ossrs/srs/issues/513.");
+                    if (m == "hls_mount") {
+                        srs_warn("HLS mount is removed from SRS2 to SRS3+, the hls in ram is served by http server.");
+                    }
+                    if (m == "hls_storage") {
+                        string v = conf->at(j)->arg0();
+                        if (v != "disk" && v != "ram" && v != "both") {
+                            ret = ERROR_SYSTEM_CONFIG_INVALID;
+                            srs_error("unsupported vhost hls hls_storage %s, ret=%d", v.c_str(), ret);
+                            return ret;
+                        }
+                        // the hls in ram is only in the worker which owns the stream,
+                        // while the http request maybe accepted by other workers.
+                        if (v != "disk" && get_workers() > 0) {
+                            ret = ERROR_SYSTEM_CONFIG_INVALID;
+                            srs_error("vhost hls hls_storage %s conflict with workers %d, ret=%d", v.c_str(), get_workers(), ret);
+                            return ret;
+                        }
                     }
                 }
             } else if (n == "http_hooks") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name.c_str();
                     if (m != "enabled" && m != "on_connect" && m != "on_close" && m != "on_publish"
-                        && m != "on_unpublish" && m != "on_play" && m != "on_stop"
+                        && m != "on_unpublish" && m != "on_play" && m != "on_play_cache_ttl" && m != "on_stop"
                         && m != "on_dvr" && m != "on_hls" && m != "on_hls_notify"
                         ) {
                         ret = ERROR_SYSTEM_CONFIG_INVALID;
@@ -4088,6 +4213,13 @@ int SrsConfig::check_config()
         return ret;
     }
     
+    // the workers must be positive, 0 to disable.
+    if (get_workers() < 0) {
+        ret = ERROR_SYSTEM_CONFIG_INVALID;
+        srs_error("workers must not be negative, actual %d, ret=%d", get_workers(), ret);
+        return ret;
+    }
+    
     return ret;
 }
 
@@ -4234,6 +4366,18 @@ bool SrsConfig::get_asprocess()
     return SRS_CONF_PERFER_FALSE(conf->arg0());
 }
 
+int SrsConfig::get_workers()
+{
+    static int DEFAULT = 0;
+    
+    SrsConfDirective* conf = root->get("workers");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atoi(conf->arg0().c_str());
+}
+
 vector<SrsConfDirective*> SrsConfig::get_stream_casters()
 {
     srs_assert(root);
@@ -4398,6 +4542,91 @@ string SrsConfig::get_kafka_topic()
     return conf->arg0();
 }
 
+bool SrsConfig::get_rate_limit_enabled()
+{
+    static bool DEFAULT = false;
+    
+    SrsConfDirective* conf = root->get("rate_limit");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("enabled");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return SRS_CONF_PERFER_FALSE(conf->arg0());
+}
+
+double SrsConfig::get_rate_limit_connect_rate()
+{
+    static double DEFAULT = 10;
+    
+    SrsConfDirective* conf = root->get("rate_limit");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("connect_rate");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
+double SrsConfig::get_rate_limit_connect_burst()
+{
+    static double DEFAULT = 20;
+    
+    SrsConfDirective* conf = root->get("rate_limit");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("connect_burst");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
+double SrsConfig::get_rate_limit_play_rate()
+{
+    static double DEFAULT = 5;
+    
+    SrsConfDirective* conf = root->get("rate_limit");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("play_rate");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
+double SrsConfig::get_rate_limit_play_burst()
+{
+    static double DEFAULT = 10;
+    
+    SrsConfDirective* conf = root->get("rate_limit");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("play_burst");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
 SrsConfDirective* SrsConfig::get_vhost(string vhost, bool try_default_vhost)
 {
     srs_assert(root);
@@ -4436,6 +4665,29 @@ void SrsConfig::get_vhosts(vector<SrsConfDirective*>& vhosts)
     }
 }
 
+SrsVhostConfig* SrsConfig::get_vhost_config(string vhost)
+{
+    std::map<std::string, SrsVhostConfig*>::iterator it = vhost_configs.find(vhost);
+    if (it != vhost_configs.end()) {
+        return it->second;
+    }
+    
+    SrsVhostConfig* vconf = new SrsVhostConfig(vhost);
+    vconf->compile(this);
+    vhost_configs[vhost] = vconf;
+    
+    return vconf;
+}
+
+void SrsConfig::compile_vhost_configs()
+{
+    std::map<std::string, SrsVhostConfig*>::iterator it;
+    for (it = vhost_configs.begin(); it != vhost_configs.end(); ++it) {
+        SrsVhostConfig* vconf = it->second;
+        vconf->compile(this);
+    }
+}
+
 bool SrsConfig::get_vhost_enabled(string vhost)
 {
     SrsConfDirective* conf = get_vhost(vhost);
@@ -5040,6 +5292,23 @@ SrsConfDirective* SrsConfig::get_vhost_on_play(string vhost)
     return conf->get("on_play");
 }
 
+int SrsConfig::get_vhost_on_play_cache_ttl(string vhost)
+{
+    static int DEFAULT = 0;
+    
+    SrsConfDirective* conf = get_vhost_http_hooks(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("on_play_cache_ttl");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atoi(conf->arg0().c_str());
+}
+
 SrsConfDirective* SrsConfig::get_vhost_on_stop(string vhost)
 {
     SrsConfDirective* conf = get_vhost_http_hooks(vhost);
@@ -5211,6 +5480,28 @@ SrsConfDirective* SrsConfig::get_vhost_edge_origin(string vhost)
     return conf->get("origin");
 }
 
+string SrsConfig::get_vhost_edge_balance(string vhost)
+{
+    static string DEFAULT = "round_robin";
+    
+    SrsConfDirective* conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("balance");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return conf->arg0();
+}
+
 bool SrsConfig::get_vhost_edge_token_traverse(string vhost)
 {
     static bool DEFAULT = false;
@@ -6159,6 +6450,23 @@ bool SrsConfig::get_hls_cleanup(string vhost)
     return SRS_CONF_PERFER_TRUE(conf->arg0());
 }
 
+string SrsConfig::get_hls_storage(string vhost)
+{
+    static string DEFAULT = "disk";
+    
+    SrsConfDirective* conf = get_hls(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("hls_storage");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return conf->arg0();
+}
+
 int SrsConfig::get_hls_dispose(string vhost)
 {
     static int DEFAULT = 0;
@@ -6602,6 +6910,23 @@ string SrsConfig::get_http_stream_dir()
     return conf->arg0();
 }
 
+int SrsConfig::get_http_stream_hls_ram_budget()
+{
+    static int DEFAULT = SRS_PERF_HLS_RAM_BUDGET;
+    
+    SrsConfDirective* conf = root->get("http_server");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("hls_ram_budget");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atoi(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_http_stream_crossdomain()
 {
     static bool DEFAULT = true;
@@ -43,6 +43,7 @@ class SrsFileWriter;
 class SrsJsonObject;
 class SrsJsonArray;
 class SrsJsonAny;
+class SrsSecurityRules;
 
 class SrsConfig;
 class SrsRequest;
@@ -292,6 +293,62 @@ private:
     virtual int read_token(_srs_internal::SrsConfigBuffer* buffer, std::vector<std::string>& args, int& line_start);
 };
 
+/**
+* the compiled config of vhost, the typed fields are parsed from the directives
+* when load and reload config, for the hot path to read the config in O(1),
+* for example, the source reads the reduce_sequence_header for each message.
+* @remark the snapshot is never freed before config, so user can keep the pointer,
+*       and the fields are updated in place when reload.
+* @remark the default values are same to the get_xxx(vhost) of config.
+*/
+class SrsVhostConfig
+{
+public:
+    // the vhost name of snapshot.
+    std::string vhost;
+    // whether the vhost directive exists.
+    bool exists;
+    bool enabled;
+    bool is_edge;
+// play or source section
+public:
+    bool gop_cache;
+    double queue_length;
+    bool atc;
+    bool atc_auto;
+    int time_jitter;
+    bool mix_correct;
+    bool reduce_sequence_header;
+    bool parse_sps;
+// publish section
+public:
+    bool mr_enabled;
+    int mr_sleep_ms;
+// hls section
+public:
+    bool hls_enabled;
+    std::string hls_on_error;
+    int hls_dispose;
+// dvr section
+public:
+    bool dvr_enabled;
+    bool dvr_wait_keyframe;
+    int dvr_time_jitter;
+// security section
+public:
+    bool security_enabled;
+    // the rules compiled to prefix tries, never NULL.
+    SrsSecurityRules* security_rules;
+public:
+    SrsVhostConfig(std::string v);
+    virtual ~SrsVhostConfig();
+public:
+    /**
+    * compile the snapshot from the directives of config.
+    */
+    virtual void compile(SrsConfig* conf);
+};
+
 /**
 * the config service provider.
 * for the config supports reload, so never keep the reference cross st-thread,
@@ -355,6 +412,13 @@ private:
     * the reload subscribers, when reload, callback all handlers.
     */
     std::vector<ISrsReloadHandler*> subscribes;
+// compiled vhost section
+private:
+    /**
+    * the compiled snapshot of vhosts, key is vhost name.
+    * @remark never free the snapshot before config, for user keeps it.
+    */
+    std::map<std::string, SrsVhostConfig*> vhost_configs;
 public:
     SrsConfig();
     virtual ~SrsConfig();
@@ -620,6 +684,11 @@ public:
     virtual std::string         get_work_dir();
     // whether use asprocess mode.
     virtual bool                get_asprocess();
+    /**
+     * get the number of worker processes,
+     * 0 to serve all clients in the master process.
+     */
+    virtual int                 get_workers();
 // stream_caster section
 public:
     /**
@@ -664,6 +733,24 @@ public:
      * get the kafka topic to use for srs.
      */
     virtual std::string         get_kafka_topic();
+// rate_limit section
+public:
+    /**
+     * whether limit the rate of clients by ip.
+     */
+    virtual bool                get_rate_limit_enabled();
+    /**
+     * get the max connections per second of each ip, and the burst.
+     * @remark 0 to never limit the connect.
+     */
+    virtual double              get_rate_limit_connect_rate();
+    virtual double              get_rate_limit_connect_burst();
+    /**
+     * get the max plays per second of each ip, and the burst.
+     * @remark 0 to never limit the play.
+     */
+    virtual double              get_rate_limit_play_rate();
+    virtual double              get_rate_limit_play_burst();
 // vhost specified section
 public:
     /**
@@ -676,6 +763,18 @@ public:
      * get all vhosts in config file.
      */
     virtual void get_vhosts(std::vector<SrsConfDirective*>& vhosts);
+    /**
+     * get the compiled snapshot of vhost, compile it when not found.
+     * @param vhost, the name of vhost, not the default vhost when not exists.
+     * @remark user can keep the snapshot, which is updated when reload.
+     */
+    virtual SrsVhostConfig*     get_vhost_config(std::string vhost);
+private:
+    /**
+     * recompile all snapshots of vhosts, when root changed.
+     */
+    virtual void compile_vhost_configs();
+public:
     /**
     * whether vhost is enabled
     * @param vhost, the vhost name.
@@ -861,6 +960,12 @@ public:
     */
     virtual SrsConfDirective*   get_vhost_on_play(std::string vhost);
     /**
+    * get the ttl in seconds to cache the decision of on_play hook,
+    * and the identical on_play calls in flight share the decision.
+    * @return 0 to disable the cache.
+    */
+    virtual int                 get_vhost_on_play_cache_ttl(std::string vhost);
+    /**
     * get the on_stop callbacks of vhost.
     * @return the on_stop callback directive, the args is the url to callback.
     */
@@ -925,6 +1030,11 @@ public:
     */
     virtual SrsConfDirective*   get_vhost_edge_origin(std::string vhost);
     /**
+    * get the load balance algorithm of edge to select the origin,
+    * round_robin, hash, least_streams or latency.
+    */
+    virtual std::string         get_vhost_edge_balance(std::string vhost);
+    /**
     * whether edge token tranverse is enabled,
     * if true, edge will send connect origin to verfy the token of client.
     * for example, we verify all clients on the origin FMS by server-side as,
@@ -1195,6 +1305,10 @@ public:
      * whether cleanup the old ts files.
      */
     virtual bool                get_hls_cleanup(std::string vhost);
+    /**
+     * get the storage of hls files, disk, ram or both.
+     */
+    virtual std::string         get_hls_storage(std::string vhost);
     /**
      * the timeout to dispose the hls.
      */
@@ -1328,6 +1442,10 @@ public:
      * whether enable crossdomain for http static and stream server.
      */
     virtual bool                get_http_stream_crossdomain();
+    /**
+     * get the memory budget in MB of the hls files in ram.
+     */
+    virtual int                 get_http_stream_hls_ram_budget();
 public:
     /**
     * get whether vhost enabled http stream
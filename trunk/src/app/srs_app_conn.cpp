@@ -38,6 +38,14 @@ IConnectionManager::~IConnectionManager()
 {
 }
 
+ISrsExpire::ISrsExpire()
+{
+}
+
+ISrsExpire::~ISrsExpire()
+{
+}
+
 SrsConnection::SrsConnection(IConnectionManager* cm, st_netfd_t c, string cip)
 {
     id = 0;
@@ -54,12 +54,29 @@ public:
     virtual void remove(SrsConnection* c) = 0;
 };
 
+/**
+ * the object which can be expired, for example, the connection, or the
+ * caster which publish in process without connection.
+ */
+class ISrsExpire
+{
+public:
+    ISrsExpire();
+    virtual ~ISrsExpire();
+public:
+    /**
+     * set the object to expired, it must quit ASAP.
+     */
+    virtual void expire() = 0;
+};
+
 /**
 * the basic connection of SRS,
 * all connections accept from listener must extends from this base class,
 * server will add the connection to manager, and delete it when remove.
 */
 class SrsConnection : virtual public ISrsOneCycleThreadHandler, virtual public IKbpsDelta, virtual public ISrsReloadHandler
+    , virtual public ISrsExpire
 {
 private:
     /**
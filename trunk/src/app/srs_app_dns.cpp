@@ -0,0 +1,701 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_app_dns.hpp>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_app_utility.hpp>
+
+// the type and class of A record.
+#define SRS_DNS_TYPE_A 1
+#define SRS_DNS_CLASS_IN 1
+// the rcode of host not found.
+#define SRS_DNS_RCODE_NXDOMAIN 3
+// the max size of dns packet over udp.
+#define SRS_DNS_PACKET_SIZE 512
+
+/**
+ * strip the trailing dot of the fully qualified host, for example, the www.ossrs.net.
+ */
+static string srs_dns_strip_host(string host)
+{
+    if (!host.empty() && host.at(host.length() - 1) == '.') {
+        return host.substr(0, host.length() - 1);
+    }
+    return host;
+}
+
+u_int16_t srs_dns_random_id()
+{
+    u_int16_t id = 0;
+    
+    // the id must be unpredictable, to defense the spoofed response.
+    int fd = ::open("/dev/urandom", O_RDONLY);
+    if (fd >= 0) {
+        ssize_t nread = ::read(fd, &id, sizeof(id));
+        ::close(fd);
+        if (nread == (ssize_t)sizeof(id)) {
+            return id;
+        }
+    }
+    
+    return (u_int16_t)(::random() ^ getpid() ^ ::time(NULL));
+}
+
+int srs_dns_encode_query(u_int16_t id, string host, char* buf, int size, int* pnb_buf)
+{
+    int ret = ERROR_SUCCESS;
+    
+    host = srs_dns_strip_host(host);
+    
+    // the header, question and labels of host.
+    if (host.empty() || 12 + (int)host.length() + 2 + 4 > size) {
+        ret = ERROR_SYSTEM_DNS_PACKET;
+        srs_error("dns host %s invalid. ret=%d", host.c_str(), ret);
+        return ret;
+    }
+    
+    SrsBuffer stream;
+    if ((ret = stream.initialize(buf, size)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // header, recursion desired, a question.
+    stream.write_2bytes(id);
+    stream.write_2bytes(0x0100);
+    stream.write_2bytes(1);
+    stream.write_2bytes(0);
+    stream.write_2bytes(0);
+    stream.write_2bytes(0);
+    
+    // the name in labels, for example, 3www5ossrs3net0
+    // @remark never split by srs_string_split, which ignores the empty label.
+    size_t start = 0;
+    while (true) {
+        size_t pos = host.find(".", start);
+        string label = host.substr(start, pos == string::npos? string::npos : pos - start);
+        
+        if (label.empty() || label.length() > 63) {
+            ret = ERROR_SYSTEM_DNS_PACKET;
+            srs_error("dns host %s invalid label. ret=%d", host.c_str(), ret);
+            return ret;
+        }
+        
+        stream.write_1bytes((int8_t)label.length());
+        stream.write_string(label);
+        
+        if (pos == string::npos) {
+            break;
+        }
+        start = pos + 1;
+    }
+    stream.write_1bytes(0);
+    
+    stream.write_2bytes(SRS_DNS_TYPE_A);
+    stream.write_2bytes(SRS_DNS_CLASS_IN);
+    
+    *pnb_buf = stream.pos();
+    
+    return ret;
+}
+
+/**
+ * skip the name in labels or compressed pointer.
+ */
+static int srs_dns_skip_name(SrsBuffer* stream)
+{
+    int ret = ERROR_SUCCESS;
+    
+    while (true) {
+        if (!stream->require(1)) {
+            ret = ERROR_SYSTEM_DNS_RESPONSE;
+            srs_error("dns decode name failed. ret=%d", ret);
+            return ret;
+        }
+        
+        u_int8_t len = (u_int8_t)stream->read_1bytes();
+        if (len == 0) {
+            break;
+        }
+        
+        // the pointer to the name, 2 bytes.
+        if ((len & 0xc0) == 0xc0) {
+            if (!stream->require(1)) {
+                ret = ERROR_SYSTEM_DNS_RESPONSE;
+                srs_error("dns decode name pointer failed. ret=%d", ret);
+                return ret;
+            }
+            stream->skip(1);
+            break;
+        }
+        
+        if (!stream->require(len)) {
+            ret = ERROR_SYSTEM_DNS_RESPONSE;
+            srs_error("dns decode label failed. ret=%d", ret);
+            return ret;
+        }
+        stream->skip(len);
+    }
+    
+    return ret;
+}
+
+/**
+ * read the name of question in labels, the pointer is not allowed.
+ */
+static int srs_dns_read_name(SrsBuffer* stream, string& name)
+{
+    int ret = ERROR_SUCCESS;
+    
+    while (true) {
+        if (!stream->require(1)) {
+            ret = ERROR_SYSTEM_DNS_RESPONSE;
+            srs_error("dns decode question name failed. ret=%d", ret);
+            return ret;
+        }
+        
+        u_int8_t len = (u_int8_t)stream->read_1bytes();
+        if (len == 0) {
+            break;
+        }
+        
+        if (len > 63 || !stream->require(len)) {
+            ret = ERROR_SYSTEM_DNS_RESPONSE;
+            srs_error("dns decode question label failed, len=%d. ret=%d", len, ret);
+            return ret;
+        }
+        
+        if (!name.empty()) {
+            name += ".";
+        }
+        name += stream->read_string(len);
+    }
+    
+    return ret;
+}
+
+int srs_dns_decode_response(u_int16_t id, string host, char* buf, int size, string& ip, int* pttl)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsBuffer stream;
+    if ((ret = stream.initialize(buf, size)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    if (!stream.require(12)) {
+        ret = ERROR_SYSTEM_DNS_PACKET;
+        srs_error("dns decode header failed. ret=%d", ret);
+        return ret;
+    }
+    
+    u_int16_t rid = (u_int16_t)stream.read_2bytes();
+    u_int16_t flags = (u_int16_t)stream.read_2bytes();
+    int qdcount = (u_int16_t)stream.read_2bytes();
+    int ancount = (u_int16_t)stream.read_2bytes();
+    stream.skip(4);
+    
+    // must be the response of query.
+    if (rid != id || (flags & 0x8000) == 0) {
+        ret = ERROR_SYSTEM_DNS_PACKET;
+        srs_warn("dns response id=%d not match %d, flags=%#x. ret=%d", rid, id, flags, ret);
+        return ret;
+    }
+    
+    // must echo the question of query, the name is case insensitive.
+    if (qdcount != 1) {
+        ret = ERROR_SYSTEM_DNS_PACKET;
+        srs_warn("dns response id=%d question count %d invalid. ret=%d", rid, qdcount, ret);
+        return ret;
+    }
+    
+    string name;
+    if ((ret = srs_dns_read_name(&stream, name)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if (!stream.require(4)) {
+        ret = ERROR_SYSTEM_DNS_RESPONSE;
+        srs_error("dns decode question failed. ret=%d", ret);
+        return ret;
+    }
+    
+    int qtype = (u_int16_t)stream.read_2bytes();
+    int qclass = (u_int16_t)stream.read_2bytes();
+    host = srs_dns_strip_host(host);
+    if (strcasecmp(name.c_str(), host.c_str()) != 0 || qtype != SRS_DNS_TYPE_A || qclass != SRS_DNS_CLASS_IN) {
+        ret = ERROR_SYSTEM_DNS_PACKET;
+        srs_warn("dns response id=%d question %s type=%d class=%d not match %s. ret=%d",
+            rid, name.c_str(), qtype, qclass, host.c_str(), ret);
+        return ret;
+    }
+    
+    int rcode = flags & 0x0f;
+    if (rcode == SRS_DNS_RCODE_NXDOMAIN) {
+        return ERROR_SYSTEM_DNS_RESOLVE;
+    }
+    if (rcode != 0) {
+        ret = ERROR_SYSTEM_DNS_RESPONSE;
+        srs_warn("dns response error rcode=%d. ret=%d", rcode, ret);
+        return ret;
+    }
+    
+    // the answers maybe the CNAME chain, then the A records,
+    // use the min ttl of answers till the first A record.
+    int ttl = -1;
+    for (int i = 0; i < ancount; i++) {
+        if ((ret = srs_dns_skip_name(&stream)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        if (!stream.require(10)) {
+            ret = ERROR_SYSTEM_DNS_RESPONSE;
+            srs_error("dns decode answer failed. ret=%d", ret);
+            return ret;
+        }
+        
+        int type = (u_int16_t)stream.read_2bytes();
+        int klass = (u_int16_t)stream.read_2bytes();
+        int answer_ttl = (int)(u_int32_t)stream.read_4bytes();
+        int rdlength = (u_int16_t)stream.read_2bytes();
+        
+        if (!stream.require(rdlength)) {
+            ret = ERROR_SYSTEM_DNS_RESPONSE;
+            srs_error("dns decode answer data failed. ret=%d", ret);
+            return ret;
+        }
+        
+        if (answer_ttl >= 0 && (ttl < 0 || answer_ttl < ttl)) {
+            ttl = answer_ttl;
+        }
+        
+        if (type != SRS_DNS_TYPE_A || klass != SRS_DNS_CLASS_IN || rdlength != 4) {
+            stream.skip(rdlength);
+            continue;
+        }
+        
+        char ipv4[16];
+        u_int8_t* p = (u_int8_t*)(stream.data() + stream.pos());
+        snprintf(ipv4, sizeof(ipv4), "%d.%d.%d.%d", p[0], p[1], p[2], p[3]);
+        
+        ip = ipv4;
+        *pttl = srs_max(0, ttl);
+        return ret;
+    }
+    
+    // no A record.
+    return ERROR_SYSTEM_DNS_RESOLVE;
+}
+
+SrsDnsEntry::SrsDnsEntry(string h)
+{
+    host = h;
+    error = ERROR_SUCCESS;
+    expire = 0;
+    resolving = false;
+    cond = st_cond_new();
+    nb_waiting = 0;
+    nb_hits = 0;
+}
+
+SrsDnsEntry::~SrsDnsEntry()
+{
+    st_cond_destroy(cond);
+}
+
+SrsDnsResolver* SrsDnsResolver::_instance = NULL;
+
+SrsDnsResolver* SrsDnsResolver::instance()
+{
+    if (!_instance) {
+        _instance = new SrsDnsResolver();
+    }
+    return _instance;
+}
+
+SrsDnsResolver::SrsDnsResolver()
+{
+    initialized = false;
+    
+    nb_requests = nb_hits = nb_negative_hits = nb_coalesced = 0;
+    nb_queries = nb_failures = nb_timeouts = 0;
+}
+
+SrsDnsResolver::~SrsDnsResolver()
+{
+    std::map<std::string, SrsDnsEntry*>::iterator it;
+    for (it = entries.begin(); it != entries.end(); ++it) {
+        SrsDnsEntry* entry = it->second;
+        srs_freep(entry);
+    }
+    entries.clear();
+}
+
+void SrsDnsResolver::initialize(vector<string> s, map<string, string> h)
+{
+    servers = s;
+    hosts = h;
+    initialized = true;
+}
+
+int SrsDnsResolver::resolve(string host, string& ip)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (inet_addr(host.c_str()) != INADDR_NONE) {
+        ip = host;
+        return ret;
+    }
+    
+    if (!initialized) {
+        load_system();
+    }
+    
+    nb_requests++;
+    
+    // the static hosts.
+    std::map<std::string, std::string>::iterator hit = hosts.find(host);
+    if (hit != hosts.end()) {
+        ip = hit->second;
+        return ret;
+    }
+    
+    SrsDnsEntry* entry = NULL;
+    std::map<std::string, SrsDnsEntry*>::iterator it = entries.find(host);
+    if (it != entries.end()) {
+        entry = it->second;
+    } else {
+        sweep(srs_update_system_time_ms());
+        entry = entries[host] = new SrsDnsEntry(host);
+    }
+    
+    // wait for the query in flight.
+    if (entry->resolving) {
+        nb_coalesced++;
+        
+        entry->nb_waiting++;
+        st_cond_timedwait(entry->cond, SRS_DNS_QUERY_TIMEOUT_US * srs_max(1, (int)servers.size()));
+        entry->nb_waiting--;
+        
+        if (entry->resolving) {
+            ret = ERROR_SYSTEM_DNS_TIMEOUT;
+            srs_error("dns wait for %s timeout. ret=%d", host.c_str(), ret);
+            return ret;
+        }
+        
+        ip = entry->ip;
+        return entry->error;
+    }
+    
+    // hit the cache.
+    if (entry->expire > srs_update_system_time_ms()) {
+        entry->nb_hits++;
+        
+        if (entry->error != ERROR_SUCCESS) {
+            nb_negative_hits++;
+            return entry->error;
+        }
+        
+        nb_hits++;
+        ip = entry->ip;
+        return ret;
+    }
+    
+    entry->resolving = true;
+    
+    int ttl = 0;
+    string resolved;
+    ret = query(host, resolved, &ttl);
+    
+    entry->ip = resolved;
+    entry->error = ret;
+    
+    int64_t ttl_ms;
+    if (ret == ERROR_SUCCESS) {
+        ttl_ms = srs_min(SRS_DNS_TTL_MAX_MS, srs_max(SRS_DNS_TTL_MIN_MS, (int64_t)ttl * 1000));
+    } else if (ret == ERROR_SYSTEM_DNS_RESOLVE) {
+        ttl_ms = SRS_DNS_NEGATIVE_TTL_MS;
+    } else {
+        ttl_ms = SRS_DNS_FAILURE_TTL_MS;
+    }
+    entry->expire = srs_update_system_time_ms() + ttl_ms;
+    
+    entry->resolving = false;
+    st_cond_broadcast(entry->cond);
+    
+    if (ret != ERROR_SUCCESS) {
+        srs_error("dns resolve %s failed, cache %dms. ret=%d", host.c_str(), (int)ttl_ms, ret);
+        return ret;
+    }
+    
+    ip = resolved;
+    srs_trace("dns resolve %s to %s, ttl=%ds, cache %dms", host.c_str(), ip.c_str(), ttl, (int)ttl_ms);
+    
+    return ret;
+}
+
+void SrsDnsResolver::dumps(SrsJsonObject* obj)
+{
+    if (!initialized) {
+        load_system();
+    }
+    
+    SrsJsonArray* arr = SrsJsonAny::array();
+    obj->set("servers", arr);
+    for (int i = 0; i < (int)servers.size(); i++) {
+        arr->append(SrsJsonAny::str(servers.at(i).c_str()));
+    }
+    
+    obj->set("requests", SrsJsonAny::integer(nb_requests));
+    obj->set("hits", SrsJsonAny::integer(nb_hits));
+    obj->set("negative_hits", SrsJsonAny::integer(nb_negative_hits));
+    obj->set("coalesced", SrsJsonAny::integer(nb_coalesced));
+    obj->set("queries", SrsJsonAny::integer(nb_queries));
+    obj->set("failures", SrsJsonAny::integer(nb_failures));
+    obj->set("timeouts", SrsJsonAny::integer(nb_timeouts));
+    
+    int64_t now = srs_get_system_time_ms();
+    
+    arr = SrsJsonAny::array();
+    obj->set("entries", arr);
+    
+    std::map<std::string, SrsDnsEntry*>::iterator it;
+    for (it = entries.begin(); it != entries.end(); ++it) {
+        SrsDnsEntry* entry = it->second;
+        
+        SrsJsonObject* e = SrsJsonAny::object();
+        arr->append(e);
+        
+        e->set("host", SrsJsonAny::str(entry->host.c_str()));
+        e->set("ip", SrsJsonAny::str(entry->ip.c_str()));
+        e->set("error", SrsJsonAny::integer(entry->error));
+        e->set("ttl", SrsJsonAny::integer(srs_max((int64_t)0, entry->expire - now) / 1000));
+        e->set("resolving", SrsJsonAny::boolean(entry->resolving));
+        e->set("hits", SrsJsonAny::integer(entry->nb_hits));
+    }
+}
+
+void SrsDnsResolver::load_system()
+{
+    initialized = true;
+    
+    // the name servers, for example:
+    //      nameserver 8.8.8.8
+    if (true) {
+        std::ifstream f("/etc/resolv.conf");
+        std::string line;
+        while (std::getline(f, line)) {
+            std::istringstream is(line);
+            std::string key, value;
+            if (!(is >> key >> value) || key != "nameserver") {
+                continue;
+            }
+            if (inet_addr(value.c_str()) == INADDR_NONE) {
+                continue;
+            }
+            servers.push_back(value + ":" + srs_int2str(SRS_DNS_PORT));
+        }
+    }
+    
+    // the static hosts, for example:
+    //      127.0.0.1 localhost
+    if (true) {
+        std::ifstream f("/etc/hosts");
+        std::string line;
+        while (std::getline(f, line)) {
+            size_t pos = line.find("#");
+            if (pos != std::string::npos) {
+                line = line.substr(0, pos);
+            }
+            
+            std::istringstream is(line);
+            std::string ip, name;
+            if (!(is >> ip) || inet_addr(ip.c_str()) == INADDR_NONE) {
+                continue;
+            }
+            while (is >> name) {
+                if (hosts.find(name) == hosts.end()) {
+                    hosts[name] = ip;
+                }
+            }
+        }
+    }
+    
+    if (hosts.find("localhost") == hosts.end()) {
+        hosts["localhost"] = "127.0.0.1";
+    }
+    
+    srs_trace("dns load %d servers and %d hosts", (int)servers.size(), (int)hosts.size());
+}
+
+int SrsDnsResolver::query(string host, string& ip, int* pttl)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // no name server, resolve by system.
+    if (servers.empty()) {
+        ip = srs_dns_resolve(host);
+        if (ip.empty()) {
+            ret = ERROR_SYSTEM_DNS_RESOLVE;
+            srs_error("dns resolve %s by system failed. ret=%d", host.c_str(), ret);
+            return ret;
+        }
+        *pttl = 0;
+        return ret;
+    }
+    
+    // try the next server, util the host is resolved or not found.
+    for (int i = 0; i < (int)servers.size(); i++) {
+        std::string server = servers.at(i);
+        
+        nb_queries++;
+        if ((ret = query_server(server, host, ip, pttl)) == ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        if (ret == ERROR_SYSTEM_DNS_RESOLVE) {
+            return ret;
+        }
+        
+        nb_failures++;
+        if (ret == ERROR_SYSTEM_DNS_TIMEOUT) {
+            nb_timeouts++;
+        }
+        srs_warn("dns query %s from %s failed. ret=%d", host.c_str(), server.c_str(), ret);
+    }
+    
+    return ret;
+}
+
+int SrsDnsResolver::query_server(string server, string host, string& ip, int* pttl)
+{
+    int ret = ERROR_SUCCESS;
+    
+    std::string server_ip;
+    int port = SRS_DNS_PORT;
+    srs_parse_endpoint(server, server_ip, port);
+    
+    sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr(server_ip.c_str());
+    
+    u_int16_t qid = srs_dns_random_id();
+    
+    char buf[SRS_DNS_PACKET_SIZE];
+    int nb_buf = 0;
+    if ((ret = srs_dns_encode_query(qid, host, buf, sizeof(buf), &nb_buf)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        ret = ERROR_SOCKET_CREATE;
+        srs_error("dns create socket failed. ret=%d", ret);
+        return ret;
+    }
+    
+    st_netfd_t stfd = st_netfd_open_socket(fd);
+    if (stfd == NULL) {
+        ::close(fd);
+        ret = ERROR_ST_OPEN_SOCKET;
+        srs_error("dns open socket failed. ret=%d", ret);
+        return ret;
+    }
+    
+    int64_t deadline = srs_update_system_time_ms() * 1000 + SRS_DNS_QUERY_TIMEOUT_US;
+    
+    if (st_sendto(stfd, buf, nb_buf, (sockaddr*)&addr, sizeof(sockaddr_in), SRS_DNS_QUERY_TIMEOUT_US) != nb_buf) {
+        ret = ERROR_SOCKET_WRITE;
+        srs_error("dns send query to %s failed. ret=%d", server.c_str(), ret);
+        srs_close_stfd(stfd);
+        return ret;
+    }
+    
+    // ignore the response of other queries, util timeout.
+    while (true) {
+        int64_t timeout = deadline - srs_update_system_time_ms() * 1000;
+        if (timeout <= 0) {
+            ret = ERROR_SYSTEM_DNS_TIMEOUT;
+            break;
+        }
+        
+        sockaddr_in from;
+        int nb_from = sizeof(sockaddr_in);
+        int nread = st_recvfrom(stfd, buf, sizeof(buf), (sockaddr*)&from, &nb_from, timeout);
+        if (nread <= 0) {
+            ret = ERROR_SYSTEM_DNS_TIMEOUT;
+            break;
+        }
+        
+        if (from.sin_addr.s_addr != addr.sin_addr.s_addr || from.sin_port != addr.sin_port) {
+            continue;
+        }
+        
+        // ignore the stray packet, for example, the late response of previous query,
+        // while the failed response of server breaks to try the next server.
+        ret = srs_dns_decode_response(qid, host, buf, nread, ip, pttl);
+        if (ret != ERROR_SYSTEM_DNS_PACKET) {
+            break;
+        }
+    }
+    
+    srs_close_stfd(stfd);
+    
+    return ret;
+}
+
+void SrsDnsResolver::sweep(int64_t now)
+{
+    if ((int)entries.size() < SRS_DNS_MAX_ENTRIES) {
+        return;
+    }
+    
+    std::map<std::string, SrsDnsEntry*>::iterator it;
+    for (it = entries.begin(); it != entries.end();) {
+        SrsDnsEntry* entry = it->second;
+        
+        if (entry->resolving || entry->nb_waiting > 0 || entry->expire > now) {
+            ++it;
+            continue;
+        }
+        
+        srs_freep(entry);
+        entries.erase(it++);
+    }
+}
@@ -0,0 +1,161 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_APP_DNS_HPP
+#define SRS_APP_DNS_HPP
+
+/*
+#include <srs_app_dns.hpp>
+*/
+
+#include <srs_core.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <srs_app_st.hpp>
+
+class SrsJsonObject;
+
+// the port of name server.
+#define SRS_DNS_PORT 53
+// the timeout in us to query a name server.
+#define SRS_DNS_QUERY_TIMEOUT_US (2 * 1000 * 1000LL)
+// the ttl in ms of resolved ip, clamp the ttl of answer.
+#define SRS_DNS_TTL_MIN_MS (10 * 1000)
+#define SRS_DNS_TTL_MAX_MS (3600 * 1000)
+// the ttl in ms of host not found.
+#define SRS_DNS_NEGATIVE_TTL_MS (10 * 1000)
+// the ttl in ms of host failed to resolve, for example, timeout.
+#define SRS_DNS_FAILURE_TTL_MS (2 * 1000)
+// sweep the expired entries when cache over this size.
+#define SRS_DNS_MAX_ENTRIES 1024
+
+/**
+ * generate a random id for each query, from /dev/urandom.
+ */
+extern u_int16_t srs_dns_random_id();
+/**
+ * encode the dns query for the A record of host, RFC1035.
+ * @param id the id of query, to match the response.
+ * @param host the host, the trailing dot is stripped, and the empty
+ *       label is invalid, for example, the www..ossrs.net.
+ * @param pnb_buf output the bytes of query.
+ */
+extern int srs_dns_encode_query(u_int16_t id, std::string host, char* buf, int size, int* pnb_buf);
+/**
+ * decode the dns response for the A record, the first ipv4 is used.
+ * @param id the id of query, ERROR_SYSTEM_DNS_PACKET when not match.
+ * @param host the host of query, ERROR_SYSTEM_DNS_PACKET when the
+ *       question in response not match.
+ * @param pttl output the ttl in seconds, the min ttl of answers.
+ * @return ERROR_SYSTEM_DNS_RESOLVE when host not found or no A record,
+ *       ERROR_SYSTEM_DNS_RESPONSE when server failed or response invalid.
+ */
+extern int srs_dns_decode_response(u_int16_t id, std::string host, char* buf, int size, std::string& ip, int* pttl);
+
+/**
+ * the cached ip of host, or the error when resolve failed.
+ */
+class SrsDnsEntry
+{
+public:
+    std::string host;
+    // the resolved ip, empty when failed.
+    std::string ip;
+    // the error of resolve, ERROR_SUCCESS when ok.
+    int error;
+    // the time in ms to expire, 0 for never resolved.
+    int64_t expire;
+    // whether resolving, other threads of host wait for the result.
+    bool resolving;
+    st_cond_t cond;
+    int nb_waiting;
+    int64_t nb_hits;
+public:
+    SrsDnsEntry(std::string h);
+    virtual ~SrsDnsEntry();
+};
+
+/**
+ * the dns resolver in st, to query the name servers by udp, so the edge,
+ * forwarder, kafka and http client never block the server when resolve
+ * the host, which is done by gethostbyname before.
+ * the resolved ip is cached for the ttl of answer, and the host not found
+ * or failed to resolve is also cached for a while, the threads to resolve
+ * the same host wait for the query in flight.
+ * @remark the name servers and hosts are loaded from the /etc/resolv.conf
+ *       and /etc/hosts, without the search domains.
+ */
+class SrsDnsResolver
+{
+private:
+    static SrsDnsResolver* _instance;
+public:
+    static SrsDnsResolver* instance();
+private:
+    bool initialized;
+    // the name servers, in ip:port.
+    std::vector<std::string> servers;
+    // the static hosts, key is host, value is ip.
+    std::map<std::string, std::string> hosts;
+    std::map<std::string, SrsDnsEntry*> entries;
+public:
+    // the requests to resolve, the requests hit the cache, the host not found,
+    // and the requests wait for the query in flight.
+    int64_t nb_requests;
+    int64_t nb_hits;
+    int64_t nb_negative_hits;
+    int64_t nb_coalesced;
+    // the queries to name server, the queries failed and timeout.
+    int64_t nb_queries;
+    int64_t nb_failures;
+    int64_t nb_timeouts;
+public:
+    SrsDnsResolver();
+    virtual ~SrsDnsResolver();
+public:
+    /**
+     * use the name servers and static hosts, for example, the stub server.
+     * @remark load the system config when resolve, if not initialized.
+     */
+    virtual void initialize(std::vector<std::string> s, std::map<std::string, std::string> h);
+    /**
+     * resolve the host to ipv4, the ip is returned directly.
+     * @remark the st thread maybe switched when query the name servers.
+     */
+    virtual int resolve(std::string host, std::string& ip);
+    /**
+     * dumps the servers, counters and cached entries to json.
+     */
+    virtual void dumps(SrsJsonObject* obj);
+private:
+    virtual void load_system();
+    virtual int query(std::string host, std::string& ip, int* pttl);
+    virtual int query_server(std::string server, std::string host, std::string& ip, int* pttl);
+    virtual void sweep(int64_t now);
+};
+
+#endif
+
@@ -38,6 +38,7 @@ using namespace std;
 #include <srs_kernel_codec.hpp>
 #include <srs_kernel_flv.hpp>
 #include <srs_kernel_file.hpp>
+#include <srs_app_async_io.hpp>
 #include <srs_protocol_amf0.hpp>
 #include <srs_kernel_buffer.hpp>
 #include <srs_protocol_json.hpp>
@@ -52,7 +53,10 @@ SrsFlvSegment::SrsFlvSegment(SrsDvrPlan* p)
     jitter = NULL;
     plan = p;
 
-    fs = new SrsFileWriter();
+    SrsAsyncFileWriter* writer = new SrsAsyncFileWriter(plan->io_key);
+    // the dvr file is never read by server, drop its pages once on disk.
+    writer->set_dontneed(true);
+    fs = writer;
     enc = new SrsFlvEncoder();
     jitter_algorithm = SrsRtmpJitterAlgorithmOFF;
 
@@ -84,7 +88,7 @@ int SrsFlvSegment::initialize(SrsRequest* r)
     int ret = ERROR_SUCCESS;
 
     req = r;
-    jitter_algorithm = (SrsRtmpJitterAlgorithm)_srs_config->get_dvr_time_jitter(req->vhost);
+    jitter_algorithm = (SrsRtmpJitterAlgorithm)plan->vconf->dvr_time_jitter;
 
     return ret;
 }
@@ -184,10 +188,9 @@ int SrsFlvSegment::close()
     
     fs->close();
     
-    // when tmp flv file exists, reap it.
+    // when tmp flv file exists, reap it, after the flv written by async io.
     if (tmp_flv_file != path) {
-        if (rename(tmp_flv_file.c_str(), path.c_str()) < 0) {
-            ret = ERROR_SYSTEM_FILE_RENAME;
+        if ((ret = _srs_async_io->execute(plan->io_key, new SrsAsyncIoRenameTask(tmp_flv_file, path))) != ERROR_SUCCESS) {
             srs_error("rename flv file failed, %s => %s. ret=%d", 
                 tmp_flv_file.c_str(), path.c_str(), ret);
             return ret;
@@ -317,8 +320,7 @@ int SrsFlvSegment::write_video(SrsSharedPtrMessage* shared_video)
     // accept the sequence header here.
     // when got no keyframe, ignore when should wait keyframe.
     if (!has_keyframe && !is_sequence_header) {
-        bool wait_keyframe = _srs_config->get_dvr_wait_keyframe(req->vhost);
-        if (wait_keyframe) {
+        if (plan->vconf->dvr_wait_keyframe) {
             srs_info("dvr: ignore when wait keyframe.");
             return ret;
         }
@@ -496,11 +498,13 @@ int SrsFlvSegment::on_reload_vhost_dvr(std::string /*vhost*/)
     return ret;
 }
 
-SrsDvrAsyncCallOnDvr::SrsDvrAsyncCallOnDvr(int c, SrsRequest* r, string p)
+SrsDvrAsyncCallOnDvr::SrsDvrAsyncCallOnDvr(int c, SrsRequest* r, string p, int k, int64_t b)
 {
     cid = c;
     req = r->copy();
     path = p;
+    key = k;
+    barrier = b;
 }
 
 SrsDvrAsyncCallOnDvr::~SrsDvrAsyncCallOnDvr()
@@ -533,6 +537,9 @@ int SrsDvrAsyncCallOnDvr::call()
         hooks = conf->args;
     }
     
+    // wait for the flv written to disk.
+    _srs_async_io->wait(key, barrier);
+    
     for (int i = 0; i < (int)hooks.size(); i++) {
         std::string url = hooks.at(i);
         if ((ret = SrsHttpHooks::on_dvr(cid, url, req, path)) != ERROR_SUCCESS) {
@@ -555,8 +562,10 @@ string SrsDvrAsyncCallOnDvr::to_string()
 SrsDvrPlan::SrsDvrPlan()
 {
     req = NULL;
+    vconf = NULL;
 
     dvr_enabled = false;
+    io_key = SrsAsyncIo::alloc_key();
     segment = new SrsFlvSegment(this);
     async = new SrsAsyncCallWorker();
 }
@@ -572,6 +581,7 @@ int SrsDvrPlan::initialize(SrsRequest* r)
     int ret = ERROR_SUCCESS;
     
     req = r;
+    vconf = _srs_config->get_vhost_config(req->vhost);
 
     if ((ret = segment->initialize(r)) != ERROR_SUCCESS) {
         return ret;
@@ -639,8 +649,10 @@ int SrsDvrPlan::on_reap_segment()
 {
     int ret = ERROR_SUCCESS;
 
+    // the hook wait for the flv written by async io.
     int cid = _srs_context->get_id();
-    if ((ret = async->execute(new SrsDvrAsyncCallOnDvr(cid, req, segment->get_path()))) != ERROR_SUCCESS) {
+    int64_t barrier = _srs_async_io->sequence(io_key);
+    if ((ret = async->execute(new SrsDvrAsyncCallOnDvr(cid, req, segment->get_path(), io_key, barrier))) != ERROR_SUCCESS) {
         return ret;
     }
 
@@ -929,7 +941,7 @@ int SrsDvrSegmentPlan::update_duration(SrsSharedPtrMessage* msg)
     
     // when wait keyframe, ignore if no frame arrived.
     // @see https://github.com/ossrs/srs/issues/177
-    if (_srs_config->get_dvr_wait_keyframe(req->vhost)) {
+    if (vconf->dvr_wait_keyframe) {
         if (!msg->is_video()) {
             return ret;
         }
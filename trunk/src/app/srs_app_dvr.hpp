@@ -46,6 +46,7 @@ class SrsDvrPlan;
 class SrsJsonAny;
 class SrsJsonObject;
 class SrsThread;
+class SrsVhostConfig;
 
 #include <srs_app_source.hpp>
 #include <srs_app_reload.hpp>
@@ -184,8 +185,11 @@ private:
     int cid;
     std::string path;
     SrsRequest* req;
+    // the async io key and sequence to wait for the flv written.
+    int key;
+    int64_t barrier;
 public:
-    SrsDvrAsyncCallOnDvr(int c, SrsRequest* r, std::string p);
+    SrsDvrAsyncCallOnDvr(int c, SrsRequest* r, std::string p, int k, int64_t b);
     virtual ~SrsDvrAsyncCallOnDvr();
 public:
     virtual int call();
@@ -205,9 +209,13 @@ public:
     friend class SrsFlvSegment;
 public:
     SrsRequest* req;
+    // the compiled config of vhost, for the hot path.
+    SrsVhostConfig* vconf;
 protected:
     SrsFlvSegment* segment;
     SrsAsyncCallWorker* async;
+    // the key of async io, the flv of stream is written in order.
+    int io_key;
     bool dvr_enabled;
 public:
     SrsDvrPlan();
@@ -46,6 +46,7 @@ using namespace std;
 #include <srs_kernel_utility.hpp>
 #include <srs_kernel_balance.hpp>
 #include <srs_app_rtmp_conn.hpp>
+#include <srs_app_worker.hpp>
 
 // when error, edge ingester sleep for a while and retry.
 #define SRS_EDGE_INGESTER_SLEEP_US (int64_t)(3*1000*1000LL)
@@ -83,14 +84,27 @@ SrsEdgeRtmpUpstream::~SrsEdgeRtmpUpstream()
     srs_freep(sdk);
 }
 
-int SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLbRoundRobin* lb)
+int SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLoadBalancer* lb)
 {
     int ret = ERROR_SUCCESS;
     
     SrsRequest* req = r;
     
+    // whether connect to the origin selected by lb.
+    bool selected = false;
+    
     std::string url;
-    if (true) {
+    if (!_srs_config->get_vhost_is_edge(req->vhost)) {
+        // for workers, pull the stream from the owner worker over loopback.
+        int port = SrsWorkers::instance()->owner_port(req);
+        if (port <= 0) {
+            ret = ERROR_EDGE_WORKER_UNPUBLISHED;
+            srs_warn("worker relay %s not published. ret=%d", req->get_stream_url().c_str(), ret);
+            return ret;
+        }
+        
+        url = srs_generate_rtmp_url("127.0.0.1", port, req->vhost, req->app, req->stream);
+    } else {
         SrsConfDirective* conf = _srs_config->get_vhost_edge_origin(req->vhost);
         
         // @see https://github.com/ossrs/srs/issues/79
@@ -117,6 +131,7 @@ int SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLbRoundRobin* lb)
             server = _host;
             port = _port;
         }
+        selected = redirect.empty();
         
         // support vhost tranform for edge,
         // @see https://github.com/ossrs/srs/issues/372
@@ -129,11 +144,17 @@ int SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLbRoundRobin* lb)
     int64_t cto = SRS_EDGE_INGESTER_TIMEOUT_US;
     int64_t sto = SRS_CONSTS_RTMP_PULSE_TIMEOUT_US;
     if ((ret = sdk->connect(url, cto, sto)) != ERROR_SUCCESS) {
+        if (selected) {
+            lb->on_failure();
+        }
         srs_error("edge pull %s failed, cto=%"PRId64", sto=%"PRId64". ret=%d", url.c_str(), cto, sto, ret);
         return ret;
     }
     
     if ((ret = sdk->play()) != ERROR_SUCCESS) {
+        if (selected) {
+            lb->on_failure();
+        }
         srs_error("edge pull %s stream failed. ret=%d", url.c_str(), ret);
         return ret;
     }
@@ -173,7 +194,7 @@ SrsEdgeIngester::SrsEdgeIngester()
     req = NULL;
     
     upstream = new SrsEdgeRtmpUpstream(redirect);
-    lb = new SrsLbRoundRobin();
+    lb = NULL;
     pthread = new SrsReusableThread2("edge-igs", this, SRS_EDGE_INGESTER_SLEEP_US);
 }
 
@@ -194,6 +215,9 @@ int SrsEdgeIngester::initialize(SrsSource* s, SrsPlayEdge* e, SrsRequest* r)
     edge = e;
     req = r;
     
+    srs_freep(lb);
+    lb = srs_lb_create(_srs_config->get_vhost_edge_balance(req->vhost), req->get_stream_url());
+    
     return ret;
 }
 
@@ -214,13 +238,17 @@ void SrsEdgeIngester::stop()
     pthread->stop();
     upstream->close();
     
+    if (lb) {
+        lb->on_close();
+    }
+    
     // notice to unpublish.
     source->on_unpublish();
 }
 
 string SrsEdgeIngester::get_curr_origin()
 {
-    return lb->selected();
+    return lb? lb->selected() : "";
 }
 
 int SrsEdgeIngester::cycle()
@@ -249,6 +277,9 @@ int SrsEdgeIngester::cycle()
         
         ret = ingest();
         
+        // the origin serves one less stream.
+        lb->on_close();
+        
         // retry for rtmp 302 immediately.
         if (ret == ERROR_CONTROL_REDIRECT) {
             ret = ERROR_SUCCESS;
@@ -275,6 +306,9 @@ int SrsEdgeIngester::ingest()
     // set to larger timeout to read av data from origin.
     upstream->set_recv_timeout(SRS_EDGE_INGESTER_TIMEOUT_US);
     
+    // the latency of origin is the time to connect and got the first packet.
+    bool first = true;
+    
     while (!pthread->interrupted()) {
         pprint->elapse();
         
@@ -296,6 +330,11 @@ int SrsEdgeIngester::ingest()
         srs_assert(msg);
         SrsAutoFree(SrsCommonMessage, msg);
         
+        if (first) {
+            lb->on_success();
+            first = false;
+        }
+        
         if ((ret = process_publish_message(msg)) != ERROR_SUCCESS) {
             return ret;
         }
@@ -407,7 +446,7 @@ SrsEdgeForwarder::SrsEdgeForwarder()
     send_error_code = ERROR_SUCCESS;
     
     sdk = new SrsSimpleRtmpClient();
-    lb = new SrsLbRoundRobin();
+    lb = NULL;
     pthread = new SrsReusableThread2("edge-fwr", this, SRS_EDGE_FORWARDER_SLEEP_US);
     queue = new SrsMessageQueue();
 }
@@ -435,6 +474,9 @@ int SrsEdgeForwarder::initialize(SrsSource* s, SrsPublishEdge* e, SrsRequest* r)
     edge = e;
     req = r;
     
+    srs_freep(lb);
+    lb = srs_lb_create(_srs_config->get_vhost_edge_balance(req->vhost), req->get_stream_url());
+    
     return ret;
 }
 
@@ -467,15 +509,20 @@ int SrsEdgeForwarder::start()
     int64_t cto = SRS_EDGE_FORWARDER_TIMEOUT_US;
     int64_t sto = SRS_CONSTS_RTMP_TIMEOUT_US;
     if ((ret = sdk->connect(url, cto, sto)) != ERROR_SUCCESS) {
+        lb->on_failure();
         srs_warn("edge push %s failed, cto=%"PRId64", sto=%"PRId64". ret=%d", url.c_str(), cto, sto, ret);
         return ret;
     }
     
     if ((ret = sdk->publish()) != ERROR_SUCCESS) {
+        lb->on_failure();
         srs_error("edge push publish failed. ret=%d", ret);
         return ret;
     }
     
+    // the latency of origin is the time to connect and publish.
+    lb->on_success();
+    
     return pthread->start();
 }
 
@@ -484,6 +531,10 @@ void SrsEdgeForwarder::stop()
     pthread->stop();
     sdk->close();
     queue->clear();
+    
+    if (lb) {
+        lb->on_close();
+    }
 }
 
 #define SYS_MAX_EDGE_SEND_MSGS 128
@@ -521,7 +572,7 @@ int SrsEdgeForwarder::cycle()
         }
         
         // forward all messages.
-        // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
+        // each msg in msgs.msgs must be free after sent, @see SrsMessageArray.free().
         int count = 0;
         if ((ret = queue->dump_packets(msgs.max, msgs.msgs, count)) != ERROR_SUCCESS) {
             srs_error("get message to push to origin failed. ret=%d", ret);
@@ -541,8 +592,10 @@ int SrsEdgeForwarder::cycle()
             continue;
         }
     
-        // sendout messages, all messages are freed by send_and_free_messages().
-        if ((ret = sdk->send_and_free_messages(msgs.msgs, count)) != ERROR_SUCCESS) {
+        // sendout messages, then release the reusable msgs.
+        ret = sdk->send_messages(msgs.msgs, count);
+        msgs.free(count);
+        if (ret != ERROR_SUCCESS) {
             srs_error("edge publish push message to server failed. ret=%d", ret);
             return ret;
         }
@@ -578,7 +631,7 @@ int SrsEdgeForwarder::proxy(SrsCommonMessage* msg)
     srs_verbose("initialize shared ptr msg success.");
     
     copy.stream_id = sdk->sid();
-    if ((ret = queue->enqueue(copy.copy())) != ERROR_SUCCESS) {
+    if ((ret = queue->enqueue(&copy)) != ERROR_SUCCESS) {
         srs_error("enqueue edge publish msg failed. ret=%d", ret);
     }
     
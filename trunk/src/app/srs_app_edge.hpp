@@ -46,7 +46,7 @@ class SrsCommonMessage;
 class SrsMessageQueue;
 class ISrsProtocolReaderWriter;
 class SrsKbps;
-class SrsLbRoundRobin;
+class SrsLoadBalancer;
 class SrsTcpClient;
 class SrsSimpleRtmpClient;
 class SrsPacket;
@@ -85,7 +85,7 @@ public:
     SrsEdgeUpstream();
     virtual ~SrsEdgeUpstream();
 public:
-    virtual int connect(SrsRequest* r, SrsLbRoundRobin* lb) = 0;
+    virtual int connect(SrsRequest* r, SrsLoadBalancer* lb) = 0;
     virtual int recv_message(SrsCommonMessage** pmsg) = 0;
     virtual int decode_message(SrsCommonMessage* msg, SrsPacket** ppacket) = 0;
     virtual void close() = 0;
@@ -106,7 +106,7 @@ public:
     SrsEdgeRtmpUpstream(std::string r);
     virtual ~SrsEdgeRtmpUpstream();
 public:
-    virtual int connect(SrsRequest* r, SrsLbRoundRobin* lb);
+    virtual int connect(SrsRequest* r, SrsLoadBalancer* lb);
     virtual int recv_message(SrsCommonMessage** pmsg);
     virtual int decode_message(SrsCommonMessage* msg, SrsPacket** ppacket);
     virtual void close();
@@ -125,7 +125,7 @@ private:
     SrsPlayEdge* edge;
     SrsRequest* req;
     SrsReusableThread2* pthread;
-    SrsLbRoundRobin* lb;
+    SrsLoadBalancer* lb;
     SrsEdgeUpstream* upstream;
     // for RTMP 302 redirect.
     std::string redirect;
@@ -156,7 +156,7 @@ private:
     SrsRequest* req;
     SrsReusableThread2* pthread;
     SrsSimpleRtmpClient* sdk;
-    SrsLbRoundRobin* lb;
+    SrsLoadBalancer* lb;
     /**
     * we must ensure one thread one fd principle,
     * that is, a fd must be write/read by the one thread.
@@ -46,6 +46,7 @@ using namespace std;
 #include <srs_core_autofree.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_app_rtmp_conn.hpp>
+#include <srs_kernel_balance.hpp>
 
 // when error, forwarder sleep for a while and retry.
 #define SRS_FORWARDER_SLEEP_US (int64_t)(3*1000*1000LL)
@@ -58,6 +59,7 @@ SrsForwarder::SrsForwarder(SrsSource* s)
     sh_video = sh_audio = NULL;
 
     sdk = new SrsSimpleRtmpClient();
+    lb = new SrsLbRoundRobin();
     pthread = new SrsReusableThread2("forward", this, SRS_FORWARDER_SLEEP_US);
     queue = new SrsMessageQueue();
     jitter = new SrsRtmpJitter();
@@ -66,6 +68,7 @@ SrsForwarder::SrsForwarder(SrsSource* s)
 SrsForwarder::~SrsForwarder()
 {
     srs_freep(sdk);
+    srs_freep(lb);
     srs_freep(pthread);
     srs_freep(queue);
     srs_freep(jitter);
@@ -151,21 +154,22 @@ void SrsForwarder::on_unpublish()
 {
     pthread->stop();
     sdk->close();
+    lb->on_close();
 }
 
 int SrsForwarder::on_meta_data(SrsSharedPtrMessage* shared_metadata)
 {
     int ret = ERROR_SUCCESS;
 
-    SrsSharedPtrMessage* metadata = shared_metadata->copy();
+    SrsSharedPtrMessage metadata;
+    shared_metadata->copy_to(&metadata);
     
     // TODO: FIXME: config the jitter of Forwarder.
-    if ((ret = jitter->correct(metadata, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
-        srs_freep(metadata);
+    if ((ret = jitter->correct(&metadata, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
         return ret;
     }
     
-    if ((ret = queue->enqueue(metadata)) != ERROR_SUCCESS) {
+    if ((ret = queue->enqueue(&metadata)) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -176,20 +180,20 @@ int SrsForwarder::on_audio(SrsSharedPtrMessage* shared_audio)
 {
     int ret = ERROR_SUCCESS;
     
-    SrsSharedPtrMessage* msg = shared_audio->copy();
+    SrsSharedPtrMessage msg;
+    shared_audio->copy_to(&msg);
     
     // TODO: FIXME: config the jitter of Forwarder.
-    if ((ret = jitter->correct(msg, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
-        srs_freep(msg);
+    if ((ret = jitter->correct(&msg, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
         return ret;
     }
     
-    if (SrsFlvCodec::audio_is_sequence_header(msg->payload, msg->size)) {
+    if (SrsFlvCodec::audio_is_sequence_header(msg.payload, msg.size)) {
         srs_freep(sh_audio);
-        sh_audio = msg->copy();
+        sh_audio = msg.copy();
     }
     
-    if ((ret = queue->enqueue(msg)) != ERROR_SUCCESS) {
+    if ((ret = queue->enqueue(&msg)) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -200,20 +204,20 @@ int SrsForwarder::on_video(SrsSharedPtrMessage* shared_video)
 {
     int ret = ERROR_SUCCESS;
 
-    SrsSharedPtrMessage* msg = shared_video->copy();
+    SrsSharedPtrMessage msg;
+    shared_video->copy_to(&msg);
     
     // TODO: FIXME: config the jitter of Forwarder.
-    if ((ret = jitter->correct(msg, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
-        srs_freep(msg);
+    if ((ret = jitter->correct(&msg, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
         return ret;
     }
     
-    if (SrsFlvCodec::video_is_sequence_header(msg->payload, msg->size)) {
+    if (SrsFlvCodec::video_is_sequence_header(msg.payload, msg.size)) {
         srs_freep(sh_video);
-        sh_video = msg->copy();
+        sh_video = msg.copy();
     }
     
-    if ((ret = queue->enqueue(msg)) != ERROR_SUCCESS) {
+    if ((ret = queue->enqueue(&msg)) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -224,6 +228,15 @@ int SrsForwarder::cycle()
 {
     int ret = ERROR_SUCCESS;
     
+    // the destination failed recently, wait until it's available.
+    if (!SrsLbUpstreams::instance()->fetch(ep_forward)->available(srs_update_system_time_ms())) {
+        return ret;
+    }
+    
+    std::vector<std::string> servers;
+    servers.push_back(ep_forward);
+    lb->select(servers);
+    
     std::string url;
     if (true) {
         std::string server;
@@ -239,22 +252,24 @@ int SrsForwarder::cycle()
     int64_t cto = SRS_FORWARDER_SLEEP_US;
     int64_t sto = SRS_CONSTS_RTMP_TIMEOUT_US;
     if ((ret = sdk->connect(url, cto, sto)) != ERROR_SUCCESS) {
+        lb->on_failure();
         srs_warn("forward failed, url=%s, cto=%"PRId64", sto=%"PRId64". ret=%d", url.c_str(), cto, sto, ret);
         return ret;
     }
     
     if ((ret = sdk->publish()) != ERROR_SUCCESS) {
+        lb->on_failure();
         return ret;
     }
+    lb->on_success();
     
     if ((ret = source->on_forwarder_start(this)) != ERROR_SUCCESS) {
         srs_error("callback the source to feed the sequence header failed. ret=%d", ret);
         return ret;
     }
     
-    if ((ret = forward()) != ERROR_SUCCESS) {
-        return ret;
-    }
+    ret = forward();
+    lb->on_close();
     
     return ret;
 }
@@ -304,7 +319,7 @@ int SrsForwarder::forward()
         }
         
         // forward all messages.
-        // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
+        // each msg in msgs.msgs must be free after sent, @see SrsMessageArray.free().
         int count = 0;
         if ((ret = queue->dump_packets(msgs.max, msgs.msgs, count)) != ERROR_SUCCESS) {
             srs_error("get message to forward failed. ret=%d", ret);
@@ -322,8 +337,10 @@ int SrsForwarder::forward()
             continue;
         }
     
-        // sendout messages, all messages are freed by send_and_free_messages().
-        if ((ret = sdk->send_and_free_messages(msgs.msgs, count)) != ERROR_SUCCESS) {
+        // sendout messages, then release the reusable msgs.
+        ret = sdk->send_messages(msgs.msgs, count);
+        msgs.free(count);
+        if (ret != ERROR_SUCCESS) {
             srs_error("forwarder messages to server failed. ret=%d", ret);
             return ret;
         }
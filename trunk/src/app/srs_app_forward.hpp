@@ -43,6 +43,7 @@ class SrsRtmpClient;
 class SrsRequest;
 class SrsSource;
 class SrsKbps;
+class SrsLoadBalancer;
 class SrsSimpleRtmpClient;
 
 /**
@@ -60,6 +61,8 @@ private:
 private:
     SrsSource* source;
     SrsSimpleRtmpClient* sdk;
+    // the lb of the single destination, to backoff when it's ejected for failures.
+    SrsLoadBalancer* lb;
     SrsRtmpJitter* jitter;
     SrsMessageQueue* queue;
     /**
@@ -0,0 +1,448 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <srs_app_handshake.hpp>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+// for the locks of openssl in multiple threads.
+#ifdef SRS_AUTO_SSL
+#include <openssl/crypto.h>
+#endif
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_core_performance.hpp>
+
+// the st thread to read the pipe of handshake pool.
+#define SRS_AUTO_HANDSHAKE_SLEEP_US 100000
+// the timeout to wait for the shared key, to check it again.
+#define SRS_AUTO_HANDSHAKE_WAIT_US 100000
+
+#ifdef SRS_AUTO_SSL
+
+using namespace _srs_internal;
+
+ISrsHandshakeWaiter::ISrsHandshakeWaiter()
+{
+}
+
+ISrsHandshakeWaiter::~ISrsHandshakeWaiter()
+{
+}
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+// the locks of openssl 1.0, which requires the locking callback for threads.
+static pthread_mutex_t* _srs_openssl_locks = NULL;
+
+static void srs_openssl_locking(int mode, int n, const char* /*file*/, int /*line*/)
+{
+    if (mode & CRYPTO_LOCK) {
+        pthread_mutex_lock(&_srs_openssl_locks[n]);
+    } else {
+        pthread_mutex_unlock(&_srs_openssl_locks[n]);
+    }
+}
+#endif
+
+SrsHandshakePool::SrsHandshakePool()
+{
+    capacity = 0;
+    waiter = NULL;
+    started = false;
+    quit = false;
+    nb_hits = nb_misses = 0;
+    
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+SrsHandshakePool::~SrsHandshakePool()
+{
+    stop();
+    
+    std::deque<SrsDH*>::iterator it;
+    for (it = keys.begin(); it != keys.end(); ++it) {
+        SrsDH* dh = *it;
+        srs_freep(dh);
+    }
+    keys.clear();
+    
+    std::vector<SrsHmacContext*>::iterator hit;
+    for (hit = hmacs.begin(); hit != hmacs.end(); ++hit) {
+        SrsHmacContext* h = *hit;
+        openssl_HMAC_free(h->ctx);
+        srs_freep(h);
+    }
+    hmacs.clear();
+    
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&lock);
+}
+
+int SrsHandshakePool::initialize(int nb_keys, ISrsHandshakeWaiter* w)
+{
+    int ret = ERROR_SUCCESS;
+    
+    capacity = nb_keys;
+    waiter = w;
+    
+    // the openssl is used by st and pthread, which requires the locks,
+    // while the openssl 1.1+ always locks and ignore the callback.
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    if (!CRYPTO_get_locking_callback()) {
+        int nb_locks = CRYPTO_num_locks();
+        _srs_openssl_locks = new pthread_mutex_t[nb_locks];
+        for (int i = 0; i < nb_locks; i++) {
+            pthread_mutex_init(&_srs_openssl_locks[i], NULL);
+        }
+        CRYPTO_set_locking_callback(srs_openssl_locking);
+    }
+#endif
+    
+    if (pthread_create(&tid, NULL, SrsHandshakePool::pool_pthread, this) != 0) {
+        ret = ERROR_SYSTEM_CREATE_THREAD;
+        srs_error("create handshake pool thread failed. ret=%d", ret);
+        return ret;
+    }
+    started = true;
+    
+    srs_trace("handshake pool: keep %d DH keys, compute in %s", nb_keys, waiter? "pthread" : "st");
+    
+    return ret;
+}
+
+void SrsHandshakePool::stop()
+{
+    if (!started) {
+        return;
+    }
+    
+    pthread_mutex_lock(&lock);
+    quit = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+    
+    pthread_join(tid, NULL);
+    started = false;
+    
+    srs_trace("handshake pool: stopped, hits=%"PRId64", misses=%"PRId64, nb_hits, nb_misses);
+}
+
+SrsDH* SrsHandshakePool::fetch_dh()
+{
+    SrsDH* dh = NULL;
+    
+    pthread_mutex_lock(&lock);
+    if (!keys.empty()) {
+        dh = keys.front();
+        keys.pop_front();
+        
+        // wakeup the pthread to generate more keys.
+        pthread_cond_signal(&cond);
+    }
+    pthread_mutex_unlock(&lock);
+    
+    if (dh) {
+        nb_hits++;
+    } else {
+        nb_misses++;
+    }
+    
+    return dh;
+}
+
+int SrsHandshakePool::compute_shared_key(SrsDH* dh, const char* ppkey, int32_t ppkey_size, char* skey, int32_t& skey_size)
+{
+    if (!waiter || !started) {
+        return dh->copy_shared_key(ppkey, ppkey_size, skey, skey_size);
+    }
+    
+    // the job is on the stack of coroutine, which waits until done.
+    SrsDHComputeJob job;
+    job.dh = dh;
+    job.ppkey = ppkey;
+    job.ppkey_size = ppkey_size;
+    job.skey = skey;
+    job.skey_size = skey_size;
+    job.ret = ERROR_SUCCESS;
+    job.done = false;
+    
+    pthread_mutex_lock(&lock);
+    jobs.push_back(&job);
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+    
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        bool done = job.done;
+        pthread_mutex_unlock(&lock);
+        
+        if (done) {
+            break;
+        }
+        
+        waiter->wait();
+    }
+    
+    skey_size = job.skey_size;
+    return job.ret;
+}
+
+HMAC_CTX* SrsHandshakePool::hmac(const void* key, int key_size)
+{
+    // only cache the genuine keys, for other keys are temporary.
+    if (key != SrsGenuineFMSKey && key != SrsGenuineFPKey) {
+        return NULL;
+    }
+    
+    std::vector<SrsHmacContext*>::iterator it;
+    for (it = hmacs.begin(); it != hmacs.end(); ++it) {
+        SrsHmacContext* h = *it;
+        if (h->key == key && h->key_size == key_size) {
+            return h->ctx;
+        }
+    }
+    
+    HMAC_CTX* ctx = openssl_HMAC_new(key, key_size);
+    if (!ctx) {
+        return NULL;
+    }
+    
+    SrsHmacContext* h = new SrsHmacContext();
+    h->key = key;
+    h->key_size = key_size;
+    h->ctx = ctx;
+    hmacs.push_back(h);
+    
+    return h->ctx;
+}
+
+void* SrsHandshakePool::pool_pthread(void* arg)
+{
+    SrsHandshakePool* pool = (SrsHandshakePool*)arg;
+    pool->do_cycle();
+    return NULL;
+}
+
+// @remark never log in the pthread, for the log is only used by st.
+void SrsHandshakePool::do_cycle()
+{
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        while (!quit && jobs.empty() && (int)keys.size() >= capacity) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        
+        // compute the shared key first, for the handshake is waiting for it.
+        if (!jobs.empty()) {
+            SrsDHComputeJob* job = jobs.front();
+            jobs.pop_front();
+            pthread_mutex_unlock(&lock);
+            
+            int32_t skey_size = job->skey_size;
+            int ret = job->dh->copy_shared_key(job->ppkey, job->ppkey_size, job->skey, skey_size);
+            
+            pthread_mutex_lock(&lock);
+            job->ret = ret;
+            job->skey_size = skey_size;
+            job->done = true;
+            pthread_mutex_unlock(&lock);
+            
+            waiter->notify();
+            continue;
+        }
+        
+        // quit when all jobs computed.
+        if (quit) {
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+        pthread_mutex_unlock(&lock);
+        
+        // generate the key, retry later when openssl failed.
+        SrsDH* dh = new SrsDH();
+        if (dh->initialize() != ERROR_SUCCESS) {
+            srs_freep(dh);
+            usleep(100 * 1000);
+            continue;
+        }
+        
+        // drop the key when public key is not 128bytes, @see SrsDH::initialize(true)
+        char pkey[128];
+        int32_t pkey_size = 128;
+        if (dh->copy_public_key(pkey, pkey_size) != ERROR_SUCCESS || pkey_size != 128) {
+            srs_freep(dh);
+            continue;
+        }
+        
+        pthread_mutex_lock(&lock);
+        keys.push_back(dh);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+SrsHandshakeWaiter::SrsHandshakeWaiter()
+{
+    pthread = new SrsReusableThread("hsp", this, SRS_AUTO_HANDSHAKE_SLEEP_US);
+    done_pipe[0] = done_pipe[1] = -1;
+    done_stfd = NULL;
+    done_cond = st_cond_new();
+}
+
+SrsHandshakeWaiter::~SrsHandshakeWaiter()
+{
+    stop();
+    
+    srs_freep(pthread);
+    
+    if (done_stfd) {
+        srs_close_stfd(done_stfd);
+        done_pipe[0] = -1;
+    }
+    if (done_pipe[0] >= 0) {
+        ::close(done_pipe[0]);
+    }
+    if (done_pipe[1] >= 0) {
+        ::close(done_pipe[1]);
+    }
+    
+    st_cond_destroy(done_cond);
+}
+
+int SrsHandshakeWaiter::initialize()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (pipe(done_pipe) < 0) {
+        ret = ERROR_SYSTEM_CREATE_PIPE;
+        srs_error("create handshake pipe failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // never block the pool pthread when pipe is full,
+    // for the st thread will wakeup all waiting handshakes.
+    int flags = fcntl(done_pipe[1], F_GETFL, 0);
+    if (flags < 0 || fcntl(done_pipe[1], F_SETFL, flags | O_NONBLOCK) < 0) {
+        ret = ERROR_SYSTEM_CREATE_PIPE;
+        srs_error("set handshake pipe nonblock failed. ret=%d", ret);
+        return ret;
+    }
+    
+    if ((done_stfd = st_netfd_open(done_pipe[0])) == NULL) {
+        ret = ERROR_SYSTEM_CREATE_PIPE;
+        srs_error("create handshake st pipe failed. ret=%d", ret);
+        return ret;
+    }
+    
+    if ((ret = pthread->start()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    return ret;
+}
+
+void SrsHandshakeWaiter::stop()
+{
+    pthread->stop();
+    
+    // wakeup the waiting handshakes.
+    st_cond_broadcast(done_cond);
+}
+
+void SrsHandshakeWaiter::wait()
+{
+    // wait with timeout, for the waiter maybe stopped.
+    st_cond_timedwait(done_cond, SRS_AUTO_HANDSHAKE_WAIT_US);
+}
+
+void SrsHandshakeWaiter::notify()
+{
+    char v = 0;
+    
+    // ignore when pipe is full, the st thread will read it.
+    ssize_t nwrite = ::write(done_pipe[1], &v, 1);
+    (void)nwrite;
+}
+
+int SrsHandshakeWaiter::cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    char buf[64];
+    while (pthread->can_loop()) {
+        ssize_t nread = st_read(done_stfd, buf, sizeof(buf), ST_UTIME_NO_TIMEOUT);
+        if (nread <= 0) {
+            return ret;
+        }
+        
+        st_cond_broadcast(done_cond);
+    }
+    
+    return ret;
+}
+
+// the waiter of pool, NULL when compute the shared key in st.
+static SrsHandshakeWaiter* _srs_handshake_waiter = NULL;
+// the pool of server, which is the hook of handshake.
+static SrsHandshakePool* _srs_handshake_server_pool = NULL;
+
+#endif
+
+int srs_initialize_handshake_pool()
+{
+    int ret = ERROR_SUCCESS;
+    
+#if defined(SRS_AUTO_SSL) && SRS_PERF_DH_KEY_POOL > 0
+#ifdef SRS_PERF_DH_OFFLOAD
+    _srs_handshake_waiter = new SrsHandshakeWaiter();
+    if ((ret = _srs_handshake_waiter->initialize()) != ERROR_SUCCESS) {
+        srs_error("initialize the handshake waiter failed. ret=%d", ret);
+        return ret;
+    }
+#endif
+    
+    _srs_handshake_server_pool = new SrsHandshakePool();
+    if ((ret = _srs_handshake_server_pool->initialize(SRS_PERF_DH_KEY_POOL, _srs_handshake_waiter)) != ERROR_SUCCESS) {
+        srs_error("initialize the handshake pool failed. ret=%d", ret);
+        return ret;
+    }
+    _srs_handshake_pool = _srs_handshake_server_pool;
+#endif
+    
+    return ret;
+}
+
+void srs_dispose_handshake_pool()
+{
+#ifdef SRS_AUTO_SSL
+    // stop the pthread, but never free the pool and waiter,
+    // for the handshakes maybe waiting for it.
+    if (_srs_handshake_server_pool) {
+        _srs_handshake_server_pool->stop();
+    }
+#endif
+}
+
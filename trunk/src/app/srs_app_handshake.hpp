@@ -0,0 +1,186 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef SRS_APP_HANDSHAKE_HPP
+#define SRS_APP_HANDSHAKE_HPP
+
+/*
+#include <srs_app_handshake.hpp>
+*/
+#include <srs_core.hpp>
+
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+#include <srs_app_st.hpp>
+#include <srs_app_thread.hpp>
+#include <srs_rtmp_handshake.hpp>
+
+#ifdef SRS_AUTO_SSL
+
+/**
+ * the st waiter of the handshake pool, to wait for the DH shared key
+ * computed by the pool pthread, for example, the st cond which is
+ * signaled when the pthread notify by pipe.
+ */
+class ISrsHandshakeWaiter
+{
+public:
+    ISrsHandshakeWaiter();
+    virtual ~ISrsHandshakeWaiter();
+public:
+    /**
+     * wait in st thread, until notified or timeout.
+     */
+    virtual void wait() = 0;
+    /**
+     * notify the waiting st threads, in the pool pthread.
+     */
+    virtual void notify() = 0;
+};
+
+/**
+ * the job to compute the DH shared key in the pool pthread,
+ * the done is protected by the lock of pool.
+ */
+struct SrsDHComputeJob
+{
+    _srs_internal::SrsDH* dh;
+    const char* ppkey;
+    int32_t ppkey_size;
+    char* skey;
+    int32_t skey_size;
+    int ret;
+    bool done;
+};
+
+/**
+ * the HMAC context of the genuine key, which is initialized with key once,
+ * then reset to digest each data.
+ */
+struct SrsHmacContext
+{
+    const void* key;
+    int key_size;
+    HMAC_CTX* ctx;
+};
+
+/**
+ * the pool for the complex handshake of server, the DH keys are generated by
+ * a pthread, so the st never generate the 1024bits DH key when lots of clients
+ * connect, for example, 30k clients reconnect when the edge restarts.
+ * when waiter is set, the DH shared key is computed by the pthread too, while
+ * the handshake coroutine waits for it, so st serves other connections.
+ */
+class SrsHandshakePool : public _srs_internal::ISrsHandshakePool
+{
+private:
+    int capacity;
+    ISrsHandshakeWaiter* waiter;
+    pthread_t tid;
+    bool started;
+    // the fields protected by lock, shared by st and pthread.
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool quit;
+    std::deque<_srs_internal::SrsDH*> keys;
+    std::deque<SrsDHComputeJob*> jobs;
+    // the HMAC contexts of genuine keys, only used in st.
+    std::vector<SrsHmacContext*> hmacs;
+public:
+    // the number of keys fetched from pool, and generated in st when empty.
+    int64_t nb_hits;
+    int64_t nb_misses;
+public:
+    SrsHandshakePool();
+    virtual ~SrsHandshakePool();
+public:
+    /**
+     * start the pthread to keep nb_keys DH keys in pool.
+     * @param w the waiter to compute the shared key in pthread, NULL to compute in st.
+     */
+    virtual int initialize(int nb_keys, ISrsHandshakeWaiter* w);
+    /**
+     * stop the pthread, the left jobs are computed before quit.
+     */
+    virtual void stop();
+// interface ISrsHandshakePool
+public:
+    virtual _srs_internal::SrsDH* fetch_dh();
+    /**
+     * compute the DH shared key in pthread and wait for it when waiter is set,
+     * otherwise compute in st.
+     */
+    virtual int compute_shared_key(_srs_internal::SrsDH* dh, const char* ppkey, int32_t ppkey_size, char* skey, int32_t& skey_size);
+    /**
+     * get the HMAC context of the genuine key.
+     * @return NULL for other keys, for example, the temp key of c2s2.
+     */
+    virtual HMAC_CTX* hmac(const void* key, int key_size);
+private:
+    static void* pool_pthread(void* arg);
+    virtual void do_cycle();
+};
+
+/**
+ * the st waiter of the handshake pool, the pool pthread notify by pipe when
+ * the DH shared key computed, then the st thread reads the pipe and signals
+ * the waiting handshakes.
+ */
+class SrsHandshakeWaiter : public ISrsHandshakeWaiter, public ISrsReusableThreadHandler
+{
+private:
+    SrsReusableThread* pthread;
+    // the pipe to notify st when the shared key computed.
+    int done_pipe[2];
+    st_netfd_t done_stfd;
+    // signal when the shared key computed.
+    st_cond_t done_cond;
+public:
+    SrsHandshakeWaiter();
+    virtual ~SrsHandshakeWaiter();
+public:
+    virtual int initialize();
+    virtual void stop();
+// interface ISrsHandshakeWaiter
+public:
+    virtual void wait();
+    virtual void notify();
+// interface ISrsReusableThreadHandler
+public:
+    virtual int cycle();
+};
+
+#endif
+
+/**
+ * initialize the handshake pool, to pre-generate the DH keys by pthread.
+ * @remark user must initialize it after st initialized.
+ */
+extern int srs_initialize_handshake_pool();
+extern void srs_dispose_handshake_pool();
+
+#endif
+
@@ -41,6 +41,7 @@ using namespace std;
 #include <srs_core_autofree.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_app_config.hpp>
+#include <srs_app_async_io.hpp>
 
 static void update_box(char *start, int size)
 {
@@ -89,8 +90,9 @@ string serialFlv(SrsSharedPtrMessage *msg)
 class SrsHdsFragment
 {
 public:
-    SrsHdsFragment(SrsRequest *r)
+    SrsHdsFragment(SrsRequest *r, int k)
         : req(r)
+        , key(k)
         , index(-1)
         , start_time(0)
         , videoSh(NULL)
@@ -154,19 +156,19 @@ public:
 
         data = string(ss.data(), ss.size()) + data;
 
+        // write the fragment by async io, never block the st.
         const char *file_path = path.c_str();
-        int fd = open(file_path, O_WRONLY | O_CREAT, S_IRWXU | S_IRGRP | S_IROTH);
-        if (fd < 0) {
+        SrsAsyncFileWriter writer(key);
+        if (writer.open(path) != ERROR_SUCCESS) {
             srs_error("open fragment file failed, path=%s", file_path);
-            return -1;
+            return ERROR_HDS_OPEN_FRAGMENT_FAILED;
         }
 
-        if (write(fd, data.data(), data.size()) != (int)data.size()) {
-            srs_error("write fragment file failed, path=", file_path);
-            close(fd);
-            return -1;
+        if (writer.write((void*)data.data(), data.size(), NULL) != ERROR_SUCCESS) {
+            srs_error("write fragment file failed, path=%s", file_path);
+            return ERROR_HDS_WRITE_FRAGMENT_FAILED;
         }
-        close(fd);
+        writer.close();
 
         srs_trace("build fragment success=%s", file_path);
 
@@ -247,6 +249,8 @@ public:
 
 private:
     SrsRequest *req;
+    // the key of async io to write fragment.
+    int key;
     list<SrsSharedPtrMessage *> msgs;
 
     /*!
@@ -268,7 +272,7 @@ SrsHds::SrsHds(SrsSource *s)
     , hds_req(NULL)
     , hds_enabled(false)
 {
-
+    io_key = SrsAsyncIo::alloc_key();
 }
 
 SrsHds::~SrsHds()
@@ -338,7 +342,7 @@ int SrsHds::on_video(SrsSharedPtrMessage* msg)
     }
 
     if (!currentSegment) {
-        currentSegment = new SrsHdsFragment(hds_req);
+        currentSegment = new SrsHdsFragment(hds_req, io_key);
         currentSegment->set_index(fragment_index++);
         currentSegment->set_start_time(msg->timestamp);
 
@@ -390,7 +394,7 @@ int SrsHds::on_audio(SrsSharedPtrMessage* msg)
     }
 
     if (!currentSegment) {
-        currentSegment = new SrsHdsFragment(hds_req);
+        currentSegment = new SrsHdsFragment(hds_req, io_key);
         currentSegment->set_index(fragment_index++);
         currentSegment->set_start_time(msg->timestamp);
 
@@ -452,21 +456,20 @@ int SrsHds::flush_mainfest()
     }
     string path = dir + "/" + hds_req->stream + ".f4m";
 
-    int fd = open(path.c_str(), O_WRONLY | O_CREAT, S_IRWXU | S_IRGRP | S_IROTH);
-    if (fd < 0) {
+    SrsAsyncFileWriter writer(io_key);
+    if (writer.open(path) != ERROR_SUCCESS) {
         srs_error("open manifest file failed, path=%s", path.c_str());
         ret = ERROR_HDS_OPEN_F4M_FAILED;
         return ret;
     }
 
     int f4m_size = strlen(buf);
-    if (write(fd, buf, f4m_size) != f4m_size) {
-        srs_error("write manifest file failed, path=", path.c_str());
-        close(fd);
+    if (writer.write(buf, f4m_size, NULL) != ERROR_SUCCESS) {
+        srs_error("write manifest file failed, path=%s", path.c_str());
         ret = ERROR_HDS_WRITE_F4M_FAILED;
         return ret;
     }
-    close(fd);
+    writer.close();
 
     srs_trace("build manifest success=%s", path.c_str());
 
@@ -709,20 +712,19 @@ int SrsHds::flush_bootstrap()
 
     string path = _srs_config->get_hds_path(hds_req->vhost) + "/" + hds_req->app + "/" + hds_req->stream +".abst";
 
-    int fd = open(path.c_str(), O_WRONLY | O_CREAT, S_IRWXU | S_IRGRP | S_IROTH);
-    if (fd < 0) {
+    SrsAsyncFileWriter writer(io_key);
+    if (writer.open(path) != ERROR_SUCCESS) {
         srs_error("open bootstrap file failed, path=%s", path.c_str());
         ret = ERROR_HDS_OPEN_BOOTSTRAP_FAILED;
         return ret;
     }
 
-    if (write(fd, start_abst, size_abst) != size_abst) {
-        srs_error("write bootstrap file failed, path=", path.c_str());
-        close(fd);
+    if (writer.write(start_abst, size_abst, NULL) != ERROR_SUCCESS) {
+        srs_error("write bootstrap file failed, path=%s", path.c_str());
         ret = ERROR_HDS_WRITE_BOOTSTRAP_FAILED;
         return ret;
     }
-    close(fd);
+    writer.close();
 
     srs_trace("build bootstrap success=%s", path.c_str());
 
@@ -741,7 +743,7 @@ void SrsHds::adjust_windows()
     double windows_size_limit = _srs_config->get_hds_window(hds_req->vhost) * 1000;
     if (windows_size > windows_size_limit ) {
         SrsHdsFragment *fragment = fragments.front();
-        unlink(fragment->fragment_path().c_str());
+        _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(fragment->fragment_path()));
         fragments.erase(fragments.begin());
         srs_freep(fragment);
     }
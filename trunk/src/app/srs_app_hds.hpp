@@ -61,6 +61,8 @@ private:
 
     SrsRequest *hds_req;
     bool hds_enabled;
+    // the key of async io, the files of stream are written in order.
+    int io_key;
 };
 
 #endif
@@ -50,6 +50,7 @@ using namespace std;
 #include <srs_kernel_ts.hpp>
 #include <srs_app_utility.hpp>
 #include <srs_app_http_hooks.hpp>
+#include <srs_core_performance.hpp>
 
 // drop the segment when duration of ts too small.
 #define SRS_AUTO_HLS_SEGMENT_MIN_DURATION_MS 100
@@ -66,18 +67,208 @@ using namespace std;
  * */
 #ifdef SRS_AUTO_HLS
 
-SrsHlsCacheWriter::SrsHlsCacheWriter(bool write_cache, bool write_file)
+SrsHlsRamFile::SrsSharedChunks::SrsSharedChunks()
 {
+    last_size = 0;
+    size = 0;
+    shared_count = 0;
+}
+
+SrsHlsRamFile::SrsSharedChunks::~SrsSharedChunks()
+{
+    std::vector<char*>::iterator it;
+    for (it = chunks.begin(); it != chunks.end(); ++it) {
+        char* chunk = *it;
+        srs_freepa(chunk);
+    }
+    chunks.clear();
+}
+
+SrsHlsRamFile::SrsHlsRamFile()
+{
+    ptr = new SrsSharedChunks();
+}
+
+SrsHlsRamFile::~SrsHlsRamFile()
+{
+    if (ptr->shared_count == 0) {
+        srs_freep(ptr);
+    } else {
+        ptr->shared_count--;
+    }
+}
+
+void SrsHlsRamFile::append(char* data, int size)
+{
+    // the file is immutable once shared.
+    srs_assert(ptr->shared_count == 0);
+    
+    while (size > 0) {
+        if (ptr->chunks.empty() || ptr->last_size >= SRS_PERF_HLS_RAM_CHUNK) {
+            ptr->chunks.push_back(new char[SRS_PERF_HLS_RAM_CHUNK]);
+            ptr->last_size = 0;
+        }
+        
+        int nb_copy = srs_min(size, SRS_PERF_HLS_RAM_CHUNK - ptr->last_size);
+        memcpy(ptr->chunks.back() + ptr->last_size, data, nb_copy);
+        
+        ptr->last_size += nb_copy;
+        ptr->size += nb_copy;
+        data += nb_copy;
+        size -= nb_copy;
+    }
+}
+
+int64_t SrsHlsRamFile::size()
+{
+    return ptr->size;
+}
+
+int SrsHlsRamFile::nb_chunks()
+{
+    return (int)ptr->chunks.size();
+}
+
+int SrsHlsRamFile::chunks_to_iovs(iovec* iovs)
+{
+    int nb_chunks = (int)ptr->chunks.size();
+    
+    for (int i = 0; i < nb_chunks; i++) {
+        iovs[i].iov_base = ptr->chunks[i];
+        iovs[i].iov_len = (i == nb_chunks - 1)? ptr->last_size : SRS_PERF_HLS_RAM_CHUNK;
+    }
+    
+    return nb_chunks;
+}
+
+SrsHlsRamFile* SrsHlsRamFile::copy()
+{
+    SrsHlsRamFile* copy = new SrsHlsRamFile();
+    srs_freep(copy->ptr);
+    
+    copy->ptr = ptr;
+    ptr->shared_count++;
+    
+    return copy;
+}
+
+SrsHlsRamStore* SrsHlsRamStore::_instance = NULL;
+
+SrsHlsRamStore::SrsHlsRamStore()
+{
+    nb_bytes = 0;
+    nb_hits = nb_misses = nb_evicts = 0;
+}
+
+SrsHlsRamStore::~SrsHlsRamStore()
+{
+    std::map<std::string, SrsHlsRamEntry>::iterator it;
+    for (it = files.begin(); it != files.end(); ++it) {
+        SrsHlsRamFile* file = it->second.file;
+        srs_freep(file);
+    }
+    files.clear();
+    lru.clear();
+}
+
+SrsHlsRamStore* SrsHlsRamStore::instance()
+{
+    if (!_instance) {
+        _instance = new SrsHlsRamStore();
+    }
+    return _instance;
+}
+
+void SrsHlsRamStore::put(string path, SrsHlsRamFile* file, int64_t budget)
+{
+    remove(path);
+    
+    SrsHlsRamEntry entry;
+    entry.file = file;
+    entry.lru = lru.insert(lru.begin(), path);
+    files[path] = entry;
+    nb_bytes += file->size();
+    
+    evict(budget);
+}
+
+SrsHlsRamFile* SrsHlsRamStore::fetch(string path)
+{
+    std::map<std::string, SrsHlsRamEntry>::iterator it = files.find(path);
+    if (it == files.end()) {
+        nb_misses++;
+        return NULL;
+    }
+    nb_hits++;
+    
+    // move to front, the most recently used.
+    SrsHlsRamEntry& entry = it->second;
+    lru.splice(lru.begin(), lru, entry.lru);
+    
+    return entry.file->copy();
+}
+
+bool SrsHlsRamStore::exists(string path)
+{
+    return files.find(path) != files.end();
+}
+
+void SrsHlsRamStore::remove(string path)
+{
+    std::map<std::string, SrsHlsRamEntry>::iterator it = files.find(path);
+    if (it == files.end()) {
+        return;
+    }
+    
+    SrsHlsRamEntry& entry = it->second;
+    SrsHlsRamFile* file = entry.file;
+    
+    nb_bytes -= file->size();
+    lru.erase(entry.lru);
+    files.erase(it);
+    
+    // the chunks are freed when the last viewer done.
+    srs_freep(file);
+}
+
+int64_t SrsHlsRamStore::size()
+{
+    return nb_bytes;
+}
+
+void SrsHlsRamStore::evict(int64_t budget)
+{
+    // never evict the file just put, at the front.
+    while (nb_bytes > budget && lru.size() > 1) {
+        std::string path = lru.back();
+        
+        nb_evicts++;
+        srs_warn("hls: evict %s from ram, size=%"PRId64", budget=%"PRId64", evicts=%"PRId64,
+            path.c_str(), nb_bytes, budget, nb_evicts);
+        
+        remove(path);
+    }
+}
+
+SrsHlsCacheWriter::SrsHlsCacheWriter(int key, bool write_cache, bool write_file) : impl(key)
+{
+    data = NULL;
     should_write_cache = write_cache;
     should_write_file = write_file;
 }
 
 SrsHlsCacheWriter::~SrsHlsCacheWriter()
 {
+    srs_freep(data);
 }
 
 int SrsHlsCacheWriter::open(string file)
 {
+    if (should_write_cache) {
+        srs_freep(data);
+        data = new SrsHlsRamFile();
+    }
+    
     if (!should_write_file) {
         return ERROR_SUCCESS;
     }
@@ -106,7 +297,7 @@ bool SrsHlsCacheWriter::is_open()
 int64_t SrsHlsCacheWriter::tellg()
 {
     if (!should_write_file) {
-        return 0;
+        return data? data->size() : 0;
     }
 
     return impl.tellg();
@@ -114,31 +305,42 @@ int64_t SrsHlsCacheWriter::tellg()
 
 int SrsHlsCacheWriter::write(void* buf, size_t count, ssize_t* pnwrite)
 {
-    if (should_write_cache) {
+    if (should_write_cache && data) {
         if (count > 0) {
-            data.append((char*)buf, count);
+            data->append((char*)buf, (int)count);
         }
     }
 
     if (should_write_file) {
         return impl.write(buf, count, pnwrite);
     }
+    
+    if (pnwrite) {
+        *pnwrite = count;
+    }
 
     return ERROR_SUCCESS;
 }
 
-string SrsHlsCacheWriter::cache()
+int SrsHlsCacheWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
+{
+    return write_iovs(iov, iovcnt, pnwrite);
+}
+
+SrsHlsRamFile* SrsHlsCacheWriter::cache()
 {
-    return data;
+    SrsHlsRamFile* file = data;
+    data = NULL;
+    return file;
 }
 
-SrsHlsSegment::SrsHlsSegment(SrsTsContext* c, bool write_cache, bool write_file, SrsCodecAudio ac, SrsCodecVideo vc)
+SrsHlsSegment::SrsHlsSegment(SrsTsContext* c, int key, bool write_cache, bool write_file, SrsCodecAudio ac, SrsCodecVideo vc)
 {
     duration = 0;
     sequence_no = 0;
     segment_start_dts = 0;
     is_sequence_header = false;
-    writer = new SrsHlsCacheWriter(write_cache, write_file);
+    writer = new SrsHlsCacheWriter(key, write_cache, write_file);
     muxer = new SrsTSMuxer(writer, c, ac, vc);
 }
 
@@ -169,7 +371,7 @@ void SrsHlsSegment::update_duration(int64_t current_frame_dts)
     return;
 }
 
-SrsDvrAsyncCallOnHls::SrsDvrAsyncCallOnHls(int c, SrsRequest* r, string p, string t, string m, string mu, int s, double d)
+SrsDvrAsyncCallOnHls::SrsDvrAsyncCallOnHls(int c, SrsRequest* r, string p, string t, string m, string mu, int s, double d, int k, int64_t b)
 {
     req = r->copy();
     cid = c;
@@ -179,6 +381,8 @@ SrsDvrAsyncCallOnHls::SrsDvrAsyncCallOnHls(int c, SrsRequest* r, string p, strin
     m3u8_url = mu;
     seq_no = s;
     duration = d;
+    key = k;
+    barrier = b;
 }
 
 SrsDvrAsyncCallOnHls::~SrsDvrAsyncCallOnHls()
@@ -211,6 +415,9 @@ int SrsDvrAsyncCallOnHls::call()
         hooks = conf->args;
     }
     
+    // wait for the ts and m3u8 written to disk.
+    _srs_async_io->wait(key, barrier);
+    
     for (int i = 0; i < (int)hooks.size(); i++) {
         std::string url = hooks.at(i);
         if ((ret = SrsHttpHooks::on_hls(cid, url, req, path, ts_url, m3u8, m3u8_url, seq_no, duration)) != ERROR_SUCCESS) {
@@ -228,11 +435,13 @@ string SrsDvrAsyncCallOnHls::to_string()
     return "on_hls: " + path;
 }
 
-SrsDvrAsyncCallOnHlsNotify::SrsDvrAsyncCallOnHlsNotify(int c, SrsRequest* r, string u)
+SrsDvrAsyncCallOnHlsNotify::SrsDvrAsyncCallOnHlsNotify(int c, SrsRequest* r, string u, int k, int64_t b)
 {
     cid = c;
     req = r->copy();
     ts_url = u;
+    key = k;
+    barrier = b;
 }
 
 SrsDvrAsyncCallOnHlsNotify::~SrsDvrAsyncCallOnHlsNotify()
@@ -265,6 +474,9 @@ int SrsDvrAsyncCallOnHlsNotify::call()
         hooks = conf->args;
     }
     
+    // wait for the ts written to disk.
+    _srs_async_io->wait(key, barrier);
+    
     int nb_notify = _srs_config->get_vhost_hls_nb_notify(req->vhost);
     for (int i = 0; i < (int)hooks.size(); i++) {
         std::string url = hooks.at(i);
@@ -301,6 +513,7 @@ SrsHlsMuxer::SrsHlsMuxer()
     should_write_cache = false;
     should_write_file = true;
     async = new SrsAsyncCallWorker();
+    io_key = SrsAsyncIo::alloc_key();
     context = new SrsTsContext();
 }
 
@@ -321,32 +534,33 @@ SrsHlsMuxer::~SrsHlsMuxer()
 
 void SrsHlsMuxer::dispose()
 {
+    if (should_write_cache) {
+        std::vector<SrsHlsSegment*>::iterator it;
+        for (it = segments.begin(); it != segments.end(); ++it) {
+            SrsHlsSegment* segment = *it;
+            SrsHlsRamStore::instance()->remove(ram_path(segment->full_path));
+        }
+        SrsHlsRamStore::instance()->remove(ram_path(m3u8));
+    }
+    
     if (should_write_file) {
         std::vector<SrsHlsSegment*>::iterator it;
         for (it = segments.begin(); it != segments.end(); ++it) {
             SrsHlsSegment* segment = *it;
-            if (unlink(segment->full_path.c_str()) < 0) {
-                srs_warn("dispose unlink path failed, file=%s.", segment->full_path.c_str());
-            }
+            _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(segment->full_path));
             srs_freep(segment);
         }
         segments.clear();
         
         if (current) {
             std::string path = current->full_path + ".tmp";
-            if (unlink(path.c_str()) < 0) {
-                srs_warn("dispose unlink path failed, file=%s", path.c_str());
-            }
             srs_freep(current);
+            _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(path));
         }
         
-        if (unlink(m3u8.c_str()) < 0) {
-            srs_warn("dispose unlink path failed. file=%s", m3u8.c_str());
-        }
+        _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(m3u8));
     }
     
-    // TODO: FIXME: support hls dispose in HTTP cache.
-    
     srs_trace("gracefully dispose hls %s", req? req->get_stream_url().c_str() : "");
 }
 
@@ -415,9 +629,10 @@ int SrsHlsMuxer::update_config(SrsRequest* r, string entry_prefix,
     // when update config, reset the history target duration.
     max_td = (int)(fragment * _srs_config->get_hls_td_ratio(r->vhost));
     
-    // TODO: FIXME: refine better for SRS2 only support disk.
-    should_write_cache = false;
-    should_write_file = true;
+    // write the files to ram store, or disk, or both.
+    std::string storage = _srs_config->get_hls_storage(r->vhost);
+    should_write_cache = storage == "ram" || storage == "both";
+    should_write_file = storage != "ram";
     
     // create m3u8 dir once.
     m3u8_dir = srs_path_dirname(m3u8);
@@ -476,7 +691,7 @@ int SrsHlsMuxer::segment_open(int64_t segment_start_dts)
     }
     
     // new segment.
-    current = new SrsHlsSegment(context, should_write_cache, should_write_file, default_acodec, default_vcodec);
+    current = new SrsHlsSegment(context, io_key, should_write_cache, should_write_file, default_acodec, default_vcodec);
     current->sequence_no = _sequence_no++;
     current->segment_start_dts = segment_start_dts;
     
@@ -710,6 +925,9 @@ int SrsHlsMuxer::segment_close(string log_desc)
     std::vector<SrsHlsSegment*>::iterator it;
     it = std::find(segments.begin(), segments.end(), current);
     srs_assert(it == segments.end());
+    
+    // the reaped segment, to notify when ts and m3u8 written.
+    SrsHlsSegment* reaped = NULL;
 
     // valid, add to segments if segment duration is ok
     // when too small, it maybe not enough data to play.
@@ -717,20 +935,7 @@ int SrsHlsMuxer::segment_close(string log_desc)
     // make the segment more acceptable, when in [min, max_td * 2], it's ok.
     if (current->duration * 1000 >= SRS_AUTO_HLS_SEGMENT_MIN_DURATION_MS && (int)current->duration <= max_td * 2) {
         segments.push_back(current);
-
-        // use async to call the http hooks, for it will cause thread switch.
-        if ((ret = async->execute(new SrsDvrAsyncCallOnHls(
-            _srs_context->get_id(), req,
-            current->full_path, current->uri, m3u8, m3u8_url,
-            current->sequence_no, current->duration))) != ERROR_SUCCESS)
-        {
-            return ret;
-        }
-
-        // use async to call the http hooks, for it will cause thread switch.
-        if ((ret = async->execute(new SrsDvrAsyncCallOnHlsNotify(_srs_context->get_id(), req, current->uri))) != ERROR_SUCCESS) {
-            return ret;
-        }
+        reaped = current;
 
         srs_info("%s reap ts segment, sequence_no=%d, uri=%s, duration=%.2f, start=%"PRId64,
             log_desc.c_str(), current->sequence_no, current->uri.c_str(), current->duration, 
@@ -740,11 +945,16 @@ int SrsHlsMuxer::segment_close(string log_desc)
         srs_freep(current->muxer);
         std::string full_path = current->full_path;
         current = NULL;
+        
+        // the ts in ram is immutable since now, shared by all viewers.
+        if (should_write_cache) {
+            int64_t budget = (int64_t)_srs_config->get_http_stream_hls_ram_budget() * 1024 * 1024;
+            SrsHlsRamStore::instance()->put(ram_path(full_path), reaped->writer->cache(), budget);
+        }
 
-        // rename from tmp to real path
+        // rename from tmp to real path, after the ts written by async io.
         std::string tmp_file = full_path + ".tmp";
-        if (should_write_file && rename(tmp_file.c_str(), full_path.c_str()) < 0) {
-            ret = ERROR_HLS_WRITE_FAILED;
+        if (should_write_file && (ret = _srs_async_io->execute(io_key, new SrsAsyncIoRenameTask(tmp_file, full_path))) != ERROR_SUCCESS) {
             srs_error("rename ts file failed, %s => %s. ret=%d", 
                 tmp_file.c_str(), full_path.c_str(), ret);
             return ret;
@@ -757,15 +967,13 @@ int SrsHlsMuxer::segment_close(string log_desc)
             log_desc.c_str(), current->sequence_no, current->uri.c_str(), current->duration, 
             current->segment_start_dts);
 
-        // rename from tmp to real path
+        // remove the tmp file, after the ts closed by async io.
         std::string tmp_file = current->full_path + ".tmp";
+        srs_freep(current);
+        
         if (should_write_file) {
-            if (unlink(tmp_file.c_str()) < 0) {
-                srs_warn("ignore unlink path failed, file=%s.", tmp_file.c_str());
-            }
+            _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(tmp_file));
         }
-
-        srs_freep(current);
     }
 
     // the segments to remove
@@ -791,15 +999,28 @@ int SrsHlsMuxer::segment_close(string log_desc)
 
     // refresh the m3u8, donot contains the removed ts
     ret = refresh_m3u8();
+    
+    // use async to call the http hooks, for it will cause thread switch,
+    // the hooks wait for the ts and m3u8 written by async io.
+    // @remark the reaped segment is the last one, never removed.
+    if (reaped) {
+        int cid = _srs_context->get_id();
+        int64_t barrier = _srs_async_io->sequence(io_key);
+        
+        async->execute(new SrsDvrAsyncCallOnHls(cid, req, reaped->full_path, reaped->uri, m3u8, m3u8_url,
+            reaped->sequence_no, reaped->duration, io_key, barrier));
+        async->execute(new SrsDvrAsyncCallOnHlsNotify(cid, req, reaped->uri, io_key, barrier));
+    }
 
     // remove the ts file.
     for (int i = 0; i < (int)segment_to_remove.size(); i++) {
         SrsHlsSegment* segment = segment_to_remove[i];
         
         if (hls_cleanup && should_write_file) {
-            if (unlink(segment->full_path.c_str()) < 0) {
-                srs_warn("cleanup unlink path failed, file=%s.", segment->full_path.c_str());
-            }
+            _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(segment->full_path));
+        }
+        if (hls_cleanup && should_write_cache) {
+            SrsHlsRamStore::instance()->remove(ram_path(segment->full_path));
         }
         
         srs_freep(segment);
@@ -824,19 +1045,19 @@ int SrsHlsMuxer::refresh_m3u8()
         return ret;
     }
     
+    // the temp m3u8 is written and renamed by async io in order.
     std::string temp_m3u8 = m3u8 + ".temp";
-    if ((ret = _refresh_m3u8(temp_m3u8)) == ERROR_SUCCESS) {
-        if (should_write_file && rename(temp_m3u8.c_str(), m3u8.c_str()) < 0) {
-            ret = ERROR_HLS_WRITE_FAILED;
-            srs_error("rename m3u8 file failed. %s => %s, ret=%d", temp_m3u8.c_str(), m3u8.c_str(), ret);
+    if ((ret = _refresh_m3u8(temp_m3u8)) != ERROR_SUCCESS) {
+        // remove the temp file.
+        if (should_write_file) {
+            _srs_async_io->execute(io_key, new SrsAsyncIoUnlinkTask(temp_m3u8));
         }
+        return ret;
     }
     
-    // remove the temp file.
-    if (srs_path_exists(temp_m3u8)) {
-        if (unlink(temp_m3u8.c_str()) < 0) {
-            srs_warn("ignore remove m3u8 failed, %s", temp_m3u8.c_str());
-        }
+    if (should_write_file && (ret = _srs_async_io->execute(io_key, new SrsAsyncIoRenameTask(temp_m3u8, m3u8))) != ERROR_SUCCESS) {
+        srs_error("rename m3u8 file failed. %s => %s, ret=%d", temp_m3u8.c_str(), m3u8.c_str(), ret);
+        return ret;
     }
     
     return ret;
@@ -851,7 +1072,7 @@ int SrsHlsMuxer::_refresh_m3u8(string m3u8_file)
         return ret;
     }
 
-    SrsHlsCacheWriter writer(should_write_cache, should_write_file);
+    SrsHlsCacheWriter writer(io_key, should_write_cache, should_write_file);
     if ((ret = writer.open(m3u8_file)) != ERROR_SUCCESS) {
         srs_error("open m3u8 file %s failed. ret=%d", m3u8_file.c_str(), ret);
         return ret;
@@ -924,9 +1145,27 @@ int SrsHlsMuxer::_refresh_m3u8(string m3u8_file)
     }
     srs_info("write m3u8 %s success.", m3u8_file.c_str());
     
+    // replace the m3u8 in ram, the viewers of previous one are not affected.
+    if (should_write_cache) {
+        int64_t budget = (int64_t)_srs_config->get_http_stream_hls_ram_budget() * 1024 * 1024;
+        SrsHlsRamStore::instance()->put(ram_path(this->m3u8), writer.cache(), budget);
+    }
+    
     return ret;
 }
 
+string SrsHlsMuxer::ram_path(string file)
+{
+    std::string path = file;
+    if (srs_string_starts_with(path, hls_path)) {
+        path = path.substr(hls_path.length());
+    }
+    while (srs_string_starts_with(path, "/")) {
+        path = path.substr(1);
+    }
+    return "/" + path;
+}
+
 SrsHlsCache::SrsHlsCache()
 {
     cache = new SrsTsCache();
@@ -1130,6 +1369,7 @@ int SrsHlsCache::reap_segment(string log_desc, SrsHlsMuxer* muxer, int64_t segme
 SrsHls::SrsHls()
 {
     req = NULL;
+    vconf = NULL;
     source = NULL;
     
     hls_enabled = false;
@@ -1182,7 +1422,7 @@ int SrsHls::cycle()
         return ret;
     }
     
-    int hls_dispose = _srs_config->get_hls_dispose(req->vhost) * 1000;
+    int hls_dispose = vconf->hls_dispose * 1000;
     if (hls_dispose <= 0) {
         return ret;
     }
@@ -1208,6 +1448,7 @@ int SrsHls::initialize(SrsSource* s, SrsRequest* r)
 
     source = s;
     req = r;
+    vconf = _srs_config->get_vhost_config(req->vhost);
 
     if ((ret = muxer->initialize()) != ERROR_SUCCESS) {
         return ret;
@@ -1228,8 +1469,7 @@ int SrsHls::on_publish(bool fetch_sequence_header)
         return ret;
     }
     
-    std::string vhost = req->vhost;
-    if (!_srs_config->get_hls_enabled(vhost)) {
+    if (!vconf->hls_enabled) {
         return ret;
     }
     
@@ -1373,7 +1613,7 @@ int SrsHls::on_video(SrsSharedPtrMessage* shared_video, bool is_sps_pps)
     // user can disable the sps parse to workaround when parse sps failed.
     // @see https://github.com/ossrs/srs/issues/474
     if (is_sps_pps) {
-        codec->avc_parse_sps = _srs_config->get_parse_sps(req->vhost);
+        codec->avc_parse_sps = vconf->parse_sps;
     }
     
     sample->clear();
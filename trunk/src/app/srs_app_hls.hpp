@@ -31,16 +31,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <string>
 #include <vector>
+#include <map>
+#include <list>
 
 #include <srs_kernel_codec.hpp>
 #include <srs_kernel_file.hpp>
 #include <srs_app_async_call.hpp>
+#include <srs_app_async_io.hpp>
 
 class SrsSharedPtrMessage;
 class SrsCodecSample;
 class SrsAmf0Object;
 class SrsRtmpJitter;
 class SrsTSMuxer;
+class SrsVhostConfig;
 class SrsAvcAacCodec;
 class SrsRequest;
 class SrsPithyPrint;
@@ -58,18 +62,130 @@ class SrsTsContext;
  * */
 #ifdef SRS_AUTO_HLS
 
+/**
+* the hls file in ram, the m3u8 or ts, which is a list of chunks written once
+* by the muxer, then shared by the store and all http viewers, by refcount,
+* so the viewers send the chunks by writev, never copy the file.
+* @remark the file is immutable once copied, user must never append to it.
+*/
+class SrsHlsRamFile
+{
+private:
+    class SrsSharedChunks
+    {
+    public:
+        // the chunks, each is SRS_PERF_HLS_RAM_CHUNK bytes except the last one.
+        std::vector<char*> chunks;
+        // the bytes of last chunk.
+        int last_size;
+        // the bytes of all chunks.
+        int64_t size;
+        // the reference count.
+        int shared_count;
+    public:
+        SrsSharedChunks();
+        virtual ~SrsSharedChunks();
+    };
+    SrsSharedChunks* ptr;
+public:
+    SrsHlsRamFile();
+    virtual ~SrsHlsRamFile();
+public:
+    /**
+    * append the data to file, alloc chunk when last one is full.
+    */
+    virtual void append(char* data, int size);
+    /**
+    * the bytes of file.
+    */
+    virtual int64_t size();
+    /**
+    * the number of chunks of file.
+    */
+    virtual int nb_chunks();
+    /**
+    * get the ioves of chunks, to send by writev.
+    * @param iovs the ioves to fill, at least nb_chunks().
+    * @return the number of ioves filled.
+    */
+    virtual int chunks_to_iovs(iovec* iovs);
+    /**
+    * copy the file, the chunks are shared and never copied.
+    */
+    virtual SrsHlsRamFile* copy();
+};
+
+/**
+* the store of hls files in ram, the key is the path relative to hls_path,
+* for example, /live/livestream.m3u8, which is the url path of http server.
+* the least recently used files are evicted when exceed the memory budget,
+* and the file is freed when the last viewer of it done.
+*/
+class SrsHlsRamStore
+{
+private:
+    static SrsHlsRamStore* _instance;
+private:
+    struct SrsHlsRamEntry
+    {
+        SrsHlsRamFile* file;
+        std::list<std::string>::iterator lru;
+    };
+    std::map<std::string, SrsHlsRamEntry> files;
+    // the paths of files, the most recently used at front.
+    std::list<std::string> lru;
+    // the bytes of files in store.
+    int64_t nb_bytes;
+public:
+    // the number of files hit, missed and evicted.
+    int64_t nb_hits;
+    int64_t nb_misses;
+    int64_t nb_evicts;
+public:
+    SrsHlsRamStore();
+    virtual ~SrsHlsRamStore();
+public:
+    static SrsHlsRamStore* instance();
+public:
+    /**
+    * put the file to store, replace the exists one, then evict the least
+    * recently used files when exceed the budget.
+    * @param budget the max bytes of files in store.
+    * @remark the store owns the file.
+    */
+    virtual void put(std::string path, SrsHlsRamFile* file, int64_t budget);
+    /**
+    * fetch the file, and mark it recently used.
+    * @return the copy of file which user must free, NULL when not found.
+    */
+    virtual SrsHlsRamFile* fetch(std::string path);
+    /**
+    * whether the file is in store.
+    */
+    virtual bool exists(std::string path);
+    virtual void remove(std::string path);
+    /**
+    * the bytes of files in store.
+    */
+    virtual int64_t size();
+private:
+    virtual void evict(int64_t budget);
+};
+
 /**
 * write to file and cache.
+* @remark the file is written by async io, never block the st.
 */
 class SrsHlsCacheWriter : public SrsFileWriter
 {
 private:
-    SrsFileWriter impl;
-    std::string data;
+    SrsAsyncFileWriter impl;
+    // the file in ram, NULL when not write cache.
+    SrsHlsRamFile* data;
     bool should_write_cache;
     bool should_write_file;
 public:
-    SrsHlsCacheWriter(bool write_cache, bool write_file);
+    SrsHlsCacheWriter(int key, bool write_cache, bool write_file);
     virtual ~SrsHlsCacheWriter();
 public:
     /**
@@ -86,11 +202,13 @@ public:
     * @param pnwrite the output nb_write, NULL to ignore.
     */
     virtual int write(void* buf, size_t count, ssize_t* pnwrite);
+    virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
 public:
     /**
-    * get the string cache.
+    * detach the file in ram, which is written since open.
+    * @return the file which user must free, NULL when not write cache.
     */
-    virtual std::string cache();
+    virtual SrsHlsRamFile* cache();
 };
 
 /**
@@ -118,7 +236,7 @@ public:
     // whether current segement is sequence header.
     bool is_sequence_header;
 public:
-    SrsHlsSegment(SrsTsContext* c, bool write_cache, bool write_file, SrsCodecAudio ac, SrsCodecVideo vc);
+    SrsHlsSegment(SrsTsContext* c, int key, bool write_cache, bool write_file, SrsCodecAudio ac, SrsCodecVideo vc);
     virtual ~SrsHlsSegment();
 public:
     /**
@@ -142,8 +260,11 @@ private:
     int seq_no;
     SrsRequest* req;
     double duration;
+    // the async io key and sequence to wait for the files written.
+    int key;
+    int64_t barrier;
 public:
-    SrsDvrAsyncCallOnHls(int c, SrsRequest* r, std::string p, std::string t, std::string m, std::string mu, int s, double d);
+    SrsDvrAsyncCallOnHls(int c, SrsRequest* r, std::string p, std::string t, std::string m, std::string mu, int s, double d, int k, int64_t b);
     virtual ~SrsDvrAsyncCallOnHls();
 public:
     virtual int call();
@@ -159,8 +280,11 @@ private:
     int cid;
     std::string ts_url;
     SrsRequest* req;
+    // the async io key and sequence to wait for the files written.
+    int key;
+    int64_t barrier;
 public:
-    SrsDvrAsyncCallOnHlsNotify(int c, SrsRequest* r, std::string u);
+    SrsDvrAsyncCallOnHlsNotify(int c, SrsRequest* r, std::string u, int k, int64_t b);
     virtual ~SrsDvrAsyncCallOnHlsNotify();
 public:
     virtual int call();
@@ -190,6 +314,8 @@ private:
     double hls_fragment;
     double hls_window;
     SrsAsyncCallWorker* async;
+    // the key of async io, all files of stream are written in order.
+    int io_key;
 private:
     // whether use floor algorithm for timestamp.
     bool hls_ts_floor;
@@ -206,7 +332,7 @@ private:
     std::string m3u8;
     std::string m3u8_url;
 private:
-    // TODO: FIXME: remove it.
+    // whether write the files to ram store and disk, by hls_storage.
     bool should_write_cache;
     bool should_write_file;
 private:
@@ -289,6 +415,10 @@ public:
 private:
     virtual int refresh_m3u8();
     virtual int _refresh_m3u8(std::string m3u8_file);
+    /**
+    * get the path of file in ram store, relative to hls_path.
+    */
+    virtual std::string ram_path(std::string file);
 };
 
 /**
@@ -358,6 +488,8 @@ private:
     SrsHlsCache* hls_cache;
 private:
     SrsRequest* req;
+    // the compiled config of vhost, for the hot path.
+    SrsVhostConfig* vconf;
     bool hls_enabled;
     bool hls_can_dispose;
     int64_t last_update_time;
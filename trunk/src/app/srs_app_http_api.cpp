@@ -47,14 +47,15 @@ using namespace std;
 #include <srs_app_server.hpp>
 #include <srs_protocol_amf0.hpp>
 #include <srs_protocol_utility.hpp>
+#include <srs_app_dns.hpp>
 
-int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, string data)
+int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, char* data, int size)
 {
     int ret = ERROR_SUCCESS;
     
     SrsHttpHeader* h = w->header();
     
-    h->set_content_length(data.length() + callback.length() + 2);
+    h->set_content_length(size + callback.length() + 2);
     h->set_content_type("text/javascript");
     
     if (!callback.empty() && (ret = w->write((char*)callback.data(), (int)callback.length())) != ERROR_SUCCESS) {
@@ -65,7 +66,7 @@ int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, string da
     if ((ret = w->write(c0, 1)) != ERROR_SUCCESS) {
         return ret;
     }
-    if ((ret = w->write((char*)data.data(), (int)data.length())) != ERROR_SUCCESS) {
+    if ((ret = w->write(data, size)) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -79,44 +80,57 @@ int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, string da
 
 int srs_api_response_jsonp_code(ISrsHttpResponseWriter* w, string callback, int code)
 {
-    SrsJsonObject* obj = SrsJsonAny::object();
-    SrsAutoFree(SrsJsonObject, obj);
+    SrsJsonWriter json;
     
-    obj->set("code", SrsJsonAny::integer(code));
+    json.object_start();
+    json.field_integer("code", code);
+    json.object_end();
     
-    return srs_api_response_jsonp(w, callback, obj->dumps());
+    return srs_api_response_jsonp(w, callback, json.bytes(), json.length());
 }
 
-int srs_api_response_json(ISrsHttpResponseWriter* w, string data)
+int srs_api_response_json(ISrsHttpResponseWriter* w, char* data, int size)
 {
     SrsHttpHeader* h = w->header();
     
-    h->set_content_length(data.length());
+    h->set_content_length(size);
     h->set_content_type("application/json");
     
-    return w->write((char*)data.data(), (int)data.length());
+    return w->write(data, size);
 }
 
 int srs_api_response_json_code(ISrsHttpResponseWriter* w, int code)
 {
-    SrsJsonObject* obj = SrsJsonAny::object();
-    SrsAutoFree(SrsJsonObject, obj);
+    SrsJsonWriter json;
     
-    obj->set("code", SrsJsonAny::integer(code));
+    json.object_start();
+    json.field_integer("code", code);
+    json.object_end();
     
-    return srs_api_response_json(w, obj->dumps());
+    return srs_api_response_json(w, json.bytes(), json.length());
 }
 
-int srs_api_response(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string json)
+/**
+ * response the json written by writer, without copy it to string.
+ */
+int srs_api_response(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, SrsJsonWriter* json)
 {
     // no jsonp, directly response.
     if (!r->is_jsonp()) {
-        return srs_api_response_json(w, json);
+        return srs_api_response_json(w, json->bytes(), json->length());
     }
     
     // jsonp, get function name from query("callback")
     string callback = r->query_get("callback");
-    return srs_api_response_jsonp(w, callback, json);
+    return srs_api_response_jsonp(w, callback, json->bytes(), json->length());
+}
+
+int srs_api_response(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, SrsJsonObject* obj)
+{
+    SrsJsonWriter json;
+    json.any(obj);
+    
+    return srs_api_response(w, r, &json);
 }
 
 int srs_api_response_code(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, int code)
@@ -154,7 +168,7 @@ int SrsGoApiRoot::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     
     urls->set("api", SrsJsonAny::str("the api root"));
         
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiApi::SrsGoApiApi()
@@ -180,7 +194,7 @@ int SrsGoApiApi::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     
     urls->set("v1", SrsJsonAny::str("the api version 1.0"));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiV1::SrsGoApiV1()
@@ -212,6 +226,7 @@ int SrsGoApiV1::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     urls->set("meminfos", SrsJsonAny::str("the meminfo of system"));
     urls->set("authors", SrsJsonAny::str("the license, copyright, authors and contributors"));
     urls->set("features", SrsJsonAny::str("the supported features of SRS"));
+    urls->set("dns", SrsJsonAny::str("the dns resolver and cache of SRS"));
     urls->set("requests", SrsJsonAny::str("the request itself, for http debug"));
     urls->set("vhosts", SrsJsonAny::str("manage all vhosts or specified vhost"));
     urls->set("streams", SrsJsonAny::str("manage all streams or specified stream"));
@@ -226,7 +241,7 @@ int SrsGoApiV1::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     tests->set("redirects", SrsJsonAny::str("always redirect to /api/v1/test/errors"));
     tests->set("[vhost]", SrsJsonAny::str("http vhost for http://error.srs.com:1985/api/v1/tests/errors"));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiVersion::SrsGoApiVersion()
@@ -255,7 +270,7 @@ int SrsGoApiVersion::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     data->set("revision", SrsJsonAny::integer(VERSION_REVISION));
     data->set("version", SrsJsonAny::str(RTMP_SIG_SRS_VERSION));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiSummaries::SrsGoApiSummaries()
@@ -278,7 +293,7 @@ int SrsGoApiSummaries::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     
     srs_api_dump_summaries(obj);
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiRusages::SrsGoApiRusages()
@@ -323,7 +338,7 @@ int SrsGoApiRusages::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     data->set("ru_nvcsw", SrsJsonAny::integer(ru->r.ru_nvcsw));
     data->set("ru_nivcsw", SrsJsonAny::integer(ru->r.ru_nivcsw));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiSelfProcStats::SrsGoApiSelfProcStats()
@@ -400,7 +415,7 @@ int SrsGoApiSelfProcStats::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage
     data->set("guest_time", SrsJsonAny::integer(u->guest_time));
     data->set("cguest_time", SrsJsonAny::integer(u->cguest_time));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiSystemProcStats::SrsGoApiSystemProcStats()
@@ -439,7 +454,7 @@ int SrsGoApiSystemProcStats::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessa
     data->set("steal", SrsJsonAny::integer(s->steal));
     data->set("guest", SrsJsonAny::integer(s->guest));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiMemInfos::SrsGoApiMemInfos()
@@ -479,7 +494,7 @@ int SrsGoApiMemInfos::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     data->set("SwapTotal", SrsJsonAny::integer(m->SwapTotal));
     data->set("SwapFree", SrsJsonAny::integer(m->SwapFree));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiAuthors::SrsGoApiAuthors()
@@ -509,7 +524,7 @@ int SrsGoApiAuthors::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     data->set("authors", SrsJsonAny::str(RTMP_SIG_SRS_AUTHROS));
     data->set("contributors", SrsJsonAny::str(SRS_AUTO_CONSTRIBUTORS));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiFeatures::SrsGoApiFeatures()
@@ -627,7 +642,33 @@ int SrsGoApiFeatures::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     features->set("mr", SrsJsonAny::boolean(false));
 #endif
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
+}
+
+SrsGoApiDns::SrsGoApiDns()
+{
+}
+
+SrsGoApiDns::~SrsGoApiDns()
+{
+}
+
+int SrsGoApiDns::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
+{
+    SrsStatistic* stat = SrsStatistic::instance();
+    
+    SrsJsonObject* obj = SrsJsonAny::object();
+    SrsAutoFree(SrsJsonObject, obj);
+    
+    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
+    obj->set("server", SrsJsonAny::integer(stat->server_id()));
+    
+    SrsJsonObject* data = SrsJsonAny::object();
+    obj->set("dns", data);
+    
+    SrsDnsResolver::instance()->dumps(data);
+    
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiRequests::SrsGoApiRequests()
@@ -676,7 +717,7 @@ int SrsGoApiRequests::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     server->set("link", SrsJsonAny::str(RTMP_SIG_SRS_URL));
     server->set("time", SrsJsonAny::integer(srs_get_system_time_ms()));
     
-    return srs_api_response(w, r, obj->dumps());
+    return srs_api_response(w, r, obj);
 }
 
 SrsGoApiVhosts::SrsGoApiVhosts()
@@ -704,33 +745,31 @@ int SrsGoApiVhosts::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return srs_api_response_code(w, r, ret);
     }
     
-    SrsJsonObject* obj = SrsJsonAny::object();
-    SrsAutoFree(SrsJsonObject, obj);
+    if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
     
-    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
-    obj->set("server", SrsJsonAny::integer(stat->server_id()));
+    SrsJsonWriter json;
     
-    if (r->is_http_get()) {
-        if (!vhost) {
-            SrsJsonArray* data = SrsJsonAny::array();
-            obj->set("vhosts", data);
-            
-            if ((ret = stat->dumps_vhosts(data)) != ERROR_SUCCESS) {
-                return srs_api_response_code(w, r, ret);
-            }
-        } else {
-            SrsJsonObject* data = SrsJsonAny::object();
-            obj->set("vhost", data);;
-            
-            if ((ret = vhost->dumps(data)) != ERROR_SUCCESS) {
-                return srs_api_response_code(w, r, ret);
-            }
+    json.object_start();
+    json.field_integer("code", ERROR_SUCCESS);
+    json.field_integer("server", stat->server_id());
+    
+    if (!vhost) {
+        json.key("vhosts");
+        if ((ret = stat->dumps_vhosts(&json)) != ERROR_SUCCESS) {
+            return srs_api_response_code(w, r, ret);
         }
     } else {
-        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+        json.key("vhost");
+        if ((ret = vhost->dumps(&json)) != ERROR_SUCCESS) {
+            return srs_api_response_code(w, r, ret);
+        }
     }
     
-    return srs_api_response(w, r, obj->dumps());
+    json.object_end();
+    
+    return srs_api_response(w, r, &json);
 }
 
 SrsGoApiStreams::SrsGoApiStreams()
@@ -758,33 +797,31 @@ int SrsGoApiStreams::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return srs_api_response_code(w, r, ret);
     }
     
-    SrsJsonObject* obj = SrsJsonAny::object();
-    SrsAutoFree(SrsJsonObject, obj);
+    if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
     
-    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
-    obj->set("server", SrsJsonAny::integer(stat->server_id()));
+    SrsJsonWriter json;
     
-    if (r->is_http_get()) {
-        if (!stream) {
-            SrsJsonArray* data = SrsJsonAny::array();
-            obj->set("streams", data);
-            
-            if ((ret = stat->dumps_streams(data)) != ERROR_SUCCESS) {
-                return srs_api_response_code(w, r, ret);
-            }
-        } else {
-            SrsJsonObject* data = SrsJsonAny::object();
-            obj->set("stream", data);;
-            
-            if ((ret = stream->dumps(data)) != ERROR_SUCCESS) {
-                return srs_api_response_code(w, r, ret);
-            }
+    json.object_start();
+    json.field_integer("code", ERROR_SUCCESS);
+    json.field_integer("server", stat->server_id());
+    
+    if (!stream) {
+        json.key("streams");
+        if ((ret = stat->dumps_streams(&json)) != ERROR_SUCCESS) {
+            return srs_api_response_code(w, r, ret);
         }
     } else {
-        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+        json.key("stream");
+        if ((ret = stream->dumps(&json)) != ERROR_SUCCESS) {
+            return srs_api_response_code(w, r, ret);
+        }
     }
     
-    return srs_api_response(w, r, obj->dumps());
+    json.object_end();
+    
+    return srs_api_response(w, r, &json);
 }
 
 SrsGoApiClients::SrsGoApiClients()
@@ -812,25 +849,32 @@ int SrsGoApiClients::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return srs_api_response_code(w, r, ret);
     }
     
-    SrsJsonObject* obj = SrsJsonAny::object();
-    SrsAutoFree(SrsJsonObject, obj);
+    SrsJsonWriter json;
     
-    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
-    obj->set("server", SrsJsonAny::integer(stat->server_id()));
+    json.object_start();
+    json.field_integer("code", ERROR_SUCCESS);
+    json.field_integer("server", stat->server_id());
     
     if (r->is_http_get()) {
         if (!client) {
-            SrsJsonArray* data = SrsJsonAny::array();
-            obj->set("clients", data);
+            // the page of clients, for example, /api/v1/clients?cursor=100&count=10
+            // @remark the cursor is the client id, the next is the cursor of next page.
+            int cursor = ::atoi(r->query_get("cursor").c_str());
             
-            if ((ret = stat->dumps_clients(data, 0, 10)) != ERROR_SUCCESS) {
+            int count = SRS_PERF_API_CLIENTS_PAGE;
+            if (!r->query_get("count").empty()) {
+                count = ::atoi(r->query_get("count").c_str());
+            }
+            
+            int next = -1;
+            json.key("clients");
+            if ((ret = stat->dumps_clients(&json, cursor, count, &next)) != ERROR_SUCCESS) {
                 return srs_api_response_code(w, r, ret);
             }
+            json.field_integer("next", next);
         } else {
-            SrsJsonObject* data = SrsJsonAny::object();
-            obj->set("client", data);;
-            
-            if ((ret = client->dumps(data)) != ERROR_SUCCESS) {
+            json.key("client");
+            if ((ret = client->dumps(&json)) != ERROR_SUCCESS) {
                 return srs_api_response_code(w, r, ret);
             }
         }
@@ -841,13 +885,22 @@ int SrsGoApiClients::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
             return srs_api_response_code(w, r, ret);
         }
         
+        // for example, the http flv player, which can not be expired.
+        if (!client->conn) {
+            ret = ERROR_RTMP_CLIENT_NOT_EXPIRE;
+            srs_error("client id=%d can not kickoff. ret=%d", cid, ret);
+            return srs_api_response_code(w, r, ret);
+        }
+        
         client->conn->expire();
         srs_warn("kickoff client id=%d ok", cid);
     } else {
         return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
     }
     
-    return srs_api_response(w, r, obj->dumps());
+    json.object_end();
+    
+    return srs_api_response(w, r, &json);
 }
 
 SrsGoApiRaw::SrsGoApiRaw(SrsServer* svr)
@@ -886,7 +939,7 @@ int SrsGoApiRaw::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
             return srs_api_response_code(w, r, ret);
         }
         
-        return srs_api_response(w, r, obj->dumps());
+        return srs_api_response(w, r, obj);
     }
     
     // whether enabled the HTTP RAW API.
@@ -982,7 +1035,7 @@ int SrsGoApiRaw::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
             }
         }
         
-        return srs_api_response(w, r, obj->dumps());
+        return srs_api_response(w, r, obj);
     }
     
     // for rpc=update, to update the configs of server.
@@ -1279,7 +1332,7 @@ int SrsGoApiRaw::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
             srs_warn("raw api update not applied %s=%s%s.", scope.c_str(), value.c_str(), extra.c_str());
         }
         
-        return srs_api_response(w, r, obj->dumps());
+        return srs_api_response(w, r, obj);
     }
     
     return ret;
@@ -143,6 +143,15 @@ public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
 };
 
+class SrsGoApiDns : public ISrsHttpHandler
+{
+public:
+    SrsGoApiDns();
+    virtual ~SrsGoApiDns();
+public:
+    virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
+};
+
 class SrsGoApiRequests : public ISrsHttpHandler
 {
 public:
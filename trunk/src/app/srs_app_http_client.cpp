@@ -38,6 +38,95 @@ using namespace std;
 #include <srs_app_http_conn.hpp>
 #include <srs_protocol_kbps.hpp>
 
+SrsHttpClientPool* SrsHttpClientPool::_instance = NULL;
+
+SrsHttpClientPool::SrsHttpClientPool()
+{
+    nb_reuses = nb_recycles = 0;
+}
+
+SrsHttpClientPool::~SrsHttpClientPool()
+{
+    std::map<std::string, std::vector<SrsHttpIdleConnection> >::iterator it;
+    for (it = idles.begin(); it != idles.end(); ++it) {
+        std::vector<SrsHttpIdleConnection>& conns = it->second;
+        for (int i = 0; i < (int)conns.size(); i++) {
+            srs_freep(conns[i].transport);
+        }
+    }
+    idles.clear();
+}
+
+SrsHttpClientPool* SrsHttpClientPool::instance()
+{
+    if (!_instance) {
+        _instance = new SrsHttpClientPool();
+    }
+    return _instance;
+}
+
+SrsTcpClient* SrsHttpClientPool::acquire(string host, int port)
+{
+    std::map<std::string, std::vector<SrsHttpIdleConnection> >::iterator it = idles.find(host + ":" + srs_int2str(port));
+    if (it == idles.end()) {
+        return NULL;
+    }
+    
+    std::vector<SrsHttpIdleConnection>& conns = it->second;
+    int64_t now = srs_get_system_time_ms();
+    
+    // the newest is the last one, so the expired ones are dropped together.
+    while (!conns.empty()) {
+        SrsHttpIdleConnection conn = conns.back();
+        conns.pop_back();
+        
+        if (now - conn.starttime >= SRS_PERF_HTTP_CLIENT_IDLE_MS) {
+            srs_freep(conn.transport);
+            
+            for (int i = 0; i < (int)conns.size(); i++) {
+                srs_freep(conns[i].transport);
+            }
+            conns.clear();
+            break;
+        }
+        
+        if (conn.transport->is_broken()) {
+            srs_freep(conn.transport);
+            continue;
+        }
+        
+        nb_reuses++;
+        return conn.transport;
+    }
+    
+    return NULL;
+}
+
+void SrsHttpClientPool::release(string host, int port, SrsTcpClient* transport)
+{
+    std::vector<SrsHttpIdleConnection>& conns = idles[host + ":" + srs_int2str(port)];
+    int64_t now = srs_get_system_time_ms();
+    
+    // drop the oldest ones, which are expired or exceed the max idle connections.
+    int nb_drops = 0;
+    while (nb_drops < (int)conns.size()) {
+        SrsHttpIdleConnection& conn = conns[nb_drops];
+        if (now - conn.starttime < SRS_PERF_HTTP_CLIENT_IDLE_MS && (int)conns.size() - nb_drops < SRS_PERF_HTTP_CLIENT_POOL) {
+            break;
+        }
+        srs_freep(conn.transport);
+        nb_drops++;
+    }
+    conns.erase(conns.begin(), conns.begin() + nb_drops);
+    
+    SrsHttpIdleConnection conn;
+    conn.transport = transport;
+    conn.starttime = now;
+    conns.push_back(conn);
+    
+    nb_recycles++;
+}
+
 SrsHttpClient::SrsHttpClient()
 {
     transport = new SrsTcpClient();
@@ -45,6 +134,7 @@ SrsHttpClient::SrsHttpClient()
     parser = NULL;
     timeout_us = 0;
     port = 0;
+    reused = false;
 }
 
 SrsHttpClient::~SrsHttpClient()
@@ -101,96 +191,30 @@ SrsHttpClient* SrsHttpClient::set_header(string k, string v)
 
 int SrsHttpClient::post(string path, string req, ISrsHttpMessage** ppmsg)
 {
-    *ppmsg = NULL;
-    
-    int ret = ERROR_SUCCESS;
-    
-    // always set the content length.
-    headers["Content-Length"] = srs_int2str(req.length());
-    
-    if ((ret = connect()) != ERROR_SUCCESS) {
-        srs_warn("http connect server failed. ret=%d", ret);
-        return ret;
-    }
-    
-    // send POST request to uri
-    // POST %s HTTP/1.1\r\nHost: %s\r\nContent-Length: %d\r\n\r\n%s
-    std::stringstream ss;
-    ss << "POST " << path << " " << "HTTP/1.1" << SRS_HTTP_CRLF;
-    for (map<string, string>::iterator it = headers.begin(); it != headers.end(); ++it) {
-        string key = it->first;
-        string value = it->second;
-        ss << key << ": " << value << SRS_HTTP_CRLF;
-    }
-    ss << SRS_HTTP_CRLF << req;
-    
-    std::string data = ss.str();
-    if ((ret = transport->write((void*)data.c_str(), data.length(), NULL)) != ERROR_SUCCESS) {
-        // disconnect when error.
-        disconnect();
-        
-        srs_error("write http post failed. ret=%d", ret);
-        return ret;
-    }
-    
-    ISrsHttpMessage* msg = NULL;
-    if ((ret = parser->parse_message(transport, NULL, &msg)) != ERROR_SUCCESS) {
-        srs_error("parse http post response failed. ret=%d", ret);
-        return ret;
-    }
-
-    srs_assert(msg);
-    *ppmsg = msg;
-    srs_info("parse http post response success.");
-    
-    return ret;
+    return do_request("POST", path, req, ppmsg);
 }
 
 int SrsHttpClient::get(string path, string req, ISrsHttpMessage** ppmsg)
 {
-    *ppmsg = NULL;
-
-    int ret = ERROR_SUCCESS;
-    
-    // always set the content length.
-    headers["Content-Length"] = srs_int2str(req.length());
-
-    if ((ret = connect()) != ERROR_SUCCESS) {
-        srs_warn("http connect server failed. ret=%d", ret);
-        return ret;
-    }
+    return do_request("GET", path, req, ppmsg);
+}
 
-    // send POST request to uri
-    // GET %s HTTP/1.1\r\nHost: %s\r\nContent-Length: %d\r\n\r\n%s
-    std::stringstream ss;
-    ss << "GET " << path << " " << "HTTP/1.1" << SRS_HTTP_CRLF;
-    for (map<string, string>::iterator it = headers.begin(); it != headers.end(); ++it) {
-        string key = it->first;
-        string value = it->second;
-        ss << key << ": " << value << SRS_HTTP_CRLF;
+void SrsHttpClient::recycle(ISrsHttpMessage* msg)
+{
+    if (!transport->connected()) {
+        return;
     }
-    ss << SRS_HTTP_CRLF << req;
-
-    std::string data = ss.str();
-    if ((ret = transport->write((void*)data.c_str(), data.length(), NULL)) != ERROR_SUCCESS) {
-        // disconnect when error.
+    
+    // the next response is corrupt when body left in connection.
+    if (SRS_PERF_HTTP_CLIENT_POOL <= 0 || !msg->is_keep_alive() || !msg->body_reader()->eof()) {
         disconnect();
-
-        srs_error("write http get failed. ret=%d", ret);
-        return ret;
-    }
-
-    ISrsHttpMessage* msg = NULL;
-    if ((ret = parser->parse_message(transport, NULL, &msg)) != ERROR_SUCCESS) {
-        srs_error("parse http post response failed. ret=%d", ret);
-        return ret;
+        return;
     }
-    srs_assert(msg);
-
-    *ppmsg = msg;
-    srs_info("parse http get response success.");
-
-    return ret;
+    
+    kbps->set_io(NULL, NULL);
+    
+    SrsHttpClientPool::instance()->release(host, port, transport);
+    transport = new SrsTcpClient();
 }
 
 void SrsHttpClient::set_recv_timeout(int64_t timeout)
@@ -212,23 +236,118 @@ void SrsHttpClient::kbps_sample(const char* label, int64_t age)
     srs_trace("<- %s time=%"PRId64", okbps=%d,%d,%d, ikbps=%d,%d,%d", label, age, sr, sr30s, sr5m, rr, rr30s, rr5m);
 }
 
+int SrsHttpClient::do_request(string method, string path, string req, ISrsHttpMessage** ppmsg)
+{
+    *ppmsg = NULL;
+    
+    int ret = ERROR_SUCCESS;
+    
+    // always set the content length.
+    headers["Content-Length"] = srs_int2str(req.length());
+    
+    // send request to uri
+    // POST %s HTTP/1.1\r\nHost: %s\r\nContent-Length: %d\r\n\r\n%s
+    std::stringstream ss;
+    ss << method << " " << path << " " << "HTTP/1.1" << SRS_HTTP_CRLF;
+    for (map<string, string>::iterator it = headers.begin(); it != headers.end(); ++it) {
+        string key = it->first;
+        string value = it->second;
+        ss << key << ": " << value << SRS_HTTP_CRLF;
+    }
+    ss << SRS_HTTP_CRLF << req;
+    
+    std::string data = ss.str();
+    
+    for (int i = 0; i < 2; i++) {
+        // never reuse the idle connection when retry.
+        if ((ret = connect(i == 0)) != ERROR_SUCCESS) {
+            srs_warn("http connect server failed. ret=%d", ret);
+            return ret;
+        }
+        
+        // the server maybe close the reused connection when we send the request,
+        // so we retry once by a new connection.
+        bool retry = (reused && i == 0);
+        int64_t nb_recv = transport->get_recv_bytes();
+        
+        if ((ret = transport->write((void*)data.c_str(), data.length(), NULL)) != ERROR_SUCCESS) {
+            // disconnect when error.
+            disconnect();
+            
+            if (retry) {
+                srs_warn("write http %s by reused connection failed, retry. ret=%d", method.c_str(), ret);
+                continue;
+            }
+            
+            srs_error("write http %s failed. ret=%d", method.c_str(), ret);
+            return ret;
+        }
+        
+        ISrsHttpMessage* msg = NULL;
+        if ((ret = parser->parse_message(transport, NULL, &msg)) != ERROR_SUCCESS) {
+            // only retry when the reused connection is closed or reset before any
+            // byte of response, for the server maybe already handled the request,
+            // for example, the timeout or the broken response of the POST of hooks.
+            if (retry && ret == ERROR_SOCKET_READ && transport->get_recv_bytes() == nb_recv) {
+                disconnect();
+                
+                // reset the parser, which maybe parsed part of message.
+                srs_freep(parser);
+                parser = new SrsHttpParser();
+                if ((ret = parser->initialize(HTTP_RESPONSE, false)) != ERROR_SUCCESS) {
+                    srs_error("initialize parser failed. ret=%d", ret);
+                    return ret;
+                }
+                
+                srs_warn("reused connection closed before http %s response, retry.", method.c_str());
+                continue;
+            }
+            
+            srs_error("parse http %s response failed. ret=%d", method.c_str(), ret);
+            return ret;
+        }
+        
+        srs_assert(msg);
+        *ppmsg = msg;
+        srs_info("parse http %s response success.", method.c_str());
+        
+        return ret;
+    }
+    
+    return ret;
+}
+
 void SrsHttpClient::disconnect()
 {
     kbps->set_io(NULL, NULL);
     transport->close();
 }
 
-int SrsHttpClient::connect()
+int SrsHttpClient::connect(bool pooled)
 {
     int ret = ERROR_SUCCESS;
     
     if (transport->connected()) {
+        reused = true;
         return ret;
     }
     
     disconnect();
     
-    // open socket.
+    // reuse the idle connection of upstream.
+    SrsTcpClient* idle = NULL;
+    if (pooled) {
+        idle = SrsHttpClientPool::instance()->acquire(host, port);
+    }
+    if (idle) {
+        srs_freep(transport);
+        transport = idle;
+        reused = true;
+    } else {
+        reused = false;
+    }
+    
+    // open socket, ignore when reused.
     if ((ret = transport->connect(host, port, timeout_us)) != ERROR_SUCCESS) {
         srs_warn("http client failed, server=%s, port=%d, timeout=%"PRId64", ret=%d",
             host.c_str(), port, timeout_us, ret);
@@ -31,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <string>
 #include <map>
+#include <vector>
 
 #ifdef SRS_AUTO_HTTP_CORE
 
@@ -45,6 +46,51 @@ class SrsKbps;
 // the default timeout for http client.
 #define SRS_HTTP_CLIENT_TIMEOUT_US (int64_t)(30*1000*1000LL)
 
+/**
+ * the idle connection in pool.
+ */
+struct SrsHttpIdleConnection
+{
+    SrsTcpClient* transport;
+    // the time in ms when connection become idle.
+    int64_t starttime;
+};
+
+/**
+ * the pool of idle keep-alive connections of http client, for each upstream
+ * host:port, the http client acquires the connection from pool and recycles
+ * it when response is read completely, for example, the http hooks of all
+ * clients share the connections to the api server, so we never connect and
+ * leave TIME_WAIT for each hook, especially when lots of clients join.
+ * @remark the pool is only used in st thread.
+ */
+class SrsHttpClientPool
+{
+private:
+    static SrsHttpClientPool* _instance;
+    // the idle connections of upstream, key is host:port, the last one is the newest.
+    std::map<std::string, std::vector<SrsHttpIdleConnection> > idles;
+public:
+    // the number of connections acquired from pool, and recycled to pool.
+    int64_t nb_reuses;
+    int64_t nb_recycles;
+public:
+    SrsHttpClientPool();
+    virtual ~SrsHttpClientPool();
+    static SrsHttpClientPool* instance();
+public:
+    /**
+     * acquire the newest idle connection of upstream, drop the expired or broken ones.
+     * @return the connected transport, NULL when no idle connection.
+     * @remark user must free the transport, or release it to pool.
+     */
+    virtual SrsTcpClient* acquire(std::string host, int port);
+    /**
+     * release the connected transport to pool, which is freed when pool is full.
+     */
+    virtual void release(std::string host, int port, SrsTcpClient* transport);
+};
+
 /**
 * http client to GET/POST/PUT/DELETE uri
 */
@@ -60,6 +106,8 @@ private:
     // host name or ip.
     std::string host;
     int port;
+    // whether the transport is reused, which maybe closed by server.
+    bool reused;
 public:
     SrsHttpClient();
     virtual ~SrsHttpClient();
@@ -90,12 +138,31 @@ public:
      * @remark user must free the ppmsg if not NULL.
      */
     virtual int get(std::string path, std::string req, ISrsHttpMessage** ppmsg);
+    /**
+     * recycle the connection to pool for the next request to the same upstream,
+     * when the response is keep-alive and its body is read completely,
+     * otherwise, close the connection.
+     * @remark user must recycle before free the msg, and never read it again.
+     */
+    virtual void recycle(ISrsHttpMessage* msg);
 public:
     virtual void set_recv_timeout(int64_t timeout);
     virtual void kbps_sample(const char* label, int64_t age);
 private:
+    /**
+     * send the request and parse the response, retry once by a new connection
+     * when the reused connection is closed by server, that is, failed to write
+     * the request, or closed before the first byte of response.
+     * @remark never retry when timeout or response is broken, for the request
+     *       maybe handled by server, for example, the POST of hooks.
+     */
+    virtual int do_request(std::string method, std::string path, std::string req, ISrsHttpMessage** ppmsg);
     virtual void disconnect();
-    virtual int connect();
+    /**
+     * connect to server when not connected.
+     * @param pooled whether reuse the idle connection in pool.
+     */
+    virtual int connect(bool pooled);
 };
 
 #endif
@@ -165,8 +165,40 @@ int SrsHttpResponseWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
 {
     int ret = ERROR_SUCCESS;
     
-    // when header not ready, or not chunked, send one by one.
-    if (!header_wrote || content_length != -1) {
+    // write the header data in memory.
+    if (!header_wrote) {
+        write_header(SRS_CONSTS_HTTP_OK);
+    }
+    
+    // directly send all ioves with content length, never copy.
+    if (content_length != -1) {
+        char* first = iovcnt > 0? (char*)iov[0].iov_base : NULL;
+        int nb_first = iovcnt > 0? (int)iov[0].iov_len : 0;
+        if ((ret = send_header(first, nb_first)) != ERROR_SUCCESS) {
+            srs_error("http: send header failed. ret=%d", ret);
+            return ret;
+        }
+        
+        int64_t size = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            size += iov[i].iov_len;
+        }
+        
+        written += size;
+        if (written > content_length) {
+            ret = ERROR_HTTP_CONTENT_LENGTH;
+            srs_error("http: exceed content length. ret=%d", ret);
+            return ret;
+        }
+        
+        if (iovcnt <= 0) {
+            return ret;
+        }
+        return srs_write_large_iovs(skt, iov, iovcnt, pnwrite);
+    }
+    
+    // when header not sent, send one by one.
+    if (!header_sent) {
         ssize_t nwrite = 0;
         for (int i = 0; i < iovcnt; i++) {
             iovec* piovc = iov + i;
@@ -245,6 +277,52 @@ int SrsHttpResponseWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
     return ret;
 }
 
+#ifdef SRS_PERF_HTTP_SENDFILE
+int SrsHttpResponseWriter::sendfile(int fd, int64_t offset, int64_t size)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // write the header data in memory.
+    if (!header_wrote) {
+        write_header(SRS_CONSTS_HTTP_OK);
+    }
+    
+    // whatever header is wrote, we should try to send header.
+    if ((ret = send_header(NULL, 0)) != ERROR_SUCCESS) {
+        srs_error("http: send header failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // check the bytes send and content length.
+    written += size;
+    if (content_length != -1 && written > content_length) {
+        ret = ERROR_HTTP_CONTENT_LENGTH;
+        srs_error("http: exceed content length. ret=%d", ret);
+        return ret;
+    }
+    
+    // ignore empty content.
+    if (size <= 0) {
+        return ret;
+    }
+    
+    // directly send with content length
+    if (content_length != -1) {
+        return skt->sendfile(fd, offset, size, NULL);
+    }
+    
+    // send in chunked encoding, the file as the chunk body.
+    int nb_size = snprintf(header_cache, SRS_HTTP_HEADER_CACHE_SIZE, "%"PRIx64 SRS_HTTP_CRLF, size);
+    if ((ret = skt->write(header_cache, nb_size, NULL)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = skt->sendfile(fd, offset, size, NULL)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    return skt->write((void*)SRS_HTTP_CRLF, 2, NULL);
+}
+#endif
+
 void SrsHttpResponseWriter::write_header(int code)
 {
     if (header_wrote) {
@@ -1305,6 +1383,11 @@ int SrsHttpServer::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return http_stream->mux.serve_http(w, r);
     }
     
+    // then the hls in ram, which is never on disk.
+    if (http_stream->hls.can_serve(r)) {
+        return http_stream->hls.serve_http(w, r);
+    }
+    
     return http_static->mux.serve_http(w, r);
 }
 
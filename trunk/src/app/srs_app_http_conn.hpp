@@ -106,6 +106,9 @@ public:
     virtual SrsHttpHeader* header();
     virtual int write(char* data, int size);
     virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+#ifdef SRS_PERF_HTTP_SENDFILE
+    virtual int sendfile(int fd, int64_t offset, int64_t size);
+#endif
     virtual void write_header(int code);
     virtual int send_header(char* data, int size);
 };
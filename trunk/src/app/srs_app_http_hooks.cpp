@@ -50,6 +50,25 @@ using namespace std;
 // the timeout for hls notify, in us.
 #define SRS_HLS_NOTIFY_TIMEOUT_US (int64_t)(10*1000*1000LL)
 
+// sweep the expired decisions when exceed this number.
+#define SRS_HTTP_HOOKS_MAX_DECISIONS 1024
+
+SrsHttpHooksDecision::SrsHttpHooksDecision()
+{
+    error = ERROR_SUCCESS;
+    expire = 0;
+    calling = false;
+    cond = st_cond_new();
+    nb_waiting = 0;
+}
+
+SrsHttpHooksDecision::~SrsHttpHooksDecision()
+{
+    st_cond_destroy(cond);
+}
+
+std::map<std::string, SrsHttpHooksDecision*> SrsHttpHooks::decisions;
+
 SrsHttpHooks::SrsHttpHooks()
 {
 }
@@ -205,6 +224,68 @@ int SrsHttpHooks::on_play(string url, SrsRequest* req)
 {
     int ret = ERROR_SUCCESS;
     
+    int ttl = _srs_config->get_vhost_on_play_cache_ttl(req->vhost);
+    if (ttl <= 0) {
+        return do_on_play(url, req);
+    }
+    
+    int client_id = _srs_context->get_id();
+    std::string key = url + " " + req->get_stream_url() + "?" + req->param;
+    
+    SrsHttpHooksDecision* decision = NULL;
+    std::map<std::string, SrsHttpHooksDecision*>::iterator it = decisions.find(key);
+    if (it != decisions.end()) {
+        decision = it->second;
+    } else {
+        sweep_decisions();
+        decision = decisions[key] = new SrsHttpHooksDecision();
+    }
+    
+    // wait for the identical call in flight.
+    if (decision->calling) {
+        decision->nb_waiting++;
+        st_cond_timedwait(decision->cond, SRS_HTTP_CLIENT_TIMEOUT_US);
+        decision->nb_waiting--;
+        
+        if (decision->calling) {
+            ret = ERROR_SOCKET_TIMEOUT;
+            srs_error("http hook on_play wait timeout. client_id=%d, url=%s, key=%s, ret=%d",
+                client_id, url.c_str(), key.c_str(), ret);
+            return ret;
+        }
+        
+        srs_trace("http hook on_play shared. client_id=%d, url=%s, key=%s, ret=%d",
+            client_id, url.c_str(), key.c_str(), decision->error);
+        return decision->error;
+    }
+    
+    // hit the cache.
+    if (decision->expire > srs_update_system_time_ms()) {
+        srs_trace("http hook on_play cached. client_id=%d, url=%s, key=%s, ret=%d",
+            client_id, url.c_str(), key.c_str(), decision->error);
+        return decision->error;
+    }
+    
+    decision->calling = true;
+    ret = do_on_play(url, req);
+    
+    // only cache the decision of hook, never cache the error of network or server.
+    decision->error = ret;
+    decision->expire = 0;
+    if (ret == ERROR_SUCCESS || ret == ERROR_RESPONSE_CODE) {
+        decision->expire = srs_update_system_time_ms() + ttl * 1000;
+    }
+    
+    decision->calling = false;
+    st_cond_broadcast(decision->cond);
+    
+    return ret;
+}
+
+int SrsHttpHooks::do_on_play(string url, SrsRequest* req)
+{
+    int ret = ERROR_SUCCESS;
+    
     int client_id = _srs_context->get_id();
     
     SrsJsonObject* obj = SrsJsonAny::object();
@@ -417,6 +498,11 @@ int SrsHttpHooks::on_hls_notify(int cid, std::string url, SrsRequest* req, std::
         nb_read += nb_bytes;
     }
     
+    // reuse the connection when the body is read completely.
+    if (ret == ERROR_SUCCESS) {
+        http.recycle(msg);
+    }
+    
     int spenttime = (int)(srs_update_system_time_ms() - starttime);
     srs_trace("http hook on_hls_notify success. client_id=%d, url=%s, code=%d, spent=%dms, read=%dB, ret=%d",
         client_id, url.c_str(), msg->status_code(), spenttime, nb_read, ret);
@@ -427,6 +513,28 @@ int SrsHttpHooks::on_hls_notify(int cid, std::string url, SrsRequest* req, std::
     return ret;
 }
 
+void SrsHttpHooks::sweep_decisions()
+{
+    if ((int)decisions.size() < SRS_HTTP_HOOKS_MAX_DECISIONS) {
+        return;
+    }
+    
+    int64_t now = srs_update_system_time_ms();
+    
+    std::map<std::string, SrsHttpHooksDecision*>::iterator it;
+    for (it = decisions.begin(); it != decisions.end();) {
+        SrsHttpHooksDecision* decision = it->second;
+        
+        if (decision->calling || decision->nb_waiting > 0 || decision->expire > now) {
+            ++it;
+            continue;
+        }
+        
+        srs_freep(decision);
+        decisions.erase(it++);
+    }
+}
+
 int SrsHttpHooks::do_post(SrsHttpClient* hc, std::string url, std::string req, int& code, string& res)
 {
     int ret = ERROR_SUCCESS;
@@ -452,6 +560,9 @@ int SrsHttpHooks::do_post(SrsHttpClient* hc, std::string url, std::string req, i
         return ret;
     }
     
+    // the connection is reused by the next hook to the same api server.
+    hc->recycle(msg);
+    
     // ensure the http status is ok.
     // https://github.com/ossrs/srs/issues/158
     if (code != SRS_CONSTS_HTTP_OK && code != SRS_CONSTS_HTTP_Created) {
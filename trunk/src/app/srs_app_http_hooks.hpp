@@ -30,9 +30,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_core.hpp>
 
 #include <string>
+#include <map>
 
 #ifdef SRS_AUTO_HTTP_CALLBACK
 
+#include <srs_app_st.hpp>
+
 class SrsHttpUri;
 class SrsStSocket;
 class SrsRequest;
@@ -40,6 +43,25 @@ class SrsHttpParser;
 class SrsFlvSegment;
 class SrsHttpClient;
 
+/**
+ * the decision of hook, cached for the ttl, and shared by the identical calls in flight.
+ */
+class SrsHttpHooksDecision
+{
+public:
+    // the error of hook, ERROR_SUCCESS when allowed.
+    int error;
+    // the time in ms to expire, 0 for never cached.
+    int64_t expire;
+    // whether calling the hook, the identical calls wait for the decision.
+    bool calling;
+    st_cond_t cond;
+    int nb_waiting;
+public:
+    SrsHttpHooksDecision();
+    virtual ~SrsHttpHooksDecision();
+};
+
 /**
 * the http hooks, http callback api,
 * for some event, such as on_connect, call
@@ -47,6 +69,9 @@ class SrsHttpClient;
 */
 class SrsHttpHooks
 {
+private:
+    // the cached decisions of on_play, key is the hook url and vhost/app/stream?param.
+    static std::map<std::string, SrsHttpHooksDecision*> decisions;
 private:
     SrsHttpHooks();
 public:
@@ -80,6 +105,7 @@ public:
     * on_play hook, when client start to play stream.
     * @param url the api server url, to valid the client. 
     *         ignore if empty.
+    * @remark the decision is cached when on_play_cache_ttl of vhost is configured.
     */
     static int on_play(std::string url, SrsRequest* req);
     /**
@@ -119,6 +145,11 @@ public:
      */
     static int on_hls_notify(int cid, std::string url, SrsRequest* req, std::string ts_url, int nb_notify);
 private:
+    static int do_on_play(std::string url, SrsRequest* req);
+    /**
+     * sweep the expired decisions, when there are too many decisions.
+     */
+    static void sweep_decisions();
     static int do_post(SrsHttpClient* hc, std::string url, std::string req, int& code, std::string& res);
 };
 
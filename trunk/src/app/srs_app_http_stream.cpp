@@ -51,10 +51,13 @@ using namespace std;
 #include <srs_kernel_aac.hpp>
 #include <srs_kernel_mp3.hpp>
 #include <srs_kernel_ts.hpp>
+#include <srs_kernel_stream.hpp>
+#include <srs_kernel_codec.hpp>
 #include <srs_app_pithy_print.hpp>
 #include <srs_app_source.hpp>
 #include <srs_app_server.hpp>
 #include <srs_app_statistic.hpp>
+#include <srs_app_hls.hpp>
 
 #endif
 
@@ -69,12 +72,20 @@ SrsBufferCache::SrsBufferCache(SrsSource* s, SrsRequest* r)
     
     // TODO: FIXME: support reload.
     fast_cache = _srs_config->get_vhost_http_remux_fast_cache(req->vhost);
+    
+    chunks_front = 0;
+    nb_viewers = 0;
+    remux_video = false;
+    chunks_wait = st_cond_new();
 }
 
 SrsBufferCache::~SrsBufferCache()
 {
     srs_freep(pthread);
     
+    clear_chunks();
+    st_cond_destroy(chunks_wait);
+    
     srs_freep(queue);
     srs_freep(req);
 }
@@ -115,10 +126,95 @@ int SrsBufferCache::dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorithm jit
     return ret;
 }
 
+void SrsBufferCache::set_remux(string ext)
+{
+    remux_ext = ext;
+}
+
+bool SrsBufferCache::is_remux()
+{
+    return !remux_ext.empty();
+}
+
+void SrsBufferCache::on_viewer_start()
+{
+    nb_viewers++;
+}
+
+void SrsBufferCache::on_viewer_stop()
+{
+    nb_viewers--;
+}
+
+int SrsBufferCache::dump_chunks(int64_t* pcursor, SrsMessageArray* msgs, int& count)
+{
+    int ret = ERROR_SUCCESS;
+    
+    count = 0;
+    
+    int64_t cursor = *pcursor;
+    int64_t end = chunks_front + (int64_t)chunks.size();
+    
+    // join the stream, or the viewer falls behind the cache.
+    if (cursor < chunks_front) {
+        if (cursor >= 0) {
+            srs_warn("http: viewer falls behind the remux, skip %"PRId64" chunks", chunks_front - cursor);
+            *pcursor = -1;
+        }
+        
+        if (remux_ext == ".ts") {
+            // for ts, must join at the PAT/PMT and IDR.
+            if (joins.empty()) {
+                return ret;
+            }
+            cursor = joins.back();
+        } else {
+            // for aac/mp3, join from the fast cache, or the live.
+            cursor = end;
+            if (fast_cache > 0 && !chunks.empty()) {
+                int64_t start_time = chunks.back()->timestamp - (int64_t)(fast_cache * 1000);
+                for (cursor = chunks_front; cursor < end - 1; cursor++) {
+                    if (chunks[cursor - chunks_front]->timestamp >= start_time) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    // the msgs refer the chunks, which maybe freed by remux when sending.
+    for (; cursor < end && count < msgs->max; cursor++) {
+        SrsSharedPtrMessage* chunk = chunks[cursor - chunks_front];
+        chunk->copy_to(msgs->msgs[count++]);
+    }
+    *pcursor = cursor;
+    
+    return ret;
+}
+
+void SrsBufferCache::wait_chunks(int64_t timeout_us)
+{
+    st_cond_timedwait(chunks_wait, timeout_us);
+}
+
+string SrsBufferCache::header()
+{
+    return remux_header;
+}
+
 int SrsBufferCache::cycle()
 {
     int ret = ERROR_SUCCESS;
     
+    // remux for the viewers, or the fast cache.
+    if (!remux_ext.empty()) {
+        if (nb_viewers <= 0 && fast_cache <= 0) {
+            st_usleep(SRS_CONSTS_RTMP_PULSE_TIMEOUT_US);
+            return ret;
+        }
+        return remux_cycle();
+    }
+    
     // TODO: FIXME: support reload.
     if (fast_cache <= 0) {
         st_sleep(SRS_STREAM_CACHE_CYCLE_SECONDS);
@@ -147,7 +243,7 @@ int SrsBufferCache::cycle()
         pprint->elapse();
 
         // get messages from consumer.
-        // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
+        // each msg in msgs.msgs must be free, @see SrsMessageArray.free().
         int count = 0;
         if ((ret = consumer->dump_packets(&msgs, count)) != ERROR_SUCCESS) {
             srs_error("http: get messages from consumer failed. ret=%d", ret);
@@ -168,16 +264,193 @@ int SrsBufferCache::cycle()
                 count, pprint->age(), SRS_PERF_MW_MIN_MSGS, SRS_CONSTS_RTMP_PULSE_TIMEOUT_US / 1000);
         }
     
-        // free the messages.
+        // cache the messages, the queue copy the reference of msgs.
         for (int i = 0; i < count; i++) {
             SrsSharedPtrMessage* msg = msgs.msgs[i];
             queue->enqueue(msg);
         }
+        
+        // free the messages.
+        msgs.free(count);
+    }
+    
+    return ret;
+}
+
+int SrsBufferCache::remux_cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    ISrsBufferEncoder* enc = NULL;
+    if (remux_ext == ".ts") {
+        enc = new SrsTsStreamEncoder();
+    } else if (remux_ext == ".aac") {
+        enc = new SrsAacStreamEncoder();
+    } else {
+        enc = new SrsMp3StreamEncoder();
+    }
+    SrsAutoFree(ISrsBufferEncoder, enc);
+    
+    // the header of stream is written when initialize.
+    SrsBufferChunkWriter writer;
+    if ((ret = enc->initialize(&writer, this)) != ERROR_SUCCESS) {
+        srs_error("http: initialize remux encoder failed. ret=%d", ret);
+        return ret;
+    }
+    remux_header = writer.flush();
+    remux_video = false;
+    
+    // the dumped gop cache of source makes the viewer join fast.
+    SrsConsumer* consumer = NULL;
+    if ((ret = source->create_consumer(NULL, consumer, true, true, true)) != ERROR_SUCCESS) {
+        srs_error("http: create remux consumer failed. ret=%d", ret);
+        return ret;
+    }
+    SrsAutoFree(SrsConsumer, consumer);
+    
+    SrsPithyPrint* pprint = SrsPithyPrint::create_http_stream_cache();
+    SrsAutoFree(SrsPithyPrint, pprint);
+    
+    SrsMessageArray msgs(SRS_PERF_MW_MSGS);
+    int mw_sleep = _srs_config->get_mw_sleep_ms(req->vhost);
+    
+    srs_trace("http: start remux %s, viewers=%d, fast_cache=%.2fs", remux_ext.c_str(), nb_viewers, fast_cache);
+    
+    // stop remux when no viewers, the chunks are cleared for the encoder is reset.
+    while (nb_viewers > 0 || fast_cache > 0) {
+        pprint->elapse();
+        
+#ifdef SRS_PERF_QUEUE_COND_WAIT
+        // wait for messages, to remux some messages in a time.
+        consumer->wait(SRS_PERF_MW_MIN_MSGS, mw_sleep);
+#endif
+        
+        // get messages from consumer.
+        // each msg in msgs.msgs must be free, @see SrsMessageArray.free().
+        int count = 0;
+        if ((ret = consumer->dump_packets(&msgs, count)) != ERROR_SUCCESS) {
+            srs_error("http: get messages from consumer failed. ret=%d", ret);
+            break;
+        }
+        
+        if (count <= 0) {
+#ifndef SRS_PERF_QUEUE_COND_WAIT
+            st_usleep(mw_sleep * 1000);
+#endif
+            // ignore when nothing got.
+            continue;
+        }
+        
+        if (pprint->can_print()) {
+            srs_trace("-> "SRS_CONSTS_LOG_HTTP_STREAM_CACHE" http: remux %d msgs, chunks=%d, viewers=%d, age=%d",
+                count, (int)chunks.size(), nb_viewers, pprint->age());
+        }
+        
+        ret = remux_messages(enc, &writer, msgs.msgs, count);
+        
+        // free the messages.
+        msgs.free(count);
+        
+        if (ret != ERROR_SUCCESS) {
+            srs_error("http: remux messages failed. ret=%d", ret);
+            break;
+        }
+        
+        // notify the viewers to send the chunks.
+        st_cond_broadcast(chunks_wait);
     }
     
+    srs_trace("http: stop remux %s, viewers=%d", remux_ext.c_str(), nb_viewers);
+    clear_chunks();
+    
     return ret;
 }
 
+int SrsBufferCache::remux_messages(ISrsBufferEncoder* enc, SrsBufferChunkWriter* writer, SrsSharedPtrMessage** msgs, int nb_msgs)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsTsStreamEncoder* ts = dynamic_cast<SrsTsStreamEncoder*>(enc);
+    
+    for (int i = 0; i < nb_msgs; i++) {
+        SrsSharedPtrMessage* msg = msgs[i];
+        
+        // for ts, the viewer joins at the PAT/PMT and IDR,
+        // or the PAT/PMT and audio for stream without video.
+        bool join = false;
+        if (ts) {
+            if (msg->is_video()) {
+                remux_video = true;
+                join = SrsFlvCodec::video_is_keyframe(msg->payload, msg->size)
+                    && !SrsFlvCodec::video_is_sequence_header(msg->payload, msg->size);
+            } else if (msg->is_audio() && !remux_video) {
+                join = joins.empty()
+                    || msg->timestamp - chunks[joins.back() - chunks_front]->timestamp >= SRS_PERF_HTTP_REMUX_PURE_AUDIO_JOIN_MS;
+            }
+            if (join) {
+                ts->refresh_pat_pmt();
+            }
+        }
+        
+        if (msg->is_audio()) {
+            ret = enc->write_audio(msg->timestamp, msg->payload, msg->size);
+        } else if (msg->is_video()) {
+            ret = enc->write_video(msg->timestamp, msg->payload, msg->size);
+        } else {
+            ret = enc->write_metadata(msg->timestamp, msg->payload, msg->size);
+        }
+        
+        if (ret != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        SrsSharedPtrMessage* chunk = writer->chunk(msg);
+        if (!chunk) {
+            continue;
+        }
+        
+        if (join) {
+            joins.push_back(chunks_front + (int64_t)chunks.size());
+        }
+        chunks.push_back(chunk);
+    }
+    
+    // shrink the cache, but always keep the last join point.
+    int64_t cache_ms = srs_max((int64_t)SRS_PERF_HTTP_REMUX_CACHE_MS, (int64_t)(fast_cache * 1000));
+    while (chunks.size() > 1) {
+        SrsSharedPtrMessage* chunk = chunks.front();
+        if (chunks.back()->timestamp - chunk->timestamp <= cache_ms) {
+            break;
+        }
+        if (!joins.empty() && chunks_front >= joins.back()) {
+            break;
+        }
+        
+        srs_freep(chunk);
+        chunks.pop_front();
+        chunks_front++;
+    }
+    while (!joins.empty() && joins.front() < chunks_front) {
+        joins.pop_front();
+    }
+    
+    return ret;
+}
+
+void SrsBufferCache::clear_chunks()
+{
+    std::deque<SrsSharedPtrMessage*>::iterator it;
+    for (it = chunks.begin(); it != chunks.end(); ++it) {
+        SrsSharedPtrMessage* chunk = *it;
+        srs_freep(chunk);
+    }
+    
+    chunks_front += (int64_t)chunks.size();
+    chunks.clear();
+    joins.clear();
+    remux_header = "";
+}
+
 ISrsBufferEncoder::ISrsBufferEncoder()
 {
 }
@@ -234,6 +507,11 @@ int SrsTsStreamEncoder::dump_cache(SrsConsumer* /*consumer*/, SrsRtmpJitterAlgor
     return ERROR_SUCCESS;
 }
 
+void SrsTsStreamEncoder::refresh_pat_pmt()
+{
+    enc->refresh_pat_pmt();
+}
+
 SrsFlvStreamEncoder::SrsFlvStreamEncoder()
 {
     enc = new SrsFlvEncoder();
@@ -410,6 +688,93 @@ int SrsMp3StreamEncoder::dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorith
     return cache->dump_cache(consumer, jitter);
 }
 
+SrsBufferChunkWriter::SrsBufferChunkWriter()
+{
+    buffer = new SrsSimpleStream();
+}
+
+SrsBufferChunkWriter::~SrsBufferChunkWriter()
+{
+    srs_freep(buffer);
+}
+
+int SrsBufferChunkWriter::open(std::string /*file*/)
+{
+    return ERROR_SUCCESS;
+}
+
+void SrsBufferChunkWriter::close()
+{
+}
+
+bool SrsBufferChunkWriter::is_open()
+{
+    return true;
+}
+
+int64_t SrsBufferChunkWriter::tellg()
+{
+    return 0;
+}
+
+int SrsBufferChunkWriter::write(void* buf, size_t count, ssize_t* pnwrite)
+{
+    if (count > 0) {
+        buffer->append((const char*)buf, (int)count);
+    }
+    
+    if (pnwrite) {
+        *pnwrite = count;
+    }
+    return ERROR_SUCCESS;
+}
+
+int SrsBufferChunkWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
+{
+    return write_iovs(iov, iovcnt, pnwrite);
+}
+
+SrsSharedPtrMessage* SrsBufferChunkWriter::chunk(SrsSharedPtrMessage* msg)
+{
+    int size = buffer->length();
+    if (size <= 0) {
+        return NULL;
+    }
+    
+    char* payload = new char[size];
+    memcpy(payload, buffer->bytes(), size);
+    buffer->erase(size);
+    
+    SrsMessageHeader header;
+    if (msg->is_audio()) {
+        header.initialize_audio(size, (u_int32_t)msg->timestamp, msg->stream_id);
+    } else if (msg->is_video()) {
+        header.initialize_video(size, (u_int32_t)msg->timestamp, msg->stream_id);
+    } else {
+        header.initialize_amf0_script(size, msg->stream_id);
+    }
+    
+    SrsSharedPtrMessage* chunk = new SrsSharedPtrMessage();
+    if (chunk->create(&header, payload, size) != ERROR_SUCCESS) {
+        srs_freep(chunk);
+        srs_freepa(payload);
+        return NULL;
+    }
+    chunk->timestamp = msg->timestamp;
+    
+    return chunk;
+}
+
+string SrsBufferChunkWriter::flush()
+{
+    string data;
+    if (buffer->length() > 0) {
+        data.append(buffer->bytes(), buffer->length());
+        buffer->erase(buffer->length());
+    }
+    return data;
+}
+
 SrsBufferWriter::SrsBufferWriter(ISrsHttpResponseWriter* w)
 {
     writer = w;
@@ -504,6 +869,27 @@ int SrsLiveStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     }
     SrsAutoFree(ISrsBufferEncoder, enc);
     
+    // update the statistic when source disconveried.
+    SrsStatistic* stat = SrsStatistic::instance();
+    if ((ret = stat->on_client(_srs_context->get_id(), req, NULL, SrsRtmpConnPlay)) != ERROR_SUCCESS) {
+        srs_error("stat client failed. ret=%d", ret);
+        return ret;
+    }
+    
+#ifdef SRS_PERF_HTTP_SHARED_REMUX
+    // the ts/aac/mp3 stream is remuxed once by cache, send the chunks.
+    if (cache->is_remux()) {
+        cache->on_viewer_start();
+        ret = streaming_send_chunks(w);
+        cache->on_viewer_stop();
+        
+        if (ret != ERROR_SUCCESS && !srs_is_client_gracefully_close(ret)) {
+            srs_error("http: send chunks to client failed. ret=%d", ret);
+        }
+        return ret;
+    }
+#endif
+    
     // create consumer of souce, ignore gop cache, use the audio gop cache.
     SrsConsumer* consumer = NULL;
     if ((ret = source->create_consumer(NULL, consumer, true, true, !enc->has_cache())) != ERROR_SUCCESS) {
@@ -517,13 +903,6 @@ int SrsLiveStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     SrsAutoFree(SrsPithyPrint, pprint);
     
     SrsMessageArray msgs(SRS_PERF_MW_MSGS);
-
-    // update the statistic when source disconveried.
-    SrsStatistic* stat = SrsStatistic::instance();
-    if ((ret = stat->on_client(_srs_context->get_id(), req, NULL, SrsRtmpConnPlay)) != ERROR_SUCCESS) {
-        srs_error("stat client failed. ret=%d", ret);
-        return ret;
-    }
     
     // the memory writer.
     SrsBufferWriter writer(w);
@@ -549,7 +928,7 @@ int SrsLiveStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         pprint->elapse();
 
         // get messages from consumer.
-        // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
+        // each msg in msgs.msgs must be free, @see SrsMessageArray.free().
         int count = 0;
         if ((ret = consumer->dump_packets(&msgs, count)) != ERROR_SUCCESS) {
             srs_error("http: get messages from consumer failed. ret=%d", ret);
@@ -582,10 +961,7 @@ int SrsLiveStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 #endif
     
         // free the messages.
-        for (int i = 0; i < count; i++) {
-            SrsSharedPtrMessage* msg = msgs.msgs[i];
-            srs_freep(msg);
-        }
+        msgs.free(count);
         
         // check send error code.
         if (ret != ERROR_SUCCESS) {
@@ -622,6 +998,77 @@ int SrsLiveStream::streaming_send_messages(ISrsBufferEncoder* enc, SrsSharedPtrM
     return ret;
 }
 
+int SrsLiveStream::streaming_send_chunks(ISrsHttpResponseWriter* w)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsPithyPrint* pprint = SrsPithyPrint::create_http_stream();
+    SrsAutoFree(SrsPithyPrint, pprint);
+    
+    SrsMessageArray msgs(SRS_PERF_MW_MSGS);
+    
+    // the iovs of header and chunks.
+    iovec* iovs = new iovec[SRS_PERF_MW_MSGS + 1];
+    SrsAutoFreeA(iovec, iovs);
+    
+    // the sequence of next chunk, -1 to join the stream.
+    int64_t cursor = -1;
+    bool header_sent = false;
+    
+    // TODO: FIXME: free and erase the disabled entry after all related connections is closed.
+    while (entry->enabled) {
+        pprint->elapse();
+        
+        // each msg in msgs.msgs must be free, @see SrsMessageArray.free().
+        int count = 0;
+        if ((ret = cache->dump_chunks(&cursor, &msgs, count)) != ERROR_SUCCESS) {
+            srs_error("http: get chunks from cache failed. ret=%d", ret);
+            return ret;
+        }
+        
+        if (count <= 0) {
+            // the remux will notify when chunks remuxed.
+            cache->wait_chunks(SRS_CONSTS_RTMP_PULSE_TIMEOUT_US);
+            continue;
+        }
+        
+        if (pprint->can_print()) {
+            srs_info("-> "SRS_CONSTS_LOG_HTTP_STREAM" http: got %d chunks, age=%d", count, pprint->age());
+        }
+        
+        // send the header before the first chunk.
+        int nb_iovs = 0;
+        std::string header;
+        if (!header_sent) {
+            header_sent = true;
+            header = cache->header();
+            if (!header.empty()) {
+                iovs[nb_iovs].iov_base = (char*)header.data();
+                iovs[nb_iovs].iov_len = header.length();
+                nb_iovs++;
+            }
+        }
+        
+        for (int i = 0; i < count; i++) {
+            SrsSharedPtrMessage* chunk = msgs.msgs[i];
+            iovs[nb_iovs].iov_base = chunk->payload;
+            iovs[nb_iovs].iov_len = chunk->size;
+            nb_iovs++;
+        }
+        
+        ret = w->writev(iovs, nb_iovs, NULL);
+        
+        // free the chunks.
+        msgs.free(count);
+        
+        if (ret != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
 SrsLiveEntry::SrsLiveEntry(std::string m, bool h)
 {
     mount = m;
@@ -665,66 +1112,59 @@ bool SrsLiveEntry::is_mp3()
     return _is_mp3;
 }
 
-SrsHlsM3u8Stream::SrsHlsM3u8Stream()
+SrsHlsRamStream::SrsHlsRamStream()
 {
 }
 
-SrsHlsM3u8Stream::~SrsHlsM3u8Stream()
+SrsHlsRamStream::~SrsHlsRamStream()
 {
 }
 
-void SrsHlsM3u8Stream::set_m3u8(std::string v)
+bool SrsHlsRamStream::can_serve(ISrsHttpMessage* r)
 {
-    m3u8 = v;
+#ifdef SRS_AUTO_HLS
+    std::string ext = r->ext();
+    if (ext != ".m3u8" && ext != ".ts") {
+        return false;
+    }
+    
+    return SrsHlsRamStore::instance()->exists(r->path());
+#else
+    return false;
+#endif
 }
 
-int SrsHlsM3u8Stream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
+int SrsHlsRamStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     int ret = ERROR_SUCCESS;
     
-    std::string data = m3u8;
+#ifdef SRS_AUTO_HLS
+    SrsHlsRamFile* file = SrsHlsRamStore::instance()->fetch(r->path());
+    if (!file) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_NotFound);
+    }
+    SrsAutoFree(SrsHlsRamFile, file);
     
-    w->header()->set_content_length((int)data.length());
-    w->header()->set_content_type("application/x-mpegURL;charset=utf-8");
-
-    if ((ret = w->write((char*)data.data(), (int)data.length())) != ERROR_SUCCESS) {
-        if (!srs_is_client_gracefully_close(ret)) {
-            srs_error("send m3u8 failed. ret=%d", ret);
-        }
-        return ret;
+    w->header()->set_content_length(file->size());
+    if (r->ext() == ".m3u8") {
+        w->header()->set_content_type("application/x-mpegURL;charset=utf-8");
+    } else {
+        w->header()->set_content_type("video/MP2T");
     }
-
-    return ret;
-}
-
-SrsHlsTsStream::SrsHlsTsStream()
-{
-}
-
-SrsHlsTsStream::~SrsHlsTsStream()
-{
-}
-
-void SrsHlsTsStream::set_ts(std::string v)
-{
-    ts = v;
-}
-
-int SrsHlsTsStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
-{
-    int ret = ERROR_SUCCESS;
     
-    std::string data = ts;
+    // send the shared chunks, the file is never freed before sent.
+    int nb_iovs = file->nb_chunks();
+    iovec* iovs = new iovec[srs_max(1, nb_iovs)];
+    SrsAutoFreeA(iovec, iovs);
     
-    w->header()->set_content_length((int)data.length());
-    w->header()->set_content_type("video/MP2T");
-
-    if ((ret = w->write((char*)data.data(), (int)data.length())) != ERROR_SUCCESS) {
+    nb_iovs = file->chunks_to_iovs(iovs);
+    if ((ret = w->writev(iovs, nb_iovs, NULL)) != ERROR_SUCCESS) {
         if (!srs_is_client_gracefully_close(ret)) {
-            srs_error("send ts failed. ret=%d", ret);
+            srs_error("send hls %s failed. ret=%d", r->path().c_str(), ret);
         }
         return ret;
     }
+#endif
 
     return ret;
 }
@@ -810,6 +1250,13 @@ int SrsHttpStreamServer::http_mount(SrsSource* s, SrsRequest* r)
     
         entry->cache = new SrsBufferCache(s, r);
         entry->stream = new SrsLiveStream(s, r, entry->cache);
+        
+#ifdef SRS_PERF_HTTP_SHARED_REMUX
+        // remux the ts/aac/mp3 once for all viewers.
+        if (entry->is_ts() || entry->is_aac() || entry->is_mp3()) {
+            entry->cache->set_remux(srs_path_filext(mount));
+        }
+#endif
 
         // TODO: FIXME: maybe refine the logic of http remux service.
         // if user push streams followed:
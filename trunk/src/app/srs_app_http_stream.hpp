@@ -32,12 +32,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_app_http_conn.hpp>
 
+#include <deque>
+
 #ifdef SRS_AUTO_HTTP_SERVER
 
+class ISrsBufferEncoder;
+class SrsBufferChunkWriter;
+class SrsSimpleStream;
+class SrsMessageArray;
+
 /**
 * for the srs http stream cache, 
 * for example, the audio stream cache to make android(weixin) happy.
 * we start a thread to shrink the queue.
+* for the ts/aac/mp3 stream, the thread remux the stream once for all viewers,
+* and cache the remuxed chunks for viewers to send.
 */
 class SrsBufferCache : public ISrsEndlessThreadHandler
 {
@@ -48,6 +57,22 @@ private:
     SrsSource* source;
     SrsRequest* req;
     SrsEndlessThread* pthread;
+private:
+    // the extension of remux, empty to not remux, for example, flv stream.
+    std::string remux_ext;
+    // the remuxed chunks, the sequence of front chunk is chunks_front.
+    std::deque<SrsSharedPtrMessage*> chunks;
+    int64_t chunks_front;
+    // the sequence of chunks viewer can join at, the PAT/PMT and IDR for ts.
+    std::deque<int64_t> joins;
+    // the header to send before chunks, for example, the ID3 of mp3.
+    std::string remux_header;
+    // the number of viewers which send the remuxed chunks.
+    int nb_viewers;
+    // whether the remuxed stream has video, for ts.
+    bool remux_video;
+    // notify the viewers when new chunks remuxed.
+    st_cond_t chunks_wait;
 public:
     SrsBufferCache(SrsSource* s, SrsRequest* r);
     virtual ~SrsBufferCache();
@@ -55,9 +80,46 @@ public:
 public:
     virtual int start();
     virtual int dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorithm jitter);
+public:
+    /**
+     * remux the stream once for all viewers, for the ts/aac/mp3 stream.
+     * @param ext the extension of stream, for example, .ts
+     */
+    virtual void set_remux(std::string ext);
+    virtual bool is_remux();
+    /**
+     * when viewer start or stop to send the remuxed chunks,
+     * the remux only works when there are viewers or fast cache.
+     */
+    virtual void on_viewer_start();
+    virtual void on_viewer_stop();
+    /**
+     * dump the remuxed chunks from the cursor of viewer.
+     * @param pcursor the sequence of next chunk to send, -1 to join the stream,
+     *       which is updated to the sequence of next chunk.
+     * @param msgs the chunks to send, user must free them by SrsMessageArray::free().
+     * @param count the number of chunks dumped.
+     * @remark the viewer which falls behind the cache joins the stream again.
+     */
+    virtual int dump_chunks(int64_t* pcursor, SrsMessageArray* msgs, int& count);
+    /**
+     * wait for new chunks, or timeout.
+     */
+    virtual void wait_chunks(int64_t timeout_us);
+    /**
+     * the header to send before any chunk.
+     */
+    virtual std::string header();
+    /**
+     * remux the messages by encoder, and cache the written bytes as chunks.
+     */
+    virtual int remux_messages(ISrsBufferEncoder* enc, SrsBufferChunkWriter* writer, SrsSharedPtrMessage** msgs, int nb_msgs);
 // interface ISrsEndlessThreadHandler.
 public:
     virtual int cycle();
+private:
+    virtual int remux_cycle();
+    virtual void clear_chunks();
 };
 
 /**
@@ -150,6 +212,11 @@ public:
 public:
     virtual bool has_cache();
     virtual int dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorithm jitter);
+public:
+    /**
+     * write the PAT/PMT before next frame, so viewer can join from it.
+     */
+    virtual void refresh_pat_pmt();
 };
 
 /**
@@ -194,6 +261,37 @@ public:
     virtual int dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorithm jitter);
 };
 
+/**
+* write stream to memory, to remux the stream to chunks.
+*/
+class SrsBufferChunkWriter : public SrsFileWriter
+{
+private:
+    SrsSimpleStream* buffer;
+public:
+    SrsBufferChunkWriter();
+    virtual ~SrsBufferChunkWriter();
+public:
+    virtual int open(std::string file);
+    virtual void close();
+public:
+    virtual bool is_open();
+    virtual int64_t tellg();
+public:
+    virtual int write(void* buf, size_t count, ssize_t* pnwrite);
+    virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+public:
+    /**
+     * create a chunk of the written bytes, and reset the buffer.
+     * @return NULL if nothing written, user must free it.
+     */
+    virtual SrsSharedPtrMessage* chunk(SrsSharedPtrMessage* msg);
+    /**
+     * get the written bytes as string, and reset the buffer.
+     */
+    virtual std::string flush();
+};
+
 /**
 * write stream to http response direclty.
 */
@@ -233,6 +331,10 @@ public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
 private:
     virtual int streaming_send_messages(ISrsBufferEncoder* enc, SrsSharedPtrMessage** msgs, int nb_msgs);
+    /**
+     * send the chunks remuxed by cache, for the ts/aac/mp3 stream.
+     */
+    virtual int streaming_send_chunks(ISrsHttpResponseWriter* w);
 };
 
 /**
@@ -268,33 +370,19 @@ public:
 };
 
 /**
-* the m3u8 stream handler.
-*/
-class SrsHlsM3u8Stream : public ISrsHttpHandler
-{
-private:
-    std::string m3u8;
-public:
-    SrsHlsM3u8Stream();
-    virtual ~SrsHlsM3u8Stream();
-public:
-    virtual void set_m3u8(std::string v);
-public:
-    virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
-};
-
-/**
-* the ts stream handler.
+* the hls handler, serve the m3u8 and ts in ram store of hls,
+* the files are sent by writev from the shared chunks, never copied.
 */
-class SrsHlsTsStream : public ISrsHttpHandler
+class SrsHlsRamStream : public ISrsHttpHandler
 {
-private:
-    std::string ts;
 public:
-    SrsHlsTsStream();
-    virtual ~SrsHlsTsStream();
+    SrsHlsRamStream();
+    virtual ~SrsHlsRamStream();
 public:
-    virtual void set_ts(std::string v);
+    /**
+    * whether the request file is in ram store.
+    */
+    virtual bool can_serve(ISrsHttpMessage* r);
 public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
 };
@@ -334,6 +422,8 @@ public:
     std::map<std::string, SrsLiveEntry*> tflvs;
     // the http live streaming streams, crote by template.
     std::map<std::string, SrsLiveEntry*> sflvs;
+    // the hls in ram, never on disk.
+    SrsHlsRamStream hls;
 public:
     SrsHttpStreamServer(SrsServer* svr);
     virtual ~SrsHttpStreamServer();
@@ -586,6 +586,7 @@ int SrsKafkaProducer::request_metadata()
     
     // reconnect to kafka server.
     if ((ret = transport->connect(server, port, SRS_CONSTS_KAFKA_TIMEOUT_US)) != ERROR_SUCCESS) {
+        lb->on_failure();
         srs_error("kafka connect %s:%d failed. ret=%d", server.c_str(), port, ret);
         return ret;
     }
@@ -593,10 +594,12 @@ int SrsKafkaProducer::request_metadata()
     // do fetch medata from broker.
     SrsKafkaTopicMetadataResponse* metadata = NULL;
     if ((ret = kafka->fetch_metadata(topic, &metadata)) != ERROR_SUCCESS) {
+        lb->on_failure();
         srs_error("kafka fetch metadata failed. ret=%d", ret);
         return ret;
     }
     SrsAutoFree(SrsKafkaTopicMetadataResponse, metadata);
+    lb->on_success();
     
     // we may need to request multiple times.
     // for example, the first time to create a none-exists topic, then query metadata.
@@ -32,7 +32,7 @@
 #include <map>
 #include <vector>
 
-class SrsLbRoundRobin;
+class SrsLoadBalancer;
 class SrsAsyncCallWorker;
 class SrsTcpClient;
 class SrsKafkaClient;
@@ -172,7 +172,7 @@ public:
     std::vector<SrsKafkaPartition*> partitions;
     SrsKafkaCache* cache;
 private:
-    SrsLbRoundRobin* lb;
+    SrsLoadBalancer* lb;
     SrsAsyncCallWorker* worker;
 public:
     SrsKafkaProducer();
@@ -30,6 +30,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/uio.h>
 using namespace std;
 
 #include <srs_kernel_log.hpp>
@@ -40,6 +44,13 @@ using namespace std;
 // set the max packet size.
 #define SRS_UDP_MAX_PACKET_SIZE 65535
 
+// the max number of packets to recv in a time.
+#ifdef SRS_PERF_UDP_RECVMMSG
+    #define SRS_UDP_RECV_BATCH SRS_PERF_UDP_RECV_BATCH
+#else
+    #define SRS_UDP_RECV_BATCH 1
+#endif
+
 // sleep in ms for udp recv packet.
 #define SRS_UDP_PACKET_RECV_CYCLE_INTERVAL_MS 0
 
@@ -59,6 +70,20 @@ int ISrsUdpHandler::on_stfd_change(st_netfd_t /*fd*/)
     return ERROR_SUCCESS;
 }
 
+int ISrsUdpHandler::on_udp_packets(SrsUdpPacket* pkts, int nb_pkts)
+{
+    int ret = ERROR_SUCCESS;
+    
+    for (int i = 0; i < nb_pkts; i++) {
+        SrsUdpPacket* pkt = pkts + i;
+        if ((ret = on_udp_packet(pkt->from, pkt->buf, pkt->nb_buf)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
 ISrsTcpHandler::ISrsTcpHandler()
 {
 }
@@ -76,8 +101,32 @@ SrsUdpListener::SrsUdpListener(ISrsUdpHandler* h, string i, int p)
     _fd = -1;
     _stfd = NULL;
 
+    // the buffer of each packet is SRS_UDP_MAX_PACKET_SIZE, while the pages
+    // never touched by small packets are not resident in memory.
     nb_buf = SRS_UDP_MAX_PACKET_SIZE;
-    buf = new char[nb_buf];
+    buf = new char[nb_buf * SRS_UDP_RECV_BATCH];
+    froms = new sockaddr_in[SRS_UDP_RECV_BATCH];
+    pkts = new SrsUdpPacket[SRS_UDP_RECV_BATCH];
+    
+    for (int i = 0; i < SRS_UDP_RECV_BATCH; i++) {
+        pkts[i].from = froms + i;
+        pkts[i].buf = buf + i * nb_buf;
+        pkts[i].nb_buf = 0;
+    }
+    
+#ifdef SRS_PERF_UDP_RECVMMSG
+    msgs = new mmsghdr[SRS_UDP_RECV_BATCH];
+    iovs = new iovec[SRS_UDP_RECV_BATCH];
+    memset(msgs, 0, sizeof(mmsghdr) * SRS_UDP_RECV_BATCH);
+    
+    for (int i = 0; i < SRS_UDP_RECV_BATCH; i++) {
+        iovs[i].iov_base = pkts[i].buf;
+        iovs[i].iov_len = nb_buf;
+        msgs[i].msg_hdr.msg_iov = iovs + i;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = froms + i;
+    }
+#endif
 
     pthread = new SrsReusableThread("udp", this);
 }
@@ -95,6 +144,12 @@ SrsUdpListener::~SrsUdpListener()
     close(_fd);
 
     srs_freepa(buf);
+    srs_freepa(froms);
+    srs_freepa(pkts);
+#ifdef SRS_PERF_UDP_RECVMMSG
+    srs_freepa(msgs);
+    srs_freepa(iovs);
+#endif
 }
 
 int SrsUdpListener::fd()
@@ -157,17 +212,13 @@ int SrsUdpListener::cycle()
 {
     int ret = ERROR_SUCCESS;
 
-    // TODO: FIXME: support ipv6, @see man 7 ipv6
-    sockaddr_in from;
-    int nb_from = sizeof(sockaddr_in);
-    int nread = 0;
-
-    if ((nread = st_recvfrom(_stfd, buf, nb_buf, (sockaddr*)&from, &nb_from, ST_UTIME_NO_TIMEOUT)) <= 0) {
-        srs_warn("ignore recv udp packet failed, nread=%d", nread);
+    int nb_pkts = 0;
+    if ((nb_pkts = recv_packets()) <= 0) {
+        srs_warn("ignore recv udp packet failed, nread=%d", nb_pkts);
         return ret;
     }
     
-    if ((ret = handler->on_udp_packet(&from, buf, nread)) != ERROR_SUCCESS) {
+    if ((ret = handler->on_udp_packets(pkts, nb_pkts)) != ERROR_SUCCESS) {
         srs_warn("handle udp packet failed. ret=%d", ret);
         return ret;
     }
@@ -179,11 +230,56 @@ int SrsUdpListener::cycle()
     return ret;
 }
 
-SrsTcpListener::SrsTcpListener(ISrsTcpHandler* h, string i, int p)
+int SrsUdpListener::recv_packets()
+{
+#ifdef SRS_PERF_UDP_RECVMMSG
+    for (;;) {
+        for (int i = 0; i < SRS_UDP_RECV_BATCH; i++) {
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[i].msg_hdr.msg_flags = 0;
+        }
+        
+        // the fd is nonblocking by st, recv all packets in the socket buffer.
+        int nb_msgs = ::recvmmsg(_fd, msgs, SRS_UDP_RECV_BATCH, MSG_DONTWAIT, NULL);
+        if (nb_msgs > 0) {
+            for (int i = 0; i < nb_msgs; i++) {
+                pkts[i].nb_buf = (int)msgs[i].msg_len;
+            }
+            return nb_msgs;
+        }
+        
+        if (nb_msgs < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nb_msgs < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            return -1;
+        }
+        
+        // wait for the socket to be readable.
+        if (st_netfd_poll(_stfd, POLLIN, ST_UTIME_NO_TIMEOUT) != 0) {
+            return -1;
+        }
+    }
+#else
+    // TODO: FIXME: support ipv6, @see man 7 ipv6
+    int nb_from = sizeof(sockaddr_in);
+    int nread = 0;
+    
+    if ((nread = st_recvfrom(_stfd, pkts[0].buf, nb_buf, (sockaddr*)pkts[0].from, &nb_from, ST_UTIME_NO_TIMEOUT)) <= 0) {
+        return nread;
+    }
+    pkts[0].nb_buf = nread;
+    
+    return 1;
+#endif
+}
+
+SrsTcpListener::SrsTcpListener(ISrsTcpHandler* h, string i, int p, bool rp)
 {
     handler = h;
     ip = i;
     port = p;
+    reuse_port = rp;
 
     _fd = -1;
     _stfd = NULL;
@@ -223,6 +319,20 @@ int SrsTcpListener::listen()
     }
     srs_verbose("setsockopt reuse-addr success. port=%d, fd=%d", port, _fd);
     
+    // the workers accept on the same port, and kernel balance the clients.
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        if (setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &reuse_socket, sizeof(int)) == -1) {
+            ret = ERROR_SOCKET_SETREUSE;
+            srs_error("setsockopt reuse-port error. port=%d, ret=%d", port, ret);
+            return ret;
+        }
+        srs_verbose("setsockopt reuse-port success. port=%d, fd=%d", port, _fd);
+#else
+        srs_warn("SO_REUSEPORT not supported, port=%d", port);
+#endif
+    }
+    
     sockaddr_in addr;
     addr.sin_family = AF_INET;
     addr.sin_port = htons(port);
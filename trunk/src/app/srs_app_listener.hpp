@@ -36,6 +36,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_app_thread.hpp>
 
 struct sockaddr_in;
+struct mmsghdr;
+struct iovec;
+
+/**
+* the udp packet received by listener,
+* the from and buf are shared memory, user should copy if need to use.
+*/
+struct SrsUdpPacket
+{
+    // the udp packet from address.
+    sockaddr_in* from;
+    // the udp packet bytes.
+    char* buf;
+    int nb_buf;
+};
 
 /**
 * the udp packet handler.
@@ -62,6 +77,11 @@ public:
     * @remark user should never use the buf, for it's a shared memory bytes.
     */
     virtual int on_udp_packet(sockaddr_in* from, char* buf, int nb_buf) = 0;
+    /**
+    * when udp listener got a batch of udp packets, in the order received.
+    * @remark the default implements handle the packet one by one.
+    */
+    virtual int on_udp_packets(SrsUdpPacket* pkts, int nb_pkts);
 };
 
 /**
@@ -89,8 +109,15 @@ private:
     st_netfd_t _stfd;
     SrsReusableThread* pthread;
 private:
+    // the pre-allocated buffers and address for each packet of batch.
     char* buf;
     int nb_buf;
+    sockaddr_in* froms;
+    SrsUdpPacket* pkts;
+#ifdef SRS_PERF_UDP_RECVMMSG
+    mmsghdr* msgs;
+    iovec* iovs;
+#endif
 private:
     ISrsUdpHandler* handler;
     std::string ip;
@@ -106,6 +133,12 @@ public:
 // interface ISrsReusableThreadHandler.
 public:
     virtual int cycle();
+private:
+    /**
+     * recv a batch of packets, wait util got at least one packet.
+     * @return the number of packets, or -1 when failed.
+     */
+    virtual int recv_packets();
 };
 
 /**
@@ -121,8 +154,10 @@ private:
     ISrsTcpHandler* handler;
     std::string ip;
     int port;
+    // whether share the port with other processes, by SO_REUSEPORT.
+    bool reuse_port;
 public:
-    SrsTcpListener(ISrsTcpHandler* h, std::string i, int p);
+    SrsTcpListener(ISrsTcpHandler* h, std::string i, int p, bool rp = false);
     virtual ~SrsTcpListener();
 public:
     virtual int fd();
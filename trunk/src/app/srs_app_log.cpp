@@ -24,7 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_app_log.hpp>
 
 #include <stdarg.h>
+#include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -34,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_kernel_error.hpp>
 #include <srs_app_utility.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_core_performance.hpp>
 
 SrsThreadContext::SrsThreadContext()
 {
@@ -88,24 +91,279 @@ void SrsThreadContext::clear_cid()
 // reserved for the end of log data, it must be strlen(LOG_TAIL)
 #define LOG_TAIL_SIZE 1
 
+// the interval in ms to drain the ring to file.
+#define SRS_ASYNC_LOG_INTERVAL_MS 100
+
+SrsAsyncLogWriter::SrsAsyncLogWriter(int size)
+{
+    ring = NULL;
+    nb_ring = size;
+    head = tail = 0;
+    started = false;
+    quit = false;
+    fd = -1;
+    nb_lines = nb_bytes = nb_drops = 0;
+    
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+SrsAsyncLogWriter::~SrsAsyncLogWriter()
+{
+    stop();
+    
+    if (fd > 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    srs_freepa(ring);
+    
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&lock);
+}
+
+bool SrsAsyncLogWriter::is_open()
+{
+    // the fd is only changed by st, so it's safe to read without lock.
+    return fd > 0;
+}
+
+void SrsAsyncLogWriter::reopen(std::string path)
+{
+    int nfd = -1;
+    
+    if (!path.empty()) {
+        nfd = ::open(path.c_str(), O_RDWR | O_APPEND);
+        
+        if(nfd == -1 && errno == ENOENT) {
+            nfd = ::open(path.c_str(),
+                O_RDWR | O_CREAT | O_TRUNC,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH
+            );
+        }
+    }
+    
+    // swap the fd, the old fd maybe writing by pthread, which closes it.
+    pthread_mutex_lock(&lock);
+    
+    int ofd = fd;
+    fd = nfd;
+    
+    if (ofd > 0 && started) {
+        closing.push_back(ofd);
+        ofd = -1;
+        pthread_cond_signal(&cond);
+    }
+    
+    pthread_mutex_unlock(&lock);
+    
+    if (ofd > 0) {
+        ::close(ofd);
+    }
+}
+
+bool SrsAsyncLogWriter::write(char* buf, int size)
+{
+    // write in st thread when ring disabled or pthread failed.
+    if (nb_ring <= 0 || (!started && start() != ERROR_SUCCESS)) {
+        if (fd > 0) {
+            ::write(fd, buf, size);
+        }
+        return true;
+    }
+    
+    // drop the log when ring is full, never block st.
+    int64_t used = head - __sync_add_and_fetch(&tail, 0);
+    if (used + size > nb_ring) {
+        nb_drops++;
+        pthread_cond_signal(&cond);
+        return false;
+    }
+    
+    // copy to ring, maybe in two parts when wrap.
+    int pos = (int)(head % nb_ring);
+    int nb_first = srs_min(size, nb_ring - pos);
+    memcpy(ring + pos, buf, nb_first);
+    if (nb_first < size) {
+        memcpy(ring, buf + nb_first, size - nb_first);
+    }
+    
+    // publish the bytes to pthread, with the full barrier.
+    __sync_add_and_fetch(&head, size);
+    
+    nb_lines++;
+    nb_bytes += size;
+    
+    // wakeup the pthread when ring is half full, or it drains by interval.
+    if (used + size > nb_ring / 2) {
+        pthread_cond_signal(&cond);
+    }
+    
+    return true;
+}
+
+void SrsAsyncLogWriter::stop()
+{
+    if (started) {
+        pthread_mutex_lock(&lock);
+        quit = true;
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&lock);
+        
+        pthread_join(tid, NULL);
+        started = false;
+        quit = false;
+    }
+    
+    // the pthread is stopped, drain in st.
+    drain(fd);
+    close_fds(closing);
+}
+
+void SrsAsyncLogWriter::before_fork()
+{
+    pthread_mutex_lock(&lock);
+}
+
+void SrsAsyncLogWriter::after_fork_parent()
+{
+    pthread_mutex_unlock(&lock);
+}
+
+void SrsAsyncLogWriter::after_fork_child()
+{
+    // the child has no pthread, which is started again when write log.
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+    started = false;
+    quit = false;
+    
+    // the logs in ring are drained by the parent.
+    tail = head;
+    close_fds(closing);
+}
+
+int SrsAsyncLogWriter::start()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!ring) {
+        ring = new char[nb_ring];
+    }
+    
+    if (pthread_create(&tid, NULL, SrsAsyncLogWriter::writer_pthread, this) != 0) {
+        ret = ERROR_SYSTEM_CREATE_THREAD;
+        return ret;
+    }
+    started = true;
+    
+    return ret;
+}
+
+void* SrsAsyncLogWriter::writer_pthread(void* arg)
+{
+    SrsAsyncLogWriter* writer = (SrsAsyncLogWriter*)arg;
+    writer->do_cycle();
+    return NULL;
+}
+
+void SrsAsyncLogWriter::do_cycle()
+{
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        
+        if (!quit) {
+            timeval now;
+            gettimeofday(&now, NULL);
+            
+            int64_t us = now.tv_usec + SRS_ASYNC_LOG_INTERVAL_MS * 1000;
+            timespec ts;
+            ts.tv_sec = now.tv_sec + us / 1000000;
+            ts.tv_nsec = (us % 1000000) * 1000;
+            pthread_cond_timedwait(&cond, &lock, &ts);
+        }
+        
+        bool stopping = quit;
+        int wfd = fd;
+        std::vector<int> fds;
+        fds.swap(closing);
+        
+        pthread_mutex_unlock(&lock);
+        
+        // write the disk without lock, the fds are closed after drained.
+        drain(wfd);
+        close_fds(fds);
+        
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+void SrsAsyncLogWriter::close_fds(std::vector<int>& fds)
+{
+    std::vector<int>::iterator it;
+    for (it = fds.begin(); it != fds.end(); ++it) {
+        ::close(*it);
+    }
+    fds.clear();
+}
+
+void SrsAsyncLogWriter::drain(int wfd)
+{
+    if (!ring) {
+        return;
+    }
+    
+    int64_t h = __sync_add_and_fetch(&head, 0);
+    
+    while (tail < h) {
+        int pos = (int)(tail % nb_ring);
+        int size = (int)srs_min(h - tail, (int64_t)(nb_ring - pos));
+        
+        // the log is dropped when no file or disk error.
+        char* p = ring + pos;
+        for (int left = size; wfd > 0 && left > 0;) {
+            ssize_t nwrite = ::write(wfd, p, left);
+            if (nwrite <= 0) {
+                break;
+            }
+            p += nwrite;
+            left -= (int)nwrite;
+        }
+        
+        // release the bytes to st, with the full barrier.
+        __sync_add_and_fetch(&tail, size);
+    }
+}
+
+// the logger to drain when fork or exit.
+static SrsFastLog* _srs_fast_log = NULL;
+
 SrsFastLog::SrsFastLog()
 {
     _level = SrsLogLevel::Trace;
     log_data = new char[LOG_MAX_SIZE];
 
-    fd = -1;
+    writer = new SrsAsyncLogWriter(SRS_PERF_ASYNC_LOG_RING);
+    nb_drops = 0;
     log_to_file_tank = false;
     utc = false;
+    
+    cached_time = 0;
+    cached_utc = false;
+    nb_cached_header = 0;
+    pid = getpid();
 }
 
 SrsFastLog::~SrsFastLog()
 {
     srs_freepa(log_data);
-
-    if (fd > 0) {
-        ::close(fd);
-        fd = -1;
+    
+    if (_srs_fast_log == this) {
+        _srs_fast_log = NULL;
     }
+    srs_freep(writer);
 
     if (_srs_config) {
         _srs_config->unsubscribe(this);
@@ -124,16 +382,23 @@ int SrsFastLog::initialize()
         utc = _srs_config->get_utc_time();
     }
     
+    // drain the log ring when fork, for the pthread is not in child,
+    // and when exit, for the log of server quit.
+    static bool registered = false;
+    if (!registered) {
+        pthread_atfork(SrsFastLog::before_fork, SrsFastLog::after_fork_parent, SrsFastLog::after_fork_child);
+        atexit(SrsFastLog::before_exit);
+        registered = true;
+    }
+    _srs_fast_log = this;
+    
     return ret;
 }
 
 void SrsFastLog::reopen()
 {
-    if (fd > 0) {
-        ::close(fd);
-    }
-    
     if (!log_to_file_tank) {
+        writer->reopen("");
         return;
     }
     
@@ -157,7 +422,7 @@ void SrsFastLog::verbose(const char* tag, int context_id, const char* fmt, ...)
     size += vsnprintf(log_data + size, LOG_MAX_SIZE - size, fmt, ap);
     va_end(ap);
 
-    write_log(fd, log_data, size, SrsLogLevel::Verbose);
+    write_log(log_data, size, SrsLogLevel::Verbose);
 }
 
 void SrsFastLog::info(const char* tag, int context_id, const char* fmt, ...)
@@ -177,7 +442,7 @@ void SrsFastLog::info(const char* tag, int context_id, const char* fmt, ...)
     size += vsnprintf(log_data + size, LOG_MAX_SIZE - size, fmt, ap);
     va_end(ap);
 
-    write_log(fd, log_data, size, SrsLogLevel::Info);
+    write_log(log_data, size, SrsLogLevel::Info);
 }
 
 void SrsFastLog::trace(const char* tag, int context_id, const char* fmt, ...)
@@ -197,7 +462,7 @@ void SrsFastLog::trace(const char* tag, int context_id, const char* fmt, ...)
     size += vsnprintf(log_data + size, LOG_MAX_SIZE - size, fmt, ap);
     va_end(ap);
 
-    write_log(fd, log_data, size, SrsLogLevel::Trace);
+    write_log(log_data, size, SrsLogLevel::Trace);
 }
 
 void SrsFastLog::warn(const char* tag, int context_id, const char* fmt, ...)
@@ -217,7 +482,7 @@ void SrsFastLog::warn(const char* tag, int context_id, const char* fmt, ...)
     size += vsnprintf(log_data + size, LOG_MAX_SIZE - size, fmt, ap);
     va_end(ap);
 
-    write_log(fd, log_data, size, SrsLogLevel::Warn);
+    write_log(log_data, size, SrsLogLevel::Warn);
 }
 
 void SrsFastLog::error(const char* tag, int context_id, const char* fmt, ...)
@@ -242,7 +507,7 @@ void SrsFastLog::error(const char* tag, int context_id, const char* fmt, ...)
         size += snprintf(log_data + size, LOG_MAX_SIZE - size, "(%s)", strerror(errno));
     }
 
-    write_log(fd, log_data, size, SrsLogLevel::Error);
+    write_log(log_data, size, SrsLogLevel::Error);
 }
 
 int SrsFastLog::on_reload_utc_time()
@@ -270,10 +535,7 @@ int SrsFastLog::on_reload_log_tank()
     if (!log_to_file_tank) {
         return ret;
     }
-
-    if (fd > 0) {
-        ::close(fd);
-    }
+    
     open_log_file();
     
     return ret;
@@ -303,10 +565,7 @@ int SrsFastLog::on_reload_log_file()
     if (!log_to_file_tank) {
         return ret;
     }
-
-    if (fd > 0) {
-        ::close(fd);
-    }
+    
     open_log_file();
     
     return ret;
@@ -320,44 +579,60 @@ bool SrsFastLog::generate_header(bool error, const char* tag, int context_id, co
         return false;
     }
     
-    // to calendar time
-    struct tm* tm;
-    if (utc) {
-        if ((tm = gmtime(&tv.tv_sec)) == NULL) {
-            return false;
+    // to calendar time, only once per second.
+    if (tv.tv_sec != cached_time || utc != cached_utc || nb_cached_header <= 0) {
+        struct tm tm;
+        if (utc) {
+            if (gmtime_r(&tv.tv_sec, &tm) == NULL) {
+                return false;
+            }
+        } else {
+            if (localtime_r(&tv.tv_sec, &tm) == NULL) {
+                return false;
+            }
         }
-    } else {
-        if ((tm = localtime(&tv.tv_sec)) == NULL) {
+        
+        nb_cached_header = snprintf(cached_header, sizeof(cached_header),
+            "[%d-%02d-%02d %02d:%02d:%02d",
+            1900 + tm.tm_year, 1 + tm.tm_mon, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+        if (nb_cached_header <= 0 || nb_cached_header >= (int)sizeof(cached_header)) {
+            nb_cached_header = 0;
             return false;
         }
+        
+        cached_time = tv.tv_sec;
+        cached_utc = utc;
     }
     
     // write log header
+    memcpy(log_data, cached_header, nb_cached_header);
+    char* p = log_data + nb_cached_header;
+    int left = LOG_MAX_SIZE - nb_cached_header;
     int log_header_size = -1;
     
     if (error) {
         if (tag) {
-            log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%s][%d][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, tag, getpid(), context_id, errno);
+            log_header_size = snprintf(p, left, 
+                ".%03d][%s][%s][%d][%d][%d] ", 
+                (int)(tv.tv_usec / 1000), 
+                level_name, tag, pid, context_id, errno);
         } else {
-            log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%d][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, getpid(), context_id, errno);
+            log_header_size = snprintf(p, left, 
+                ".%03d][%s][%d][%d][%d] ", 
+                (int)(tv.tv_usec / 1000), 
+                level_name, pid, context_id, errno);
         }
     } else {
         if (tag) {
-            log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%s][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, tag, getpid(), context_id);
+            log_header_size = snprintf(p, left, 
+                ".%03d][%s][%s][%d][%d] ", 
+                (int)(tv.tv_usec / 1000), 
+                level_name, tag, pid, context_id);
         } else {
-            log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, getpid(), context_id);
+            log_header_size = snprintf(p, left, 
+                ".%03d][%s][%d][%d] ", 
+                (int)(tv.tv_usec / 1000), 
+                level_name, pid, context_id);
         }
     }
 
@@ -366,12 +641,12 @@ bool SrsFastLog::generate_header(bool error, const char* tag, int context_id, co
     }
     
     // write the header size.
-    *header_size = srs_min(LOG_MAX_SIZE - 1, log_header_size);
+    *header_size = srs_min(LOG_MAX_SIZE - 1, nb_cached_header + log_header_size);
     
     return true;
 }
 
-void SrsFastLog::write_log(int& fd, char *str_log, int size, int level)
+void SrsFastLog::write_log(char *str_log, int size, int level)
 {
     // ensure the tail and EOF of string
     //      LOG_TAIL_SIZE for the TAIL char.
@@ -401,14 +676,35 @@ void SrsFastLog::write_log(int& fd, char *str_log, int size, int level)
     }
     
     // open log file. if specified
-    if (fd < 0) {
+    if (!writer->is_open()) {
         open_log_file();
     }
     
-    // write log to file.
-    if (fd > 0) {
-        ::write(fd, str_log, size);
+    // write log to ring, drained to file by pthread.
+    if (!writer->write(str_log, size)) {
+        return;
     }
+    
+    // report the dropped logs, when ring is available again.
+    if (nb_drops == writer->nb_drops) {
+        return;
+    }
+    
+    int64_t drops = writer->nb_drops - nb_drops;
+    nb_drops = writer->nb_drops;
+    
+    // the log is already in ring, so the log data is free to use.
+    int header_size = 0;
+    if (!generate_header(false, NULL, 0, "warn", &header_size)) {
+        return;
+    }
+    
+    size = header_size + snprintf(str_log + header_size, LOG_MAX_SIZE - header_size,
+        "log ring is full, drop %"PRId64" logs", drops);
+    size = srs_min(LOG_MAX_SIZE - 1 - LOG_TAIL_SIZE, size);
+    str_log[size++] = LOG_TAIL;
+    
+    writer->write(str_log, size);
 }
 
 void SrsFastLog::open_log_file()
@@ -423,13 +719,34 @@ void SrsFastLog::open_log_file()
         return;
     }
     
-    fd = ::open(filename.c_str(), O_RDWR | O_APPEND);
-    
-    if(fd == -1 && errno == ENOENT) {
-        fd = open(filename.c_str(), 
-            O_RDWR | O_CREAT | O_TRUNC, 
-            S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH
-        );
+    writer->reopen(filename);
+}
+
+void SrsFastLog::before_fork()
+{
+    if (_srs_fast_log) {
+        _srs_fast_log->writer->before_fork();
+    }
+}
+
+void SrsFastLog::after_fork_parent()
+{
+    if (_srs_fast_log) {
+        _srs_fast_log->writer->after_fork_parent();
     }
 }
 
+void SrsFastLog::after_fork_child()
+{
+    if (_srs_fast_log) {
+        _srs_fast_log->pid = getpid();
+        _srs_fast_log->writer->after_fork_child();
+    }
+}
+
+void SrsFastLog::before_exit()
+{
+    if (_srs_fast_log) {
+        _srs_fast_log->writer->stop();
+    }
+}
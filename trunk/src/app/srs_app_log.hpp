@@ -35,9 +35,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_app_reload.hpp>
 
 #include <string.h>
+#include <pthread.h>
 
 #include <string>
 #include <map>
+#include <vector>
 
 /**
 * st thread context, get_id will get the st-thread id, 
@@ -58,6 +60,81 @@ public:
     virtual void clear_cid();
 };
 
+/**
+ * the async log writer, the st thread writes the log to a ring in memory,
+ * which is drained to the log file by a pthread, so a slow disk never
+ * block the st threads.
+ * the ring is lock-free, for only the st thread writes and only the pthread
+ * reads it, while the lock protects the fd, which is only held to get or swap
+ * the fd, never when write the disk, so the st never waits for the disk when
+ * reopen the file or fork. the old fd is closed by pthread after drained.
+ * when ring is full, the log is dropped and counted, never block st.
+ */
+class SrsAsyncLogWriter
+{
+private:
+    // the ring, alloc when write the first log.
+    char* ring;
+    int nb_ring;
+    // the bytes ever written to ring by st, and drained by pthread.
+    volatile int64_t head;
+    volatile int64_t tail;
+    pthread_t tid;
+    bool started;
+    // the fields protected by lock, shared by st and pthread.
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool quit;
+    int fd;
+    // the old fds to close by pthread, which maybe writing them.
+    std::vector<int> closing;
+public:
+    // the lines and bytes written to ring, and the lines dropped for ring is full.
+    int64_t nb_lines;
+    int64_t nb_bytes;
+    int64_t nb_drops;
+public:
+    /**
+     * @param size the bytes of ring, 0 to write file in st thread.
+     */
+    SrsAsyncLogWriter(int size);
+    virtual ~SrsAsyncLogWriter();
+public:
+    virtual bool is_open();
+    /**
+     * open the file of path and close the current file, the logs in ring
+     * are drained to the new file, which are not drained yet.
+     * @param path the log file, empty to close the file only.
+     */
+    virtual void reopen(std::string path);
+    /**
+     * write the log to ring, start the pthread when not started.
+     * @return false when ring is full and the log is dropped.
+     */
+    virtual bool write(char* buf, int size);
+    /**
+     * stop the pthread and drain the ring to file.
+     */
+    virtual void stop();
+public:
+    /**
+     * hold the lock before fork, then release the lock in parent, or reset
+     * the lock in child which has no pthread, and the logs in ring are
+     * dropped in child, for they are drained by the pthread of parent.
+     */
+    virtual void before_fork();
+    virtual void after_fork_parent();
+    virtual void after_fork_child();
+private:
+    virtual int start();
+    static void* writer_pthread(void* arg);
+    virtual void do_cycle();
+    // drain the ring to file, without lock, by the pthread or st when stopped.
+    virtual void drain(int wfd);
+    // close the old fds, which are never written again.
+    virtual void close_fds(std::vector<int>& fds);
+};
+
 /**
 * we use memory/disk cache and donot flush when write log.
 * it's ok to use it without config, which will log to console, and default trace level.
@@ -72,11 +149,20 @@ protected:
 private:
     char* log_data;
     // log to file if specified srs_log_file
-    int fd;
+    SrsAsyncLogWriter* writer;
+    // the dropped lines of writer which are reported.
+    int64_t nb_drops;
     // whether log to file tank
     bool log_to_file_tank;
     // whether use utc time.
     bool utc;
+    // the time of header to second, formatted once per second.
+    time_t cached_time;
+    bool cached_utc;
+    char cached_header[64];
+    int nb_cached_header;
+    // the pid, updated when fork.
+    int pid;
 public:
     SrsFastLog();
     virtual ~SrsFastLog();
@@ -96,8 +182,13 @@ public:
     virtual int on_reload_log_file();
 private:
     virtual bool generate_header(bool error, const char* tag, int context_id, const char* level_name, int* header_size);
-    virtual void write_log(int& fd, char* str_log, int size, int level);
+    virtual void write_log(char* str_log, int size, int level);
     virtual void open_log_file();
+private:
+    static void before_fork();
+    static void after_fork_parent();
+    static void after_fork_child();
+    static void before_exit();
 };
 
 #endif
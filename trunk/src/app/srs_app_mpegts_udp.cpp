@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifdef SRS_AUTO_STREAM_CASTER
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -50,6 +51,7 @@ using namespace std;
 #include <srs_raw_avc.hpp>
 #include <srs_app_pithy_print.hpp>
 #include <srs_app_rtmp_conn.hpp>
+#include <srs_app_caster_publisher.hpp>
 
 SrsMpegtsQueue::SrsMpegtsQueue()
 {
@@ -125,15 +127,15 @@ SrsSharedPtrMessage* SrsMpegtsQueue::dequeue()
     return NULL;
 }
 
-SrsMpegtsOverUdp::SrsMpegtsOverUdp(SrsConfDirective* c)
+SrsMpegtsOverUdp::SrsMpegtsOverUdp(ISrsSourceHandler* h, SrsConfDirective* c)
 {
     stream = new SrsBuffer();
     context = new SrsTsContext();
-    buffer = new SrsSimpleStream();
+    nb_packet = 0;
     output = _srs_config->get_stream_caster_output(c);
     
     req = NULL;
-    sdk = new SrsSimpleRtmpClient();
+    sdk = new SrsCasterPublisher(h, NULL);
     
     avc = new SrsRawH264Stream();
     aac = new SrsRawAacStream();
@@ -149,7 +151,6 @@ SrsMpegtsOverUdp::~SrsMpegtsOverUdp()
     close();
 
     srs_freep(sdk);
-    srs_freep(buffer);
     srs_freep(stream);
     srs_freep(context);
     srs_freep(avc);
@@ -160,96 +161,88 @@ SrsMpegtsOverUdp::~SrsMpegtsOverUdp()
 
 int SrsMpegtsOverUdp::on_udp_packet(sockaddr_in* from, char* buf, int nb_buf)
 {
-    std::string peer_ip = inet_ntoa(from->sin_addr);
-    int peer_port = ntohs(from->sin_port);
-
-    // append to buffer.
-    buffer->append(buf, nb_buf);
-
     srs_info("udp: got %s:%d packet %d/%d bytes",
-        peer_ip.c_str(), peer_port, nb_buf, buffer->length());
+        inet_ntoa(from->sin_addr), ntohs(from->sin_port), nb_buf, nb_packet);
         
-    return on_udp_bytes(peer_ip, peer_port, buf, nb_buf);
+    return on_udp_bytes(from, buf, nb_buf);
 }
 
-int SrsMpegtsOverUdp::on_udp_bytes(string host, int port, char* buf, int nb_buf)
+int SrsMpegtsOverUdp::on_udp_bytes(sockaddr_in* from, char* buf, int nb_buf)
 {
     int ret = ERROR_SUCCESS;
-
-    // collect nMB data to parse in a time.
-    // TODO: FIXME: comment the following for release.
-    //if (buffer->length() < 3 * 1024 * 1024) return ret;
-    // TODO: FIXME: remove the debug to file.
-#if 0
-    SrsFileWriter fw;
-    if ((ret = fw.open("latest.ts")) != ERROR_SUCCESS) {
-        return ret;
-    }
-    if ((ret = fw.write(buffer->bytes(), buffer->length(), NULL)) != ERROR_SUCCESS) {
-        return ret;
-    }
-    fw.close();
-#endif
-#if 0
-    SrsFileReader fr;
-    if ((ret = fr.open("latest.ts")) != ERROR_SUCCESS) {
-        return ret;
-    }
-    buffer->erase(buffer->length());
-    int nb_fbuf = fr.filesize();
-    char* fbuf = new char[nb_fbuf];
-    SrsAutoFreeA(char, fbuf);
-    if ((ret = fr.read(fbuf, nb_fbuf, NULL)) != ERROR_SUCCESS) {
-        return ret;
-    }
-    fr.close();
-    buffer->append(fbuf, nb_fbuf);
-#endif
-
-    // find the sync byte of mpegts.
-    char* p = buffer->bytes();
-    for (int i = 0; i < buffer->length(); i++) {
-        if (p[i] != 0x47) {
-            continue;
+    
+    char* p = buf;
+    char* end = buf + nb_buf;
+    
+    // complete the ts packet split in the previous udp packet.
+    if (nb_packet > 0) {
+        int size = srs_min(SRS_TS_PACKET_SIZE - nb_packet, (int)(end - p));
+        memcpy(packet + nb_packet, p, size);
+        nb_packet += size;
+        p += size;
+        
+        if (nb_packet < SRS_TS_PACKET_SIZE) {
+            return ret;
         }
-
-        if (i > 0) {
-            buffer->erase(i);
+        
+        nb_packet = 0;
+        if ((ret = on_ts_packet(packet)) != ERROR_SUCCESS) {
+            return ret;
         }
-        break;
     }
-
-    // drop ts packet when size not modulus by 188
-    if (buffer->length() < SRS_TS_PACKET_SIZE) {
-        srs_warn("udp: wait %s:%d packet %d/%d bytes", host.c_str(), port, nb_buf, buffer->length());
+    
+    // find the sync byte of mpegts.
+    char* start = p;
+    while (p < end && p[0] != 0x47) {
+        p++;
+    }
+    
+    // drop ts packet when size not modulus by 188,
+    // ignore when the split ts packet completes at the end of udp packet.
+    if (p == end) {
+        if (start < end) {
+            srs_warn("udp: drop %s:%d packet %d/%d bytes, no sync byte",
+                inet_ntoa(from->sin_addr), ntohs(from->sin_port), (int)(end - start), nb_buf);
+        }
         return ret;
     }
-
-    // use stream to parse ts packet.
-    int nb_packet =  buffer->length() / SRS_TS_PACKET_SIZE;
-    for (int i = 0; i < nb_packet; i++) {
-        char* p = buffer->bytes() + (i * SRS_TS_PACKET_SIZE);
-        if ((ret = stream->initialize(p, SRS_TS_PACKET_SIZE)) != ERROR_SUCCESS) {
+    
+    // parse the ts packets in place.
+    for (; end - p >= SRS_TS_PACKET_SIZE; p += SRS_TS_PACKET_SIZE) {
+        if ((ret = on_ts_packet(p)) != ERROR_SUCCESS) {
             return ret;
         }
-
-        // process each ts packet
-        if ((ret = context->decode(stream, this)) != ERROR_SUCCESS) {
-            srs_warn("mpegts: ignore parse ts packet failed. ret=%d", ret);
-            continue;
-        }
-        srs_info("mpegts: parse ts packet completed");
     }
     srs_info("mpegts: parse udp packet completed");
-
-    // erase consumed bytes
-    if (nb_packet > 0) {
-        buffer->erase(nb_packet * SRS_TS_PACKET_SIZE);
+    
+    // keep the left bytes of ts packet, to complete by next udp packet.
+    if (p < end) {
+        nb_packet = (int)(end - p);
+        memcpy(packet, p, nb_packet);
     }
 
     return ret;
 }
 
+int SrsMpegtsOverUdp::on_ts_packet(char* p)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // use stream to parse ts packet.
+    if ((ret = stream->initialize(p, SRS_TS_PACKET_SIZE)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // process each ts packet
+    if ((ret = context->decode(stream, this)) != ERROR_SUCCESS) {
+        srs_warn("mpegts: ignore parse ts packet failed. ret=%d", ret);
+        return ERROR_SUCCESS;
+    }
+    srs_info("mpegts: parse ts packet completed");
+    
+    return ret;
+}
+
 int SrsMpegtsOverUdp::on_ts_message(SrsTsMessage* msg)
 {
     int ret = ERROR_SUCCESS;
@@ -48,7 +48,8 @@ class SrsSharedPtrMessage;
 class SrsRawAacStream;
 struct SrsRawAacStreamCodec;
 class SrsPithyPrint;
-class SrsSimpleRtmpClient;
+class SrsCasterPublisher;
+class ISrsSourceHandler;
 
 #include <srs_app_st.hpp>
 #include <srs_kernel_ts.hpp>
@@ -83,11 +84,14 @@ class SrsMpegtsOverUdp : virtual public ISrsTsHandler
 private:
     SrsBuffer* stream;
     SrsTsContext* context;
-    SrsSimpleStream* buffer;
+    // the bytes of ts packet which is split in udp packets,
+    // the ts packets in udp packet are parsed in place.
+    char packet[SRS_TS_PACKET_SIZE];
+    int nb_packet;
     std::string output;
 private:
     SrsRequest* req;
-    SrsSimpleRtmpClient* sdk;
+    SrsCasterPublisher* sdk;
 private:
     SrsRawH264Stream* avc;
     std::string h264_sps;
@@ -102,13 +106,14 @@ private:
     SrsMpegtsQueue* queue;
     SrsPithyPrint* pprint;
 public:
-    SrsMpegtsOverUdp(SrsConfDirective* c);
+    SrsMpegtsOverUdp(ISrsSourceHandler* h, SrsConfDirective* c);
     virtual ~SrsMpegtsOverUdp();
 // interface ISrsUdpHandler
 public:
     virtual int on_udp_packet(sockaddr_in* from, char* buf, int nb_buf);
 private:
-    virtual int on_udp_bytes(std::string host, int port, char* buf, int nb_buf);
+    virtual int on_udp_bytes(sockaddr_in* from, char* buf, int nb_buf);
+    virtual int on_ts_packet(char* p);
 // interface ISrsTsHandler
 public:
     virtual int on_ts_message(SrsTsMessage* msg);
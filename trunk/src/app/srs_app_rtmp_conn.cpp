@@ -56,6 +56,7 @@ using namespace std;
 #include <srs_protocol_utility.hpp>
 #include <srs_protocol_json.hpp>
 #include <srs_app_kafka.hpp>
+#include <srs_app_worker.hpp>
 
 // when stream is busy, for example, streaming is already
 // publishing, when a new client to request to publish,
@@ -294,9 +295,9 @@ int SrsSimpleRtmpClient::decode_message(SrsCommonMessage* msg, SrsPacket** ppack
     return client->decode_message(msg, ppacket);
 }
 
-int SrsSimpleRtmpClient::send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs)
+int SrsSimpleRtmpClient::send_messages(SrsSharedPtrMessage** msgs, int nb_msgs)
 {
-    return client->send_and_free_messages(msgs, nb_msgs, stream_id);
+    return client->send_messages(msgs, nb_msgs, stream_id);
 }
 
 int SrsSimpleRtmpClient::send_and_free_message(SrsSharedPtrMessage* msg)
@@ -315,6 +316,7 @@ SrsRtmpConn::SrsRtmpConn(SrsServer* svr, st_netfd_t c, string cip)
     server = svr;
     
     req = new SrsRequest();
+    vconf = NULL;
     res = new SrsResponse();
     skt = new SrsStSocket(c);
     rtmp = new SrsRtmpServer(skt);
@@ -331,6 +333,7 @@ SrsRtmpConn::SrsRtmpConn(SrsServer* svr, st_netfd_t c, string cip)
     realtime = SRS_PERF_MIN_LATENCY_ENABLED;
     send_min_interval = 0;
     tcp_nodelay = false;
+    worker_relay = false;
 
     _srs_config->subscribe(this);
 }
@@ -349,6 +352,11 @@ SrsRtmpConn::~SrsRtmpConn()
     srs_freep(kbps);
 }
 
+void SrsRtmpConn::set_worker_relay()
+{
+    worker_relay = true;
+}
+
 void SrsRtmpConn::dispose()
 {
     SrsConnection::dispose();
@@ -697,8 +705,20 @@ int SrsRtmpConn::stream_service_cycle()
     srs_trace("client identified, type=%s, stream_name=%s, duration=%.2f", 
         srs_client_type_string(type).c_str(), req->stream.c_str(), req->duration);
     
-    // security check
-    if ((ret = security->check(type, ip, req)) != ERROR_SUCCESS) {
+    // the relay of worker only plays the stream.
+    if (worker_relay && type != SrsRtmpConnPlay) {
+        ret = ERROR_SYSTEM_CLIENT_INVALID;
+        srs_error("worker relay must play, type=%s. ret=%d", srs_client_type_string(type).c_str(), ret);
+        return ret;
+    }
+    
+    // drop the client which plays too fast.
+    if (type == SrsRtmpConnPlay && (ret = SrsRateLimiter::instance()->on_play(ip)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // security check, the worker relay is checked by the worker serves the player.
+    if (!worker_relay && (ret = security->check(type, ip, req)) != ERROR_SUCCESS) {
         srs_error("security check failed. ret=%d", ret);
         return ret;
     }
@@ -717,13 +737,13 @@ int SrsRtmpConn::stream_service_cycle()
     
     // update the statistic when source disconveried.
     SrsStatistic* stat = SrsStatistic::instance();
-    if ((ret = stat->on_client(_srs_context->get_id(), req, this, type)) != ERROR_SUCCESS) {
+    if (!worker_relay && (ret = stat->on_client(_srs_context->get_id(), req, this, type)) != ERROR_SUCCESS) {
         srs_error("stat client failed. ret=%d", ret);
         return ret;
     }
 
-    bool vhost_is_edge = _srs_config->get_vhost_is_edge(req->vhost);
-    bool enabled_cache = _srs_config->get_gop_cache(req->vhost);
+    bool vhost_is_edge = vconf->is_edge;
+    bool enabled_cache = vconf->gop_cache;
     srs_trace("source url=%s, ip=%s, cache=%d, is_edge=%d, source_id=%d[%d]",
         req->get_stream_url().c_str(), ip.c_str(), enabled_cache, vhost_is_edge, 
         source->source_id(), source->source_id());
@@ -738,14 +758,16 @@ int SrsRtmpConn::stream_service_cycle()
                 srs_error("start to play stream failed. ret=%d", ret);
                 return ret;
             }
-            if ((ret = http_hooks_on_play()) != ERROR_SUCCESS) {
+            if (!worker_relay && (ret = http_hooks_on_play()) != ERROR_SUCCESS) {
                 srs_error("http hook on_play failed. ret=%d", ret);
                 return ret;
             }
             
             srs_info("start to play stream %s success", req->stream.c_str());
             ret = playing(source);
-            http_hooks_on_stop();
+            if (!worker_relay) {
+                http_hooks_on_stop();
+            }
             
             return ret;
         }
@@ -802,6 +824,7 @@ int SrsRtmpConn::check_vhost(bool try_default_vhost)
         srs_trace("vhost change from %s to %s", req->vhost.c_str(), vhost->arg0().c_str());
         req->vhost = vhost->arg0();
     }
+    vconf = _srs_config->get_vhost_config(req->vhost);
     
     if (_srs_config->get_refer_enabled(req->vhost)) {
         if ((ret = refer->check(req->pageUrl, _srs_config->get_refer_all(req->vhost))) != ERROR_SUCCESS) {
@@ -811,7 +834,7 @@ int SrsRtmpConn::check_vhost(bool try_default_vhost)
         srs_verbose("check refer success.");
     }
     
-    if ((ret = http_hooks_on_connect()) != ERROR_SUCCESS) {
+    if (!worker_relay && (ret = http_hooks_on_connect()) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -948,7 +971,7 @@ int SrsRtmpConn::do_playing(SrsSource* source, SrsConsumer* consumer, SrsQueueRe
 #endif
         
         // get messages from consumer.
-        // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
+        // each msg in msgs.msgs must be free after sent, @see SrsMessageArray.free().
         // @remark when enable send_min_interval, only fetch one message a time.
         int count = (send_min_interval > 0)? 1 : 0;
         if ((ret = consumer->dump_packets(&msgs, count)) != ERROR_SUCCESS) {
@@ -998,7 +1021,7 @@ int SrsRtmpConn::do_playing(SrsSource* source, SrsConsumer* consumer, SrsQueueRe
                 SrsSharedPtrMessage* msg = msgs.msgs[i];
                 
                 // foreach msg, collect the duration.
-                // @remark: never use msg when sent it, for the protocol sdk will free it.
+                // @remark: never use msg when sent it, for the msgs will be freed.
                 if (starttime < 0 || starttime > msg->timestamp) {
                     starttime = msg->timestamp;
                 }
@@ -1007,9 +1030,11 @@ int SrsRtmpConn::do_playing(SrsSource* source, SrsConsumer* consumer, SrsQueueRe
             }
         }
         
-        // sendout messages, all messages are freed by send_and_free_messages().
+        // sendout messages, then release the reusable msgs.
         // no need to assert msg, for the rtmp will assert it.
-        if (count > 0 && (ret = rtmp->send_and_free_messages(msgs.msgs, count, res->stream_id)) != ERROR_SUCCESS) {
+        ret = rtmp->send_messages(msgs.msgs, count, res->stream_id);
+        msgs.free(count);
+        if (ret != ERROR_SUCCESS) {
             if (!srs_is_client_gracefully_close(ret)) {
                 srs_error("send messages to client failed. ret=%d", ret);
             }
@@ -1052,7 +1077,7 @@ int SrsRtmpConn::publishing(SrsSource* source)
         return ret;
     }
 
-    bool vhost_is_edge = _srs_config->get_vhost_is_edge(req->vhost);
+    bool vhost_is_edge = vconf->is_edge;
     if ((ret = acquire_publish(source, vhost_is_edge)) == ERROR_SUCCESS) {
         // use isolate thread to recv,
         // @see: https://github.com/ossrs/srs/issues/237
@@ -1152,8 +1177,8 @@ int SrsRtmpConn::do_publishing(SrsSource* source, SrsPublishRecvThread* trd)
         // reportable
         if (pprint->can_print()) {
             kbps->sample();
-            bool mr = _srs_config->get_mr_enabled(req->vhost);
-            int mr_sleep = _srs_config->get_mr_sleep_ms(req->vhost);
+            bool mr = vconf->mr_enabled;
+            int mr_sleep = vconf->mr_sleep_ms;
             srs_trace("<- "SRS_CONSTS_LOG_CLIENT_PUBLISH
                 " time=%"PRId64", okbps=%d,%d,%d, ikbps=%d,%d,%d, mr=%d/%d, p1stpt=%d, pnt=%d", pprint->age(),
                 kbps->get_send_kbps(), kbps->get_send_kbps_30s(), kbps->get_send_kbps_5m(),
@@ -1169,6 +1194,14 @@ int SrsRtmpConn::do_publishing(SrsSource* source, SrsPublishRecvThread* trd)
 int SrsRtmpConn::acquire_publish(SrsSource* source, bool is_edge)
 {
     int ret = ERROR_SUCCESS;
+    
+    // pin the stream to current worker, and stop pull it from other worker.
+    if (!is_edge) {
+        if ((ret = SrsWorkers::instance()->on_publish(req)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        source->worker_relay_stop();
+    }
 
     if (!source->can_publish(is_edge)) {
         ret = ERROR_SYSTEM_STREAM_BUSY;
@@ -1201,6 +1234,7 @@ void SrsRtmpConn::release_publish(SrsSource* source, bool is_edge)
         source->on_edge_proxy_unpublish();
     } else {
         source->on_unpublish();
+        SrsWorkers::instance()->on_unpublish(req);
     }
 }
 
@@ -1546,7 +1580,9 @@ int SrsRtmpConn::on_disconnect()
 {
     int ret = ERROR_SUCCESS;
 
-    http_hooks_on_close();
+    if (!worker_relay) {
+        http_hooks_on_close();
+    }
     
 #ifdef SRS_AUTO_KAFKA
     if ((ret = _srs_kafka->on_close(srs_id())) != ERROR_SUCCESS) {
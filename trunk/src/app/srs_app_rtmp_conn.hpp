@@ -58,6 +58,7 @@ class SrsSecurity;
 class ISrsWakable;
 class SrsCommonMessage;
 class SrsPacket;
+class SrsVhostConfig;
 #ifdef SRS_AUTO_KAFKA
 class ISrsKafkaCluster;
 #endif
@@ -94,7 +95,7 @@ public:
 public:
     virtual int recv_message(SrsCommonMessage** pmsg);
     virtual int decode_message(SrsCommonMessage* msg, SrsPacket** ppacket);
-    virtual int send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs);
+    virtual int send_messages(SrsSharedPtrMessage** msgs, int nb_msgs);
     virtual int send_and_free_message(SrsSharedPtrMessage* msg);
 public:
     virtual void set_recv_timeout(int64_t timeout);
@@ -110,6 +111,8 @@ class SrsRtmpConn : public virtual SrsConnection, public virtual ISrsReloadHandl
 private:
     SrsServer* server;
     SrsRequest* req;
+    // the compiled config of vhost, for the hot path.
+    SrsVhostConfig* vconf;
     SrsResponse* res;
     SrsStSocket* skt;
     SrsRtmpServer* rtmp;
@@ -138,11 +141,20 @@ private:
     int publish_normal_timeout;
     // whether enable the tcp_nodelay.
     bool tcp_nodelay;
+    // whether the client is other worker, which plays the stream
+    // owned by current worker from the local port, to relay it.
+    bool worker_relay;
 public:
     SrsRtmpConn(SrsServer* svr, st_netfd_t c, std::string cip);
     virtual ~SrsRtmpConn();
 public:
     virtual void dispose();
+    /**
+     * mark the client as the relay of other worker, which only plays,
+     * and the hooks, security and statistic are ignored, for they are
+     * done by the worker which serves the players.
+     */
+    virtual void set_worker_relay();
 protected:
     virtual int do_cycle();
 // interface ISrsReloadHandler
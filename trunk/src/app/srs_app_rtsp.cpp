@@ -43,6 +43,7 @@ using namespace std;
 #include <srs_kernel_codec.hpp>
 #include <srs_app_pithy_print.hpp>
 #include <srs_app_rtmp_conn.hpp>
+#include <srs_app_caster_publisher.hpp>
 
 #ifdef SRS_AUTO_STREAM_CASTER
 
@@ -181,7 +182,7 @@ int SrsRtspJitter::correct(int64_t& ts)
     return ret;
 }
 
-SrsRtspConn::SrsRtspConn(SrsRtspCaster* c, st_netfd_t fd, std::string o)
+SrsRtspConn::SrsRtspConn(ISrsSourceHandler* h, SrsRtspCaster* c, st_netfd_t fd, std::string o)
 {
     output_template = o;
 
@@ -196,7 +197,7 @@ SrsRtspConn::SrsRtspConn(SrsRtspCaster* c, st_netfd_t fd, std::string o)
     trd = new SrsOneCycleThread("rtsp", this);
 
     req = NULL;
-    sdk = new SrsSimpleRtmpClient();
+    sdk = new SrsCasterPublisher(h, NULL);
     vjitter = new SrsRtspJitter();
     ajitter = new SrsRtspJitter();
 
@@ -660,6 +661,7 @@ int SrsRtspConn::connect()
         std::string output = output_template;
         output = srs_string_replace(output, "[app]", app);
         output = srs_string_replace(output, "[stream]", rtsp_stream);
+        url = output;
     }
 
     // connect host.
@@ -679,8 +681,10 @@ int SrsRtspConn::connect()
     return write_sequence_header();
 }
 
-SrsRtspCaster::SrsRtspCaster(SrsConfDirective* c)
+SrsRtspCaster::SrsRtspCaster(ISrsSourceHandler* h, SrsConfDirective* c)
 {
+    handler = h;
+    
     // TODO: FIXME: support reload.
     output = _srs_config->get_stream_caster_output(c);
     local_port_min = _srs_config->get_stream_caster_rtp_port_min(c);
@@ -728,7 +732,7 @@ int SrsRtspCaster::on_tcp_client(st_netfd_t stfd)
 {
     int ret = ERROR_SUCCESS;
 
-    SrsRtspConn* conn = new SrsRtspConn(this, stfd, output);
+    SrsRtspConn* conn = new SrsRtspConn(handler, this, stfd, output);
 
     if ((ret = conn->serve()) != ERROR_SUCCESS) {
         srs_error("rtsp: serve client failed. ret=%d", ret);
@@ -56,7 +56,8 @@ class SrsSharedPtrMessage;
 class SrsCodecSample;
 class SrsSimpleStream;
 class SrsPithyPrint;
-class SrsSimpleRtmpClient;
+class SrsCasterPublisher;
+class ISrsSourceHandler;
 
 /**
 * a rtp connection which transport a stream.
@@ -140,7 +141,7 @@ private:
     SrsOneCycleThread* trd;
 private:
     SrsRequest* req;
-    SrsSimpleRtmpClient* sdk;
+    SrsCasterPublisher* sdk;
     SrsRtspJitter* vjitter;
     SrsRtspJitter* ajitter;
 private:
@@ -153,7 +154,7 @@ private:
     std::string aac_specific_config;
     SrsRtspAudioCache* acache;
 public:
-    SrsRtspConn(SrsRtspCaster* c, st_netfd_t fd, std::string o);
+    SrsRtspConn(ISrsSourceHandler* h, SrsRtspCaster* c, st_netfd_t fd, std::string o);
     virtual ~SrsRtspConn();
 public:
     virtual int serve();
@@ -188,6 +189,7 @@ private:
 class SrsRtspCaster : public ISrsTcpHandler
 {
 private:
+    ISrsSourceHandler* handler;
     std::string output;
     int local_port_min;
     int local_port_max;
@@ -196,7 +198,7 @@ private:
 private:
     std::vector<SrsRtspConn*> clients;
 public:
-    SrsRtspCaster(SrsConfDirective* c);
+    SrsRtspCaster(ISrsSourceHandler* h, SrsConfDirective* c);
     virtual ~SrsRtspCaster();
 public:
     /**
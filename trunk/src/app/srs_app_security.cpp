@@ -23,11 +23,221 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_app_security.hpp>
 
+#include <string.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+
 #include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
 #include <srs_app_config.hpp>
+#include <srs_app_utility.hpp>
+#include <srs_core_performance.hpp>
 
 using namespace std;
 
+// no child of trie node.
+#define SRS_CIDR_NO_CHILD -1
+
+SrsCidrTrie::SrsCidrTrie()
+{
+    clear();
+}
+
+SrsCidrTrie::~SrsCidrTrie()
+{
+}
+
+int SrsCidrTrie::add(string rule)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // match any ip of IPv4 and IPv6.
+    if (rule == "all") {
+        insert(v4, NULL, 0);
+        insert(v6, NULL, 0);
+        return ret;
+    }
+    
+    string ip = rule;
+    int prefix = -1;
+    
+    size_t pos = rule.find("/");
+    if (pos != string::npos) {
+        ip = rule.substr(0, pos);
+        string bits = rule.substr(pos + 1);
+        if (bits.empty() || bits.find_first_not_of("0123456789") != string::npos || bits.length() > 3) {
+            ret = ERROR_SYSTEM_IP_INVALID;
+            srs_error("invalid prefix of rule %s. ret=%d", rule.c_str(), ret);
+            return ret;
+        }
+        prefix = ::atoi(bits.c_str());
+    }
+    
+    unsigned char bytes[16];
+    if (inet_pton(AF_INET, ip.c_str(), bytes) == 1) {
+        if (prefix > 32) {
+            ret = ERROR_SYSTEM_IP_INVALID;
+            srs_error("invalid prefix of rule %s. ret=%d", rule.c_str(), ret);
+            return ret;
+        }
+        insert(v4, bytes, prefix == -1? 32 : prefix);
+        return ret;
+    }
+    
+    if (inet_pton(AF_INET6, ip.c_str(), bytes) == 1) {
+        if (prefix > 128) {
+            ret = ERROR_SYSTEM_IP_INVALID;
+            srs_error("invalid prefix of rule %s. ret=%d", rule.c_str(), ret);
+            return ret;
+        }
+        insert(v6, bytes, prefix == -1? 128 : prefix);
+        return ret;
+    }
+    
+    ret = ERROR_SYSTEM_IP_INVALID;
+    srs_error("invalid ip of rule %s. ret=%d", rule.c_str(), ret);
+    
+    return ret;
+}
+
+bool SrsCidrTrie::match(string ip)
+{
+    unsigned char bytes[16];
+    
+    if (inet_pton(AF_INET, ip.c_str(), bytes) == 1) {
+        return lookup(v4, bytes, 32);
+    }
+    
+    if (inet_pton(AF_INET6, ip.c_str(), bytes) != 1) {
+        return false;
+    }
+    
+    // the IPv4-mapped IPv6 address, ::ffff:a.b.c.d
+    static unsigned char mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    if (memcmp(bytes, mapped, sizeof(mapped)) == 0) {
+        return lookup(v4, bytes + 12, 32);
+    }
+    
+    return lookup(v6, bytes, 128);
+}
+
+bool SrsCidrTrie::empty()
+{
+    return v4.size() == 1 && v6.size() == 1 && !v4[0].matched && !v6[0].matched;
+}
+
+void SrsCidrTrie::clear()
+{
+    SrsCidrNode root;
+    root.children[0] = root.children[1] = SRS_CIDR_NO_CHILD;
+    root.matched = false;
+    
+    v4.clear();
+    v4.push_back(root);
+    
+    v6.clear();
+    v6.push_back(root);
+}
+
+void SrsCidrTrie::insert(vector<SrsCidrNode>& nodes, const unsigned char* bytes, int prefix)
+{
+    int node = 0;
+    
+    for (int i = 0; i < prefix; i++) {
+        // the shorter prefix already matches all ips of this one.
+        if (nodes[node].matched) {
+            return;
+        }
+        
+        int bit = (bytes[i / 8] >> (7 - i % 8)) & 0x01;
+        int child = nodes[node].children[bit];
+        
+        if (child == SRS_CIDR_NO_CHILD) {
+            SrsCidrNode n;
+            n.children[0] = n.children[1] = SRS_CIDR_NO_CHILD;
+            n.matched = false;
+            
+            child = (int)nodes.size();
+            nodes.push_back(n);
+            nodes[node].children[bit] = child;
+        }
+        
+        node = child;
+    }
+    
+    nodes[node].matched = true;
+}
+
+bool SrsCidrTrie::lookup(vector<SrsCidrNode>& nodes, const unsigned char* bytes, int nb_bits)
+{
+    int node = 0;
+    
+    for (int i = 0; i < nb_bits; i++) {
+        if (nodes[node].matched) {
+            return true;
+        }
+        
+        int bit = (bytes[i / 8] >> (7 - i % 8)) & 0x01;
+        node = nodes[node].children[bit];
+        
+        if (node == SRS_CIDR_NO_CHILD) {
+            return false;
+        }
+    }
+    
+    return nodes[node].matched;
+}
+
+SrsSecurityRules::SrsSecurityRules()
+{
+}
+
+SrsSecurityRules::~SrsSecurityRules()
+{
+}
+
+void SrsSecurityRules::compile(SrsConfDirective* rules)
+{
+    allow_play.clear();
+    allow_publish.clear();
+    deny_play.clear();
+    deny_publish.clear();
+    
+    if (!rules) {
+        return;
+    }
+    
+    for (int i = 0; i < (int)rules->directives.size(); i++) {
+        SrsConfDirective* rule = rules->at(i);
+        
+        if (rule->name != "allow" && rule->name != "deny") {
+            continue;
+        }
+        
+        SrsCidrTrie* trie = NULL;
+        if (rule->name == "allow") {
+            if (rule->arg0() == "play") {
+                trie = &allow_play;
+            } else if (rule->arg0() == "publish") {
+                trie = &allow_publish;
+            }
+        } else if (rule->name == "deny") {
+            if (rule->arg0() == "play") {
+                trie = &deny_play;
+            } else if (rule->arg0() == "publish") {
+                trie = &deny_publish;
+            }
+        }
+        
+        // ignore the invalid rule, which never matches any ip.
+        if (!trie || trie->add(rule->arg1()) != ERROR_SUCCESS) {
+            srs_warn("ignore security rule %s %s %s at line %d",
+                rule->name.c_str(), rule->arg0().c_str(), rule->arg1().c_str(), rule->conf_line);
+        }
+    }
+}
+
 SrsSecurity::SrsSecurity()
 {
 }
@@ -40,19 +250,18 @@ int SrsSecurity::check(SrsRtmpConnType type, string ip, SrsRequest* req)
 {
     int ret = ERROR_SUCCESS;
     
+    // the rules compiled when load or reload config.
+    SrsVhostConfig* vconf = _srs_config->get_vhost_config(req->vhost);
+    
     // allow all if security disabled.
-    if (!_srs_config->get_security_enabled(req->vhost)) {
+    if (!vconf->security_enabled) {
         return ret;
     }
     
     // default to deny all when security enabled.
     ret = ERROR_SYSTEM_SECURITY;
     
-    // rules to apply
-    SrsConfDirective* rules = _srs_config->get_security_rules(req->vhost);
-    if (!rules) {
-        return ret;
-    }
+    SrsSecurityRules* rules = vconf->security_rules;
     
     // allow if matches allow strategy.
     if (allow_check(rules, type, ip) == ERROR_SYSTEM_SECURITY_ALLOW) {
@@ -67,93 +276,197 @@ int SrsSecurity::check(SrsRtmpConnType type, string ip, SrsRequest* req)
     return ret;
 }
 
-int SrsSecurity::allow_check(SrsConfDirective* rules, SrsRtmpConnType type, std::string ip)
+int SrsSecurity::allow_check(SrsSecurityRules* rules, SrsRtmpConnType type, std::string ip)
 {
     int ret = ERROR_SUCCESS;
     
-    for (int i = 0; i < (int)rules->directives.size(); i++) {
-        SrsConfDirective* rule = rules->at(i);
-        
-        if (rule->name != "allow") {
-            continue;
-        }
+    switch (type) {
+        case SrsRtmpConnPlay:
+            if (rules->allow_play.match(ip)) {
+                ret = ERROR_SYSTEM_SECURITY_ALLOW;
+            }
+            break;
+        case SrsRtmpConnFMLEPublish:
+        case SrsRtmpConnFlashPublish:
+            if (rules->allow_publish.match(ip)) {
+                ret = ERROR_SYSTEM_SECURITY_ALLOW;
+            }
+            break;
+        case SrsRtmpConnUnknown:
+        default:
+            break;
+    }
+    
+    return ret;
+}
 
-        switch (type) {
-            case SrsRtmpConnPlay:
-                if (rule->arg0() != "play") {
-                    break;
-                }
-                if (rule->arg1() == "all" || rule->arg1() == ip) {
-                    ret = ERROR_SYSTEM_SECURITY_ALLOW;
-                    break;
-                }
-                break;
-            case SrsRtmpConnFMLEPublish:
-            case SrsRtmpConnFlashPublish:
-                if (rule->arg0() != "publish") {
-                    break;
-                }
-                if (rule->arg1() == "all" || rule->arg1() == ip) {
-                    ret = ERROR_SYSTEM_SECURITY_ALLOW;
-                    break;
-                }
-                break;
-            case SrsRtmpConnUnknown:
-            default:
-                break;
-        }
-        
-        // when matched, donot search more.
-        if (ret == ERROR_SYSTEM_SECURITY_ALLOW) {
+int SrsSecurity::deny_check(SrsSecurityRules* rules, SrsRtmpConnType type, std::string ip)
+{
+    int ret = ERROR_SUCCESS;
+    
+    switch (type) {
+        case SrsRtmpConnPlay:
+            if (rules->deny_play.match(ip)) {
+                ret = ERROR_SYSTEM_SECURITY_DENY;
+            }
+            break;
+        case SrsRtmpConnFMLEPublish:
+        case SrsRtmpConnFlashPublish:
+            if (rules->deny_publish.match(ip)) {
+                ret = ERROR_SYSTEM_SECURITY_DENY;
+            }
+            break;
+        case SrsRtmpConnUnknown:
+        default:
             break;
-        }
     }
     
     return ret;
 }
 
-int SrsSecurity::deny_check(SrsConfDirective* rules, SrsRtmpConnType type, std::string ip)
+SrsRateLimiter* SrsRateLimiter::_instance = NULL;
+
+SrsRateLimiter::SrsRateLimiter()
+{
+    sweep_at = 0;
+    nb_connect_drops = nb_play_drops = 0;
+}
+
+SrsRateLimiter::~SrsRateLimiter()
+{
+}
+
+SrsRateLimiter* SrsRateLimiter::instance()
+{
+    if (!_instance) {
+        _instance = new SrsRateLimiter();
+    }
+    return _instance;
+}
+
+int SrsRateLimiter::on_connect(string ip)
 {
     int ret = ERROR_SUCCESS;
     
-    for (int i = 0; i < (int)rules->directives.size(); i++) {
-        SrsConfDirective* rule = rules->at(i);
+    if (!_srs_config->get_rate_limit_enabled() || is_local(ip)) {
+        return ret;
+    }
+    
+    double rate = _srs_config->get_rate_limit_connect_rate();
+    double burst = _srs_config->get_rate_limit_connect_burst();
+    
+    int64_t now = srs_get_system_time_ms();
+    sweep(connects, rate, burst, now);
+    
+    if (!consume(connects, ip, rate, burst, now)) {
+        nb_connect_drops++;
+        ret = ERROR_SYSTEM_RATE_LIMIT;
+        srs_warn("ip %s connects too fast, rate=%.2f, burst=%.2f, drops=%"PRId64". ret=%d",
+            ip.c_str(), rate, burst, nb_connect_drops, ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+int SrsRateLimiter::on_play(string ip)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!_srs_config->get_rate_limit_enabled() || is_local(ip)) {
+        return ret;
+    }
+    
+    double rate = _srs_config->get_rate_limit_play_rate();
+    double burst = _srs_config->get_rate_limit_play_burst();
+    
+    int64_t now = srs_get_system_time_ms();
+    sweep(plays, rate, burst, now);
+    
+    if (!consume(plays, ip, rate, burst, now)) {
+        nb_play_drops++;
+        ret = ERROR_SYSTEM_RATE_LIMIT;
+        srs_warn("ip %s plays too fast, rate=%.2f, burst=%.2f, drops=%"PRId64". ret=%d",
+            ip.c_str(), rate, burst, nb_play_drops, ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+bool SrsRateLimiter::is_local(string ip)
+{
+    // the local ips never change, so only retrieve once.
+    if (locals.empty()) {
+        locals.add("127.0.0.0/8");
+        locals.add("::1");
         
-        if (rule->name != "deny") {
-            continue;
+        vector<string>& ips = srs_get_local_ipv4_ips();
+        for (int i = 0; i < (int)ips.size(); i++) {
+            locals.add(ips[i]);
         }
+    }
+    
+    return locals.match(ip);
+}
 
-        switch (type) {
-            case SrsRtmpConnPlay:
-                if (rule->arg0() != "play") {
-                    break;
-                }
-                if (rule->arg1() == "all" || rule->arg1() == ip) {
-                    ret = ERROR_SYSTEM_SECURITY_DENY;
-                    break;
-                }
-                break;
-            case SrsRtmpConnFMLEPublish:
-            case SrsRtmpConnFlashPublish:
-                if (rule->arg0() != "publish") {
-                    break;
-                }
-                if (rule->arg1() == "all" || rule->arg1() == ip) {
-                    ret = ERROR_SYSTEM_SECURITY_DENY;
-                    break;
-                }
-                break;
-            case SrsRtmpConnUnknown:
-            default:
-                break;
-        }
+bool SrsRateLimiter::consume(map<string, SrsTokenBucket>& buckets, string ip, double rate, double burst, int64_t now)
+{
+    // no limit when rate is zero.
+    if (rate <= 0) {
+        return true;
+    }
+    
+    // the burst is at least one token.
+    burst = srs_max(1, burst);
+    
+    map<string, SrsTokenBucket>::iterator it = buckets.find(ip);
+    if (it == buckets.end()) {
+        SrsTokenBucket bucket;
+        bucket.tokens = burst - 1;
+        bucket.update_at = now;
+        buckets[ip] = bucket;
+        return true;
+    }
+    
+    SrsTokenBucket& bucket = it->second;
+    
+    // refill the tokens by the elapsed time.
+    if (now > bucket.update_at) {
+        bucket.tokens = srs_min(burst, bucket.tokens + rate * (now - bucket.update_at) / 1000.0);
+        bucket.update_at = now;
+    }
+    
+    if (bucket.tokens < 1) {
+        return false;
+    }
+    
+    bucket.tokens -= 1;
+    return true;
+}
+
+void SrsRateLimiter::sweep(map<string, SrsTokenBucket>& buckets, double rate, double burst, int64_t now)
+{
+    if ((int)buckets.size() < SRS_PERF_RATE_LIMIT_IPS) {
+        return;
+    }
+    
+    // sweep at most once a second, when attacked by lots of ips.
+    if (now - sweep_at < 1000) {
+        return;
+    }
+    sweep_at = now;
+    
+    // remove the bucket which is refilled, it's same to a new bucket.
+    map<string, SrsTokenBucket>::iterator it;
+    for (it = buckets.begin(); it != buckets.end();) {
+        SrsTokenBucket& bucket = it->second;
         
-        // when matched, donot search more.
-        if (ret == ERROR_SYSTEM_SECURITY_DENY) {
-            break;
+        if (rate <= 0 || bucket.tokens + rate * (now - bucket.update_at) / 1000.0 >= burst) {
+            buckets.erase(it++);
+        } else {
+            ++it;
         }
     }
-    
-    return ret;
 }
 
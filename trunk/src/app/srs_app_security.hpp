@@ -31,11 +31,83 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_core.hpp>
 
 #include <string>
+#include <vector>
+#include <map>
 
 #include <srs_rtmp_stack.hpp>
 
 class SrsConfDirective;
 
+/**
+* the node of prefix trie, the children are index of nodes.
+*/
+struct SrsCidrNode
+{
+    int children[2];
+    // whether a prefix ends at this node.
+    bool matched;
+};
+
+/**
+* the binary prefix trie of ip addresses, to match the ip by the CIDR
+* rules in O(bits), for example, 32 for IPv4 and 128 for IPv6, so the
+* cost never grows with the number of rules.
+*/
+class SrsCidrTrie
+{
+private:
+    // the nodes of IPv4 and IPv6, the first node is root.
+    std::vector<SrsCidrNode> v4;
+    std::vector<SrsCidrNode> v6;
+public:
+    SrsCidrTrie();
+    virtual ~SrsCidrTrie();
+public:
+    /**
+    * add the rule to trie, which is "all", an ip or a CIDR,
+    * for example, 192.168.1.10, 10.0.0.0/8 or 2001:db8::/32.
+    * @return ERROR_SYSTEM_IP_INVALID when rule is invalid.
+    */
+    virtual int add(std::string rule);
+    /**
+    * whether the ip matches any rule of trie.
+    * @remark the IPv4-mapped IPv6 address is matched as IPv4.
+    */
+    virtual bool match(std::string ip);
+    /**
+    * whether trie is empty, without any rule.
+    */
+    virtual bool empty();
+    /**
+    * remove all rules.
+    */
+    virtual void clear();
+private:
+    virtual void insert(std::vector<SrsCidrNode>& nodes, const unsigned char* bytes, int prefix);
+    virtual bool lookup(std::vector<SrsCidrNode>& nodes, const unsigned char* bytes, int nb_bits);
+};
+
+/**
+* the compiled security rules of vhost, the rules are compiled to the
+* prefix tries of each connection type, when load and reload config.
+*/
+class SrsSecurityRules
+{
+public:
+    SrsCidrTrie allow_play;
+    SrsCidrTrie allow_publish;
+    SrsCidrTrie deny_play;
+    SrsCidrTrie deny_publish;
+public:
+    SrsSecurityRules();
+    virtual ~SrsSecurityRules();
+public:
+    /**
+    * compile the security directive of vhost, NULL for no rules.
+    */
+    virtual void compile(SrsConfDirective* rules);
+};
+
 /**
 * the security apply on vhost.
 * @see https://github.com/ossrs/srs/issues/211
@@ -58,12 +130,68 @@ private:
     * security check the allow,
     * @return, if allowed, ERROR_SYSTEM_SECURITY_ALLOW.
     */
-    virtual int allow_check(SrsConfDirective* rules, SrsRtmpConnType type, std::string ip);
+    virtual int allow_check(SrsSecurityRules* rules, SrsRtmpConnType type, std::string ip);
     /**
     * security check the deny,
     * @return, if denied, ERROR_SYSTEM_SECURITY_DENY.
     */
-    virtual int deny_check(SrsConfDirective* rules, SrsRtmpConnType type, std::string ip);
+    virtual int deny_check(SrsSecurityRules* rules, SrsRtmpConnType type, std::string ip);
+};
+
+/**
+* the token bucket, refilled by rate tokens per second, up to burst.
+*/
+struct SrsTokenBucket
+{
+    double tokens;
+    int64_t update_at;
+};
+
+/**
+* the rate limiter of clients by ip, the connect is limited right after
+* accept, before the handshake, and the play is limited once identified,
+* so a client which connects or plays too fast never spends our cpu.
+* @remark the buckets which are refilled are removed when too many ips.
+* @remark the loopback and local ips are never limited, for the workers,
+*       edge, forward and http api of server all connect from local.
+*/
+class SrsRateLimiter
+{
+private:
+    static SrsRateLimiter* _instance;
+private:
+    std::map<std::string, SrsTokenBucket> connects;
+    std::map<std::string, SrsTokenBucket> plays;
+    int64_t sweep_at;
+    // the loopback and local ips of server, which are never limited.
+    SrsCidrTrie locals;
+public:
+    // the number of clients dropped for connect or play too fast.
+    int64_t nb_connect_drops;
+    int64_t nb_play_drops;
+public:
+    SrsRateLimiter();
+    virtual ~SrsRateLimiter();
+public:
+    static SrsRateLimiter* instance();
+public:
+    /**
+    * consume a token of connect for ip.
+    * @return ERROR_SYSTEM_RATE_LIMIT when ip connects too fast.
+    */
+    virtual int on_connect(std::string ip);
+    /**
+    * consume a token of play for ip.
+    * @return ERROR_SYSTEM_RATE_LIMIT when ip plays too fast.
+    */
+    virtual int on_play(std::string ip);
+private:
+    /**
+    * whether the ip is loopback or local ip of server.
+    */
+    virtual bool is_local(std::string ip);
+    virtual bool consume(std::map<std::string, SrsTokenBucket>& buckets, std::string ip, double rate, double burst, int64_t now);
+    virtual void sweep(std::map<std::string, SrsTokenBucket>& buckets, double rate, double burst, int64_t now);
 };
 
 #endif
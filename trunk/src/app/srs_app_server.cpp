@@ -50,6 +50,11 @@ using namespace std;
 #include <srs_core_mem_watch.hpp>
 #include <srs_kernel_consts.hpp>
 #include <srs_app_kafka.hpp>
+#include <srs_app_async_io.hpp>
+#include <srs_app_handshake.hpp>
+#include <srs_app_worker.hpp>
+#include <srs_kernel_pool.hpp>
+#include <srs_app_security.hpp>
 
 // system interval in ms,
 // all resolution times should be times togother,
@@ -108,6 +113,8 @@ std::string srs_listener_type2string(SrsListenerType type)
         return "RTSP";
     case SrsListenerFlv:
         return "HTTP-FLV";
+    case SrsListenerRtmpRelay:
+        return "RTMP-Relay";
     default:
         return "UNKONWN";
     }
@@ -129,6 +136,11 @@ SrsListenerType SrsListener::listen_type()
     return type;
 }
 
+int SrsListener::listen_port()
+{
+    return port;
+}
+
 SrsBufferListener::SrsBufferListener(SrsServer* svr, SrsListenerType t) : SrsListener(svr, t)
 {
     listener = NULL;
@@ -146,14 +158,22 @@ int SrsBufferListener::listen(string i, int p)
     ip = i;
     port = p;
 
+    // the workers share the service ports.
+    bool reuse_port = SrsWorkers::instance()->is_worker() && port > 0;
+
     srs_freep(listener);
-    listener = new SrsTcpListener(this, ip, port);
+    listener = new SrsTcpListener(this, ip, port, reuse_port);
 
     if ((ret = listener->listen()) != ERROR_SUCCESS) {
         srs_error("tcp listen failed. ret=%d", ret);
         return ret;
     }
     
+    // the port allocated by system.
+    if (port == 0) {
+        port = srs_get_local_port(listener->fd());
+    }
+    
     srs_info("listen thread current_cid=%d, "
         "listen at port=%d, type=%d, fd=%d started success, ep=%s:%d",
         _srs_context->get_id(), p, type, listener->fd(), i.c_str(), p);
@@ -184,7 +204,7 @@ SrsRtspListener::SrsRtspListener(SrsServer* svr, SrsListenerType t, SrsConfDirec
     // we just assert here for unknown stream caster.
     srs_assert(type == SrsListenerRtsp);
     if (type == SrsListenerRtsp) {
-        caster = new SrsRtspCaster(c);
+        caster = new SrsRtspCaster(svr, c);
     }
 }
 
@@ -242,7 +262,7 @@ SrsHttpFlvListener::SrsHttpFlvListener(SrsServer* svr, SrsListenerType t, SrsCon
     // we just assert here for unknown stream caster.
     srs_assert(type == SrsListenerFlv);
     if (type == SrsListenerFlv) {
-        caster = new SrsAppCasterFlv(c);
+        caster = new SrsAppCasterFlv(svr, c);
     }
 }
 
@@ -349,7 +369,7 @@ SrsUdpCasterListener::SrsUdpCasterListener(SrsServer* svr, SrsListenerType t, Sr
     // we just assert here for unknown stream caster.
     srs_assert(type == SrsListenerMpegTsOverUdp);
     if (type == SrsListenerMpegTsOverUdp) {
-        caster = new SrsMpegtsOverUdp(c);
+        caster = new SrsMpegtsOverUdp(svr, c);
     }
 }
 
@@ -554,6 +574,7 @@ void SrsServer::dispose()
     close_listeners(SrsListenerMpegTsOverUdp);
     close_listeners(SrsListenerRtsp);
     close_listeners(SrsListenerFlv);
+    close_listeners(SrsListenerRtmpRelay);
     
     // @remark don't dispose ingesters, for too slow.
     
@@ -564,6 +585,11 @@ void SrsServer::dispose()
     // dispose the source for hls and dvr.
     SrsSource::dispose_all();
     
+    // flush the files of hls and dvr to disk.
+    srs_dispose_async_io();
+    
+    srs_dispose_handshake_pool();
+    
     // @remark don't dispose all connections, for too slow.
 
 #ifdef SRS_AUTO_MEM_WATCH
@@ -643,7 +669,23 @@ int SrsServer::initialize_st()
     // set current log id.
     _srs_context->generate_id();
     
+    // the message pool of current process, never free it,
+    // for the messages maybe freed when server disposed.
+#if SRS_PERF_MESSAGE_POOL > 0
+    _srs_message_pool = new SrsMessagePool(SRS_PERF_MESSAGE_POOL);
+#endif
+    
     // initialize the conponents that depends on st.
+    if ((ret = srs_initialize_async_io()) != ERROR_SUCCESS) {
+        srs_error("initialize async io failed, ret=%d", ret);
+        return ret;
+    }
+    
+    if ((ret = srs_initialize_handshake_pool()) != ERROR_SUCCESS) {
+        srs_error("initialize handshake pool failed, ret=%d", ret);
+        return ret;
+    }
+    
 #ifdef SRS_AUTO_KAFKA
     if ((ret = srs_initialize_kafka()) != ERROR_SUCCESS) {
         srs_error("initialize kafka failed, ret=%d", ret);
@@ -815,6 +857,9 @@ int SrsServer::http_handle()
     if ((ret = http_api_mux->handle("/api/v1/features", new SrsGoApiFeatures())) != ERROR_SUCCESS) {
         return ret;
     }
+    if ((ret = http_api_mux->handle("/api/v1/dns", new SrsGoApiDns())) != ERROR_SUCCESS) {
+        return ret;
+    }
     if ((ret = http_api_mux->handle("/api/v1/vhosts/", new SrsGoApiVhosts())) != ERROR_SUCCESS) {
         return ret;
     }
@@ -863,6 +908,11 @@ int SrsServer::ingest()
     int ret = ERROR_SUCCESS;
     
 #ifdef SRS_AUTO_INGEST
+    // the ingesters only run in the primary worker.
+    if (!SrsWorkers::instance()->is_primary()) {
+        return ret;
+    }
+    
     if ((ret = ingester->start()) != ERROR_SUCCESS) {
         srs_error("start ingest streams failed. ret=%d", ret);
         return ret;
@@ -1102,6 +1152,7 @@ int SrsServer::listen_rtmp()
     srs_assert((int)ip_ports.size() > 0);
     
     close_listeners(SrsListenerRtmpStream);
+    close_listeners(SrsListenerRtmpRelay);
     
     for (int i = 0; i < (int)ip_ports.size(); i++) {
         SrsListener* listener = new SrsBufferListener(this, SrsListenerRtmpStream);
@@ -1117,6 +1168,19 @@ int SrsServer::listen_rtmp()
         }
     }
     
+    // the worker listen at a local port, for other workers to pull its streams.
+    SrsWorkers* workers = SrsWorkers::instance();
+    if (workers->is_worker()) {
+        SrsListener* listener = new SrsBufferListener(this, SrsListenerRtmpRelay);
+        listeners.push_back(listener);
+        
+        if ((ret = listener->listen("127.0.0.1", 0)) != ERROR_SUCCESS) {
+            srs_error("RTMP worker listen at local failed. ret=%d", ret);
+            return ret;
+        }
+        workers->on_local_listen(listener->listen_port());
+    }
+    
     return ret;
 }
 
@@ -1179,6 +1243,11 @@ int SrsServer::listen_stream_caster()
 #ifdef SRS_AUTO_STREAM_CASTER
     close_listeners(SrsListenerMpegTsOverUdp);
     
+    // the stream casters only run in the primary worker.
+    if (!SrsWorkers::instance()->is_primary()) {
+        return ret;
+    }
+    
     std::vector<SrsConfDirective*>::iterator it;
     std::vector<SrsConfDirective*> stream_casters = _srs_config->get_stream_casters();
 
@@ -1300,6 +1369,11 @@ SrsConnection* SrsServer::fd2conn(SrsListenerType type, st_netfd_t stfd)
         srs_info("ignore empty ip client, fd=%d.", fd);
         return NULL;
     }
+    
+    // drop the client which connects too fast, before the handshake.
+    if ((ret = SrsRateLimiter::instance()->on_connect(ip)) != ERROR_SUCCESS) {
+        return NULL;
+    }
 
     // check connection limitation.
     int max_connections = _srs_config->get_max_connections();
@@ -1334,6 +1408,10 @@ SrsConnection* SrsServer::fd2conn(SrsListenerType type, st_netfd_t stfd)
     
     if (type == SrsListenerRtmpStream) {
         conn = new SrsRtmpConn(this, stfd, ip);
+    } else if (type == SrsListenerRtmpRelay) {
+        SrsRtmpConn* relay = new SrsRtmpConn(this, stfd, ip);
+        relay->set_worker_relay();
+        conn = relay;
     } else if (type == SrsListenerHttpApi) {
 #ifdef SRS_AUTO_HTTP_API
         conn = new SrsHttpApi(this, stfd, http_api_mux, ip);
@@ -1391,6 +1469,11 @@ int SrsServer::on_reload_listen()
 
 int SrsServer::on_reload_pid()
 {
+    // the pid file is held by master of workers.
+    if (SrsWorkers::instance()->is_worker()) {
+        return ERROR_SUCCESS;
+    }
+    
     if (pid_fd > 0) {
         ::close(pid_fd);
         pid_fd = -1;
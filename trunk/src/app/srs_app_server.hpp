@@ -75,6 +75,8 @@ enum SrsListenerType
     SrsListenerRtsp             = 4,
     // TCP stream, FLV stream over HTTP.
     SrsListenerFlv              = 5,
+    // RTMP relay, the local port for other workers to pull streams.
+    SrsListenerRtmpRelay        = 6,
 };
 
 /**
@@ -93,6 +95,8 @@ public:
     virtual ~SrsListener();
 public:
     virtual SrsListenerType listen_type();
+    // get the listen port, which is allocated by system when listen at port 0.
+    virtual int listen_port();
     virtual int listen(std::string i, int p) = 0;
 };
 
@@ -47,6 +47,7 @@ using namespace std;
 #include <srs_core_autofree.hpp>
 #include <srs_protocol_utility.hpp>
 #include <srs_app_ng_exec.hpp>
+#include <srs_app_worker.hpp>
 
 #define CONST_MAX_JITTER_MS         250
 #define CONST_MAX_JITTER_MS_NEG         -250
@@ -154,17 +155,15 @@ int SrsRtmpJitter::get_time()
     return (int)last_pkt_correct_time;
 }
 
-#ifdef SRS_PERF_QUEUE_FAST_VECTOR
 SrsFastVector::SrsFastVector()
 {
-    count = 0;
-    nb_msgs = SRS_PERF_MW_MSGS * 8;
-    msgs = new SrsSharedPtrMessage*[nb_msgs];
+    head = count = 0;
+    nb_msgs = SRS_PERF_MW_MSGS * 2;
+    msgs = new SrsSharedPtrMessage[nb_msgs];
 }
 
 SrsFastVector::~SrsFastVector()
 {
-    free();
     srs_freepa(msgs);
 }
 
@@ -173,43 +172,10 @@ int SrsFastVector::size()
     return count;
 }
 
-int SrsFastVector::begin()
-{
-    return 0;
-}
-
-int SrsFastVector::end()
-{
-    return count;
-}
-
-SrsSharedPtrMessage** SrsFastVector::data()
-{
-    return msgs;
-}
-
 SrsSharedPtrMessage* SrsFastVector::at(int index)
 {
     srs_assert(index < count);
-    return msgs[index];
-}
-
-void SrsFastVector::clear()
-{
-    count = 0;
-}
-
-void SrsFastVector::erase(int _begin, int _end)
-{
-    srs_assert(_begin < _end);
-    
-    // move all erased to previous.
-    for (int i = 0; i < count - _end; i++) {
-        msgs[_begin + i] = msgs[_end + i];
-    }
-    
-    // update the count.
-    count -= _end - _begin;
+    return &msgs[(head + index) % nb_msgs];
 }
 
 void SrsFastVector::push_back(SrsSharedPtrMessage* msg)
@@ -217,36 +183,66 @@ void SrsFastVector::push_back(SrsSharedPtrMessage* msg)
     // increase vector.
     if (count >= nb_msgs) {
         int size = nb_msgs * 2;
-        SrsSharedPtrMessage** buf = new SrsSharedPtrMessage*[size];
-        for (int i = 0; i < nb_msgs; i++) {
-            buf[i] = msgs[i];
+        SrsSharedPtrMessage* buf = new SrsSharedPtrMessage[size];
+        for (int i = 0; i < count; i++) {
+            msgs[(head + i) % nb_msgs].move_to(&buf[i]);
         }
-        srs_warn("fast vector incrase %d=>%d", nb_msgs, size);
+        srs_info("fast vector incrase %d=>%d", nb_msgs, size);
         
         // use new array.
         srs_freepa(msgs);
         msgs = buf;
         nb_msgs = size;
+        head = 0;
     }
     
-    msgs[count++] = msg;
+    msg->copy_to(&msgs[(head + count) % nb_msgs]);
+    count++;
+}
+
+void SrsFastVector::pop_front(SrsSharedPtrMessage* msg)
+{
+    srs_assert(count > 0);
+    
+    msgs[head].move_to(msg);
+    head = (head + 1) % nb_msgs;
+    count--;
+}
+
+void SrsFastVector::compact(std::vector<bool>& keep)
+{
+    srs_assert((int)keep.size() == count);
+    
+    int nb_kept = 0;
+    for (int i = 0; i < count; i++) {
+        SrsSharedPtrMessage* msg = &msgs[(head + i) % nb_msgs];
+        
+        if (!keep[i]) {
+            msg->release();
+            continue;
+        }
+        
+        msg->move_to(&msgs[(head + nb_kept) % nb_msgs]);
+        nb_kept++;
+    }
+    count = nb_kept;
 }
 
 void SrsFastVector::free()
 {
     for (int i = 0; i < count; i++) {
-        SrsSharedPtrMessage* msg = msgs[i];
-        srs_freep(msg);
+        msgs[(head + i) % nb_msgs].release();
     }
-    count = 0;
+    head = count = 0;
 }
-#endif
 
 SrsMessageQueue::SrsMessageQueue(bool ignore_shrink)
 {
     _ignore_shrink = ignore_shrink;
     queue_size_ms = 0;
     av_start_time = av_end_time = -1;
+    front_index = 0;
+    wait_keyframe = false;
 }
 
 SrsMessageQueue::~SrsMessageQueue()
@@ -273,6 +269,16 @@ int SrsMessageQueue::enqueue(SrsSharedPtrMessage* msg, bool* is_overflow)
 {
     int ret = ERROR_SUCCESS;
     
+    // index the keyframe, and drop the video which depends on the dropped gop.
+    if (msg->is_video() && !SrsFlvCodec::video_is_sequence_header(msg->payload, msg->size)) {
+        if (SrsFlvCodec::video_is_keyframe(msg->payload, msg->size)) {
+            keyframes.push_back(front_index + msgs.size());
+            wait_keyframe = false;
+        } else if (wait_keyframe) {
+            return ret;
+        }
+    }
+    
     if (msg->is_av()) {
         if (av_start_time == -1) {
             av_start_time = msg->timestamp;
@@ -306,26 +312,21 @@ int SrsMessageQueue::dump_packets(int max_count, SrsSharedPtrMessage** pmsgs, in
     
     srs_assert(max_count > 0);
     count = srs_min(max_count, nb_msgs);
-
-    SrsSharedPtrMessage** omsgs = msgs.data();
+    
+    // move the msgs to the reusable objects of user, no copy and free.
     for (int i = 0; i < count; i++) {
-        pmsgs[i] = omsgs[i];
+        msgs.pop_front(pmsgs[i]);
     }
     
-    SrsSharedPtrMessage* last = omsgs[count - 1];
-    av_start_time = last->timestamp;
-    
-    if (count >= nb_msgs) {
-        // the pmsgs is big enough and clear msgs at most time.
-        msgs.clear();
-    } else {
-        // erase some vector elements may cause memory copy,
-        // maybe can use more efficient vector.swap to avoid copy.
-        // @remark for the pmsgs is big enough, for instance, SRS_PERF_MW_MSGS 128,
-        //      the rtmp play client will get 128msgs once, so this branch rarely execute.
-        msgs.erase(msgs.begin(), msgs.begin() + count);
+    // the dumped keyframes are not in queue.
+    front_index += count;
+    while (!keyframes.empty() && keyframes.front() < front_index) {
+        keyframes.pop_front();
     }
     
+    SrsSharedPtrMessage* last = pmsgs[count - 1];
+    av_start_time = last->timestamp;
+    
     return ret;
 }
 
@@ -338,9 +339,8 @@ int SrsMessageQueue::dump_packets(SrsConsumer* consumer, bool atc, SrsRtmpJitter
         return ret;
     }
 
-    SrsSharedPtrMessage** omsgs = msgs.data();
     for (int i = 0; i < nb_msgs; i++) {
-        SrsSharedPtrMessage* msg = omsgs[i];
+        SrsSharedPtrMessage* msg = msgs.at(i);
         if ((ret = consumer->enqueue(msg, atc, ag)) != ERROR_SUCCESS) {
             return ret;
         }
@@ -351,67 +351,96 @@ int SrsMessageQueue::dump_packets(SrsConsumer* consumer, bool atc, SrsRtmpJitter
 
 void SrsMessageQueue::shrink()
 {
-    SrsSharedPtrMessage* video_sh = NULL;
-    SrsSharedPtrMessage* audio_sh = NULL;
     int msgs_size = (int)msgs.size();
     
-    // remove all msg
-    // igone the sequence header
-    for (int i = 0; i < (int)msgs.size(); i++) {
+    // shrink to half of queue, to avoid shrink for each msg.
+    int64_t cut_time = av_end_time - queue_size_ms / 2;
+    
+    // resume the video at the first keyframe after the cut time.
+    int resume = msgs_size;
+    for (int i = 0; i < (int)keyframes.size(); i++) {
+        int pos = (int)(keyframes.at(i) - front_index);
+        if (msgs.at(pos)->timestamp >= cut_time) {
+            resume = pos;
+            break;
+        }
+    }
+    
+    // the last sequence headers and metadata in the dropped msgs.
+    int video_sh = -1;
+    int audio_sh = -1;
+    int metadata = -1;
+    
+    std::vector<bool> keep(msgs_size, true);
+    for (int i = 0; i < msgs_size; i++) {
         SrsSharedPtrMessage* msg = msgs.at(i);
-
-        if (msg->is_video() && SrsFlvCodec::video_is_sequence_header(msg->payload, msg->size)) {
-            srs_freep(video_sh);
-            video_sh = msg;
+        
+        // the msgs after the resume keyframe and cut time are kept.
+        if (i >= resume && msg->timestamp >= cut_time) {
             continue;
         }
-        else if (msg->is_audio() && SrsFlvCodec::audio_is_sequence_header(msg->payload, msg->size)) {
-            srs_freep(audio_sh);
-            audio_sh = msg;
-            continue;
+        
+        if (msg->is_video()) {
+            if (SrsFlvCodec::video_is_sequence_header(msg->payload, msg->size)) {
+                video_sh = i;
+            }
+            keep[i] = i >= resume;
+        } else if (msg->is_audio()) {
+            if (SrsFlvCodec::audio_is_sequence_header(msg->payload, msg->size)) {
+                audio_sh = i;
+            }
+            keep[i] = msg->timestamp >= cut_time;
+        } else {
+            metadata = i;
+            keep[i] = false;
         }
-
-        srs_freep(msg);
     }
-    msgs.clear();  
-
-    // update av_start_time
-    av_start_time = av_end_time;
-    //push_back secquence header and update timestamp
-    if (video_sh) {
-        video_sh->timestamp = av_end_time;
-        msgs.push_back(video_sh);
+    
+    // keep the sequence headers and metadata, update the timestamp.
+    int headers[] = {video_sh, audio_sh, metadata};
+    for (int i = 0; i < 3; i++) {
+        if (headers[i] >= 0 && !keep[headers[i]]) {
+            SrsSharedPtrMessage* msg = msgs.at(headers[i]);
+            msg->timestamp = srs_max(msg->timestamp, cut_time);
+            keep[headers[i]] = true;
+        }
     }
-    if (audio_sh) {
-        audio_sh->timestamp = av_end_time;
-        msgs.push_back(audio_sh);
+    
+    msgs.compact(keep);
+    
+    // rebuild the index of keyframes, which after the resume are kept.
+    keyframes.clear();
+    for (int i = 0; i < (int)msgs.size(); i++) {
+        SrsSharedPtrMessage* msg = msgs.at(i);
+        if (msg->is_video() && !SrsFlvCodec::video_is_sequence_header(msg->payload, msg->size)
+            && SrsFlvCodec::video_is_keyframe(msg->payload, msg->size)) {
+            keyframes.push_back(front_index + i);
+        }
     }
     
+    // no keyframe to resume, drop the video util next keyframe.
+    wait_keyframe = (resume == msgs_size);
+    
+    // update av_start_time
+    av_start_time = srs_max(av_start_time, cut_time);
+    
     if (_ignore_shrink) {
-        srs_info("shrink the cache queue, size=%d, removed=%d, max=%.2f", 
-            (int)msgs.size(), msgs_size - (int)msgs.size(), queue_size_ms / 1000.0);
+        srs_info("shrink the cache queue, size=%d, removed=%d, max=%.2f, wait_keyframe=%d", 
+            (int)msgs.size(), msgs_size - (int)msgs.size(), queue_size_ms / 1000.0, wait_keyframe);
     } else {
-        srs_trace("shrink the cache queue, size=%d, removed=%d, max=%.2f", 
-            (int)msgs.size(), msgs_size - (int)msgs.size(), queue_size_ms / 1000.0);
+        srs_trace("shrink the cache queue, size=%d, removed=%d, max=%.2f, wait_keyframe=%d", 
+            (int)msgs.size(), msgs_size - (int)msgs.size(), queue_size_ms / 1000.0, wait_keyframe);
     }
 }
 
 void SrsMessageQueue::clear()
 {
-#ifndef SRS_PERF_QUEUE_FAST_VECTOR
-    std::vector<SrsSharedPtrMessage*>::iterator it;
-
-    for (it = msgs.begin(); it != msgs.end(); ++it) {
-        SrsSharedPtrMessage* msg = *it;
-        srs_freep(msg);
-    }
-#else
     msgs.free();
-#endif
-
-    msgs.clear();
     
     av_start_time = av_end_time = -1;
+    front_index = 0;
+    keyframes.clear();
+    wait_keyframe = false;
 }
 
 ISrsWakable::ISrsWakable()
@@ -469,22 +498,24 @@ int SrsConsumer::enqueue(SrsSharedPtrMessage* shared_msg, bool atc, SrsRtmpJitte
 {
     int ret = ERROR_SUCCESS;
     
-    SrsSharedPtrMessage* msg = shared_msg->copy();
+    // the msg on stack holds a reference of payload with the corrected timestamp,
+    // the queue copy the reference to its slot, so no msg object is allocated.
+    SrsSharedPtrMessage msg;
+    shared_msg->copy_to(&msg);
 
     if (!atc) {
-        if ((ret = jitter->correct(msg, ag)) != ERROR_SUCCESS) {
-            srs_freep(msg);
+        if ((ret = jitter->correct(&msg, ag)) != ERROR_SUCCESS) {
             return ret;
         }
     }
     
-    if ((ret = queue->enqueue(msg, NULL)) != ERROR_SUCCESS) {
+    if ((ret = queue->enqueue(&msg, NULL)) != ERROR_SUCCESS) {
         return ret;
     }
     
 #ifdef SRS_PERF_QUEUE_COND_WAIT
     srs_verbose("enqueue msg, time=%"PRId64", size=%d, duration=%d, waiting=%d, min_msg=%d", 
-        msg->timestamp, msg->size, queue->duration(), mw_waiting, mw_min_msgs);
+        msg.timestamp, msg.size, queue->duration(), mw_waiting, mw_min_msgs);
         
     // fire the mw when msgs is enough.
     if (mw_waiting) {
@@ -925,6 +956,7 @@ SrsSharedPtrMessage* SrsMixQueue::pop()
 SrsSource::SrsSource()
 {
     req = NULL;
+    vconf = NULL;
     jitter_algorithm = SrsRtmpJitterAlgorithmOFF;
     mix_correct = false;
     mix_queue = new SrsMixQueue();
@@ -945,6 +977,7 @@ SrsSource::SrsSource()
     cache_metadata = cache_sh_video = cache_sh_audio = NULL;
     
     _can_publish = true;
+    worker_relay = false;
     _pre_source_id = _source_id = -1;
     die_at = -1;
     
@@ -1030,6 +1063,12 @@ int SrsSource::cycle()
     }
 #endif
     
+    // the player maybe waiting for the stream publish to other worker.
+    if ((ret = worker_relay_play()) != ERROR_SUCCESS) {
+        srs_warn("ignore worker relay failed. ret=%d", ret);
+        ret = ERROR_SUCCESS;
+    }
+    
     return ret;
 }
 
@@ -1067,7 +1106,8 @@ int SrsSource::initialize(SrsRequest* r, ISrsSourceHandler* h)
 
     handler = h;
     req = r->copy();
-    atc = _srs_config->get_atc(req->vhost);
+    vconf = _srs_config->get_vhost_config(req->vhost);
+    atc = vconf->atc;
 
 #ifdef SRS_AUTO_HLS
     if ((ret = hls->initialize(this, req)) != ERROR_SUCCESS) {
@@ -1498,8 +1538,8 @@ int SrsSource::on_meta_data(SrsCommonMessage* msg, SrsOnMetaDataPacket* metadata
     metadata->metadata->set("server_version", SrsAmf0Any::str(RTMP_SIG_SRS_VERSION));
     
     // if allow atc_auto and bravo-atc detected, open atc for vhost.
-    atc = _srs_config->get_atc(req->vhost);
-    if (_srs_config->get_atc_auto(req->vhost)) {
+    atc = vconf->atc;
+    if (vconf->atc_auto) {
         if ((prop = metadata->metadata->get_property("bravo_atc")) != NULL) {
             if (prop->is_string() && prop->to_str() == "true") {
                 atc = true;
@@ -1524,7 +1564,7 @@ int SrsSource::on_meta_data(SrsCommonMessage* msg, SrsOnMetaDataPacket* metadata
     
     // when already got metadata, drop when reduce sequence header.
     bool drop_for_reduce = false;
-    if (cache_metadata && _srs_config->get_reduce_sequence_header(req->vhost)) {
+    if (cache_metadata && vconf->reduce_sequence_header) {
         drop_for_reduce = true;
         srs_warn("drop for reduce sh metadata, size=%d", msg->size);
     }
@@ -1572,15 +1612,6 @@ int SrsSource::on_audio(SrsCommonMessage* shared_audio)
 {
     int ret = ERROR_SUCCESS;
     
-    // monotically increase detect.
-    if (!mix_correct && is_monotonically_increase) {
-        if (last_packet_time > 0 && shared_audio->header.timestamp < last_packet_time) {
-            is_monotonically_increase = false;
-            srs_warn("AUDIO: stream not monotonically increase, please open mix_correct.");
-        }
-    }
-    last_packet_time = shared_audio->header.timestamp;
-    
     // convert shared_audio to msg, user should not use shared_audio again.
     // the payload is transfer to msg, and set to NULL in shared_audio.
     SrsSharedPtrMessage msg;
@@ -1588,15 +1619,31 @@ int SrsSource::on_audio(SrsCommonMessage* shared_audio)
         srs_error("initialize the audio failed. ret=%d", ret);
         return ret;
     }
-    srs_info("Audio dts=%"PRId64", size=%d", msg.timestamp, msg.size);
+    
+    return on_audio(&msg);
+}
+
+int SrsSource::on_audio(SrsSharedPtrMessage* msg)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // monotically increase detect.
+    if (!mix_correct && is_monotonically_increase) {
+        if (last_packet_time > 0 && msg->timestamp < last_packet_time) {
+            is_monotonically_increase = false;
+            srs_warn("AUDIO: stream not monotonically increase, please open mix_correct.");
+        }
+    }
+    last_packet_time = msg->timestamp;
+    srs_info("Audio dts=%"PRId64", size=%d", msg->timestamp, msg->size);
     
     // directly process the audio message.
     if (!mix_correct) {
-        return on_audio_imp(&msg);
+        return on_audio_imp(msg);
     }
     
     // insert msg to the queue.
-    mix_queue->push(msg.copy());
+    mix_queue->push(msg->copy());
     
     // fetch someone from mix queue.
     SrsSharedPtrMessage* m = mix_queue->pop();
@@ -1643,7 +1690,7 @@ int SrsSource::on_audio_imp(SrsSharedPtrMessage* msg)
     
     // whether consumer should drop for the duplicated sequence header.
     bool drop_for_reduce = false;
-    if (is_sequence_header && cache_sh_audio && _srs_config->get_reduce_sequence_header(req->vhost)) {
+    if (is_sequence_header && cache_sh_audio && vconf->reduce_sequence_header) {
         if (cache_sh_audio->size == msg->size) {
             drop_for_reduce = srs_bytes_equals(cache_sh_audio->payload, msg->payload, msg->size);
             srs_warn("drop for reduce sh audio, size=%d", msg->size);
@@ -1683,7 +1730,7 @@ int SrsSource::on_audio_imp(SrsSharedPtrMessage* msg)
     if ((ret = hls->on_audio(msg)) != ERROR_SUCCESS) {
         // apply the error strategy for hls.
         // @see https://github.com/ossrs/srs/issues/264
-        std::string hls_error_strategy = _srs_config->get_hls_on_error(req->vhost);
+        std::string hls_error_strategy = vconf->hls_on_error;
         if (srs_config_hls_is_on_error_ignore(hls_error_strategy)) {
             srs_warn("hls process audio message failed, ignore and disable hls. ret=%d", ret);
             
@@ -1790,43 +1837,50 @@ int SrsSource::on_video(SrsCommonMessage* shared_video)
 {
     int ret = ERROR_SUCCESS;
     
+    // convert shared_video to msg, user should not use shared_video again.
+    // the payload is transfer to msg, and set to NULL in shared_video.
+    SrsSharedPtrMessage msg;
+    if ((ret = msg.create(shared_video)) != ERROR_SUCCESS) {
+        srs_error("initialize the video failed. ret=%d", ret);
+        return ret;
+    }
+    
+    return on_video(&msg);
+}
+
+int SrsSource::on_video(SrsSharedPtrMessage* msg)
+{
+    int ret = ERROR_SUCCESS;
+    
     // monotically increase detect.
     if (!mix_correct && is_monotonically_increase) {
-        if (last_packet_time > 0 && shared_video->header.timestamp < last_packet_time) {
+        if (last_packet_time > 0 && msg->timestamp < last_packet_time) {
             is_monotonically_increase = false;
             srs_warn("VIDEO: stream not monotonically increase, please open mix_correct.");
         }
     }
-    last_packet_time = shared_video->header.timestamp;
+    last_packet_time = msg->timestamp;
     
     // drop any unknown header video.
     // @see https://github.com/ossrs/srs/issues/421
-    if (!SrsFlvCodec::video_is_acceptable(shared_video->payload, shared_video->size)) {
+    if (!SrsFlvCodec::video_is_acceptable(msg->payload, msg->size)) {
         char b0 = 0x00;
-        if (shared_video->size > 0) {
-            b0 = shared_video->payload[0];
+        if (msg->size > 0) {
+            b0 = msg->payload[0];
         }
         
-        srs_warn("drop unknown header video, size=%d, bytes[0]=%#x", shared_video->size, b0);
-        return ret;
-    }
-    
-    // convert shared_video to msg, user should not use shared_video again.
-    // the payload is transfer to msg, and set to NULL in shared_video.
-    SrsSharedPtrMessage msg;
-    if ((ret = msg.create(shared_video)) != ERROR_SUCCESS) {
-        srs_error("initialize the video failed. ret=%d", ret);
+        srs_warn("drop unknown header video, size=%d, bytes[0]=%#x", msg->size, b0);
         return ret;
     }
-    srs_info("Video dts=%"PRId64", size=%d", msg.timestamp, msg.size);
+    srs_info("Video dts=%"PRId64", size=%d", msg->timestamp, msg->size);
     
     // directly process the audio message.
     if (!mix_correct) {
-        return on_video_imp(&msg);
+        return on_video_imp(msg);
     }
     
     // insert msg to the queue.
-    mix_queue->push(msg.copy());
+    mix_queue->push(msg->copy());
     
     // fetch someone from mix queue.
     SrsSharedPtrMessage* m = mix_queue->pop();
@@ -1856,7 +1910,7 @@ int SrsSource::on_video_imp(SrsSharedPtrMessage* msg)
     
     // whether consumer should drop for the duplicated sequence header.
     bool drop_for_reduce = false;
-    if (is_sequence_header && cache_sh_video && _srs_config->get_reduce_sequence_header(req->vhost)) {
+    if (is_sequence_header && cache_sh_video && vconf->reduce_sequence_header) {
         if (cache_sh_video->size == msg->size) {
             drop_for_reduce = srs_bytes_equals(cache_sh_video->payload, msg->payload, msg->size);
             srs_warn("drop for reduce sh video, size=%d", msg->size);
@@ -1874,7 +1928,7 @@ int SrsSource::on_video_imp(SrsSharedPtrMessage* msg)
         
         // user can disable the sps parse to workaround when parse sps failed.
         // @see https://github.com/ossrs/srs/issues/474
-        codec.avc_parse_sps = _srs_config->get_parse_sps(req->vhost);
+        codec.avc_parse_sps = vconf->parse_sps;
         
         SrsCodecSample sample;
         if ((ret = codec.video_avc_demux(msg->payload, msg->size, &sample)) != ERROR_SUCCESS) {
@@ -1899,7 +1953,7 @@ int SrsSource::on_video_imp(SrsSharedPtrMessage* msg)
     if ((ret = hls->on_video(msg, is_sequence_header)) != ERROR_SUCCESS) {
         // apply the error strategy for hls.
         // @see https://github.com/ossrs/srs/issues/264
-        std::string hls_error_strategy = _srs_config->get_hls_on_error(req->vhost);
+        std::string hls_error_strategy = vconf->hls_on_error;
         if (srs_config_hls_is_on_error_ignore(hls_error_strategy)) {
             srs_warn("hls process video message failed, ignore and disable hls. ret=%d", ret);
             
@@ -2124,46 +2178,50 @@ int SrsSource::on_publish()
     is_monotonically_increase = true;
     last_packet_time = 0;
     
-    // create forwarders
-    if ((ret = create_forwarders()) != ERROR_SUCCESS) {
-        srs_error("create forwarders failed. ret=%d", ret);
-        return ret;
-    }
+    // the worker which owns the stream delivers it to other services,
+    // the relay worker only serve its players.
+    if (!worker_relay) {
+        // create forwarders
+        if ((ret = create_forwarders()) != ERROR_SUCCESS) {
+            srs_error("create forwarders failed. ret=%d", ret);
+            return ret;
+        }
     
-    // TODO: FIXME: use initialize to set req.
+        // TODO: FIXME: use initialize to set req.
 #ifdef SRS_AUTO_TRANSCODE
-    if ((ret = encoder->on_publish(req)) != ERROR_SUCCESS) {
-        srs_error("start encoder failed. ret=%d", ret);
-        return ret;
-    }
+        if ((ret = encoder->on_publish(req)) != ERROR_SUCCESS) {
+            srs_error("start encoder failed. ret=%d", ret);
+            return ret;
+        }
 #endif
     
 #ifdef SRS_AUTO_HLS
-    if ((ret = hls->on_publish(false)) != ERROR_SUCCESS) {
-        srs_error("start hls failed. ret=%d", ret);
-        return ret;
-    }
+        if ((ret = hls->on_publish(false)) != ERROR_SUCCESS) {
+            srs_error("start hls failed. ret=%d", ret);
+            return ret;
+        }
 #endif
     
 #ifdef SRS_AUTO_DVR
-    if ((ret = dvr->on_publish(false)) != ERROR_SUCCESS) {
-        srs_error("start dvr failed. ret=%d", ret);
-        return ret;
-    }
+        if ((ret = dvr->on_publish(false)) != ERROR_SUCCESS) {
+            srs_error("start dvr failed. ret=%d", ret);
+            return ret;
+        }
 #endif
     
-    // TODO: FIXME: use initialize to set req.
+        // TODO: FIXME: use initialize to set req.
 #ifdef SRS_AUTO_HDS
-    if ((ret = hds->on_publish(req)) != ERROR_SUCCESS) {
-        srs_error("start hds failed. ret=%d", ret);
-        return ret;
-    }
+        if ((ret = hds->on_publish(req)) != ERROR_SUCCESS) {
+            srs_error("start hds failed. ret=%d", ret);
+            return ret;
+        }
 #endif
     
-    // TODO: FIXME: use initialize to set req.
-    if ((ret = ng_exec->on_publish(req)) != ERROR_SUCCESS) {
-        srs_error("start exec failed. ret=%d", ret);
-        return ret;
+        // TODO: FIXME: use initialize to set req.
+        if ((ret = ng_exec->on_publish(req)) != ERROR_SUCCESS) {
+            srs_error("start exec failed. ret=%d", ret);
+            return ret;
+        }
     }
 
     // notify the handler.
@@ -2185,26 +2243,29 @@ void SrsSource::on_unpublish()
         return;
     }
     
-    // destroy all forwarders
-    destroy_forwarders();
+    if (!worker_relay) {
+        // destroy all forwarders
+        destroy_forwarders();
 
 #ifdef SRS_AUTO_TRANSCODE
-    encoder->on_unpublish();
+        encoder->on_unpublish();
 #endif
 
 #ifdef SRS_AUTO_HLS
-    hls->on_unpublish();
+        hls->on_unpublish();
 #endif
     
 #ifdef SRS_AUTO_DVR
-    dvr->on_unpublish();
+        dvr->on_unpublish();
 #endif
 
 #ifdef SRS_AUTO_HDS
-    hds->on_unpublish();
+        hds->on_unpublish();
 #endif
     
-    ng_exec->on_unpublish();
+        ng_exec->on_unpublish();
+    }
+    worker_relay = false;
 
     // only clear the gop cache,
     // donot clear the sequence header, for it maybe not changed,
@@ -2293,6 +2354,9 @@ int SrsSource::create_consumer(SrsConnection* conn, SrsConsumer*& consumer, bool
             srs_error("notice edge start play stream failed. ret=%d", ret);
             return ret;
         }
+    } else if ((ret = worker_relay_play()) != ERROR_SUCCESS) {
+        srs_error("notice worker relay stream failed. ret=%d", ret);
+        return ret;
     }
     
     return ret;
@@ -2310,6 +2374,9 @@ void SrsSource::on_consumer_destroy(SrsConsumer* consumer)
     if (consumers.empty()) {
         play_edge->on_all_client_stop();
         die_at = srs_get_system_time_ms();
+        
+        // the relay stopped, pull again when player comes.
+        worker_relay = false;
     }
 }
 
@@ -2338,6 +2405,40 @@ void SrsSource::on_edge_proxy_unpublish()
     publish_edge->on_proxy_unpublish();
 }
 
+int SrsSource::worker_relay_play()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // ignore when publishing or relaying, or no player.
+    if (worker_relay || vconf->is_edge || !_can_publish || consumers.empty()) {
+        return ret;
+    }
+    
+    // ignore when not published, or published in current worker.
+    int port = SrsWorkers::instance()->owner_port(req);
+    if (port <= 0) {
+        return ret;
+    }
+    
+    srs_trace("worker relay %s from tcp://127.0.0.1:%d", req->get_stream_url().c_str(), port);
+    
+    // pull the stream like edge, which is stopped when all players quit.
+    worker_relay = true;
+    if ((ret = play_edge->on_client_play()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    return ret;
+}
+
+void SrsSource::worker_relay_stop()
+{
+    if (worker_relay) {
+        play_edge->on_all_client_stop();
+    }
+    worker_relay = false;
+}
+
 int SrsSource::create_forwarders()
 {
     int ret = ERROR_SUCCESS;
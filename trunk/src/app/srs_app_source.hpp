@@ -32,6 +32,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <map>
 #include <vector>
+#include <deque>
 #include <string>
 
 #include <srs_app_st.hpp>
@@ -53,6 +54,7 @@ class SrsEdgeProxyContext;
 class SrsMessageArray;
 class SrsNgExec;
 class SrsConnection;
+class SrsVhostConfig;
 #ifdef SRS_AUTO_HLS
 class SrsHls;
 #endif
@@ -105,37 +107,53 @@ public:
     virtual int get_time();
 };
 
-#ifdef SRS_PERF_QUEUE_FAST_VECTOR
 /**
 * to alloc and increase fixed space,
 * fast remove and insert for msgs sender.
+* the msgs are stored by value in a ring, each slot is a reference
+* to the shared payload, so push and pop never alloc message object.
 * @see https://github.com/ossrs/srs/issues/251
 */
 class SrsFastVector
 {
 private:
-    SrsSharedPtrMessage** msgs;
+    // the ring of msgs, the slots in [head, head+count) are in use.
+    SrsSharedPtrMessage* msgs;
     int nb_msgs;
+    int head;
     int count;
 public:
     SrsFastVector();
     virtual ~SrsFastVector();
 public:
     virtual int size();
-    virtual int begin();
-    virtual int end();
-    virtual SrsSharedPtrMessage** data();
+    /**
+    * get the msg at index from front.
+    * @remark the msg is owned by vector, user never free it.
+    */
     virtual SrsSharedPtrMessage* at(int index);
-    virtual void clear();
-    virtual void erase(int _begin, int _end);
+    /**
+    * copy a reference of msg to the back, user still owns the msg.
+    */
     virtual void push_back(SrsSharedPtrMessage* msg);
+    /**
+    * move the front msg to the reusable msg of user, and remove it.
+    */
+    virtual void pop_front(SrsSharedPtrMessage* msg);
+    /**
+    * release the msgs which are not kept, the order of msgs is kept.
+    * @param keep the flags of msgs from front, false to release it.
+    */
+    virtual void compact(std::vector<bool>& keep);
+    /**
+    * release all msgs.
+    */
     virtual void free();
 };
-#endif
 
 /**
 * the message queue for the consumer(client), forwarder.
-* we limit the size in seconds, drop old messages(the whole gop) if full.
+* we limit the size in seconds, drop old messages(the gop aware) if full.
 */
 class SrsMessageQueue
 {
@@ -144,11 +162,13 @@ private:
     int64_t av_start_time;
     int64_t av_end_time;
     int queue_size_ms;
-#ifdef SRS_PERF_QUEUE_FAST_VECTOR
     SrsFastVector msgs;
-#else
-    std::vector<SrsSharedPtrMessage*> msgs;
-#endif
+    // the absolute index of the front msg, increased when dump msgs.
+    int64_t front_index;
+    // the absolute index of video keyframes in queue, from front.
+    std::deque<int64_t> keyframes;
+    // whether drop the video util keyframe, when shrink dropped the gop.
+    bool wait_keyframe;
 public:
     SrsMessageQueue(bool ignore_shrink = false);
     virtual ~SrsMessageQueue();
@@ -169,13 +189,15 @@ public:
 public:
     /**
     * enqueue the message, the timestamp always monotonically.
-    * @param msg, the msg to enqueue, user never free it whatever the return code.
+    * @param msg, the msg to enqueue, the queue copy a reference of it,
+    *       so user still owns the msg and should free it whatever the return code.
     * @param is_overflow, whether overflow and shrinked. NULL to ignore.
     */
     virtual int enqueue(SrsSharedPtrMessage* msg, bool* is_overflow = NULL);
     /**
      * get packets in consumer queue.
-     * @pmsgs SrsSharedPtrMessage*[], used to store the msgs, user must alloc it.
+     * @pmsgs SrsSharedPtrMessage*[], used to store the msgs, user must alloc it,
+     *       the msgs in queue are moved to the objects of pmsgs, @see SrsMessageArray.
      * @count the count in array, output param.
      * @max_count the max count to dequeue, must be positive.
      */
@@ -187,8 +209,12 @@ public:
     virtual int dump_packets(SrsConsumer* consumer, bool atc, SrsRtmpJitterAlgorithm ag);
 private:
     /**
-    * remove a gop from the front.
-    * if no iframe found, clear it.
+    * drop the old msgs to half of queue size, the gop aware:
+    * 1. drop the whole gops which is older than the cut time.
+    * 2. drop the video of the gop which cross the cut time, resume at next keyframe.
+    * 3. keep the audio after the cut time flowing.
+    * 4. keep the last sequence headers and metadata.
+    * if no keyframe after the cut time, drop video util the next keyframe enqueued.
     */
     virtual void shrink();
 public:
@@ -456,6 +482,8 @@ private:
     int _pre_source_id;
     // deep copy of client request.
     SrsRequest* req;
+    // the compiled config of vhost, for the hot path.
+    SrsVhostConfig* vconf;
     // to delivery stream to clients.
     std::vector<SrsConsumer*> consumers;
     // the time jitter algorithm for vhost.
@@ -509,6 +537,8 @@ private:
     * can publish, true when is not streaming
     */
     bool _can_publish;
+    // whether the stream is pulled from the worker which owns it.
+    bool worker_relay;
     // last die time, when all consumers quit and no publisher,
     // we will remove the source when source die.
     int64_t die_at;
@@ -560,10 +590,20 @@ public:
     virtual int on_meta_data(SrsCommonMessage* msg, SrsOnMetaDataPacket* metadata);
 public:
     virtual int on_audio(SrsCommonMessage* audio);
+    /**
+     * feed the shared audio, for the caster which publish in process.
+     * @remark the msg is copied when used, user should free it.
+     */
+    virtual int on_audio(SrsSharedPtrMessage* audio);
 private:
     virtual int on_audio_imp(SrsSharedPtrMessage* audio);
 public:
     virtual int on_video(SrsCommonMessage* video);
+    /**
+     * feed the shared video, for the caster which publish in process.
+     * @remark the msg is copied when used, user should free it.
+     */
+    virtual int on_video(SrsSharedPtrMessage* video);
 private:
     virtual int on_video_imp(SrsSharedPtrMessage* video);
 public:
@@ -599,6 +639,10 @@ public:
     virtual int on_edge_proxy_publish(SrsCommonMessage* msg);
     // for edge, proxy stop publish
     virtual void on_edge_proxy_unpublish();
+    // for workers, pull the stream from the owner worker when got players.
+    virtual int worker_relay_play();
+    // for workers, stop pull stream when publish to current worker.
+    virtual void worker_relay_stop();
 private:
     virtual int create_forwarders();
     virtual void destroy_forwarders();
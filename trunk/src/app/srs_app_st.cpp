@@ -23,6 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_app_st.hpp>
 
+#include <poll.h>
+#ifdef SRS_PERF_HTTP_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
 #include <string>
 using namespace std;
 
@@ -421,6 +426,57 @@ int SrsStSocket::writev(const iovec *iov, int iov_size, ssize_t* nwrite)
     return ret;
 }
 
+#ifdef SRS_PERF_HTTP_SENDFILE
+int SrsStSocket::sendfile(int fd, int64_t offset, int64_t size, ssize_t* nwrite)
+{
+    int ret = ERROR_SUCCESS;
+    
+    int osfd = st_netfd_fileno(stfd);
+    off_t pos = (off_t)offset;
+    int64_t left = size;
+    
+    while (left > 0) {
+        ssize_t nb_write = ::sendfile(osfd, fd, &pos, (size_t)left);
+        
+        if (nb_write > 0) {
+            left -= nb_write;
+            send_bytes += nb_write;
+            continue;
+        }
+        
+        // the file is truncated.
+        if (nb_write == 0) {
+            ret = ERROR_SOCKET_WRITE;
+            srs_warn("sendfile eof, left=%"PRId64", ret=%d", left, ret);
+            break;
+        }
+        
+        if (errno == EINTR) {
+            continue;
+        }
+        
+        // the socket is not writable, wait in st.
+        if (errno == EAGAIN) {
+            if (st_netfd_poll(stfd, POLLOUT, send_timeout) == 0) {
+                continue;
+            }
+            // @see https://github.com/ossrs/srs/issues/200
+            ret = (errno == ETIME)? ERROR_SOCKET_TIMEOUT : ERROR_SOCKET_WRITE;
+            break;
+        }
+        
+        ret = ERROR_SOCKET_WRITE;
+        break;
+    }
+    
+    if (nwrite) {
+        *nwrite = (ssize_t)(size - left);
+    }
+    
+    return ret;
+}
+#endif
+
 SrsTcpClient::SrsTcpClient()
 {
     io = NULL;
@@ -468,6 +524,21 @@ void SrsTcpClient::close()
     srs_close_stfd(stfd);
 }
 
+bool SrsTcpClient::is_broken()
+{
+    if (!io) {
+        return true;
+    }
+    
+    // poll without timeout, never switch st thread.
+    pollfd pfd;
+    pfd.fd = st_netfd_fileno(stfd);
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    
+    return ::poll(&pfd, 1, 0) != 0;
+}
+
 bool SrsTcpClient::is_never_timeout(int64_t timeout_us)
 {
     return io->is_never_timeout(timeout_us);
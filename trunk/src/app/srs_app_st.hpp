@@ -36,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_app_st.hpp>
 #include <srs_protocol_io.hpp>
+#include <srs_core_performance.hpp>
 
 // the internal classes, user should never use it.
 // user should use the public classes at the bellow:
@@ -202,6 +203,14 @@ public:
      */
     virtual int write(void* buf, size_t size, ssize_t* nwrite);
     virtual int writev(const iovec *iov, int iov_size, ssize_t* nwrite);
+#ifdef SRS_PERF_HTTP_SENDFILE
+    /**
+     * send size bytes of file fd from offset, by sendfile,
+     * wait in st when the socket is not writable.
+     * @param nwrite, the actual write bytes, ignore if NULL.
+     */
+    virtual int sendfile(int fd, int64_t offset, int64_t size, ssize_t* nwrite);
+#endif
 };
 
 /**
@@ -235,6 +244,12 @@ public:
      * @remark ignore when closed.
      */
     virtual void close();
+    /**
+     * whether the idle connection is broken, that is, readable without any
+     * request sent, which is closed or reset by server, or got garbage.
+     * @remark return true when not connected.
+     */
+    virtual bool is_broken();
 // interface ISrsProtocolReaderWriter
 public:
     virtual bool is_never_timeout(int64_t timeout_us);
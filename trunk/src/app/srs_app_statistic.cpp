@@ -34,6 +34,7 @@ using namespace std;
 #include <srs_app_config.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_protocol_amf0.hpp>
+#include <srs_core_performance.hpp>
 
 int64_t srs_gvid = getpid() * 3;
 
@@ -58,7 +59,7 @@ SrsStatisticVhost::~SrsStatisticVhost()
     srs_freep(kbps);
 }
 
-int SrsStatisticVhost::dumps(SrsJsonObject* obj)
+int SrsStatisticVhost::dumps(SrsJsonWriter* w)
 {
     int ret = ERROR_SUCCESS;
     
@@ -66,27 +67,31 @@ int SrsStatisticVhost::dumps(SrsJsonObject* obj)
     bool hls_enabled = _srs_config->get_hls_enabled(vhost);
     bool enabled = _srs_config->get_vhost_enabled(vhost);
     
-    obj->set("id", SrsJsonAny::integer(id));
-    obj->set("name", SrsJsonAny::str(vhost.c_str()));
-    obj->set("enabled", SrsJsonAny::boolean(enabled));
-    obj->set("clients", SrsJsonAny::integer(nb_clients));
-    obj->set("streams", SrsJsonAny::integer(nb_streams));
-    obj->set("send_bytes", SrsJsonAny::integer(kbps->get_send_bytes()));
-    obj->set("recv_bytes", SrsJsonAny::integer(kbps->get_recv_bytes()));
-    
-    SrsJsonObject* okbps = SrsJsonAny::object();
-    obj->set("kbps", okbps);
-    
-    okbps->set("recv_30s", SrsJsonAny::integer(kbps->get_recv_kbps_30s()));
-    okbps->set("send_30s", SrsJsonAny::integer(kbps->get_send_kbps_30s()));
-    
-    SrsJsonObject* hls = SrsJsonAny::object();
-    obj->set("hls", hls);
-    
-    hls->set("enabled", SrsJsonAny::boolean(hls_enabled));
+    w->object_start();
+    
+    w->field_integer("id", id);
+    w->field_str("name", vhost);
+    w->field_boolean("enabled", enabled);
+    w->field_integer("clients", nb_clients);
+    w->field_integer("streams", nb_streams);
+    w->field_integer("send_bytes", kbps->get_send_bytes());
+    w->field_integer("recv_bytes", kbps->get_recv_bytes());
+    
+    w->key("kbps");
+    w->object_start();
+    w->field_integer("recv_30s", kbps->get_recv_kbps_30s());
+    w->field_integer("send_30s", kbps->get_send_kbps_30s());
+    w->object_end();
+    
+    w->key("hls");
+    w->object_start();
+    w->field_boolean("enabled", hls_enabled);
     if (hls_enabled) {
-        hls->set("fragment", SrsJsonAny::number(_srs_config->get_hls_fragment(vhost)));
+        w->field_number("fragment", _srs_config->get_hls_fragment(vhost));
     }
+    w->object_end();
+    
+    w->object_end();
     
     return ret;
 }
@@ -122,56 +127,60 @@ SrsStatisticStream::~SrsStatisticStream()
     srs_freep(kbps);
 }
 
-int SrsStatisticStream::dumps(SrsJsonObject* obj)
+int SrsStatisticStream::dumps(SrsJsonWriter* w)
 {
     int ret = ERROR_SUCCESS;
     
-    obj->set("id", SrsJsonAny::integer(id));
-    obj->set("name", SrsJsonAny::str(stream.c_str()));
-    obj->set("vhost", SrsJsonAny::integer(vhost->id));
-    obj->set("app", SrsJsonAny::str(app.c_str()));
-    obj->set("live_ms", SrsJsonAny::integer(srs_get_system_time_ms()));
-    obj->set("clients", SrsJsonAny::integer(nb_clients));
-    obj->set("send_bytes", SrsJsonAny::integer(kbps->get_send_bytes()));
-    obj->set("recv_bytes", SrsJsonAny::integer(kbps->get_recv_bytes()));
-    
-    SrsJsonObject* okbps = SrsJsonAny::object();
-    obj->set("kbps", okbps);
-    
-    okbps->set("recv_30s", SrsJsonAny::integer(kbps->get_recv_kbps_30s()));
-    okbps->set("send_30s", SrsJsonAny::integer(kbps->get_send_kbps_30s()));
-    
-    SrsJsonObject* publish = SrsJsonAny::object();
-    obj->set("publish", publish);
-    
-    publish->set("active", SrsJsonAny::boolean(active));
-    publish->set("cid", SrsJsonAny::integer(connection_cid));
+    w->object_start();
+    
+    w->field_integer("id", id);
+    w->field_str("name", stream);
+    w->field_integer("vhost", vhost->id);
+    w->field_str("app", app);
+    w->field_integer("live_ms", srs_get_system_time_ms());
+    w->field_integer("clients", nb_clients);
+    w->field_integer("send_bytes", kbps->get_send_bytes());
+    w->field_integer("recv_bytes", kbps->get_recv_bytes());
+    
+    w->key("kbps");
+    w->object_start();
+    w->field_integer("recv_30s", kbps->get_recv_kbps_30s());
+    w->field_integer("send_30s", kbps->get_send_kbps_30s());
+    w->object_end();
+    
+    w->key("publish");
+    w->object_start();
+    w->field_boolean("active", active);
+    w->field_integer("cid", connection_cid);
+    w->object_end();
     
     if (!has_video) {
-        obj->set("video", SrsJsonAny::null());
+        w->field_null("video");
     } else {
-        SrsJsonObject* video = SrsJsonAny::object();
-        obj->set("video", video);
-        
-        video->set("codec", SrsJsonAny::str(srs_codec_video2str(vcodec).c_str()));
-        video->set("profile", SrsJsonAny::str(srs_codec_avc_profile2str(avc_profile).c_str()));
-        video->set("level", SrsJsonAny::str(srs_codec_avc_level2str(avc_level).c_str()));
-        video->set("width", SrsJsonAny::integer(width));
-        video->set("height", SrsJsonAny::integer(height));
+        w->key("video");
+        w->object_start();
+        w->field_str("codec", srs_codec_video2str(vcodec));
+        w->field_str("profile", srs_codec_avc_profile2str(avc_profile));
+        w->field_str("level", srs_codec_avc_level2str(avc_level));
+        w->field_integer("width", width);
+        w->field_integer("height", height);
+        w->object_end();
     }
     
     if (!has_audio) {
-        obj->set("audio", SrsJsonAny::null());
+        w->field_null("audio");
     } else {
-        SrsJsonObject* audio = SrsJsonAny::object();
-        obj->set("audio", audio);
-        
-        audio->set("codec", SrsJsonAny::str(srs_codec_audio2str(acodec).c_str()));
-        audio->set("sample_rate", SrsJsonAny::integer(flv_sample_rates[asample_rate]));
-        audio->set("channel", SrsJsonAny::integer(asound_type + 1));
-        audio->set("profile", SrsJsonAny::str(srs_codec_aac_object2str(aac_object).c_str()));
+        w->key("audio");
+        w->object_start();
+        w->field_str("codec", srs_codec_audio2str(acodec));
+        w->field_integer("sample_rate", flv_sample_rates[asample_rate]);
+        w->field_integer("channel", asound_type + 1);
+        w->field_str("profile", srs_codec_aac_object2str(aac_object));
+        w->object_end();
     }
     
+    w->object_end();
+    
     return ret;
 }
 
@@ -206,21 +215,25 @@ SrsStatisticClient::~SrsStatisticClient()
 {
 }
 
-int SrsStatisticClient::dumps(SrsJsonObject* obj)
+int SrsStatisticClient::dumps(SrsJsonWriter* w)
 {
     int ret = ERROR_SUCCESS;
     
-    obj->set("id", SrsJsonAny::integer(id));
-    obj->set("vhost", SrsJsonAny::integer(stream->vhost->id));
-    obj->set("stream", SrsJsonAny::integer(stream->id));
-    obj->set("ip", SrsJsonAny::str(req->ip.c_str()));
-    obj->set("pageUrl", SrsJsonAny::str(req->pageUrl.c_str()));
-    obj->set("swfUrl", SrsJsonAny::str(req->swfUrl.c_str()));
-    obj->set("tcUrl", SrsJsonAny::str(req->tcUrl.c_str()));
-    obj->set("url", SrsJsonAny::str(req->get_stream_url().c_str()));
-    obj->set("type", SrsJsonAny::str(srs_client_type_string(type).c_str()));
-    obj->set("publish", SrsJsonAny::boolean(srs_client_type_is_publish(type)));
-    obj->set("alive", SrsJsonAny::number((srs_get_system_time_ms() - create) / 1000.0));
+    w->object_start();
+    
+    w->field_integer("id", id);
+    w->field_integer("vhost", stream->vhost->id);
+    w->field_integer("stream", stream->id);
+    w->field_str("ip", req->ip);
+    w->field_str("pageUrl", req->pageUrl);
+    w->field_str("swfUrl", req->swfUrl);
+    w->field_str("tcUrl", req->tcUrl);
+    w->field_str("url", req->get_stream_url());
+    w->field_str("type", srs_client_type_string(type));
+    w->field_boolean("publish", srs_client_type_is_publish(type));
+    w->field_number("alive", (srs_get_system_time_ms() - create) / 1000.0);
+    
+    w->object_end();
     
     return ret;
 }
@@ -362,7 +375,7 @@ void SrsStatistic::on_stream_close(SrsRequest* req)
     stream->close();
 }
 
-int SrsStatistic::on_client(int id, SrsRequest* req, SrsConnection* conn, SrsRtmpConnType type)
+int SrsStatistic::on_client(int id, SrsRequest* req, ISrsExpire* conn, SrsRtmpConnType type)
 {
     int ret = ERROR_SUCCESS;
     
@@ -456,64 +469,74 @@ int64_t SrsStatistic::server_id()
     return _server_id;
 }
 
-int SrsStatistic::dumps_vhosts(SrsJsonArray* arr)
+int SrsStatistic::dumps_vhosts(SrsJsonWriter* w)
 {
     int ret = ERROR_SUCCESS;
+    
+    w->array_start();
 
     std::map<int64_t, SrsStatisticVhost*>::iterator it;
     for (it = vhosts.begin(); it != vhosts.end(); it++) {
         SrsStatisticVhost* vhost = it->second;
         
-        SrsJsonObject* obj = SrsJsonAny::object();
-        arr->append(obj);
-        
-        if ((ret = vhost->dumps(obj)) != ERROR_SUCCESS) {
+        if ((ret = vhost->dumps(w)) != ERROR_SUCCESS) {
             return ret;
         }
     }
+    
+    w->array_end();
 
     return ret;
 }
 
-int SrsStatistic::dumps_streams(SrsJsonArray* arr)
+int SrsStatistic::dumps_streams(SrsJsonWriter* w)
 {
     int ret = ERROR_SUCCESS;
     
+    w->array_start();
+    
     std::map<int64_t, SrsStatisticStream*>::iterator it;
     for (it = streams.begin(); it != streams.end(); it++) {
         SrsStatisticStream* stream = it->second;
-        
-        SrsJsonObject* obj = SrsJsonAny::object();
-        arr->append(obj);
 
-        if ((ret = stream->dumps(obj)) != ERROR_SUCCESS) {
+        if ((ret = stream->dumps(w)) != ERROR_SUCCESS) {
             return ret;
         }
     }
     
+    w->array_end();
+    
     return ret;
 }
 
-int SrsStatistic::dumps_clients(SrsJsonArray* arr, int start, int count)
+int SrsStatistic::dumps_clients(SrsJsonWriter* w, int cursor, int count, int* pnext)
 {
     int ret = ERROR_SUCCESS;
     
-    std::map<int, SrsStatisticClient*>::iterator it = clients.begin();
-    for (int i = 0; i < start + count && it != clients.end(); it++, i++) {
-        if (i < start) {
-            continue;
-        }
-        
+    *pnext = -1;
+    
+    // never dump too many clients in a page, which blocks the server.
+    count = srs_max(0, srs_min(count, SRS_PERF_API_CLIENTS_MAX));
+    
+    w->array_start();
+    
+    // the clients is sorted by id, so seek to the cursor directly,
+    // never iterate the clients before it.
+    std::map<int, SrsStatisticClient*>::iterator it = clients.lower_bound(cursor);
+    for (int i = 0; i < count && it != clients.end(); it++, i++) {
         SrsStatisticClient* client = it->second;
         
-        SrsJsonObject* obj = SrsJsonAny::object();
-        arr->append(obj);
-        
-        if ((ret = client->dumps(obj)) != ERROR_SUCCESS) {
+        if ((ret = client->dumps(w)) != ERROR_SUCCESS) {
             return ret;
         }
     }
     
+    if (it != clients.end()) {
+        *pnext = it->first;
+    }
+    
+    w->array_end();
+    
     return ret;
 }
 
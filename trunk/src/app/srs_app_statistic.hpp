@@ -40,8 +40,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 class SrsKbps;
 class SrsRequest;
 class SrsConnection;
-class SrsJsonObject;
-class SrsJsonArray;
+class ISrsExpire;
+class SrsJsonWriter;
 
 struct SrsStatisticVhost
 {
@@ -59,7 +59,7 @@ public:
     SrsStatisticVhost();
     virtual ~SrsStatisticVhost();
 public:
-    virtual int dumps(SrsJsonObject* obj);
+    virtual int dumps(SrsJsonWriter* w);
 };
 
 struct SrsStatisticStream
@@ -104,7 +104,7 @@ public:
     SrsStatisticStream();
     virtual ~SrsStatisticStream();
 public:
-    virtual int dumps(SrsJsonObject* obj);
+    virtual int dumps(SrsJsonWriter* w);
 public:
     /**
     * publish the stream.
@@ -120,7 +120,8 @@ struct SrsStatisticClient
 {
 public:
     SrsStatisticStream* stream;
-    SrsConnection* conn;
+    // the object to expire when kickoff, NULL when not supported.
+    ISrsExpire* conn;
     SrsRequest* req;
     SrsRtmpConnType type;
     int id;
@@ -129,7 +130,7 @@ public:
     SrsStatisticClient();
     virtual ~SrsStatisticClient();
 public:
-    virtual int dumps(SrsJsonObject* obj);
+    virtual int dumps(SrsJsonWriter* w);
 };
 
 class SrsStatistic
@@ -195,10 +196,10 @@ public:
      * when got a client to publish/play stream,
      * @param id, the client srs id.
      * @param req, the client request object.
-     * @param conn, the physical absract connection object.
+     * @param conn, the physical absract connection object, or the caster, to kickoff.
      * @param type, the type of connection.
      */
-    virtual int on_client(int id, SrsRequest* req, SrsConnection* conn, SrsRtmpConnType type);
+    virtual int on_client(int id, SrsRequest* req, ISrsExpire* conn, SrsRtmpConnType type);
     /**
      * client disconnect
      * @remark the on_disconnect always call, while the on_client is call when
@@ -224,19 +225,20 @@ public:
     */
     virtual int64_t server_id();
     /**
-    * dumps the vhosts to amf0 array.
+    * dumps the vhosts to json array.
     */
-    virtual int dumps_vhosts(SrsJsonArray* arr);
+    virtual int dumps_vhosts(SrsJsonWriter* w);
     /**
-    * dumps the streams to amf0 array.
+    * dumps the streams to json array.
     */
-    virtual int dumps_streams(SrsJsonArray* arr);
+    virtual int dumps_streams(SrsJsonWriter* w);
     /**
-     * dumps the clients to amf0 array
-     * @param start the start index, from 0.
-     * @param count the max count of clients to dump.
+     * dumps a page of clients to json array, sorted by client id.
+     * @param cursor the id of first client to dump, 0 for the first page.
+     * @param count the max count of clients to dump, clamp to SRS_PERF_API_CLIENTS_MAX.
+     * @param pnext output the cursor of next page, -1 when no more clients.
      */
-    virtual int dumps_clients(SrsJsonArray* arr, int start, int count);
+    virtual int dumps_clients(SrsJsonWriter* w, int cursor, int count, int* pnext);
 private:
     virtual SrsStatisticVhost* create_vhost(SrsRequest* req);
     virtual SrsStatisticStream* create_stream(SrsStatisticVhost* vhost, SrsRequest* req);
@@ -44,11 +44,13 @@ using namespace std;
 #include <srs_app_config.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_kernel_error.hpp>
+#include <srs_kernel_pool.hpp>
 #include <srs_protocol_kbps.hpp>
 #include <srs_protocol_json.hpp>
 #include <srs_kernel_buffer.hpp>
 #include <srs_protocol_amf0.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_app_dns.hpp>
 
 // the longest time to wait for a process to quit.
 #define SRS_PROCESS_QUIT_TIMEOUT_MS 1000
@@ -61,6 +63,13 @@ int srs_socket_connect(string server, int port, int64_t timeout, st_netfd_t* pst
     st_netfd_t stfd = NULL;
     sockaddr_in addr;
     
+    // resolve the server in st, which never block the server.
+    std::string ip;
+    if ((ret = SrsDnsResolver::instance()->resolve(server, ip)) != ERROR_SUCCESS) {
+        srs_error("dns resolve server %s failed. ret=%d", server.c_str(), ret);
+        return ret;
+    }
+    
     int sock = socket(AF_INET, SOCK_STREAM, 0);
     if(sock == -1){
         ret = ERROR_SOCKET_CREATE;
@@ -77,13 +86,6 @@ int srs_socket_connect(string server, int port, int64_t timeout, st_netfd_t* pst
     }
     
     // connect to server.
-    std::string ip = srs_dns_resolve(server);
-    if (ip.empty()) {
-        ret = ERROR_SYSTEM_IP_INVALID;
-        srs_error("dns resolve server error, ip empty. ret=%d", ret);
-        goto failed;
-    }
-    
     addr.sin_family = AF_INET;
     addr.sin_port = htons(port);
     addr.sin_addr.s_addr = inet_addr(ip.c_str());
@@ -1537,5 +1539,18 @@ void srs_api_dump_summaries(SrsJsonObject* obj)
     sys->set("conn_sys_tw", SrsJsonAny::integer(nrs->nb_conn_sys_tw));
     sys->set("conn_sys_udp", SrsJsonAny::integer(nrs->nb_conn_sys_udp));
     sys->set("conn_srs", SrsJsonAny::integer(nrs->nb_conn_srs));
+    
+    // the message pool of current process.
+    SrsJsonObject* pool = SrsJsonAny::object();
+    data->set("message_pool", pool);
+    
+    SrsMessagePool* mp = _srs_message_pool;
+    pool->set("enabled", SrsJsonAny::boolean(mp != NULL));
+    pool->set("allocs", SrsJsonAny::integer(mp? mp->nb_allocs : 0));
+    pool->set("reuses", SrsJsonAny::integer(mp? mp->nb_reuses : 0));
+    pool->set("oversizes", SrsJsonAny::integer(mp? mp->nb_oversizes : 0));
+    pool->set("objects", SrsJsonAny::integer(mp? mp->nb_objects : 0));
+    pool->set("object_reuses", SrsJsonAny::integer(mp? mp->nb_object_reuses : 0));
+    pool->set("cached_bytes", SrsJsonAny::integer(mp? mp->cached_bytes : 0));
 }
 
@@ -0,0 +1,529 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_app_worker.hpp>
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <algorithm>
+
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_consts.hpp>
+#include <srs_rtmp_stack.hpp>
+
+// the state of stream slot.
+#define SRS_WORKER_SLOT_EMPTY 0
+#define SRS_WORKER_SLOT_WRITING 1
+#define SRS_WORKER_SLOT_READY 2
+
+// the worker which quit in this interval after spawn,
+// we sleep for a while before respawn it, in seconds.
+#define SRS_WORKER_RESPAWN_INTERVAL 1
+
+// the signals received by master, forward to workers.
+static volatile sig_atomic_t _srs_worker_quit = 0;
+static volatile sig_atomic_t _srs_worker_signals[NSIG];
+
+static void srs_worker_sig_catcher(int signo)
+{
+    // only to wakeup the master from sigsuspend when worker quit.
+    if (signo == SIGCHLD) {
+        return;
+    }
+
+    if (signo == SRS_SIGNAL_GRACEFULLY_QUIT || signo == SIGINT) {
+        _srs_worker_quit = 1;
+    }
+    _srs_worker_signals[signo] = 1;
+}
+
+/**
+ * the FNV-1a hash of stream url.
+ */
+static u_int32_t srs_worker_hash(const char* url)
+{
+    u_int32_t h = 2166136261U;
+    for (const char* p = url; *p; p++) {
+        h ^= (u_int8_t)*p;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+SrsStreamDirectory::SrsStreamDirectory()
+{
+    shm = NULL;
+    nb_shm = 0;
+    ports = NULL;
+    streams = NULL;
+}
+
+SrsStreamDirectory::~SrsStreamDirectory()
+{
+    if (shm) {
+        ::munmap(shm, nb_shm);
+    }
+}
+
+int SrsStreamDirectory::initialize()
+{
+    int ret = ERROR_SUCCESS;
+
+    nb_shm = sizeof(int) * SRS_WORKER_MAX + sizeof(SrsWorkerStreamSlot) * SRS_WORKER_MAX_STREAMS;
+
+    // the anonymous shared memory is inherited by the forked workers.
+    void* p = ::mmap(NULL, nb_shm, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        ret = ERROR_SYSTEM_WORKER_SHM;
+        srs_error("map worker directory failed, size=%d. ret=%d", nb_shm, ret);
+        return ret;
+    }
+
+    // the mapped anonymous memory is zero, that is, the slots are empty.
+    shm = (char*)p;
+    ports = (volatile int*)shm;
+    streams = (SrsWorkerStreamSlot*)(shm + sizeof(int) * SRS_WORKER_MAX);
+
+    for (int i = 0; i < SRS_WORKER_MAX_STREAMS; i++) {
+        streams[i].owner = -1;
+    }
+
+    srs_trace("worker directory mapped, size=%d, streams=%d", nb_shm, SRS_WORKER_MAX_STREAMS);
+
+    return ret;
+}
+
+int SrsStreamDirectory::claim(string url, int w)
+{
+    int ret = ERROR_SUCCESS;
+
+    for (;;) {
+        SrsWorkerStreamSlot* slot = find(url, w);
+        if (!slot) {
+            srs_warn("worker directory full, allow publish %s without pin", url.c_str());
+            return ret;
+        }
+
+        int owner = slot->owner;
+        if (owner == w) {
+            return ret;
+        }
+
+        if (__sync_bool_compare_and_swap(&slot->owner, -1, w)) {
+            return ret;
+        }
+
+        // the slot is owned by other worker, or reused by other url, find again.
+        if (slot->owner != -1 && matches(slot, url)) {
+            return ERROR_SYSTEM_STREAM_BUSY;
+        }
+    }
+
+    return ret;
+}
+
+void SrsStreamDirectory::release(string url, int w)
+{
+    SrsWorkerStreamSlot* slot = find(url, -1);
+    if (slot) {
+        __sync_bool_compare_and_swap(&slot->owner, w, -1);
+    }
+}
+
+void SrsStreamDirectory::release_all(int w)
+{
+    for (int i = 0; i < SRS_WORKER_MAX_STREAMS; i++) {
+        SrsWorkerStreamSlot* slot = &streams[i];
+        if (slot->state == SRS_WORKER_SLOT_READY) {
+            __sync_bool_compare_and_swap(&slot->owner, w, -1);
+        }
+    }
+}
+
+int SrsStreamDirectory::owner(string url)
+{
+    SrsWorkerStreamSlot* slot = find(url, -1);
+    return slot? slot->owner : -1;
+}
+
+void SrsStreamDirectory::set_port(int w, int port)
+{
+    srs_assert(w >= 0 && w < SRS_WORKER_MAX);
+    ports[w] = port;
+}
+
+int SrsStreamDirectory::port(int w)
+{
+    srs_assert(w >= 0 && w < SRS_WORKER_MAX);
+    return ports[w];
+}
+
+SrsWorkerStreamSlot* SrsStreamDirectory::find(string url, int w)
+{
+    const char* key = url.c_str();
+    u_int32_t h = srs_worker_hash(key);
+
+    // the first released slot in the probe sequence, reused when url not found.
+    SrsWorkerStreamSlot* released = NULL;
+
+    for (int i = 0; i < SRS_WORKER_MAX_STREAMS; i++) {
+        SrsWorkerStreamSlot* slot = &streams[(h + i) % SRS_WORKER_MAX_STREAMS];
+
+        // the empty slot, the url is not in directory.
+        if (slot->state == SRS_WORKER_SLOT_EMPTY) {
+            if (w < 0) {
+                return NULL;
+            }
+
+            // reuse the released slot, to keep the probe sequence short.
+            if (released) {
+                break;
+            }
+
+            // write the url when we got the slot, or the slot is taken by other worker.
+            if (__sync_bool_compare_and_swap(&slot->state, SRS_WORKER_SLOT_EMPTY, SRS_WORKER_SLOT_WRITING)) {
+                strncpy(slot->url, key, SRS_WORKER_STREAM_URL - 1);
+                __sync_synchronize();
+                slot->state = SRS_WORKER_SLOT_READY;
+                return slot;
+            }
+        }
+
+        if (matches(slot, url)) {
+            return slot;
+        }
+
+        if (!released && slot->owner == -1) {
+            released = slot;
+        }
+    }
+
+    if (w < 0 || !released) {
+        return NULL;
+    }
+
+    // own the released slot before rewrite its url, or it's taken by other worker,
+    // and the caller will find again.
+    if (!__sync_bool_compare_and_swap(&released->owner, -1, w)) {
+        return released;
+    }
+
+    released->state = SRS_WORKER_SLOT_WRITING;
+    __sync_synchronize();
+    memset(released->url, 0, SRS_WORKER_STREAM_URL);
+    strncpy(released->url, key, SRS_WORKER_STREAM_URL - 1);
+    __sync_fetch_and_add(&released->version, 1);
+    released->state = SRS_WORKER_SLOT_READY;
+
+    return released;
+}
+
+bool SrsStreamDirectory::matches(SrsWorkerStreamSlot* slot, string url)
+{
+    for (;;) {
+        // the url is writing by other worker, which is very fast.
+        while (slot->state == SRS_WORKER_SLOT_WRITING) {
+            sched_yield();
+        }
+
+        int version = slot->version;
+        __sync_synchronize();
+
+        bool matched = (strncmp(slot->url, url.c_str(), SRS_WORKER_STREAM_URL - 1) == 0);
+
+        __sync_synchronize();
+        if (slot->state != SRS_WORKER_SLOT_WRITING && slot->version == version) {
+            return matched;
+        }
+    }
+
+    return false;
+}
+
+SrsWorkers* SrsWorkers::_instance = new SrsWorkers();
+
+SrsWorkers::SrsWorkers()
+{
+    directory = new SrsStreamDirectory();
+    index = -1;
+    sigemptyset(&unblocked);
+}
+
+SrsWorkers::~SrsWorkers()
+{
+    srs_freep(directory);
+}
+
+SrsWorkers* SrsWorkers::instance()
+{
+    return _instance;
+}
+
+int SrsWorkers::fork_workers(int nb)
+{
+    int ret = ERROR_SUCCESS;
+
+    if (nb > SRS_WORKER_MAX) {
+        ret = ERROR_SYSTEM_WORKER_FORK;
+        srs_error("too many workers %d, max is %d. ret=%d", nb, SRS_WORKER_MAX, ret);
+        return ret;
+    }
+
+    if ((ret = directory->initialize()) != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    // the master catch the signals to forward to workers, and SIGCHLD
+    // to wakeup when worker quit. the signals are blocked, only delivered
+    // when master waits in sigsuspend, so the signal arrives after master
+    // scanned the signals is never lost.
+    struct sigaction sa;
+    sa.sa_handler = srs_worker_sig_catcher;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    sigaction(SRS_SIGNAL_RELOAD, &sa, NULL);
+    sigaction(SRS_SIGNAL_REOPEN_LOG, &sa, NULL);
+    sigaction(SRS_SIGNAL_GRACEFULLY_QUIT, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGCHLD, &sa, NULL);
+
+    sigset_t blocked;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SRS_SIGNAL_RELOAD);
+    sigaddset(&blocked, SRS_SIGNAL_REOPEN_LOG);
+    sigaddset(&blocked, SRS_SIGNAL_GRACEFULLY_QUIT);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &blocked, &unblocked);
+
+    pids.resize(nb, -1);
+
+    for (int i = 0; i < nb; i++) {
+        if ((ret = spawn(i)) != ERROR_SUCCESS) {
+            return ret;
+        }
+
+        // the worker returns to serve.
+        if (is_worker()) {
+            return ret;
+        }
+    }
+
+    srs_trace("master fork %d workers", nb);
+
+    return wait_workers();
+}
+
+bool SrsWorkers::is_worker()
+{
+    return index >= 0;
+}
+
+bool SrsWorkers::is_primary()
+{
+    return index <= 0;
+}
+
+void SrsWorkers::on_local_listen(int port)
+{
+    if (!is_worker()) {
+        return;
+    }
+
+    directory->set_port(index, port);
+    srs_trace("worker %d relay streams at tcp://127.0.0.1:%d", index, port);
+}
+
+int SrsWorkers::on_publish(SrsRequest* req)
+{
+    int ret = ERROR_SUCCESS;
+
+    if (!is_worker()) {
+        return ret;
+    }
+
+    std::string url = req->get_stream_url();
+    if ((ret = directory->claim(url, index)) != ERROR_SUCCESS) {
+        srs_warn("stream %s is publishing in worker %d. ret=%d", url.c_str(), directory->owner(url), ret);
+        return ret;
+    }
+
+    return ret;
+}
+
+void SrsWorkers::on_unpublish(SrsRequest* req)
+{
+    if (!is_worker()) {
+        return;
+    }
+
+    directory->release(req->get_stream_url(), index);
+}
+
+int SrsWorkers::owner_port(SrsRequest* req)
+{
+    if (!is_worker()) {
+        return 0;
+    }
+
+    int owner = directory->owner(req->get_stream_url());
+    if (owner < 0 || owner == index) {
+        return 0;
+    }
+
+    return directory->port(owner);
+}
+
+int SrsWorkers::spawn(int i)
+{
+    int ret = ERROR_SUCCESS;
+
+    int pid = fork();
+
+    if (pid < 0) {
+        ret = ERROR_SYSTEM_WORKER_FORK;
+        srs_error("fork worker %d failed. ret=%d", i, ret);
+        return ret;
+    }
+
+    // worker, restore the signals, which is installed by signal manager.
+    if (pid == 0) {
+        signal(SRS_SIGNAL_RELOAD, SIG_DFL);
+        signal(SRS_SIGNAL_REOPEN_LOG, SIG_DFL);
+        signal(SRS_SIGNAL_GRACEFULLY_QUIT, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGCHLD, SIG_DFL);
+        sigprocmask(SIG_SETMASK, &unblocked, NULL);
+
+        index = i;
+        pids.clear();
+        return ret;
+    }
+
+    pids[i] = pid;
+    srs_trace("fork worker %d, pid=%d", i, pid);
+
+    return ret;
+}
+
+int SrsWorkers::wait_workers()
+{
+    int ret = ERROR_SUCCESS;
+
+    std::vector<time_t> starts(pids.size(), ::time(NULL));
+
+    for (;;) {
+        for (int signo = 1; signo < NSIG; signo++) {
+            if (_srs_worker_signals[signo]) {
+                _srs_worker_signals[signo] = 0;
+                signal_workers(signo);
+            }
+        }
+
+        int status = 0;
+        int pid = waitpid(-1, &status, WNOHANG);
+
+        // no worker quit, wait for signals, which are only delivered here.
+        if (pid == 0) {
+            sigsuspend(&unblocked);
+            continue;
+        }
+
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // all workers quit.
+            if (errno == ECHILD) {
+                break;
+            }
+
+            srs_error("master wait workers failed, errno=%d", errno);
+            break;
+        }
+
+        std::vector<int>::iterator it = std::find(pids.begin(), pids.end(), pid);
+        if (it == pids.end()) {
+            continue;
+        }
+
+        int i = (int)(it - pids.begin());
+        pids[i] = -1;
+
+        // the streams of worker are not published any more.
+        directory->release_all(i);
+        directory->set_port(i, 0);
+
+        if (_srs_worker_quit) {
+            srs_trace("worker %d quit, pid=%d, status=%d", i, pid, status);
+            continue;
+        }
+        srs_warn("worker %d crash, pid=%d, status=%d, respawn it", i, pid, status);
+
+        // avoid busy loop when worker always crash when startup.
+        if (::time(NULL) - starts[i] < SRS_WORKER_RESPAWN_INTERVAL) {
+            ::sleep(SRS_WORKER_RESPAWN_INTERVAL);
+        }
+        starts[i] = ::time(NULL);
+
+        if ((ret = spawn(i)) != ERROR_SUCCESS) {
+            return ret;
+        }
+
+        if (is_worker()) {
+            return ret;
+        }
+    }
+
+    srs_trace("master quit, all workers quit");
+
+    return ret;
+}
+
+void SrsWorkers::signal_workers(int signo)
+{
+    // the master is not the st server, reopen its log when required.
+    if (signo == SRS_SIGNAL_REOPEN_LOG) {
+        _srs_log->reopen();
+    }
+
+    for (int i = 0; i < (int)pids.size(); i++) {
+        if (pids[i] > 0) {
+            ::kill(pids[i], signo);
+        }
+    }
+
+    srs_trace("master forward signal %d to %d workers", signo, (int)pids.size());
+}
+
@@ -0,0 +1,184 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_APP_WORKER_HPP
+#define SRS_APP_WORKER_HPP
+
+/*
+#include <srs_app_worker.hpp>
+*/
+#include <srs_core.hpp>
+
+#include <signal.h>
+#include <string>
+#include <vector>
+
+class SrsRequest;
+
+// the max number of worker processes.
+#define SRS_WORKER_MAX 64
+// the max number of streams in the directory, the released slot is reused.
+#define SRS_WORKER_MAX_STREAMS 4096
+// the max length of stream url in the directory.
+#define SRS_WORKER_STREAM_URL 256
+
+/**
+ * the slot of stream in the directory, shared by all workers.
+ */
+struct SrsWorkerStreamSlot
+{
+    // the state of slot, see SrsStreamDirectory.
+    volatile int state;
+    // the index of worker which owns the stream, -1 for none.
+    volatile int owner;
+    // increased when the url of slot is rewritten, to detect the torn read.
+    volatile int version;
+    // the stream url, vhost/app/stream.
+    char url[SRS_WORKER_STREAM_URL];
+};
+
+/**
+ * the stream directory, in shared memory which is mapped by master
+ * before fork the workers, to pin each stream to the worker which
+ * accepts its publisher. a worker which serves a player of stream
+ * owned by other worker pulls the stream from the owner.
+ * @remark the directory is accessed by multiple processes, so we use
+ *       the atomic operations. the slot is never freed, only its owner is
+ *       reset when unpublish, and the released slot is reused by the url
+ *       not in directory, so the probe sequence is never broken.
+ */
+class SrsStreamDirectory
+{
+private:
+    // the mapped shared memory.
+    char* shm;
+    int nb_shm;
+    // the local port of workers, 0 for not listen yet.
+    volatile int* ports;
+    // the hash table of streams, open addressing.
+    SrsWorkerStreamSlot* streams;
+public:
+    SrsStreamDirectory();
+    virtual ~SrsStreamDirectory();
+public:
+    /**
+     * map the shared memory, must be called before fork.
+     */
+    virtual int initialize();
+public:
+    /**
+     * claim the stream for worker w.
+     * @return ERROR_SYSTEM_STREAM_BUSY when owned by other worker.
+     * @remark when directory is full, warn and allow the publish.
+     */
+    virtual int claim(std::string url, int w);
+    /**
+     * release the stream when it's owned by worker w.
+     */
+    virtual void release(std::string url, int w);
+    /**
+     * release all streams of worker w, when it's quit.
+     */
+    virtual void release_all(int w);
+    /**
+     * get the owner of stream, -1 for none.
+     */
+    virtual int owner(std::string url);
+public:
+    virtual void set_port(int w, int port);
+    virtual int port(int w);
+private:
+    /**
+     * find the slot of url.
+     * @param w the worker to create the slot for when not found, -1 to never create.
+     *       the released slot is reused and owned by w, or the empty slot is taken.
+     * @return NULL when not found or the directory is full.
+     */
+    virtual SrsWorkerStreamSlot* find(std::string url, int w);
+    /**
+     * whether the slot is url, retry when the url is rewriting.
+     */
+    virtual bool matches(SrsWorkerStreamSlot* slot, std::string url);
+};
+
+/**
+ * the worker processes, the master forks the workers which accept clients
+ * on the same ports by SO_REUSEPORT, and respawn the crashed worker.
+ * the master never initialize the st, only forward the signals to workers.
+ */
+class SrsWorkers
+{
+private:
+    static SrsWorkers* _instance;
+    SrsWorkers();
+public:
+    virtual ~SrsWorkers();
+    static SrsWorkers* instance();
+private:
+    SrsStreamDirectory* directory;
+    // the index of current worker, -1 for master or no workers.
+    int index;
+    // the pid of workers, for master.
+    std::vector<int> pids;
+    // the signal mask before master block the forwarded signals,
+    // restored by worker, and used by master to wait for signals.
+    sigset_t unblocked;
+public:
+    /**
+     * fork the workers and the master wait for them.
+     * the worker returns from this function with index set,
+     * while the master returns when all workers quit.
+     */
+    virtual int fork_workers(int nb);
+    /**
+     * whether current process is worker.
+     */
+    virtual bool is_worker();
+    /**
+     * whether current process is the primary process, which runs the
+     * stream casters and ingesters, that is, the worker 0 or no worker.
+     */
+    virtual bool is_primary();
+    /**
+     * when the worker listen at the local port to relay streams.
+     */
+    virtual void on_local_listen(int port);
+    /**
+     * when publish stream, pin the stream to current worker.
+     * @return ERROR_SYSTEM_STREAM_BUSY when stream owned by other worker.
+     */
+    virtual int on_publish(SrsRequest* req);
+    virtual void on_unpublish(SrsRequest* req);
+    /**
+     * get the local port of worker which owns the stream,
+     * 0 when no workers, not published or owned by current worker.
+     */
+    virtual int owner_port(SrsRequest* req);
+private:
+    virtual int spawn(int i);
+    virtual int wait_workers();
+    virtual void signal_workers(int signo);
+};
+
+#endif
+
@@ -116,11 +116,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #undef SRS_PERF_MW_SO_RCVBUF
 /**
-* whether enable the fast vector for qeueue.
-* @see https://github.com/ossrs/srs/issues/251
-*/
-#define SRS_PERF_QUEUE_FAST_VECTOR
-/**
 * whether use cond wait to send messages.
 * @remark this improve performance for large connectios.
 * @see https://github.com/ossrs/srs/issues/251
@@ -147,6 +142,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #define SRS_PERF_CHUNK_STREAM_CACHE 16
 
+/**
+* how many chunk iovs to cache in the shared message, [0, N].
+* the chunk headers of message are generated once and shared by all consumers
+* with the same out chunk size, stream id and timestamp, for example, thousands
+* of players of the same stream use the same iovs to send message.
+* @remark 0 to disable the chunk iovs cache, generate headers for each consumer.
+*/
+#define SRS_PERF_CHUNK_IOVS_CACHE 4
+
+/**
+* how many flv tag headers to cache in the shared message, [0, N].
+* the flv tag header and previous tag size of message are generated once and
+* shared by all http flv players with the same timestamp of message.
+* @remark 0 to disable the flv tag cache, generate tag for each player.
+*/
+#define SRS_PERF_FLV_TAG_CACHE 4
+
 /**
 * the gop cache and play cache queue.
 */
@@ -188,6 +200,151 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #undef SRS_PERF_FAST_FLV_ENCODER
 #define SRS_PERF_FAST_FLV_ENCODER
 
+/**
+ * whether remux the http ts/aac/mp3 live stream once for all viewers,
+ * the viewers send the shared remuxed chunks, never remux for each viewer.
+ */
+#undef SRS_PERF_HTTP_SHARED_REMUX
+#define SRS_PERF_HTTP_SHARED_REMUX
+/**
+ * the min duration in ms of the remuxed chunks to cache,
+ * the viewer which falls behind the cache joins the stream again.
+ * @remark for aac/mp3, the fast_cache is used when larger.
+ */
+#define SRS_PERF_HTTP_REMUX_CACHE_MS 10000
+/**
+ * the interval in ms to write the PAT/PMT for ts stream without video,
+ * for the viewer to join the pure audio stream.
+ */
+#define SRS_PERF_HTTP_REMUX_PURE_AUDIO_JOIN_MS 1000
+
+/**
+ * whether send the static files of http server by sendfile, the file is
+ * sent from page cache to socket directly, never copy to user space.
+ * @remark only for linux, the osx always read and write the file.
+ */
+#undef SRS_PERF_HTTP_SENDFILE
+#ifndef SRS_OSX
+    #define SRS_PERF_HTTP_SENDFILE
+#endif
+
+/**
+ * the udp listener recv the packets in batch by recvmmsg, to the buffers
+ * pre-allocated for each packet, then hand the batch to the caster,
+ * for example, the MPEG-TS over UDP, which about 10k+ packets/s per feed.
+ * @remark only for linux, the osx recv a packet in a time.
+ */
+#undef SRS_PERF_UDP_RECVMMSG
+#ifndef SRS_OSX
+    #define SRS_PERF_UDP_RECVMMSG
+#endif
+/**
+ * the max number of udp packets to recv in a batch.
+ */
+#define SRS_PERF_UDP_RECV_BATCH 16
+
+/**
+ * how many ts packets to mux in buffer then write in a time,
+ * for HLS and HTTP-TS, the ts packets of a frame are written together,
+ * and flushed when buffer is full, for example, the I frame.
+ * @remark it's 188*256=48KB per ts context, large enough for most P/B frames.
+ */
+#define SRS_PERF_TS_WRITE_PACKETS 256
+
+/**
+ * how many file io workers(pthreads) to write the HLS/DVR/HDS files,
+ * the disk io is submit to worker by stream, so a slow disk never block st.
+ * @remark 0 to disable the async file io, write files in st thread.
+ */
+#define SRS_PERF_ASYNC_IO_WORKERS 2
+/**
+ * the buffer size of async file writer, the writes of file are buffered,
+ * then submit to the file io worker when buffer is full or file closed.
+ */
+#define SRS_PERF_ASYNC_IO_BUFFER 65536
+/**
+ * the async file io starts to write back the dirty pages every this bytes,
+ * by sync_file_range, so the page cache never balloons when recording lots
+ * of streams, and the file never read again, for example, the dvr flv,
+ * drops its pages from page cache once they are on disk.
+ * @remark 0 to disable, and only for linux, the osx never write back.
+ */
+#define SRS_PERF_ASYNC_IO_WRITEBACK 1048576
+/**
+ * the max bytes of writes pending in a file io worker, when the disk stalls,
+ * the writes over it are dropped and counted, and the error is returned to
+ * the muxer, so the queue of worker never eats up the memory.
+ */
+#define SRS_PERF_ASYNC_IO_MAX_PENDING (64 * 1024 * 1024)
+
+/**
+ * the max bytes cached by the message pool, the payloads and objects of
+ * messages are alloc from the free lists of size class, and cached when
+ * freed, so the publish and play never malloc in steady state.
+ * @remark 0 to disable the message pool, alloc by new and delete.
+ */
+#define SRS_PERF_MESSAGE_POOL (32 * 1024 * 1024)
+
+/**
+ * the bytes of ring to write log to file, the st thread formats the log to
+ * the ring, which is drained to file by a pthread, so a slow disk never
+ * block st. the log is dropped and counted when ring is full.
+ * @remark 0 to disable, write log to file in st thread.
+ */
+#define SRS_PERF_ASYNC_LOG_RING (4 * 1024 * 1024)
+
+/**
+ * the max idle keep-alive connections of http client for each upstream,
+ * for example, the http hooks reuse the connections to the api server,
+ * so the clients never connect and leave TIME_WAIT for each hook.
+ * @remark 0 to disable, close the connection after each request.
+ */
+#define SRS_PERF_HTTP_CLIENT_POOL 32
+/**
+ * the max time in ms to keep the idle connection in pool, which should be
+ * less than the keep-alive timeout of server, for instance, 5s of nodejs.
+ */
+#define SRS_PERF_HTTP_CLIENT_IDLE_MS 4000
+
+/**
+ * the hls files in ram are written in chunks of this bytes, which are shared by
+ * all viewers and sent by writev, never copied for each request.
+ */
+#define SRS_PERF_HLS_RAM_CHUNK 65536
+/**
+ * the default memory budget in MB of the hls files in ram, the least recently
+ * used files are evicted when exceed it.
+ */
+#define SRS_PERF_HLS_RAM_BUDGET 256
+
+/**
+ * the max ips of the rate limiter to keep the token buckets, when exceed,
+ * the buckets which are refilled are removed, at most once a second.
+ */
+#define SRS_PERF_RATE_LIMIT_IPS 10000
+
+/**
+ * how many DH keys to generate by pthread for the rtmp complex handshake,
+ * so the st never generate the 1024bits DH key for each handshake, when
+ * lots of clients connect at once, for example, the edge restarts.
+ * @remark 0 to disable, generate the key in st for each handshake.
+ */
+#define SRS_PERF_DH_KEY_POOL 256
+/**
+ * whether compute the DH shared key by the pthread of pool, while the handshake
+ * coroutine waits for it, so the st serves other connections.
+ * @remark the handshake latency+ for the thread switch, only for the CPU bound server.
+ */
+#undef SRS_PERF_DH_OFFLOAD
+
+/**
+ * the default and max count of clients in a page of http api /api/v1/clients,
+ * the large page dumps lots of clients in a json, which blocks the st.
+ * @remark the client pages by the query cursor and the next of response.
+ */
+#define SRS_PERF_API_CLIENTS_PAGE 10
+#define SRS_PERF_API_CLIENTS_MAX 1000
+
 /**
  * whether ensure glibc memory check.
  */
@@ -21,37 +21,318 @@
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+
 #include <srs_kernel_balance.hpp>
 
 using namespace std;
 
-SrsLbRoundRobin::SrsLbRoundRobin()
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+
+// the weight of new sample for the ewma of latency.
+#define SRS_LB_EWMA_ALPHA 0.3
+// the time in ms to eject server for the first failure,
+// which doubles for each continuous failure, to the max.
+#define SRS_LB_EJECT_MS 5000
+#define SRS_LB_EJECT_MAX_MS 60000
+
+SrsLbUpstream::SrsLbUpstream(string s)
+{
+    server = s;
+    latency = 0;
+    nb_failures = 0;
+    eject_until = 0;
+    nb_streams = 0;
+}
+
+SrsLbUpstream::~SrsLbUpstream()
+{
+}
+
+bool SrsLbUpstream::available(int64_t now)
+{
+    return eject_until <= now;
+}
+
+void SrsLbUpstream::on_success(int64_t latency_ms)
+{
+    if (latency <= 0) {
+        latency = (double)latency_ms;
+    } else {
+        latency = SRS_LB_EWMA_ALPHA * latency_ms + (1 - SRS_LB_EWMA_ALPHA) * latency;
+    }
+    
+    nb_failures = 0;
+    eject_until = 0;
+}
+
+void SrsLbUpstream::on_failure(int64_t now)
+{
+    int64_t eject_ms = SRS_LB_EJECT_MS;
+    for (int i = 0; i < nb_failures && eject_ms < SRS_LB_EJECT_MAX_MS; i++) {
+        eject_ms *= 2;
+    }
+    eject_ms = srs_min(eject_ms, SRS_LB_EJECT_MAX_MS);
+    
+    nb_failures++;
+    eject_until = now + eject_ms;
+    
+    srs_warn("lb eject %s for %dms, failures=%d", server.c_str(), (int)eject_ms, nb_failures);
+}
+
+SrsLbUpstreams* SrsLbUpstreams::_instance = NULL;
+
+SrsLbUpstreams::SrsLbUpstreams()
+{
+}
+
+SrsLbUpstreams::~SrsLbUpstreams()
+{
+    std::map<std::string, SrsLbUpstream*>::iterator it;
+    for (it = upstreams.begin(); it != upstreams.end(); ++it) {
+        SrsLbUpstream* upstream = it->second;
+        srs_freep(upstream);
+    }
+    upstreams.clear();
+}
+
+SrsLbUpstreams* SrsLbUpstreams::instance()
+{
+    if (!_instance) {
+        _instance = new SrsLbUpstreams();
+    }
+    return _instance;
+}
+
+SrsLbUpstream* SrsLbUpstreams::fetch(string server)
+{
+    std::map<std::string, SrsLbUpstream*>::iterator it = upstreams.find(server);
+    if (it != upstreams.end()) {
+        return it->second;
+    }
+    
+    SrsLbUpstream* upstream = new SrsLbUpstream(server);
+    upstreams[server] = upstream;
+    return upstream;
+}
+
+SrsLoadBalancer::SrsLoadBalancer()
 {
     index = -1;
-    count = 0;
+    upstream = NULL;
+    starttime = 0;
 }
 
-SrsLbRoundRobin::~SrsLbRoundRobin()
+SrsLoadBalancer::~SrsLoadBalancer()
 {
+    on_close();
 }
 
-u_int32_t SrsLbRoundRobin::current()
+u_int32_t SrsLoadBalancer::current()
 {
     return index;
 }
 
-string SrsLbRoundRobin::selected()
+string SrsLoadBalancer::selected()
 {
     return elem;
 }
 
-string SrsLbRoundRobin::select(const vector<string>& servers)
+string SrsLoadBalancer::select(const vector<string>& servers)
 {
     srs_assert(!servers.empty());
     
-    index = (int)(count++ % servers.size());
+    on_close();
+    
+    int64_t now = srs_update_system_time_ms();
+    
+    std::vector<SrsLbUpstream*> candidates;
+    std::vector<int> indexes;
+    for (int i = 0; i < (int)servers.size(); i++) {
+        SrsLbUpstream* u = SrsLbUpstreams::instance()->fetch(servers.at(i));
+        if (u->available(now)) {
+            candidates.push_back(u);
+            indexes.push_back(i);
+        }
+    }
+    
+    // all servers are ejected, select from all.
+    if (candidates.empty()) {
+        for (int i = 0; i < (int)servers.size(); i++) {
+            candidates.push_back(SrsLbUpstreams::instance()->fetch(servers.at(i)));
+            indexes.push_back(i);
+        }
+    }
+    
+    int i = do_select(candidates, indexes);
+    
+    index = indexes.at(i);
     elem = servers.at(index);
     
+    upstream = candidates.at(i);
+    upstream->nb_streams++;
+    starttime = now;
+    
     return elem;
 }
 
+void SrsLoadBalancer::on_success()
+{
+    if (upstream) {
+        upstream->on_success(srs_update_system_time_ms() - starttime);
+    }
+}
+
+void SrsLoadBalancer::on_failure()
+{
+    if (upstream) {
+        upstream->on_failure(srs_update_system_time_ms());
+    }
+}
+
+void SrsLoadBalancer::on_close()
+{
+    if (upstream) {
+        upstream->nb_streams--;
+        upstream = NULL;
+    }
+}
+
+SrsLbRoundRobin::SrsLbRoundRobin()
+{
+    count = 0;
+}
+
+SrsLbRoundRobin::~SrsLbRoundRobin()
+{
+}
+
+int SrsLbRoundRobin::do_select(const vector<SrsLbUpstream*>& /*candidates*/, const vector<int>& indexes)
+{
+    // select the next available server of the round.
+    u_int32_t next = count++;
+    
+    int max = indexes.back() + 1;
+    for (int i = 0; i < (int)indexes.size(); i++) {
+        if (indexes.at(i) >= (int)(next % max)) {
+            return i;
+        }
+    }
+    
+    return 0;
+}
+
+SrsLbConsistentHash::SrsLbConsistentHash(string k)
+{
+    key = k;
+}
+
+SrsLbConsistentHash::~SrsLbConsistentHash()
+{
+}
+
+/**
+ * the FNV-1a hash of key and server.
+ */
+static u_int32_t srs_lb_hash(const string& key, const string& server)
+{
+    u_int32_t h = 2166136261U;
+    for (int i = 0; i < (int)key.length(); i++) {
+        h ^= (u_int8_t)key.at(i);
+        h *= 16777619U;
+    }
+    h ^= (u_int8_t)'/';
+    h *= 16777619U;
+    for (int i = 0; i < (int)server.length(); i++) {
+        h ^= (u_int8_t)server.at(i);
+        h *= 16777619U;
+    }
+    
+    // mix the bits, for the servers only differ in the last bytes.
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    
+    return h;
+}
+
+int SrsLbConsistentHash::do_select(const vector<SrsLbUpstream*>& candidates, const vector<int>& /*indexes*/)
+{
+    int selected = 0;
+    u_int32_t max = 0;
+    
+    for (int i = 0; i < (int)candidates.size(); i++) {
+        u_int32_t h = srs_lb_hash(key, candidates.at(i)->server);
+        if (i == 0 || h > max) {
+            selected = i;
+            max = h;
+        }
+    }
+    
+    return selected;
+}
+
+SrsLbLeastStreams::SrsLbLeastStreams()
+{
+}
+
+SrsLbLeastStreams::~SrsLbLeastStreams()
+{
+}
+
+int SrsLbLeastStreams::do_select(const vector<SrsLbUpstream*>& candidates, const vector<int>& /*indexes*/)
+{
+    int selected = 0;
+    
+    for (int i = 1; i < (int)candidates.size(); i++) {
+        SrsLbUpstream* u = candidates.at(i);
+        SrsLbUpstream* s = candidates.at(selected);
+        
+        if (u->nb_streams < s->nb_streams || (u->nb_streams == s->nb_streams && u->latency < s->latency)) {
+            selected = i;
+        }
+    }
+    
+    return selected;
+}
+
+SrsLbLatency::SrsLbLatency()
+{
+}
+
+SrsLbLatency::~SrsLbLatency()
+{
+}
+
+int SrsLbLatency::do_select(const vector<SrsLbUpstream*>& candidates, const vector<int>& /*indexes*/)
+{
+    int selected = 0;
+    double min = 0;
+    
+    for (int i = 0; i < (int)candidates.size(); i++) {
+        SrsLbUpstream* u = candidates.at(i);
+        
+        double cost = u->latency * (u->nb_streams + 1);
+        if (i == 0 || cost < min) {
+            selected = i;
+            min = cost;
+        }
+    }
+    
+    return selected;
+}
+
+SrsLoadBalancer* srs_lb_create(string algorithm, string key)
+{
+    if (algorithm == "hash") {
+        return new SrsLbConsistentHash(key);
+    } else if (algorithm == "least_streams") {
+        return new SrsLbLeastStreams();
+    } else if (algorithm == "latency") {
+        return new SrsLbLatency();
+    }
+    return new SrsLbRoundRobin();
+}
+
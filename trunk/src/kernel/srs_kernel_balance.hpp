@@ -21,6 +21,7 @@
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+
 #ifndef SRS_KERNEL_AAC_HPP
 #define SRS_KERNEL_AAC_HPP
 
@@ -31,28 +32,180 @@
 
 #include <vector>
 #include <string>
+#include <map>
+
+/**
+ * the health and load of upstream server, shared by all balancers,
+ * for instance, the edge of streams which pull from the same origin.
+ */
+class SrsLbUpstream
+{
+public:
+    // the server, host:port.
+    std::string server;
+    // the ewma of latency in ms, to connect and got the first packet, 0 for never sampled.
+    double latency;
+    // the continuous failures.
+    int nb_failures;
+    // the time in ms when the ejected server is available again, 0 for never ejected.
+    int64_t eject_until;
+    // the number of balancers which select this server, that is, the streams in service.
+    int nb_streams;
+public:
+    SrsLbUpstream(std::string s);
+    virtual ~SrsLbUpstream();
+public:
+    /**
+     * whether the server is available, not ejected.
+     */
+    virtual bool available(int64_t now);
+    /**
+     * when connected to server, update the ewma of latency and reset the failures.
+     */
+    virtual void on_success(int64_t latency_ms);
+    /**
+     * when failed to connect to server, eject it for a while which backoff exponentially.
+     */
+    virtual void on_failure(int64_t now);
+};
+
+/**
+ * the upstream servers, never free the upstream which is kept by balancers.
+ */
+class SrsLbUpstreams
+{
+private:
+    static SrsLbUpstreams* _instance;
+    std::map<std::string, SrsLbUpstream*> upstreams;
+public:
+    SrsLbUpstreams();
+    virtual ~SrsLbUpstreams();
+    static SrsLbUpstreams* instance();
+public:
+    /**
+     * fetch the upstream of server, create it when not found.
+     */
+    virtual SrsLbUpstream* fetch(std::string server);
+};
 
 /**
- * the round-robin load balance algorithm,
- * used for edge pull, kafka and other multiple server feature.
+ * the load balance of upstream servers, which selects one of the servers,
+ * and feedback the result of connect, to eject the failed server and track
+ * the latency of server. the algorithm only selects the available servers,
+ * or all servers when all of them are ejected.
+ * used for edge pull and push, forward, kafka and other multiple server feature.
  */
-class SrsLbRoundRobin
+class SrsLoadBalancer
 {
 private:
     // current selected index.
     int index;
-    // total scheduled count.
-    u_int32_t count;
     // current selected server.
     std::string elem;
+    // the upstream of selected server, whose streams is increased.
+    SrsLbUpstream* upstream;
+    // the time in ms to select, to calc the latency.
+    int64_t starttime;
 public:
-    SrsLbRoundRobin();
-    virtual ~SrsLbRoundRobin();
+    SrsLoadBalancer();
+    virtual ~SrsLoadBalancer();
 public:
     virtual u_int32_t current();
     virtual std::string selected();
+    /**
+     * select the server, release the previous selected one.
+     * @remark the servers should never be empty.
+     */
     virtual std::string select(const std::vector<std::string>& servers);
+public:
+    /**
+     * when connected to the selected server and got the first packet,
+     * the latency is the elapsed time from select.
+     */
+    virtual void on_success();
+    /**
+     * when failed to connect to the selected server.
+     */
+    virtual void on_failure();
+    /**
+     * when stop to use the selected server.
+     */
+    virtual void on_close();
+protected:
+    /**
+     * select the index of server from the candidates.
+     * @param candidates the upstreams of servers to select, which are available.
+     * @param indexes the index of candidate in servers.
+     */
+    virtual int do_select(const std::vector<SrsLbUpstream*>& candidates, const std::vector<int>& indexes) = 0;
 };
 
+/**
+ * the round-robin load balance algorithm.
+ */
+class SrsLbRoundRobin : public SrsLoadBalancer
+{
+private:
+    // total scheduled count.
+    u_int32_t count;
+public:
+    SrsLbRoundRobin();
+    virtual ~SrsLbRoundRobin();
+protected:
+    virtual int do_select(const std::vector<SrsLbUpstream*>& candidates, const std::vector<int>& indexes);
+};
+
+/**
+ * the consistent hash by key, for example, the stream url, so the same
+ * stream always select the same server, to keep the gop cache of origin hot,
+ * and only the streams of the ejected server move to other servers.
+ * @remark we use the rendezvous hashing, which selects the server of max hash(key, server).
+ */
+class SrsLbConsistentHash : public SrsLoadBalancer
+{
+private:
+    std::string key;
+public:
+    SrsLbConsistentHash(std::string k);
+    virtual ~SrsLbConsistentHash();
+protected:
+    virtual int do_select(const std::vector<SrsLbUpstream*>& candidates, const std::vector<int>& indexes);
+};
+
+/**
+ * select the server which serves the least streams,
+ * and the lower latency when streams are equal.
+ */
+class SrsLbLeastStreams : public SrsLoadBalancer
+{
+public:
+    SrsLbLeastStreams();
+    virtual ~SrsLbLeastStreams();
+protected:
+    virtual int do_select(const std::vector<SrsLbUpstream*>& candidates, const std::vector<int>& indexes);
+};
+
+/**
+ * select the server of min cost, which is latency*(streams+1), the ewma of
+ * latency weighted by the load, so the far or overloaded server is avoided,
+ * and the server never sampled is selected first.
+ */
+class SrsLbLatency : public SrsLoadBalancer
+{
+public:
+    SrsLbLatency();
+    virtual ~SrsLbLatency();
+protected:
+    virtual int do_select(const std::vector<SrsLbUpstream*>& candidates, const std::vector<int>& indexes);
+};
+
+/**
+ * create the load balancer by algorithm name.
+ * @param algorithm the name of algorithm, round_robin, hash, least_streams or latency,
+ *       use round_robin for others.
+ * @param key the key to hash, for the hash algorithm.
+ */
+extern SrsLoadBalancer* srs_lb_create(std::string algorithm, std::string key);
+
 #endif
 
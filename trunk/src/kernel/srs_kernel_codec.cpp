@@ -1130,39 +1130,17 @@ int SrsAvcAacCodec::avc_demux_annexb_format(SrsBuffer* stream, SrsCodecSample* s
     // AnnexB
     // B.1.1 Byte stream NAL unit syntax,
     // H.264-AVC-ISO_IEC_14496-10.pdf, page 211.
-    while (!stream->empty()) {
-        // find start code
-        int nb_start_code = 0;
-        if (!srs_avc_startswith_annexb(stream, &nb_start_code)) {
-            return ret;
-        }
-
-        // skip the start code.
-        if (nb_start_code > 0) {
-            stream->skip(nb_start_code);
-        }
-        
-        // the NALU start bytes.
-        char* p = stream->data() + stream->pos();
-        
-        // get the last matched NALU
-        while (!stream->empty()) {
-            if (srs_avc_startswith_annexb(stream, NULL)) {
-                break;
-            }
-            
-            stream->skip(1);
-        }
-        
-        char* pp = stream->data() + stream->pos();
-        
-        // skip the empty.
-        if (pp - p <= 0) {
-            continue;
-        }
-        
+    // split all NALUs in a pass, one more than the max samples to fail.
+    char* nalus[SRS_SRS_MAX_CODEC_SAMPLE + 1];
+    int sizes[SRS_SRS_MAX_CODEC_SAMPLE + 1];
+    
+    char* p = stream->data() + stream->pos();
+    int nb_nalus = srs_avc_split_annexb(p, stream->size() - stream->pos(), nalus, sizes, SRS_SRS_MAX_CODEC_SAMPLE + 1);
+    stream->skip(stream->size() - stream->pos());
+    
+    for (int i = 0; i < nb_nalus; i++) {
         // got the NALU.
-        if ((ret = sample->add_sample_unit(p, pp - p)) != ERROR_SUCCESS) {
+        if ((ret = sample->add_sample_unit(nalus[i], sizes[i])) != ERROR_SUCCESS) {
             srs_error("annexb add video sample failed. ret=%d", ret);
             return ret;
         }
@@ -104,6 +104,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ERROR_SYSTEM_CONFIG_RAW_PARAMS      1063
 #define ERROR_SYSTEM_FILE_NOT_EXISTS        1064
 #define ERROR_SYSTEM_HOURGLASS_RESOLUTION   1065
+#define ERROR_SYSTEM_CREATE_THREAD          1066
+#define ERROR_SYSTEM_FILE_UNLINK            1067
+#define ERROR_SYSTEM_WORKER_FORK            1068
+#define ERROR_SYSTEM_WORKER_SHM             1069
+#define ERROR_SYSTEM_DNS_RESOLVE            1070
+#define ERROR_SYSTEM_DNS_TIMEOUT            1071
+#define ERROR_SYSTEM_DNS_PACKET             1072
+#define ERROR_SYSTEM_RATE_LIMIT             1073
+#define ERROR_SYSTEM_DNS_RESPONSE           1074
+#define ERROR_SYSTEM_ASYNC_IO_FULL          1075
 
 ///////////////////////////////////////////////////////
 // RTMP protocol error.
@@ -158,6 +168,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ERROR_RTSP_AUDIO_CONFIG             2047
 #define ERROR_RTMP_STREAM_NOT_FOUND         2048
 #define ERROR_RTMP_CLIENT_NOT_FOUND         2049
+#define ERROR_RTMP_CLIENT_NOT_EXPIRE        2050
 //                                           
 // system control message, 
 // not an error, but special control logic.
@@ -240,6 +251,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ERROR_RESPONSE_DATA                 3065
 #define ERROR_REQUEST_DATA                  3066
 #define ERROR_EDGE_PORT_INVALID             3067
+#define ERROR_EDGE_WORKER_UNPUBLISHED       3068
 
 ///////////////////////////////////////////////////////
 // HTTP/StreamCaster/KAFKA protocol error.
@@ -283,6 +295,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ERROR_KAFKA_CODEC_MESSAGE           4036
 #define ERROR_KAFKA_CODEC_PRODUCER          4037
 #define ERROR_HTTP_302_INVALID              4038
+#define ERROR_STREAM_CASTER_NOT_PUBLISH     4039
 
 ///////////////////////////////////////////////////////
 // HTTP API error.
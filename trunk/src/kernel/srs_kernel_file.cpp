@@ -35,6 +35,7 @@ using namespace std;
 
 #include <srs_kernel_log.hpp>
 #include <srs_kernel_error.hpp>
+#include <srs_kernel_utility.hpp>
 
 SrsFileWriter::SrsFileWriter()
 {
@@ -150,6 +151,54 @@ int SrsFileWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
 {
     int ret = ERROR_SUCCESS;
     
+    ssize_t nwrite = 0;
+    while (iovcnt > 0) {
+        int nb_iovs = srs_min(iovcnt, SRS_FILE_WRITER_MAX_IOVS);
+        
+        ssize_t this_nwrite;
+        if ((this_nwrite = ::writev(fd, iov, nb_iovs)) < 0) {
+            ret = ERROR_SYSTEM_FILE_WRITE;
+            srs_error("writev to file %s failed. ret=%d", path.c_str(), ret);
+            return ret;
+        }
+        nwrite += this_nwrite;
+        
+        // skip the written iovs.
+        while (iovcnt > 0 && this_nwrite >= (ssize_t)iov->iov_len) {
+            this_nwrite -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        
+        // write the left bytes of the partial written iov.
+        if (iovcnt > 0 && this_nwrite > 0) {
+            char* p = (char*)iov->iov_base + this_nwrite;
+            size_t left = iov->iov_len - this_nwrite;
+            while (left > 0) {
+                ssize_t left_nwrite = 0;
+                if ((ret = SrsFileWriter::write(p, left, &left_nwrite)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+                p += left_nwrite;
+                left -= left_nwrite;
+                nwrite += left_nwrite;
+            }
+            iov++;
+            iovcnt--;
+        }
+    }
+    
+    if (pnwrite) {
+        *pnwrite = nwrite;
+    }
+    
+    return ret;
+}
+
+int SrsFileWriter::write_iovs(iovec* iov, int iovcnt, ssize_t* pnwrite)
+{
+    int ret = ERROR_SUCCESS;
+    
     ssize_t nwrite = 0;
     for (int i = 0; i < iovcnt; i++) {
         iovec* piov = iov + i;
@@ -236,6 +285,11 @@ int64_t SrsFileReader::lseek(int64_t offset)
     return (int64_t)::lseek(fd, (off_t)offset, SEEK_SET);
 }
 
+int SrsFileReader::get_fd()
+{
+    return fd;
+}
+
 int64_t SrsFileReader::filesize()
 {
     int64_t cur = tellg();
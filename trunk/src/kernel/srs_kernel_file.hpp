@@ -36,6 +36,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sys/uio.h>
 #endif
 
+// the max iovs to writev in a time, the IOV_MAX of linux.
+#define SRS_FILE_WRITER_MAX_IOVS 1024
+
 /**
 * file writer, to write to file.
 */
@@ -75,9 +78,17 @@ public:
     virtual int write(void* buf, size_t count, ssize_t* pnwrite);
     /**
      * for the HTTP FLV, to writev to improve performance.
+     * @remark the iovs are written by ::writev in a syscall, while the
+     *       subclass which overrides write must override writev too,
+     *       for example, by write_iovs.
      * @see https://github.com/ossrs/srs/issues/405
      */
     virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+protected:
+    /**
+     * write the iovs one by one, by the write of subclass.
+     */
+    virtual int write_iovs(iovec* iov, int iovcnt, ssize_t* pnwrite);
 };
 
 /**
@@ -109,6 +120,10 @@ public:
     virtual void skip(int64_t size);
     virtual int64_t lseek(int64_t offset);
     virtual int64_t filesize();
+    /**
+     * get the fd of file, for example, to sendfile.
+     */
+    virtual int get_fd();
 public:
     /**
     * read from file. 
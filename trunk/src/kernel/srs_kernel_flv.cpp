@@ -39,6 +39,7 @@ using namespace std;
 #include <srs_kernel_codec.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_core_mem_watch.hpp>
+#include <srs_kernel_pool.hpp>
 
 SrsMessageHeader::SrsMessageHeader()
 {
@@ -155,6 +156,7 @@ void SrsMessageHeader::initialize_video(int size, u_int32_t time, int stream)
 SrsCommonMessage::SrsCommonMessage()
 {
     payload = NULL;
+    pooled = false;
     size = 0;
 }
 
@@ -163,14 +165,39 @@ SrsCommonMessage::~SrsCommonMessage()
 #ifdef SRS_AUTO_MEM_WATCH
     srs_memory_unwatch(payload);
 #endif
+    if (pooled) {
+        srs_pool_free(payload);
+        payload = NULL;
+    }
     srs_freepa(payload);
 }
 
+void* SrsCommonMessage::operator new(size_t size)
+{
+    return srs_pool_alloc_object(size);
+}
+
+void SrsCommonMessage::operator delete(void* p, size_t size)
+{
+    srs_pool_free_object(p, size);
+}
+
 void SrsCommonMessage::create_payload(int size)
 {
+    if (pooled) {
+        srs_pool_free(payload);
+        payload = NULL;
+    }
     srs_freepa(payload);
     
-    payload = new char[size];
+    // only the server enable the pool, the librtmp always use new,
+    // for the user of librtmp steal and delete[] the payload.
+    pooled = (_srs_message_pool != NULL);
+    if (pooled) {
+        payload = srs_pool_alloc(size);
+    } else {
+        payload = new char[size];
+    }
     srs_verbose("create payload for RTMP message. size=%d", size);
     
 #ifdef SRS_AUTO_MEM_WATCH
@@ -183,20 +210,60 @@ int SrsCommonMessage::create(SrsMessageHeader* pheader, char* body, int size)
     int ret = ERROR_SUCCESS;
     
     // drop previous payload.
+    if (pooled) {
+        srs_pool_free(payload);
+        payload = NULL;
+    }
     srs_freepa(payload);
     
     this->header = *pheader;
     this->payload = body;
+    this->pooled = false;
     this->size = size;
     
     return ret;
 }
 
+#if SRS_PERF_CHUNK_IOVS_CACHE > 0
+SrsSharedPtrMessage::SrsSharedChunkIovs::SrsSharedChunkIovs()
+{
+    chunk_size = 0;
+    stream_id = 0;
+    timestamp = 0;
+    headers = NULL;
+    iovs = NULL;
+    nb_iovs = 0;
+}
+
+SrsSharedPtrMessage::SrsSharedChunkIovs::~SrsSharedChunkIovs()
+{
+    srs_pool_free(headers);
+    srs_pool_free((char*)iovs);
+}
+
+void* SrsSharedPtrMessage::SrsSharedChunkIovs::operator new(size_t size)
+{
+    return srs_pool_alloc_object(size);
+}
+
+void SrsSharedPtrMessage::SrsSharedChunkIovs::operator delete(void* p, size_t size)
+{
+    srs_pool_free_object(p, size);
+}
+#endif
+
 SrsSharedPtrMessage::SrsSharedPtrPayload::SrsSharedPtrPayload()
 {
     payload = NULL;
     size = 0;
     shared_count = 0;
+    pooled = false;
+#if SRS_PERF_CHUNK_IOVS_CACHE > 0
+    nb_chunk_iovs = 0;
+#endif
+#if SRS_PERF_FLV_TAG_CACHE > 0
+    nb_flv_tags = 0;
+#endif
 }
 
 SrsSharedPtrMessage::SrsSharedPtrPayload::~SrsSharedPtrPayload()
@@ -204,23 +271,53 @@ SrsSharedPtrMessage::SrsSharedPtrPayload::~SrsSharedPtrPayload()
 #ifdef SRS_AUTO_MEM_WATCH
     srs_memory_unwatch(payload);
 #endif
+    if (pooled) {
+        srs_pool_free(payload);
+        payload = NULL;
+    }
     srs_freepa(payload);
+    
+#if SRS_PERF_CHUNK_IOVS_CACHE > 0
+    for (int i = 0; i < nb_chunk_iovs; i++) {
+        SrsSharedChunkIovs* v = chunk_iovs[i];
+        srs_freep(v);
+    }
+    nb_chunk_iovs = 0;
+#endif
+}
+
+void* SrsSharedPtrMessage::SrsSharedPtrPayload::operator new(size_t size)
+{
+    return srs_pool_alloc_object(size);
+}
+
+void SrsSharedPtrMessage::SrsSharedPtrPayload::operator delete(void* p, size_t size)
+{
+    srs_pool_free_object(p, size);
 }
 
 SrsSharedPtrMessage::SrsSharedPtrMessage()
 {
     ptr = NULL;
+    timestamp = 0;
+    stream_id = 0;
+    payload = NULL;
+    size = 0;
 }
 
 SrsSharedPtrMessage::~SrsSharedPtrMessage()
 {
-    if (ptr) {
-        if (ptr->shared_count == 0) {
-            srs_freep(ptr);
-        } else {
-            ptr->shared_count--;
-        }
-    }
+    release();
+}
+
+void* SrsSharedPtrMessage::operator new(size_t size)
+{
+    return srs_pool_alloc_object(size);
+}
+
+void SrsSharedPtrMessage::operator delete(void* p, size_t size)
+{
+    srs_pool_free_object(p, size);
 }
 
 int SrsSharedPtrMessage::create(SrsCommonMessage* msg)
@@ -234,7 +331,9 @@ int SrsSharedPtrMessage::create(SrsCommonMessage* msg)
     // to prevent double free of payload:
     // initialize already attach the payload of msg,
     // detach the payload to transfer the owner to shared ptr.
+    ptr->pooled = msg->pooled;
     msg->payload = NULL;
+    msg->pooled = false;
     msg->size = 0;
     
     return ret;
@@ -327,21 +426,207 @@ int SrsSharedPtrMessage::chunk_header(char* cache, int nb_cache, bool c0)
     }
 }
 
+bool SrsSharedPtrMessage::chunk_iovs(int chunk_size, iovec** piovs, int* pnb_iovs)
+{
+#if SRS_PERF_CHUNK_IOVS_CACHE > 0
+    srs_assert(ptr);
+    
+    if (!payload || size <= 0 || chunk_size <= 0) {
+        return false;
+    }
+    
+    // find the cache which built by other consumers.
+    SrsSharedChunkIovs* cache = NULL;
+    for (int i = 0; i < ptr->nb_chunk_iovs; i++) {
+        SrsSharedChunkIovs* v = ptr->chunk_iovs[i];
+        if (v->chunk_size == chunk_size && v->stream_id == stream_id && v->timestamp == timestamp) {
+            cache = v;
+            break;
+        }
+    }
+    
+    // build the cache when slot available,
+    // we never replace the cache, for the iovs maybe in sending by other consumer.
+    if (!cache) {
+        if (ptr->nb_chunk_iovs >= SRS_PERF_CHUNK_IOVS_CACHE) {
+            return false;
+        }
+        
+        int nb_chunks = (size + chunk_size - 1) / chunk_size;
+        int nb_headers = SRS_CONSTS_RTMP_MAX_FMT0_HEADER_SIZE
+            + (nb_chunks - 1) * SRS_CONSTS_RTMP_MAX_FMT3_HEADER_SIZE;
+        
+        cache = new SrsSharedChunkIovs();
+        cache->chunk_size = chunk_size;
+        cache->stream_id = stream_id;
+        cache->timestamp = timestamp;
+        cache->headers = srs_pool_alloc(nb_headers);
+        cache->iovs = (iovec*)srs_pool_alloc(sizeof(iovec) * nb_chunks * 2);
+        
+        char* h = cache->headers;
+        char* hend = cache->headers + nb_headers;
+        iovec* iovs = cache->iovs;
+        
+        char* p = payload;
+        char* pend = payload + size;
+        while (p < pend) {
+            int nbh = chunk_header(h, (int)(hend - h), p == payload);
+            srs_assert(nbh > 0);
+            
+            int payload_size = srs_min(chunk_size, (int)(pend - p));
+            
+            iovs[0].iov_base = h;
+            iovs[0].iov_len = nbh;
+            iovs[1].iov_base = p;
+            iovs[1].iov_len = payload_size;
+            
+            h += nbh;
+            p += payload_size;
+            iovs += 2;
+        }
+        cache->nb_iovs = nb_chunks * 2;
+        
+        ptr->chunk_iovs[ptr->nb_chunk_iovs++] = cache;
+    }
+    
+    *piovs = cache->iovs;
+    *pnb_iovs = cache->nb_iovs;
+    
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SrsSharedPtrMessage::flv_tag(char** pheader, char** ppts)
+{
+#if SRS_PERF_FLV_TAG_CACHE > 0
+    srs_assert(ptr);
+    
+    if (!payload || size <= 0) {
+        return false;
+    }
+    
+    // the metadata always use timestamp 0.
+    int64_t ts = (is_audio() || is_video())? (timestamp & 0x7fffffff) : 0;
+    
+    // find the cache which built by other players.
+    for (int i = 0; i < ptr->nb_flv_tags; i++) {
+        if (ptr->flv_tag_timestamps[i] == ts) {
+            *pheader = ptr->flv_tag_headers[i];
+            *ppts = ptr->flv_tag_pts;
+            return true;
+        }
+    }
+    
+    // build the cache when slot available,
+    // we never replace the cache, for the tag maybe in sending by other player.
+    if (ptr->nb_flv_tags >= SRS_PERF_FLV_TAG_CACHE) {
+        return false;
+    }
+    
+    char type = SrsCodecFlvTagScript;
+    if (is_audio()) {
+        type = SrsCodecFlvTagAudio;
+    } else if (is_video()) {
+        type = SrsCodecFlvTagVideo;
+    }
+    
+    // the tag header, the type, data size, timestamp, extended timestamp and stream id(always 0).
+    char* p = ptr->flv_tag_headers[ptr->nb_flv_tags];
+    *p++ = type;
+    *p++ = (char)(size >> 16);
+    *p++ = (char)(size >> 8);
+    *p++ = (char)size;
+    *p++ = (char)(ts >> 16);
+    *p++ = (char)(ts >> 8);
+    *p++ = (char)ts;
+    *p++ = (char)(ts >> 24);
+    *p++ = 0x00;
+    *p++ = 0x00;
+    *p++ = 0x00;
+    
+    // the previous tag size, built by first player.
+    if (ptr->nb_flv_tags == 0) {
+        int pts = SRS_FLV_TAG_HEADER_SIZE + size;
+        p = ptr->flv_tag_pts;
+        *p++ = (char)(pts >> 24);
+        *p++ = (char)(pts >> 16);
+        *p++ = (char)(pts >> 8);
+        *p++ = (char)pts;
+    }
+    
+    ptr->flv_tag_timestamps[ptr->nb_flv_tags] = ts;
+    *pheader = ptr->flv_tag_headers[ptr->nb_flv_tags++];
+    *ppts = ptr->flv_tag_pts;
+    
+    return true;
+#else
+    return false;
+#endif
+}
+
 SrsSharedPtrMessage* SrsSharedPtrMessage::copy()
 {
     srs_assert(ptr);
     
     SrsSharedPtrMessage* copy = new SrsSharedPtrMessage();
+    copy_to(copy);
     
-    copy->ptr = ptr;
+    return copy;
+}
+
+void SrsSharedPtrMessage::copy_to(SrsSharedPtrMessage* dst)
+{
+    srs_assert(ptr);
+    
+    if (dst == this) {
+        return;
+    }
+    
+    dst->release();
+    
+    dst->ptr = ptr;
     ptr->shared_count++;
     
-    copy->timestamp = timestamp;
-    copy->stream_id = stream_id;
-    copy->payload = ptr->payload;
-    copy->size = ptr->size;
+    dst->timestamp = timestamp;
+    dst->stream_id = stream_id;
+    dst->payload = ptr->payload;
+    dst->size = ptr->size;
+}
+
+void SrsSharedPtrMessage::move_to(SrsSharedPtrMessage* dst)
+{
+    if (dst == this) {
+        return;
+    }
     
-    return copy;
+    dst->release();
+    
+    dst->ptr = ptr;
+    dst->timestamp = timestamp;
+    dst->stream_id = stream_id;
+    dst->payload = payload;
+    dst->size = size;
+    
+    ptr = NULL;
+    payload = NULL;
+    size = 0;
+}
+
+void SrsSharedPtrMessage::release()
+{
+    if (ptr) {
+        if (ptr->shared_count == 0) {
+            srs_freep(ptr);
+        } else {
+            ptr->shared_count--;
+        }
+    }
+    
+    ptr = NULL;
+    payload = NULL;
+    size = 0;
 }
 
 SrsFlvEncoder::SrsFlvEncoder()
@@ -532,6 +817,21 @@ int SrsFlvEncoder::write_tags(SrsSharedPtrMessage** msgs, int count)
     for (int i = 0; i < count; i++) {
         SrsSharedPtrMessage* msg = msgs[i];
         
+        // use the tag shared by all players.
+        char* shared_header = NULL;
+        char* shared_pts = NULL;
+        if (msg->flv_tag(&shared_header, &shared_pts)) {
+            iovs[0].iov_base = shared_header;
+            iovs[0].iov_len = SRS_FLV_TAG_HEADER_SIZE;
+            iovs[1].iov_base = msg->payload;
+            iovs[1].iov_len = msg->size;
+            iovs[2].iov_base = shared_pts;
+            iovs[2].iov_len = SRS_FLV_PREVIOUS_TAG_SIZE;
+            
+            iovs += 3;
+            continue;
+        }
+        
         // cache all flv header.
         if (msg->is_audio()) {
             if ((ret = write_audio_to_cache(msg->timestamp, msg->payload, msg->size, cache)) != ERROR_SUCCESS) {
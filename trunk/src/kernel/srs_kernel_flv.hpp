@@ -281,12 +281,24 @@ public:
      *       video/audio packet use raw bytes, no video/audio packet.
      */
     char* payload;
+    /**
+     * whether the payload is alloc from the message pool,
+     * user must reset it when steal the payload.
+     */
+    bool pooled;
 public:
     SrsCommonMessage();
     virtual ~SrsCommonMessage();
 public:
     /**
-     * alloc the payload to specified size of bytes.
+     * alloc and free the message from the message pool.
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+public:
+    /**
+     * alloc the payload to specified size of bytes,
+     * from the message pool when enabled.
      */
     virtual void create_payload(int size);
 public:
@@ -370,6 +382,31 @@ public:
      */
     char* payload;
 private:
+#if SRS_PERF_CHUNK_IOVS_CACHE > 0
+    /**
+     * the chunk headers and iovs of message to send in a chunk size,
+     * shared by all consumers with the same stream id and timestamp.
+     * @remark never modified once built, for the iovs maybe in sending.
+     */
+    class SrsSharedChunkIovs
+    {
+    public:
+        int chunk_size;
+        int32_t stream_id;
+        int64_t timestamp;
+        // the chunk headers, the c0 then all c3.
+        char* headers;
+        // the interleaved iovs of chunk header and chunk payload.
+        iovec* iovs;
+        int nb_iovs;
+    public:
+        SrsSharedChunkIovs();
+        virtual ~SrsSharedChunkIovs();
+    public:
+        static void* operator new(size_t size);
+        static void operator delete(void* p, size_t size);
+    };
+#endif
     class SrsSharedPtrPayload
     {
     public:
@@ -382,14 +419,39 @@ private:
         int size;
         // the reference count
         int shared_count;
+        // whether the payload is alloc from the message pool.
+        bool pooled;
+#if SRS_PERF_CHUNK_IOVS_CACHE > 0
+        // the cache of chunk iovs, lazy built when send to consumer.
+        int nb_chunk_iovs;
+        SrsSharedChunkIovs* chunk_iovs[SRS_PERF_CHUNK_IOVS_CACHE];
+#endif
+#if SRS_PERF_FLV_TAG_CACHE > 0
+        // the cache of flv tag headers of timestamps, lazy built when send to http flv player.
+        int nb_flv_tags;
+        int64_t flv_tag_timestamps[SRS_PERF_FLV_TAG_CACHE];
+        char flv_tag_headers[SRS_PERF_FLV_TAG_CACHE][SRS_FLV_TAG_HEADER_SIZE];
+        // the previous tag size, never changed for a payload.
+        char flv_tag_pts[SRS_FLV_PREVIOUS_TAG_SIZE];
+#endif
     public:
         SrsSharedPtrPayload();
         virtual ~SrsSharedPtrPayload();
+    public:
+        static void* operator new(size_t size);
+        static void operator delete(void* p, size_t size);
     };
     SrsSharedPtrPayload* ptr;
 public:
     SrsSharedPtrMessage();
     virtual ~SrsSharedPtrMessage();
+public:
+    /**
+     * alloc and free the message from the message pool,
+     * for each consumer copy the shared message.
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
 public:
     /**
      * create shared ptr message,
@@ -428,12 +490,50 @@ public:
      * @return the size of header.
      */
     virtual int chunk_header(char* cache, int nb_cache, bool c0);
+    /**
+     * get the interleaved iovs of chunk headers and payload to send message,
+     * which is built once and shared by all consumers with the same out chunk size,
+     * stream id and timestamp of message.
+     * @param chunk_size the out chunk size of consumer.
+     * @param piovs output the iovs, user should copy it and never free it.
+     * @param pnb_iovs output the number of iovs.
+     * @return false if cache is full or disabled, user should generate the chunk headers.
+     * @remark the iovs is valid until message freed.
+     */
+    virtual bool chunk_iovs(int chunk_size, iovec** piovs, int* pnb_iovs);
+    /**
+     * get the flv tag header and previous tag size to send message in flv,
+     * which is built once and shared by all http flv players with the same timestamp.
+     * @param pheader output the tag header of SRS_FLV_TAG_HEADER_SIZE bytes.
+     * @param ppts output the previous tag size of SRS_FLV_PREVIOUS_TAG_SIZE bytes.
+     * @return false if cache is full or disabled, user should generate the tag header.
+     * @remark the bytes is valid until message freed.
+     */
+    virtual bool flv_tag(char** pheader, char** ppts);
 public:
     /**
      * copy current shared ptr message, use ref-count.
      * @remark, assert object is created.
      */
     virtual SrsSharedPtrMessage* copy();
+    /**
+     * copy current shared ptr message to dst, use ref-count,
+     * without allocate the message object, for the dst is on stack or in queue.
+     * @remark the previous payload of dst is released.
+     * @remark, assert object is created.
+     */
+    virtual void copy_to(SrsSharedPtrMessage* dst);
+    /**
+     * move the reference of current message to dst, without change the ref-count,
+     * and current message is reset to empty, which is reusable.
+     * @remark the previous payload of dst is released.
+     */
+    virtual void move_to(SrsSharedPtrMessage* dst);
+    /**
+     * release the reference of payload, free it when no other reference,
+     * and current message is reset to empty, which is reusable.
+     */
+    virtual void release();
 };
 
 /**
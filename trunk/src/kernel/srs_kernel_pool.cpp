@@ -0,0 +1,237 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_kernel_pool.hpp>
+
+#include <new>
+
+using namespace std;
+
+// the header of block, the size class at first, and the next block when free,
+// 16 bytes to keep the buffer aligned for any type.
+#define SRS_POOL_BLOCK_HEADER 16
+// the size class of block which is not cached by pool.
+#define SRS_POOL_NO_CLASS -1
+
+#define srs_pool_block_class(block) (*(int*)(block))
+#define srs_pool_block_next(block) (*(char**)((block) + sizeof(void*)))
+
+SrsMessagePool* _srs_message_pool = NULL;
+
+/**
+ * get the size class of buffer, SRS_POOL_NO_CLASS when too large.
+ */
+static int srs_pool_class(int size)
+{
+    for (int i = 0; i < SRS_MESSAGE_POOL_CLASSES; i++) {
+        if (size <= (1 << (SRS_MESSAGE_POOL_MIN_SHIFT + i))) {
+            return i;
+        }
+    }
+    return SRS_POOL_NO_CLASS;
+}
+
+SrsMessagePool::SrsMessagePool(int64_t max_cached)
+{
+    max_cached_bytes = max_cached;
+
+    for (int i = 0; i < SRS_MESSAGE_POOL_CLASSES; i++) {
+        blocks[i] = NULL;
+    }
+    for (int i = 0; i < SRS_MESSAGE_POOL_OBJECTS; i++) {
+        object_sizes[i] = 0;
+        objects[i] = NULL;
+    }
+
+    nb_allocs = nb_reuses = nb_oversizes = 0;
+    nb_objects = nb_object_reuses = 0;
+    cached_bytes = 0;
+}
+
+SrsMessagePool::~SrsMessagePool()
+{
+    for (int i = 0; i < SRS_MESSAGE_POOL_CLASSES; i++) {
+        while (blocks[i]) {
+            char* block = blocks[i];
+            blocks[i] = srs_pool_block_next(block);
+            delete[] block;
+        }
+    }
+
+    for (int i = 0; i < SRS_MESSAGE_POOL_OBJECTS; i++) {
+        while (objects[i]) {
+            void* p = objects[i];
+            objects[i] = *(void**)p;
+            ::operator delete(p);
+        }
+    }
+}
+
+char* SrsMessagePool::alloc(int size)
+{
+    nb_allocs++;
+
+    int cls = srs_pool_class(size);
+
+    // too large, alloc it directly.
+    if (cls == SRS_POOL_NO_CLASS) {
+        nb_oversizes++;
+
+        char* block = new char[SRS_POOL_BLOCK_HEADER + size];
+        srs_pool_block_class(block) = SRS_POOL_NO_CLASS;
+        return block + SRS_POOL_BLOCK_HEADER;
+    }
+
+    int nb_block = SRS_POOL_BLOCK_HEADER + (1 << (SRS_MESSAGE_POOL_MIN_SHIFT + cls));
+
+    // reuse the freed block.
+    char* block = blocks[cls];
+    if (block) {
+        nb_reuses++;
+
+        blocks[cls] = srs_pool_block_next(block);
+        cached_bytes -= nb_block;
+        return block + SRS_POOL_BLOCK_HEADER;
+    }
+
+    block = new char[nb_block];
+    srs_pool_block_class(block) = cls;
+    return block + SRS_POOL_BLOCK_HEADER;
+}
+
+void SrsMessagePool::free(char* p)
+{
+    if (!p) {
+        return;
+    }
+
+    char* block = p - SRS_POOL_BLOCK_HEADER;
+    int cls = srs_pool_block_class(block);
+
+    // free it when not cached or the cache is full.
+    int nb_block = SRS_POOL_BLOCK_HEADER + (1 << (SRS_MESSAGE_POOL_MIN_SHIFT + cls));
+    if (cls == SRS_POOL_NO_CLASS || cached_bytes + nb_block > max_cached_bytes) {
+        delete[] block;
+        return;
+    }
+
+    srs_pool_block_next(block) = blocks[cls];
+    blocks[cls] = block;
+    cached_bytes += nb_block;
+}
+
+void* SrsMessagePool::alloc_object(size_t size)
+{
+    nb_objects++;
+
+    for (int i = 0; i < SRS_MESSAGE_POOL_OBJECTS; i++) {
+        if (object_sizes[i] != size || !objects[i]) {
+            continue;
+        }
+
+        nb_object_reuses++;
+
+        void* p = objects[i];
+        objects[i] = *(void**)p;
+        cached_bytes -= size;
+        return p;
+    }
+
+    return ::operator new(size);
+}
+
+void SrsMessagePool::free_object(void* p, size_t size)
+{
+    if (!p) {
+        return;
+    }
+
+    // find the free list of size, or bind a free list to the size.
+    int index = -1;
+    for (int i = 0; i < SRS_MESSAGE_POOL_OBJECTS; i++) {
+        if (object_sizes[i] == size) {
+            index = i;
+            break;
+        }
+        if (object_sizes[i] == 0 && index == -1) {
+            index = i;
+        }
+    }
+
+    // free it when no free list or the cache is full.
+    if (index == -1 || size < sizeof(void*) || cached_bytes + (int64_t)size > max_cached_bytes) {
+        ::operator delete(p);
+        return;
+    }
+
+    object_sizes[index] = size;
+    *(void**)p = objects[index];
+    objects[index] = p;
+    cached_bytes += size;
+}
+
+char* srs_pool_alloc(int size)
+{
+    if (_srs_message_pool) {
+        return _srs_message_pool->alloc(size);
+    }
+
+    char* block = new char[SRS_POOL_BLOCK_HEADER + size];
+    srs_pool_block_class(block) = SRS_POOL_NO_CLASS;
+    return block + SRS_POOL_BLOCK_HEADER;
+}
+
+void srs_pool_free(char* p)
+{
+    if (!p) {
+        return;
+    }
+
+    // the block which is not cached, maybe alloc when pool disabled.
+    char* block = p - SRS_POOL_BLOCK_HEADER;
+    if (srs_pool_block_class(block) == SRS_POOL_NO_CLASS) {
+        delete[] block;
+        return;
+    }
+
+    srs_assert(_srs_message_pool);
+    _srs_message_pool->free(p);
+}
+
+void* srs_pool_alloc_object(size_t size)
+{
+    if (_srs_message_pool) {
+        return _srs_message_pool->alloc_object(size);
+    }
+    return ::operator new(size);
+}
+
+void srs_pool_free_object(void* p, size_t size)
+{
+    if (_srs_message_pool) {
+        _srs_message_pool->free_object(p, size);
+        return;
+    }
+    ::operator delete(p);
+}
+
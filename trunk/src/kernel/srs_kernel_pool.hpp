@@ -0,0 +1,107 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2017 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_KERNEL_POOL_HPP
+#define SRS_KERNEL_POOL_HPP
+
+/*
+#include <srs_kernel_pool.hpp>
+*/
+#include <srs_core.hpp>
+
+#include <stddef.h>
+
+// the size classes of buffer, from 2^7(128B) to 2^20(1MB).
+#define SRS_MESSAGE_POOL_MIN_SHIFT 7
+#define SRS_MESSAGE_POOL_MAX_SHIFT 20
+#define SRS_MESSAGE_POOL_CLASSES (SRS_MESSAGE_POOL_MAX_SHIFT - SRS_MESSAGE_POOL_MIN_SHIFT + 1)
+// the max number of object sizes, for example, the message and shared payload.
+#define SRS_MESSAGE_POOL_OBJECTS 4
+
+/**
+ * the slab pool for the payloads and objects of messages, the freed buffer
+ * is cached in the free list of its size class(power of 2), and the freed
+ * object is cached in the free list of its size, to reuse by next message,
+ * so the publish and play never malloc in steady state, and the memory is
+ * never fragmented by the variable size of payloads.
+ * @remark the pool is not thread safe, it's only enabled by server which runs
+ *       in the single st thread, while the librtmp never enable it.
+ */
+class SrsMessagePool
+{
+private:
+    // the free list of buffers for each size class, linked by the block header.
+    char* blocks[SRS_MESSAGE_POOL_CLASSES];
+    // the free list of objects for each object size, linked by the first pointer.
+    size_t object_sizes[SRS_MESSAGE_POOL_OBJECTS];
+    void* objects[SRS_MESSAGE_POOL_OBJECTS];
+    // the max bytes cached in free lists.
+    int64_t max_cached_bytes;
+public:
+    // the number of buffers allocated, and reused from free list.
+    int64_t nb_allocs;
+    int64_t nb_reuses;
+    // the number of buffers too large to cache.
+    int64_t nb_oversizes;
+    // the number of objects allocated, and reused from free list.
+    int64_t nb_objects;
+    int64_t nb_object_reuses;
+    // the bytes of buffers and objects in free lists.
+    int64_t cached_bytes;
+public:
+    SrsMessagePool(int64_t max_cached);
+    virtual ~SrsMessagePool();
+public:
+    /**
+     * alloc a buffer of size bytes, from the free list of its size class.
+     * @remark user must free it by free() of pool.
+     */
+    virtual char* alloc(int size);
+    virtual void free(char* p);
+    /**
+     * alloc an object of size bytes, from the free list of the size.
+     * @remark user must free it by free_object() of pool with the same size.
+     */
+    virtual void* alloc_object(size_t size);
+    virtual void free_object(void* p, size_t size);
+};
+
+// the pool of messages, NULL when disabled.
+extern SrsMessagePool* _srs_message_pool;
+
+/**
+ * alloc the buffer from pool, or new when pool is disabled.
+ * @remark user must free the buffer by srs_pool_free.
+ */
+extern char* srs_pool_alloc(int size);
+extern void srs_pool_free(char* p);
+
+/**
+ * alloc the object from pool, or operator new when pool is disabled,
+ * for the operator new and delete of class.
+ */
+extern void* srs_pool_alloc_object(size_t size);
+extern void srs_pool_free_object(void* p, size_t size);
+
+#endif
+
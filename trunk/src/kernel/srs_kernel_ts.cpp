@@ -42,6 +42,7 @@ using namespace std;
 #include <srs_kernel_utility.hpp>
 #include <srs_kernel_buffer.hpp>
 #include <srs_core_autofree.hpp>
+#include <srs_core_performance.hpp>
 
 // in ms, for HLS aac sync time.
 #define SRS_CONF_DEFAULT_AAC_SYNC 100
@@ -203,10 +204,14 @@ SrsTsContext::SrsTsContext()
     sync_byte = 0x47; // ts default sync byte.
     vcodec = SrsCodecVideoReserved;
     acodec = SrsCodecAudioReserved1;
+    packets = new char[SRS_TS_PACKET_SIZE * SRS_PERF_TS_WRITE_PACKETS];
+    nb_packets = 0;
 }
 
 SrsTsContext::~SrsTsContext()
 {
+    srs_freepa(packets);
+    
     std::map<int, SrsTsChannel*>::iterator it;
     for (it = pids.begin(); it != pids.end(); ++it) {
         SrsTsChannel* channel = it->second;
@@ -237,6 +242,9 @@ void SrsTsContext::reset()
 {
     vcodec = SrsCodecVideoReserved;
     acodec = SrsCodecAudioReserved1;
+    
+    // drop the packets of previous segment, which failed to write.
+    nb_packets = 0;
 }
 
 SrsTsChannel* SrsTsContext::get(int pid)
@@ -355,20 +363,34 @@ int SrsTsContext::encode(SrsFileWriter* writer, SrsTsMessage* msg, SrsCodecVideo
     }
     
     // when any codec changed, write PAT/PMT table.
+    SrsCodecVideo prev_vcodec = vcodec;
+    SrsCodecAudio prev_acodec = acodec;
     if (vcodec != vc || acodec != ac) {
         vcodec = vc;
         acodec = ac;
-        if ((ret = encode_pat_pmt(writer, video_pid, vs, audio_pid, as)) != ERROR_SUCCESS) {
-            return ret;
-        }
+        ret = encode_pat_pmt(writer, video_pid, vs, audio_pid, as);
     }
 
     // encode the media frame to PES packets over TS.
-    if (msg->is_audio()) {
-        return encode_pes(writer, msg, audio_pid, as, vs == SrsTsStreamReserved);
-    } else {
-        return encode_pes(writer, msg, video_pid, vs, vs == SrsTsStreamReserved);
+    if (ret == ERROR_SUCCESS) {
+        if (msg->is_audio()) {
+            ret = encode_pes(writer, msg, audio_pid, as, vs == SrsTsStreamReserved);
+        } else {
+            ret = encode_pes(writer, msg, video_pid, vs, vs == SrsTsStreamReserved);
+        }
+    }
+    
+    // drop the packets when error, to not write a broken frame,
+    // and restore the codec to write the dropped PAT/PMT for next frame.
+    if (ret != ERROR_SUCCESS) {
+        nb_packets = 0;
+        vcodec = prev_vcodec;
+        acodec = prev_acodec;
+        return ret;
     }
+    
+    // write all packets of PSI and frame in a time.
+    return flush_packets(writer);
 }
 
 void SrsTsContext::set_sync_byte(int8_t sb)
@@ -394,8 +416,10 @@ int SrsTsContext::encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStrea
 
         pkt->sync_byte = sync_byte;
 
-        char* buf = new char[SRS_TS_PACKET_SIZE];
-        SrsAutoFreeA(char, buf);
+        char* buf = NULL;
+        if ((ret = alloc_packet(writer, &buf)) != ERROR_SUCCESS) {
+            return ret;
+        }
 
         // set the left bytes with 0xFF.
         int nb_buf = pkt->size();
@@ -410,10 +434,6 @@ int SrsTsContext::encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStrea
             srs_error("ts encode ts packet failed. ret=%d", ret);
             return ret;
         }
-        if ((ret = writer->write(buf, SRS_TS_PACKET_SIZE, NULL)) != ERROR_SUCCESS) {
-            srs_error("ts write ts packet failed. ret=%d", ret);
-            return ret;
-        }
     }
     if (true) {
         SrsTsPacket* pkt = SrsTsPacket::create_pmt(this, pmt_number, pmt_pid, vpid, vs, apid, as);
@@ -421,8 +441,10 @@ int SrsTsContext::encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStrea
 
         pkt->sync_byte = sync_byte;
 
-        char* buf = new char[SRS_TS_PACKET_SIZE];
-        SrsAutoFreeA(char, buf);
+        char* buf = NULL;
+        if ((ret = alloc_packet(writer, &buf)) != ERROR_SUCCESS) {
+            return ret;
+        }
 
         // set the left bytes with 0xFF.
         int nb_buf = pkt->size();
@@ -437,10 +459,6 @@ int SrsTsContext::encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStrea
             srs_error("ts encode ts packet failed. ret=%d", ret);
             return ret;
         }
-        if ((ret = writer->write(buf, SRS_TS_PACKET_SIZE, NULL)) != ERROR_SUCCESS) {
-            srs_error("ts write ts packet failed. ret=%d", ret);
-            return ret;
-        }
     }
 
     return ret;
@@ -504,8 +522,10 @@ int SrsTsContext::encode_pes(SrsFileWriter* writer, SrsTsMessage* msg, int16_t p
 
         pkt->sync_byte = sync_byte;
 
-        char* buf = new char[SRS_TS_PACKET_SIZE];
-        SrsAutoFreeA(char, buf);
+        char* buf = NULL;
+        if ((ret = alloc_packet(writer, &buf)) != ERROR_SUCCESS) {
+            return ret;
+        }
 
         // set the left bytes with 0xFF.
         int nb_buf = pkt->size();
@@ -539,12 +559,44 @@ int SrsTsContext::encode_pes(SrsFileWriter* writer, SrsTsMessage* msg, int16_t p
             srs_error("ts encode ts packet failed. ret=%d", ret);
             return ret;
         }
-        if ((ret = writer->write(buf, SRS_TS_PACKET_SIZE, NULL)) != ERROR_SUCCESS) {
-            srs_error("ts write ts packet failed. ret=%d", ret);
+    }
+
+    return ret;
+}
+
+int SrsTsContext::alloc_packet(SrsFileWriter* writer, char** ppacket)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // flush the packets when buffer is full,
+    // for example, a large I frame over hundreds of packets.
+    if (nb_packets >= SRS_PERF_TS_WRITE_PACKETS) {
+        if ((ret = flush_packets(writer)) != ERROR_SUCCESS) {
             return ret;
         }
     }
+    
+    *ppacket = packets + SRS_TS_PACKET_SIZE * nb_packets++;
+    
+    return ret;
+}
 
+int SrsTsContext::flush_packets(SrsFileWriter* writer)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (nb_packets <= 0) {
+        return ret;
+    }
+    
+    int size = SRS_TS_PACKET_SIZE * nb_packets;
+    nb_packets = 0;
+    
+    if ((ret = writer->write(packets, size, NULL)) != ERROR_SUCCESS) {
+        srs_error("ts write ts packets failed, size=%d. ret=%d", size, ret);
+        return ret;
+    }
+    
     return ret;
 }
 
@@ -3207,6 +3259,13 @@ int SrsTsEncoder::write_video(int64_t timestamp, char* data, int size)
     return flush_video();
 }
 
+void SrsTsEncoder::refresh_pat_pmt()
+{
+    // the codec of context is reset, to write PAT/PMT for next frame,
+    // while the continuity counter of pids is kept.
+    context->reset();
+}
+
 int SrsTsEncoder::flush_audio()
 {
     int ret = ERROR_SUCCESS;
@@ -356,6 +356,12 @@ private:
     // when any codec changed, write the PAT/PMT.
     SrsCodecVideo vcodec;
     SrsCodecAudio acodec;
+    // the reusable buffer to mux the ts packets of a frame in,
+    // which is flushed to writer in one write when frame done or buffer full.
+    // @remark the buffer is always 188 aligned, for each ts packet is 188 bytes.
+    char* packets;
+    // the number of ts packets in buffer.
+    int nb_packets;
 public:
     SrsTsContext();
     virtual ~SrsTsContext();
@@ -411,6 +417,17 @@ public:
 private:
     virtual int encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStream vs, int16_t apid, SrsTsStream as);
     virtual int encode_pes(SrsFileWriter* writer, SrsTsMessage* msg, int16_t pid, SrsTsStream sid, bool pure_audio);
+    /**
+     * encode the ts packet to the next 188 bytes of packets buffer,
+     * the packet is padding with stuffings to 188 bytes by caller.
+     * @param ppacket output the 188 bytes of the packet in buffer.
+     * @remark flush the buffer to writer when it's full.
+     */
+    virtual int alloc_packet(SrsFileWriter* writer, char** ppacket);
+    /**
+     * flush all ts packets in buffer to writer, in one write.
+     */
+    virtual int flush_packets(SrsFileWriter* writer);
 };
 
 /**
@@ -1668,6 +1685,11 @@ public:
     */
     virtual int write_audio(int64_t timestamp, char* data, int size);
     virtual int write_video(int64_t timestamp, char* data, int size);
+    /**
+     * write the PAT/PMT again before next frame,
+     * so the stream can be decoded from the frame.
+     */
+    virtual void refresh_pat_pmt();
 private:
     virtual int flush_audio();
     virtual int flush_video();
@@ -37,6 +37,26 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdlib.h>
 
 #include <vector>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+// the crc32 by carry-less multiply, the x86_64 cpu is detected at runtime,
+// while the arm64 crc32 instructions must be enabled by compiler, for example,
+// the -march=armv8-a+crc.
+#if defined(__x86_64__) && defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__))
+    #define SRS_CRC32_PCLMUL
+    #include <cpuid.h>
+    #include <smmintrin.h>
+    #include <wmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #define SRS_CRC32_ARMV8
+    #include <arm_acle.h>
+#endif
+
 using namespace std;
 
 #include <srs_kernel_log.hpp>
@@ -582,6 +602,113 @@ bool srs_avc_startswith_annexb(SrsBuffer* stream, int* pnb_start_code)
     return false;
 }
 
+/**
+* find the "00 00 01" in bytes [p, end).
+* @return the position of "00 00 01", NULL when not found.
+*/
+static char* srs_avc_find_001(char* p, char* end)
+{
+#if defined(__SSE2__)
+    // compare 16 positions in a time, the bytes of p, p+1 and p+2.
+    __m128i zero = _mm_setzero_si128();
+    __m128i one = _mm_set1_epi8(0x01);
+    while (end - p >= 18) {
+        __m128i b0 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i*)p), zero);
+        __m128i b1 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i*)(p + 1)), zero);
+        __m128i b2 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i*)(p + 2)), one);
+        
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(b0, b1), b2));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    // compare 16 positions in a time, then find the matched in scalar.
+    uint8x16_t zero = vdupq_n_u8(0x00);
+    uint8x16_t one = vdupq_n_u8(0x01);
+    while (end - p >= 18) {
+        uint8x16_t b0 = vceqq_u8(vld1q_u8((uint8_t*)p), zero);
+        uint8x16_t b1 = vceqq_u8(vld1q_u8((uint8_t*)(p + 1)), zero);
+        uint8x16_t b2 = vceqq_u8(vld1q_u8((uint8_t*)(p + 2)), one);
+        
+        if (vmaxvq_u8(vandq_u8(vandq_u8(b0, b1), b2))) {
+            break;
+        }
+        p += 16;
+    }
+#endif
+    
+    // the scalar, for the tail or when no SIMD.
+    // when p[2] > 1, none of p, p+1 and p+2 is the start of "00 00 01".
+    while (end - p >= 3) {
+        if ((u_int8_t)p[2] > 0x01) {
+            p += 3;
+        } else if (p[2] == 0x01 && p[1] == 0x00 && p[0] == 0x00) {
+            return p;
+        } else {
+            p++;
+        }
+    }
+    
+    return NULL;
+}
+
+char* srs_avc_find_annexb(char* p, char* end, int* pnb_start_code)
+{
+    char* q = srs_avc_find_001(p, end);
+    if (!q) {
+        if (pnb_start_code) {
+            *pnb_start_code = 0;
+        }
+        return end;
+    }
+    
+    // the start code is N[00] 00 00 01, where N>=0
+    char* start = q;
+    while (start > p && start[-1] == 0x00) {
+        start--;
+    }
+    
+    if (pnb_start_code) {
+        *pnb_start_code = (int)(q - start) + 3;
+    }
+    
+    return start;
+}
+
+int srs_avc_split_annexb(char* data, int size, char** nalus, int* sizes, int max)
+{
+    char* end = data + size;
+    
+    // must starts with start code.
+    int nb_start_code = 0;
+    char* p = srs_avc_find_annexb(data, end, &nb_start_code);
+    if (p != data || nb_start_code == 0) {
+        return 0;
+    }
+    
+    int nb_nalus = 0;
+    while (p < end && nb_nalus < max) {
+        // skip the start code.
+        p += nb_start_code;
+        
+        // the NALU ends at the next start code, or the end of frame.
+        char* next = srs_avc_find_annexb(p, end, &nb_start_code);
+        
+        // ignore the empty.
+        if (next > p) {
+            nalus[nb_nalus] = p;
+            sizes[nb_nalus] = (int)(next - p);
+            nb_nalus++;
+        }
+        
+        p = next;
+    }
+    
+    return nb_nalus;
+}
+
 bool srs_aac_startswith_adts(SrsBuffer* stream)
 {
     char* bytes = stream->data() + stream->pos();
@@ -600,6 +727,7 @@ bool srs_aac_startswith_adts(SrsBuffer* stream)
     return true;
 }
 
+// the byte-at-a-time crc32, the reference of the slicing-by-8 and hardware crc32.
 // @see http://www.stmc.edu.hk/~vincent/ffmpeg_0.4.9-pre1/libavformat/mpegtsenc.c
 unsigned int __mpegts_crc32(const u_int8_t *data, int len)
 {
@@ -749,14 +877,293 @@ u_int32_t __crc32_ieee(u_int32_t init, const u_int8_t* buf, size_t nb_buf)
     return crc^0xFFFFFFFF;
 }
 
+// the slicing-by-8 tables, the table[0] is the byte table, and the table[k]
+// is the crc of byte followed by k zero bytes, to lookup 8 bytes in a time.
+// @see Intel, A Systematic Approach to Building High Performance Software-based CRC Generators.
+static bool _srs_crc32_initialized = false;
+static u_int32_t _srs_crc32_mpegts_table[8][256];
+static u_int32_t _srs_crc32_ieee_table[8][256];
+
+static void srs_crc32_init_tables()
+{
+    // the byte tables, same to the tables of __mpegts_crc32 and __crc32_ieee.
+    for (u_int32_t i = 0; i < 256; i++) {
+        u_int32_t v = i << 24;
+        for (int j = 0; j < 8; j++) {
+            v = (v & 0x80000000)? (v << 1) ^ 0x04c11db7 : (v << 1);
+        }
+        _srs_crc32_mpegts_table[0][i] = v;
+        
+        v = i;
+        for (int j = 0; j < 8; j++) {
+            v = (v & 0x01)? (v >> 1) ^ 0xedb88320 : (v >> 1);
+        }
+        _srs_crc32_ieee_table[0][i] = v;
+    }
+    
+    for (int k = 1; k < 8; k++) {
+        for (int i = 0; i < 256; i++) {
+            u_int32_t v = _srs_crc32_mpegts_table[k - 1][i];
+            _srs_crc32_mpegts_table[k][i] = (v << 8) ^ _srs_crc32_mpegts_table[0][v >> 24];
+            
+            v = _srs_crc32_ieee_table[k - 1][i];
+            _srs_crc32_ieee_table[k][i] = (v >> 8) ^ _srs_crc32_ieee_table[0][v & 0xff];
+        }
+    }
+}
+
+// the crc32 of mpegts, MSB first, by slicing-by-8.
+static u_int32_t srs_crc32_mpegts_slice8(u_int32_t crc, const u_int8_t* p, int size)
+{
+    u_int32_t (*t)[256] = _srs_crc32_mpegts_table;
+    
+    for (; size >= 8; p += 8, size -= 8) {
+        u_int32_t lo = crc ^ ((u_int32_t)p[0] << 24 | (u_int32_t)p[1] << 16 | (u_int32_t)p[2] << 8 | p[3]);
+        u_int32_t hi = (u_int32_t)p[4] << 24 | (u_int32_t)p[5] << 16 | (u_int32_t)p[6] << 8 | p[7];
+        crc = t[7][lo >> 24] ^ t[6][(lo >> 16) & 0xff] ^ t[5][(lo >> 8) & 0xff] ^ t[4][lo & 0xff]
+            ^ t[3][hi >> 24] ^ t[2][(hi >> 16) & 0xff] ^ t[1][(hi >> 8) & 0xff] ^ t[0][hi & 0xff];
+    }
+    
+    for (; size > 0; p++, size--) {
+        crc = (crc << 8) ^ t[0][((crc >> 24) ^ *p) & 0xff];
+    }
+    
+    return crc;
+}
+
+// the crc32 of IEEE, LSB first(reflected), by slicing-by-8.
+// @remark the crc is the inverted state, that is, 0xffffffff to start.
+static u_int32_t srs_crc32_ieee_slice8(u_int32_t crc, const u_int8_t* p, int size)
+{
+    u_int32_t (*t)[256] = _srs_crc32_ieee_table;
+    
+    for (; size >= 8; p += 8, size -= 8) {
+        u_int32_t lo = crc ^ (p[0] | (u_int32_t)p[1] << 8 | (u_int32_t)p[2] << 16 | (u_int32_t)p[3] << 24);
+        u_int32_t hi = p[4] | (u_int32_t)p[5] << 8 | (u_int32_t)p[6] << 16 | (u_int32_t)p[7] << 24;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+            ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    
+    for (; size > 0; p++, size--) {
+        crc = t[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+    }
+    
+    return crc;
+}
+
+#ifdef SRS_CRC32_PCLMUL
+// the crc32 of IEEE by folding 64 bytes in a time with carry-less multiply,
+// then barrett reduce to 32bits, the size must be at least 64 and multiple of 16.
+// @see Intel, Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction.
+// @see https://chromium.googlesource.com/chromium/src/third_party/zlib/+/master/crc32_simd.c
+// @remark the crc is the inverted state, that is, 0xffffffff to start.
+__attribute__((target("sse4.1,pclmul")))
+static u_int32_t srs_crc32_ieee_pclmul_fold(u_int32_t crc, const u_int8_t* p, int size)
+{
+    // the constants of bit-reflected domain, x^(4*128+32) mod P, etc.
+    static const u_int64_t k1k2[] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+    static const u_int64_t k3k4[] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+    static const u_int64_t k5k0[] = { 0x0163cd6124ULL, 0x0000000000ULL };
+    static const u_int64_t poly[] = { 0x01db710641ULL, 0x01f7011641ULL };
+    
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+    
+    x1 = _mm_loadu_si128((__m128i*)(p + 0x00));
+    x2 = _mm_loadu_si128((__m128i*)(p + 0x10));
+    x3 = _mm_loadu_si128((__m128i*)(p + 0x20));
+    x4 = _mm_loadu_si128((__m128i*)(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    
+    x0 = _mm_loadu_si128((__m128i*)k1k2);
+    p += 64;
+    size -= 64;
+    
+    // fold the 4x128bits in parallel.
+    while (size >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        
+        y5 = _mm_loadu_si128((__m128i*)(p + 0x00));
+        y6 = _mm_loadu_si128((__m128i*)(p + 0x10));
+        y7 = _mm_loadu_si128((__m128i*)(p + 0x20));
+        y8 = _mm_loadu_si128((__m128i*)(p + 0x30));
+        
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+        
+        p += 64;
+        size -= 64;
+    }
+    
+    // fold the 4x128bits into 128bits.
+    x0 = _mm_loadu_si128((__m128i*)k3k4);
+    
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+    
+    // fold the left 16 bytes blocks.
+    while (size >= 16) {
+        x2 = _mm_loadu_si128((__m128i*)p);
+        
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        
+        p += 16;
+        size -= 16;
+    }
+    
+    // fold 128bits to 64bits.
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    
+    x0 = _mm_loadl_epi64((__m128i*)k5k0);
+    
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    
+    // barrett reduce to 32bits.
+    x0 = _mm_loadu_si128((__m128i*)poly);
+    
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    
+    return (u_int32_t)_mm_extract_epi32(x1, 1);
+}
+
+static u_int32_t srs_crc32_ieee_pclmul(u_int32_t crc, const u_int8_t* p, int size)
+{
+    // for small buffer, for example, the kafka key, the table is faster.
+    if (size >= 64) {
+        int nb_fold = size & ~15;
+        crc = srs_crc32_ieee_pclmul_fold(crc, p, nb_fold);
+        p += nb_fold;
+        size -= nb_fold;
+    }
+    return srs_crc32_ieee_slice8(crc, p, size);
+}
+#endif
+
+#ifdef SRS_CRC32_ARMV8
+// the crc32 of IEEE by the arm64 crc32 instructions, 8 bytes in a time.
+// @remark the crc is the inverted state, that is, 0xffffffff to start.
+static u_int32_t srs_crc32_ieee_armv8(u_int32_t crc, const u_int8_t* p, int size)
+{
+    for (; size >= 8; p += 8, size -= 8) {
+        u_int64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32d(crc, v);
+    }
+    for (; size > 0; p++, size--) {
+        crc = __crc32b(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+// the crc32 kernel of IEEE, selected by cpu at the first time.
+static u_int32_t (*_srs_crc32_ieee_kernel)(u_int32_t, const u_int8_t*, int) = NULL;
+static const char* _srs_crc32_ieee_kernel_name = NULL;
+
+static void srs_crc32_initialize()
+{
+    if (_srs_crc32_initialized) {
+        return;
+    }
+    
+    srs_crc32_init_tables();
+    
+    _srs_crc32_ieee_kernel = srs_crc32_ieee_slice8;
+    _srs_crc32_ieee_kernel_name = "slice8";
+    
+#ifdef SRS_CRC32_PCLMUL
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1)) {
+        _srs_crc32_ieee_kernel = srs_crc32_ieee_pclmul;
+        _srs_crc32_ieee_kernel_name = "pclmul";
+    }
+#endif
+    
+#ifdef SRS_CRC32_ARMV8
+    _srs_crc32_ieee_kernel = srs_crc32_ieee_armv8;
+    _srs_crc32_ieee_kernel_name = "armv8";
+#endif
+    
+    _srs_crc32_initialized = true;
+}
+
+// initialize the crc32 once when program starts, before any pthread is created,
+// so the tables and kernel are never initialized by st and pthreads at the same time.
+class SrsCrc32Initializer
+{
+public:
+    SrsCrc32Initializer() {
+        srs_crc32_initialize();
+    }
+};
+static SrsCrc32Initializer _srs_crc32_initializer;
+
 u_int32_t srs_crc32_mpegts(const void* buf, int size)
 {
-    return __mpegts_crc32((const u_int8_t*)buf, size);
+    srs_crc32_initialize();
+    return srs_crc32_mpegts_slice8(0xffffffff, (const u_int8_t*)buf, size);
 }
     
 u_int32_t srs_crc32_ieee(const void* buf, int size, u_int32_t previous)
 {
-    return __crc32_ieee(previous, (const u_int8_t*)buf, size);
+    srs_crc32_initialize();
+    return ~_srs_crc32_ieee_kernel(~previous, (const u_int8_t*)buf, size);
+}
+
+const char* srs_crc32_ieee_kernel()
+{
+    srs_crc32_initialize();
+    return _srs_crc32_ieee_kernel_name;
+}
+
+SrsCrc32Ieee::SrsCrc32Ieee()
+{
+    crc = 0xffffffff;
+}
+
+SrsCrc32Ieee::~SrsCrc32Ieee()
+{
+}
+
+void SrsCrc32Ieee::update(const void* buf, int size)
+{
+    srs_crc32_initialize();
+    crc = _srs_crc32_ieee_kernel(crc, (const u_int8_t*)buf, size);
+}
+
+u_int32_t SrsCrc32Ieee::value()
+{
+    return ~crc;
 }
 
 /*
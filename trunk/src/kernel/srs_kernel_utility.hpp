@@ -119,6 +119,27 @@ extern std::string srs_path_filext(std::string path);
 */
 extern bool srs_avc_startswith_annexb(SrsBuffer* stream, int* pnb_start_code = NULL);
 
+/**
+* find the next avc start code "N[00] 00 00 01" in bytes [p, end), by SIMD
+* when available, SSE2 for x86_64 and NEON for arm64, or scalar which skips
+* 3 bytes when possible, never check the start code for each byte.
+* @param pnb_start_code output the size of start code, 0 when not found.
+*       NULL to ignore.
+* @return the start of start code, that is the first leading zero, or end
+*       when not found.
+*/
+extern char* srs_avc_find_annexb(char* p, char* end, int* pnb_start_code = NULL);
+
+/**
+* split the "AnnexB" frame to NALUs in one pass, by srs_avc_find_annexb.
+* @param nalus output the start bytes of NALUs, without start code.
+* @param sizes output the size of NALUs.
+* @param max the max number of NALUs to output.
+* @return the number of NALUs, the empty NALU is ignored,
+*       0 when frame not starts with start code.
+*/
+extern int srs_avc_split_annexb(char* data, int size, char** nalus, int* sizes, int max);
+
 /**
 * whether stream starts with the aac ADTS 
 * from aac-mp4a-format-ISO_IEC_14496-3+2001.pdf, page 75, 1.A.2.2 ADTS.
@@ -133,9 +154,35 @@ extern u_int32_t srs_crc32_mpegts(const void* buf, int size);
 
 /**
  * calc the crc32 of bytes in buf by IEEE, for zip.
+ * @param previous the crc32 of previous bytes, to calc the crc32 in pieces.
+ * @remark use the hardware crc32 when cpu supports, @see srs_crc32_ieee_kernel()
  */
 extern u_int32_t srs_crc32_ieee(const void* buf, int size, u_int32_t previous = 0);
 
+/**
+ * get the crc32 kernel of IEEE selected by cpu,
+ * the "pclmul" for x86_64, "armv8" for arm64, or "slice8" by tables.
+ */
+extern const char* srs_crc32_ieee_kernel();
+
+/**
+ * the incremental crc32 by IEEE, to update by the pieces of data,
+ * for example, the fields of kafka message which are not continuous.
+ */
+class SrsCrc32Ieee
+{
+private:
+    // the inverted crc of the updated bytes.
+    u_int32_t crc;
+public:
+    SrsCrc32Ieee();
+    virtual ~SrsCrc32Ieee();
+public:
+    virtual void update(const void* buf, int size);
+    // get the crc32 of all updated bytes.
+    virtual u_int32_t value();
+};
+
 /**
 * Decode a base64-encoded string.
 *
@@ -47,6 +47,7 @@ using namespace std;
 #include <srs_core_performance.hpp>
 #include <srs_app_utility.hpp>
 #include <srs_core_autofree.hpp>
+#include <srs_app_worker.hpp>
 
 // pre-declare
 int run(SrsServer* svr);
@@ -412,6 +413,25 @@ int run_master(SrsServer* svr)
 {
     int ret = ERROR_SUCCESS;
     
+    // the master hold the pid file, then fork the workers,
+    // which initialize the st and serve clients.
+    SrsWorkers* workers = SrsWorkers::instance();
+    if (_srs_config->get_workers() > 0) {
+        if ((ret = svr->acquire_pid_file()) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        if ((ret = workers->fork_workers(_srs_config->get_workers())) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        // the master quit when all workers quit,
+        // never dispose the server, for the st is not initialized.
+        if (!workers->is_worker()) {
+            exit(0);
+        }
+    }
+    
     if ((ret = svr->initialize_st()) != ERROR_SUCCESS) {
         return ret;
     }
@@ -420,7 +440,7 @@ int run_master(SrsServer* svr)
         return ret;
     }
     
-    if ((ret = svr->acquire_pid_file()) != ERROR_SUCCESS) {
+    if (!workers->is_worker() && (ret = svr->acquire_pid_file()) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -464,6 +464,14 @@ int SrsHttpFileServer::copy(ISrsHttpResponseWriter* w, SrsFileReader* fs, ISrsHt
 {
     int ret = ERROR_SUCCESS;
     
+#ifdef SRS_PERF_HTTP_SENDFILE
+    // send from current position of file, never read the file.
+    int64_t offset = fs->tellg();
+    if ((ret = w->sendfile(fs->get_fd(), offset, size)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    fs->lseek(offset + size);
+#else
     int left = size;
     char* buf = r->http_ts_send_buffer();
     
@@ -479,6 +487,7 @@ int SrsHttpFileServer::copy(ISrsHttpResponseWriter* w, SrsFileReader* fs, ISrsHt
             break;
         }
     }
+#endif
     
     return ret;
 }
@@ -511,8 +520,119 @@ ISrsHttpServeMux::~ISrsHttpServeMux()
 {
 }
 
+SrsHttpMuxTree::SrsHttpMuxNode::SrsHttpMuxNode()
+{
+    entry = NULL;
+}
+
+SrsHttpMuxTree::SrsHttpMuxNode::~SrsHttpMuxNode()
+{
+    std::vector<SrsHttpMuxNode*>::iterator it;
+    for (it = children.begin(); it != children.end(); ++it) {
+        SrsHttpMuxNode* node = *it;
+        srs_freep(node);
+    }
+    children.clear();
+}
+
+SrsHttpMuxTree::SrsHttpMuxNode* SrsHttpMuxTree::SrsHttpMuxNode::child(char ch)
+{
+    for (int i = 0; i < (int)children.size(); i++) {
+        SrsHttpMuxNode* node = children[i];
+        if (node->label.at(0) == ch) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+SrsHttpMuxTree::SrsHttpMuxTree()
+{
+    root = new SrsHttpMuxNode();
+}
+
+SrsHttpMuxTree::~SrsHttpMuxTree()
+{
+    srs_freep(root);
+}
+
+void SrsHttpMuxTree::insert(string pattern, SrsHttpMuxEntry* entry)
+{
+    SrsHttpMuxNode* node = root;
+    size_t pos = 0;
+    
+    while (pos < pattern.length()) {
+        SrsHttpMuxNode* next = node->child(pattern.at(pos));
+        
+        // no child, the left of pattern is the label of new node.
+        if (!next) {
+            next = new SrsHttpMuxNode();
+            next->label = pattern.substr(pos);
+            node->children.push_back(next);
+            
+            node = next;
+            break;
+        }
+        
+        // the common prefix of label and the left of pattern.
+        size_t n = 1;
+        while (n < next->label.length() && pos + n < pattern.length()
+            && next->label.at(n) == pattern.at(pos + n)) {
+            n++;
+        }
+        
+        // split the node when pattern ends in the label or diverges from it.
+        if (n < next->label.length()) {
+            SrsHttpMuxNode* mid = new SrsHttpMuxNode();
+            mid->label = next->label.substr(0, n);
+            next->label = next->label.substr(n);
+            mid->children.push_back(next);
+            
+            std::replace(node->children.begin(), node->children.end(), next, mid);
+            next = mid;
+        }
+        
+        node = next;
+        pos += n;
+    }
+    
+    node->entry = entry;
+}
+
+SrsHttpMuxEntry* SrsHttpMuxTree::match(const string& path)
+{
+    SrsHttpMuxEntry* matched = NULL;
+    
+    SrsHttpMuxNode* node = root;
+    size_t pos = 0;
+    
+    // walk down the path, the deeper matched entry is the longer pattern.
+    while (true) {
+        SrsHttpMuxEntry* entry = node->entry;
+        if (entry && entry->enabled) {
+            // exactly match, or the pattern ends with /
+            if (pos == path.length() || (pos > 0 && path.at(pos - 1) == '/')) {
+                matched = entry;
+            }
+        }
+        
+        if (pos >= path.length()) {
+            break;
+        }
+        
+        node = node->child(path.at(pos));
+        if (!node || path.compare(pos, node->label.length(), node->label) != 0) {
+            break;
+        }
+        pos += node->label.length();
+    }
+    
+    return matched;
+}
+
 SrsHttpServeMux::SrsHttpServeMux()
 {
+    tree = new SrsHttpMuxTree();
 }
 
 SrsHttpServeMux::~SrsHttpServeMux()
@@ -523,6 +643,7 @@ SrsHttpServeMux::~SrsHttpServeMux()
         srs_freep(entry);
     }
     entries.clear();
+    srs_freep(tree);
     
     vhosts.clear();
     hijackers.clear();
@@ -594,6 +715,7 @@ int SrsHttpServeMux::handle(std::string pattern, ISrsHttpHandler* handler)
             srs_freep(exists);
         }
         entries[pattern] = entry;
+        tree->insert(pattern, entry);
     }
     
     // Helpful behavior:
@@ -622,6 +744,7 @@ int SrsHttpServeMux::handle(std::string pattern, ISrsHttpHandler* handler)
             entry->handler->entry = entry;
             
             entries[rpattern] = entry;
+            tree->insert(rpattern, entry);
         }
     }
     
@@ -710,57 +833,13 @@ int SrsHttpServeMux::match(ISrsHttpMessage* r, ISrsHttpHandler** ph)
         path = r->host() + path;
     }
     
-    int nb_matched = 0;
-    ISrsHttpHandler* h = NULL;
-    
-    std::map<std::string, SrsHttpMuxEntry*>::iterator it;
-    for (it = entries.begin(); it != entries.end(); ++it) {
-        std::string pattern = it->first;
-        SrsHttpMuxEntry* entry = it->second;
-        
-        if (!entry->enabled) {
-            continue;
-        }
-        
-        if (!path_match(pattern, path)) {
-            continue;
-        }
-        
-        if (!h || (int)pattern.length() > nb_matched) {
-            nb_matched = (int)pattern.length();
-            h = entry->handler;
-        }
-    }
-    
-    *ph = h;
+    // find the longest pattern in the tree.
+    SrsHttpMuxEntry* entry = tree->match(path);
+    *ph = entry? entry->handler : NULL;
     
     return ret;
 }
 
-bool SrsHttpServeMux::path_match(string pattern, string path)
-{
-    if (pattern.empty()) {
-        return false;
-    }
-    
-    int n = (int)pattern.length();
-    
-    // not endswith '/', exactly match.
-    if (pattern.at(n - 1) != '/') {
-        return pattern == path;
-    }
-    
-    // endswith '/', match any,
-    // for example, '/api/' match '/api/[N]'
-    if ((int)path.length() >= n) {
-        if (memcmp(pattern.data(), path.data(), n) == 0) {
-            return true;
-        }
-    }
-    
-    return false;
-}
-
 SrsHttpCorsMux::SrsHttpCorsMux()
 {
     next = NULL;
@@ -35,6 +35,8 @@
 #include <string>
 #include <vector>
 
+#include <srs_core_performance.hpp>
+
 // for srs-librtmp, @see https://github.com/ossrs/srs/issues/213
 #ifndef _WIN32
 #include <sys/uio.h>
@@ -202,6 +204,13 @@ public:
      * @see https://github.com/ossrs/srs/issues/405
      */
     virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite) = 0;
+#ifdef SRS_PERF_HTTP_SENDFILE
+    /**
+     * send size bytes of file fd from offset, zero copy for static files.
+     * @remark the offset of file fd is not changed.
+     */
+    virtual int sendfile(int fd, int64_t offset, int64_t size) = 0;
+#endif
     
     // WriteHeader sends an HTTP response header with status code.
     // If WriteHeader is not called explicitly, the first call to Write
@@ -371,6 +380,50 @@ public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r) = 0;
 };
 
+/**
+ * the radix tree of mux entries, to match the longest pattern in O(length of path),
+ * whatever how many patterns, for example, thousands of http flv streams mounted.
+ * the key is the pattern, so the patterns of a vhost, which starts with the vhost,
+ * are in the same subtree.
+ * @remark the tree never free the entries, which is owned by mux.
+ * @remark the disabled entries are ignored when match, so no rebuild when disable.
+ */
+class SrsHttpMuxTree
+{
+private:
+    class SrsHttpMuxNode
+    {
+    public:
+        // the label of edge from parent to this node.
+        std::string label;
+        // the entry of pattern, NULL if no pattern ends at this node.
+        SrsHttpMuxEntry* entry;
+        std::vector<SrsHttpMuxNode*> children;
+    public:
+        SrsHttpMuxNode();
+        virtual ~SrsHttpMuxNode();
+    public:
+        // get the child whose label starts with ch, NULL if not found.
+        virtual SrsHttpMuxNode* child(char ch);
+    };
+    SrsHttpMuxNode* root;
+public:
+    SrsHttpMuxTree();
+    virtual ~SrsHttpMuxTree();
+public:
+    /**
+     * insert the entry of pattern, overwrite the exists entry of pattern.
+     */
+    virtual void insert(std::string pattern, SrsHttpMuxEntry* entry);
+    /**
+     * match the enabled entry of the longest pattern for path,
+     * the pattern ends with / match all paths starts with it,
+     * others match the path exactly.
+     * @return the matched entry, NULL if not matched.
+     */
+    virtual SrsHttpMuxEntry* match(const std::string& path);
+};
+
 // ServeMux is an HTTP request multiplexer.
 // It matches the URL of each incoming request against a list of registered
 // patterns and calls the handler for the pattern that
@@ -403,6 +456,8 @@ class SrsHttpServeMux : public ISrsHttpServeMux
 private:
     // the pattern handler, to handle the http request.
     std::map<std::string, SrsHttpMuxEntry*> entries;
+    // the radix tree of entries, to match the request.
+    SrsHttpMuxTree* tree;
     // the vhost handler.
     // when find the handler to process the request,
     // append the matched vhost when pattern not starts with /,
@@ -439,7 +494,6 @@ public:
 private:
     virtual int find_handler(ISrsHttpMessage* r, ISrsHttpHandler** ph);
     virtual int match(ISrsHttpMessage* r, ISrsHttpHandler** ph);
-    virtual bool path_match(std::string pattern, std::string path);
 };
 
 /**
@@ -212,19 +212,16 @@ void SrsKafkaBytes::set_value(const char* v, int nb_v)
     memcpy(_data, v, _size);
 }
 
-u_int32_t SrsKafkaBytes::crc32(u_int32_t previous)
+void SrsKafkaBytes::crc32(SrsCrc32Ieee* crc)
 {
     char bsize[4];
     SrsBuffer(bsize, 4).write_4bytes(_size);
     
-    if (_size <= 0) {
-        return srs_crc32_ieee(bsize, 4, previous);
-    }
-    
-    u_int32_t crc = srs_crc32_ieee(bsize, 4, previous);
-    crc = srs_crc32_ieee(_data, _size, crc);
+    crc->update(bsize, 4);
     
-    return crc;
+    if (_size > 0) {
+        crc->update(_data, _size);
+    }
 }
 
 int SrsKafkaBytes::nb_bytes()
@@ -535,7 +532,7 @@ SrsKafkaRawMessage::~SrsKafkaRawMessage()
     srs_freep(value);
 }
 
-int SrsKafkaRawMessage::create(SrsJsonObject* obj)
+int SrsKafkaRawMessage::create(SrsJsonObject* obj, SrsJsonWriter* writer)
 {
     int ret = ERROR_SUCCESS;
     
@@ -545,14 +542,18 @@ int SrsKafkaRawMessage::create(SrsJsonObject* obj)
     // no compression codec.
     attributes = 0;
     
-    // dumps the json to string.
-    value->set_value(obj->dumps());
+    // dumps the json to bytes.
+    writer->reset();
+    writer->any(obj);
+    value->set_value(writer->bytes(), writer->length());
     
     // crc32 message.
-    crc = srs_crc32_ieee(&magic_byte, 1);
-    crc = srs_crc32_ieee(&attributes, 1, crc);
-    crc = key->crc32(crc);
-    crc = value->crc32(crc);
+    SrsCrc32Ieee crc32;
+    crc32.update(&magic_byte, 1);
+    crc32.update(&attributes, 1);
+    key->crc32(&crc32);
+    value->crc32(&crc32);
+    crc = crc32.value();
     
     srs_info("crc32 message is %#x", crc);
     
@@ -1414,11 +1415,13 @@ int SrsKafkaProtocol::recv_message(SrsKafkaResponse** pmsg)
 SrsKafkaClient::SrsKafkaClient(ISrsProtocolReaderWriter* io)
 {
     protocol = new SrsKafkaProtocol(io);
+    writer = new SrsJsonWriter();
 }
 
 SrsKafkaClient::~SrsKafkaClient()
 {
     srs_freep(protocol);
+    srs_freep(writer);
 }
 
 int SrsKafkaClient::fetch_metadata(string topic, SrsKafkaTopicMetadataResponse** pmsg)
@@ -1471,7 +1474,7 @@ int SrsKafkaClient::write_messages(std::string topic, int32_t partition, vector<
         SrsJsonObject* obj = *it;
         SrsKafkaRawMessage* msg = new SrsKafkaRawMessage();
         
-        if ((ret = msg->create(obj)) != ERROR_SUCCESS) {
+        if ((ret = msg->create(obj, writer)) != ERROR_SUCCESS) {
             srs_freep(msg);
             srs_freep(req);
             srs_error("kafka write messages failed. ret=%d", ret);
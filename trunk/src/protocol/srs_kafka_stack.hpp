@@ -39,7 +39,9 @@
 
 class SrsFastStream;
 class ISrsProtocolReaderWriter;
+class SrsCrc32Ieee;
 class SrsJsonObject;
+class SrsJsonWriter;
 
 #ifdef SRS_AUTO_KAFKA
 
@@ -108,7 +110,10 @@ public:
     virtual bool empty();
     virtual void set_value(std::string v);
     virtual void set_value(const char* v, int nb_v);
-    virtual u_int32_t crc32(u_int32_t previous);
+    /**
+     * update the crc32 by the size and data of bytes.
+     */
+    virtual void crc32(SrsCrc32Ieee* crc);
 // interface ISrsCodec
 public:
     virtual int nb_bytes();
@@ -540,8 +545,9 @@ public:
 public:
     /**
      * create message from json object.
+     * @param writer the writer to dumps the json, reset before use.
      */
-    virtual int create(SrsJsonObject* obj);
+    virtual int create(SrsJsonObject* obj, SrsJsonWriter* writer);
 private:
     /**
      * get the raw message, bytes after the message_size.
@@ -923,6 +929,8 @@ class SrsKafkaClient
 {
 private:
     SrsKafkaProtocol* protocol;
+    // the writer to dumps the json of messages, reuse its buffer.
+    SrsJsonWriter* writer;
 public:
     SrsKafkaClient(ISrsProtocolReaderWriter* io);
     virtual ~SrsKafkaClient();
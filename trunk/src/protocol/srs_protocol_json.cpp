@@ -23,61 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_protocol_json.hpp>
 
-#include <sstream>
+#include <stdio.h>
+#include <string.h>
 using namespace std;
 
 #include <srs_kernel_log.hpp>
 #include <srs_protocol_amf0.hpp>
 #include <srs_kernel_utility.hpp>
-
-/* json encode
- cout<< SRS_JOBJECT_START
- << SRS_JFIELD_STR("name", "srs") << SRS_JFIELD_CONT
- << SRS_JFIELD_ORG("version", 100) << SRS_JFIELD_CONT
- << SRS_JFIELD_NAME("features") << SRS_JOBJECT_START
- << SRS_JFIELD_STR("rtmp", "released") << SRS_JFIELD_CONT
- << SRS_JFIELD_STR("hls", "released") << SRS_JFIELD_CONT
- << SRS_JFIELD_STR("dash", "plan")
- << SRS_JOBJECT_END << SRS_JFIELD_CONT
- << SRS_JFIELD_STR("author", "srs team")
- << SRS_JOBJECT_END
- it's:
- cont<< "{"
- << "name:" << "srs" << ","
- << "version:" << 100 << ","
- << "features:" << "{"
- << "rtmp:" << "released" << ","
- << "hls:" << "released" << ","
- << "dash:" << "plan"
- << "}" << ","
- << "author:" << "srs team"
- << "}"
- that is:
- """
- {
- "name": "srs",
- "version": 100,
- "features": {
- "rtmp": "released",
- "hls": "released",
- "dash": "plan"
- },
- "author": "srs team"
- }
- """
- */
-#define SRS_JOBJECT_START "{"
-#define SRS_JFIELD_NAME(k) "\"" << k << "\":"
-#define SRS_JFIELD_OBJ(k) SRS_JFIELD_NAME(k) << SRS_JOBJECT_START
-#define SRS_JFIELD_STR(k, v) SRS_JFIELD_NAME(k) << "\"" << v << "\""
-#define SRS_JFIELD_ORG(k, v) SRS_JFIELD_NAME(k) << std::dec << v
-#define SRS_JFIELD_BOOL(k, v) SRS_JFIELD_ORG(k, (v? "true":"false"))
-#define SRS_JFIELD_NULL(k) SRS_JFIELD_NAME(k) << "null"
-#define SRS_JFIELD_ERROR(ret) "\"" << "code" << "\":" << ret
-#define SRS_JFIELD_CONT ","
-#define SRS_JOBJECT_END "}"
-#define SRS_JARRAY_START "["
-#define SRS_JARRAY_END "]"
+#include <srs_kernel_pool.hpp>
 
 #ifdef SRS_JSON_USE_NXJSON
 
@@ -321,39 +274,9 @@ SrsJsonArray* SrsJsonAny::to_array()
 
 string SrsJsonAny::dumps()
 {
-    switch (marker) {
-        case SRS_JSON_String: {
-            return "\"" + to_str() + "\"";
-        }
-        case SRS_JSON_Boolean: {
-            return to_boolean()? "true":"false";
-        }
-        case SRS_JSON_Integer: {
-            return srs_int2str(to_integer());
-        }
-        case SRS_JSON_Number: {
-            // len(max int64_t) is 20, plus one "+-."
-            char tmp[22];
-            snprintf(tmp, 22, "%.6f", to_number());
-            return tmp;
-        }
-        case SRS_JSON_Null: {
-            return "null";
-        }
-        case SRS_JSON_Object: {
-            SrsJsonObject* obj = to_object();
-            return obj->dumps();
-        }
-        case SRS_JSON_Array: {
-            SrsJsonArray* arr = to_array();
-            return arr->dumps();
-        }
-        default: {
-            break;
-        }
-    }
-    
-    return "null";
+    SrsJsonWriter writer;
+    writer.any(this);
+    return writer.dumps();
 }
 
 SrsAmf0Any* SrsJsonAny::to_amf0()
@@ -527,27 +450,6 @@ SrsJsonAny* SrsJsonObject::value_at(int index)
     return elem.second;
 }
 
-string SrsJsonObject::dumps()
-{
-    stringstream ss;
-    
-    ss << SRS_JOBJECT_START;
-    
-    for (int i = 0; i < (int)properties.size(); i++) {
-        std::string name = this->key_at(i);
-        SrsJsonAny* any = this->value_at(i);
-        
-        ss << SRS_JFIELD_NAME(name) << any->dumps();
-        if (i < (int)properties.size() - 1) {
-            ss << SRS_JFIELD_CONT;
-        }
-    }
-    
-    ss << SRS_JOBJECT_END;
-    
-    return ss.str();
-}
-
 SrsAmf0Any* SrsJsonObject::to_amf0()
 {
     SrsAmf0Object* obj = SrsAmf0Any::object();
@@ -729,38 +631,306 @@ void SrsJsonArray::append(SrsJsonAny* value)
     add(value);
 }
 
-string SrsJsonArray::dumps()
+SrsAmf0Any* SrsJsonArray::to_amf0()
 {
-    stringstream ss;
-    
-    ss << SRS_JARRAY_START;
+    SrsAmf0StrictArray* arr = SrsAmf0Any::strict_array();
     
     for (int i = 0; i < (int)properties.size(); i++) {
         SrsJsonAny* any = properties[i];
         
-        ss << any->dumps();
+        arr->append(any->to_amf0());
+    }
+    
+    return arr;
+}
+
+SrsJsonWriter::SrsJsonWriter()
+{
+    buf = NULL;
+    nb_buf = 0;
+    capacity = 0;
+    wait_value = false;
+}
+
+SrsJsonWriter::~SrsJsonWriter()
+{
+    srs_pool_free(buf);
+}
+
+void SrsJsonWriter::reset()
+{
+    nb_buf = 0;
+    levels.clear();
+    wait_value = false;
+}
+
+char* SrsJsonWriter::bytes()
+{
+    return buf;
+}
+
+int SrsJsonWriter::length()
+{
+    return nb_buf;
+}
+
+string SrsJsonWriter::dumps()
+{
+    if (nb_buf <= 0) {
+        return "";
+    }
+    return string(buf, nb_buf);
+}
+
+void SrsJsonWriter::object_start()
+{
+    element();
+    append('{');
+    levels.push_back(0);
+}
+
+void SrsJsonWriter::object_end()
+{
+    srs_assert(!levels.empty());
+    levels.pop_back();
+    append('}');
+}
+
+void SrsJsonWriter::array_start()
+{
+    element();
+    append('[');
+    levels.push_back(0);
+}
+
+void SrsJsonWriter::array_end()
+{
+    srs_assert(!levels.empty());
+    levels.pop_back();
+    append(']');
+}
+
+void SrsJsonWriter::key(const char* k)
+{
+    str(k, (int)strlen(k));
+    append(':');
+    wait_value = true;
+}
+
+void SrsJsonWriter::str(const char* v, int nb_v)
+{
+    static const char* hex = "0123456789abcdef";
+    
+    element();
+    reserve(nb_v + 2);
+    append('"');
+    
+    // append the chars which need not escape in batch.
+    const char* p = v;
+    const char* end = v + nb_v;
+    while (p < end) {
+        const char* safe = p;
+        while (p < end && (u_int8_t)*p >= 0x20 && *p != '"' && *p != '\\') {
+            p++;
+        }
+        if (p > safe) {
+            append(safe, (int)(p - safe));
+        }
+        if (p >= end) {
+            break;
+        }
         
-        if (i < (int)properties.size() - 1) {
-            ss << SRS_JFIELD_CONT;
+        char c = *p++;
+        switch (c) {
+            case '"': append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\b': append("\\b", 2); break;
+            case '\f': append("\\f", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0x0f], hex[c & 0x0f]};
+                append(u, 6);
+                break;
+            }
         }
     }
     
-    ss << SRS_JARRAY_END;
+    append('"');
+}
+
+void SrsJsonWriter::str(const string& v)
+{
+    str(v.data(), (int)v.length());
+}
+
+void SrsJsonWriter::boolean(bool v)
+{
+    element();
+    if (v) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+}
+
+void SrsJsonWriter::integer(int64_t v)
+{
+    element();
     
-    return ss.str();
+    // len(min int64_t) is 20.
+    char tmp[22];
+    int nb_tmp = snprintf(tmp, sizeof(tmp), "%"PRId64, v);
+    append(tmp, nb_tmp);
 }
 
-SrsAmf0Any* SrsJsonArray::to_amf0()
+void SrsJsonWriter::number(double v)
 {
-    SrsAmf0StrictArray* arr = SrsAmf0Any::strict_array();
+    element();
     
-    for (int i = 0; i < (int)properties.size(); i++) {
-        SrsJsonAny* any = properties[i];
-        
-        arr->append(any->to_amf0());
+    // the double is large, for example, 1e300, so use the buffer for %f.
+    char tmp[512];
+    int nb_tmp = snprintf(tmp, sizeof(tmp), "%.6f", v);
+    append(tmp, srs_min(nb_tmp, (int)sizeof(tmp) - 1));
+}
+
+void SrsJsonWriter::null()
+{
+    element();
+    append("null", 4);
+}
+
+void SrsJsonWriter::any(SrsJsonAny* v)
+{
+    switch (v->marker) {
+        case SRS_JSON_String: {
+            str(v->to_str());
+            break;
+        }
+        case SRS_JSON_Boolean: {
+            boolean(v->to_boolean());
+            break;
+        }
+        case SRS_JSON_Integer: {
+            integer(v->to_integer());
+            break;
+        }
+        case SRS_JSON_Number: {
+            number(v->to_number());
+            break;
+        }
+        case SRS_JSON_Object: {
+            SrsJsonObject* obj = v->to_object();
+            object_start();
+            for (int i = 0; i < obj->count(); i++) {
+                key(obj->key_at(i).c_str());
+                any(obj->value_at(i));
+            }
+            object_end();
+            break;
+        }
+        case SRS_JSON_Array: {
+            SrsJsonArray* arr = v->to_array();
+            array_start();
+            for (int i = 0; i < arr->count(); i++) {
+                any(arr->at(i));
+            }
+            array_end();
+            break;
+        }
+        default: {
+            null();
+            break;
+        }
+    }
+}
+
+void SrsJsonWriter::field_str(const char* k, const string& v)
+{
+    key(k);
+    str(v);
+}
+
+void SrsJsonWriter::field_boolean(const char* k, bool v)
+{
+    key(k);
+    boolean(v);
+}
+
+void SrsJsonWriter::field_integer(const char* k, int64_t v)
+{
+    key(k);
+    integer(v);
+}
+
+void SrsJsonWriter::field_number(const char* k, double v)
+{
+    key(k);
+    number(v);
+}
+
+void SrsJsonWriter::field_null(const char* k)
+{
+    key(k);
+    null();
+}
+
+void SrsJsonWriter::element()
+{
+    // the value of key, the key already prefixed the comma.
+    if (wait_value) {
+        wait_value = false;
+        return;
     }
     
-    return arr;
+    if (levels.empty()) {
+        return;
+    }
+    
+    // prefix the comma when not the first element.
+    char& has_element = levels.back();
+    if (has_element) {
+        append(',');
+    }
+    has_element = 1;
+}
+
+void SrsJsonWriter::append(char c)
+{
+    if (nb_buf >= capacity) {
+        reserve(1);
+    }
+    buf[nb_buf++] = c;
+}
+
+void SrsJsonWriter::append(const char* data, int size)
+{
+    reserve(size);
+    memcpy(buf + nb_buf, data, size);
+    nb_buf += size;
+}
+
+void SrsJsonWriter::reserve(int size)
+{
+    if (nb_buf + size <= capacity) {
+        return;
+    }
+    
+    // grow in power of 2, which is the size class of message pool.
+    int nb_capacity = srs_max(capacity, 1 << SRS_MESSAGE_POOL_MIN_SHIFT);
+    while (nb_capacity < nb_buf + size) {
+        nb_capacity *= 2;
+    }
+    
+    char* p = srs_pool_alloc(nb_capacity);
+    if (nb_buf > 0) {
+        memcpy(p, buf, nb_buf);
+    }
+    srs_pool_free(buf);
+    
+    buf = p;
+    capacity = nb_capacity;
 }
 
 #ifdef SRS_JSON_USE_NXJSON
@@ -114,6 +114,9 @@ public:
     */
     virtual SrsJsonArray* to_array();
 public:
+    /**
+    * dumps the json tree to string, by SrsJsonWriter.
+    */
     virtual std::string dumps();
     virtual SrsAmf0Any* to_amf0();
 public:
@@ -150,7 +153,6 @@ public:
     // @remark: max index is count().
     virtual SrsJsonAny* value_at(int index);
 public:
-    virtual std::string dumps();
     virtual SrsAmf0Any* to_amf0();
 public:
     virtual void set(std::string key, SrsJsonAny* value);
@@ -182,13 +184,91 @@ public:
     // alias to add.
     virtual void append(SrsJsonAny* value);
 public:
-    virtual std::string dumps();
     virtual SrsAmf0Any* to_amf0();
 };
 
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
-// json encode, please use JSON.dumps() to encode json object.
+// json encode, please use JSON.dumps() to encode json object,
+// or SrsJsonWriter to stream a large json without building the tree:
+//        SrsJsonWriter writer;
+//        writer.object_start();
+//        writer.field_str("name", "srs");
+//        writer.key("clients");
+//        writer.array_start();
+//        ... // for each client, writer.object_start(); ...; writer.object_end();
+//        writer.array_end();
+//        writer.object_end();
+//        w->write(writer.bytes(), writer.length());
+
+/**
+ * the append-only json writer, which writes the tokens to its buffer,
+ * inserts the comma between elements automatically, and escapes the
+ * strings. the buffer is allocated from the message pool and kept by
+ * reset(), so the writer never builds the json tree or the temporary
+ * strings, which is required to dumps the large array, for example,
+ * the 50k clients of http api.
+ * @remark user must ensure the tokens are paired, for instance, the
+ *       key and its value, the object_start and object_end.
+ */
+class SrsJsonWriter
+{
+private:
+    char* buf;
+    int nb_buf;
+    int capacity;
+    // for each level of object or array, whether it has any element,
+    // to prefix the comma for the next element.
+    std::vector<char> levels;
+    // whether the key is written and wait for its value.
+    bool wait_value;
+public:
+    SrsJsonWriter();
+    virtual ~SrsJsonWriter();
+public:
+    /**
+    * reset the writer to write a new json, the buffer is kept.
+    */
+    virtual void reset();
+    /**
+    * get the written json, the bytes are valid until next write or reset.
+    */
+    virtual char* bytes();
+    virtual int length();
+    virtual std::string dumps();
+public:
+    virtual void object_start();
+    virtual void object_end();
+    virtual void array_start();
+    virtual void array_end();
+    /**
+    * write the key of object, user must write its value next.
+    */
+    virtual void key(const char* k);
+public:
+    virtual void str(const char* v, int nb_v);
+    virtual void str(const std::string& v);
+    virtual void boolean(bool v);
+    virtual void integer(int64_t v);
+    virtual void number(double v);
+    virtual void null();
+    /**
+    * write the json tree of any.
+    */
+    virtual void any(SrsJsonAny* v);
+public:
+    // the fields of object, the key with its value.
+    virtual void field_str(const char* k, const std::string& v);
+    virtual void field_boolean(const char* k, bool v);
+    virtual void field_integer(const char* k, int64_t v);
+    virtual void field_number(const char* k, double v);
+    virtual void field_null(const char* k);
+private:
+    void element();
+    void append(char c);
+    void append(const char* data, int size);
+    void reserve(int size);
+};
 
 #endif
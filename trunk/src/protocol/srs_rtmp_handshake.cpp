@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_rtmp_handshake.hpp>
 
 #include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include <srs_core_autofree.hpp>
 #include <srs_kernel_error.hpp>
@@ -43,6 +45,70 @@ using namespace _srs_internal;
 // for openssl_generate_key
 #include <openssl/dh.h>
 
+// the openssl 1.1+ hides the struct of HMAC_CTX and DH,
+// which are accessed by the functions, so define them for openssl 1.0.
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static HMAC_CTX* HMAC_CTX_new()
+{
+    HMAC_CTX* ctx = (HMAC_CTX*)malloc(sizeof(HMAC_CTX));
+    if (ctx != NULL) {
+        HMAC_CTX_init(ctx);
+    }
+    return ctx;
+}
+
+static void HMAC_CTX_free(HMAC_CTX* ctx)
+{
+    if (ctx != NULL) {
+        HMAC_CTX_cleanup(ctx);
+        free(ctx);
+    }
+}
+
+static void DH_get0_key(const DH* dh, const BIGNUM** pub_key, const BIGNUM** priv_key)
+{
+    if (pub_key != NULL) {
+        *pub_key = dh->pub_key;
+    }
+    if (priv_key != NULL) {
+        *priv_key = dh->priv_key;
+    }
+}
+
+static int DH_set0_pqg(DH* dh, BIGNUM* p, BIGNUM* q, BIGNUM* g)
+{
+    // the p and g must not be NULL, while q is optional.
+    if ((dh->p == NULL && p == NULL) || (dh->g == NULL && g == NULL)) {
+        return 0;
+    }
+    
+    if (p != NULL) {
+        BN_free(dh->p);
+        dh->p = p;
+    }
+    if (q != NULL) {
+        BN_free(dh->q);
+        dh->q = q;
+    }
+    if (g != NULL) {
+        BN_free(dh->g);
+        dh->g = g;
+    }
+    
+    if (q != NULL) {
+        dh->length = BN_num_bits(q);
+    }
+    
+    return 1;
+}
+
+static int DH_set_length(DH* dh, long length)
+{
+    dh->length = length;
+    return 1;
+}
+#endif
+
 namespace _srs_internal
 {
     // 68bytes FMS key which is used to sign the sever packet.
@@ -99,6 +165,7 @@ namespace _srs_internal
         
         unsigned char* temp_key = (unsigned char*)key;
         unsigned char* temp_digest = (unsigned char*)digest;
+        HMAC_CTX* pctx = NULL;
         
         if (key == NULL) {
             // use data to digest.
@@ -109,20 +176,30 @@ namespace _srs_internal
                 ret = ERROR_OpenSslSha256EvpDigest;
                 return ret;
             }
+        } else if (_srs_handshake_pool && (pctx = _srs_handshake_pool->hmac(key, key_size)) != NULL) {
+            // reuse the context of genuine key, reset it without key,
+            // so the key is never hashed again for each digest.
+            if (HMAC_Init_ex(pctx, NULL, 0, NULL, NULL) < 0) {
+                ret = ERROR_OpenSslSha256Init;
+                return ret;
+            }
+            
+            if ((ret = do_openssl_HMACsha256(pctx, data, data_size, temp_digest, &digest_size)) != ERROR_SUCCESS) {
+                return ret;
+            }
         } else {
             // use key-data to digest.
-            HMAC_CTX ctx;
+            HMAC_CTX* ctx = NULL;
             
             // @remark, if no key, use EVP_Digest to digest,
             // for instance, in python, hashlib.sha256(data).digest().
-            HMAC_CTX_init(&ctx);
-            if (HMAC_Init_ex(&ctx, temp_key, key_size, EVP_sha256(), NULL) < 0) {
+            if ((ctx = openssl_HMAC_new(temp_key, key_size)) == NULL) {
                 ret = ERROR_OpenSslSha256Init;
                 return ret;
             }
             
-            ret = do_openssl_HMACsha256(&ctx, data, data_size, temp_digest, &digest_size);
-            HMAC_CTX_cleanup(&ctx);
+            ret = do_openssl_HMACsha256(ctx, data, data_size, temp_digest, &digest_size);
+            openssl_HMAC_free(ctx);
             
             if (ret != ERROR_SUCCESS) {
                 return ret;
@@ -137,6 +214,26 @@ namespace _srs_internal
         return ret;
     }
     
+    HMAC_CTX* openssl_HMAC_new(const void* key, int key_size)
+    {
+        HMAC_CTX* ctx = NULL;
+        if ((ctx = HMAC_CTX_new()) == NULL) {
+            return NULL;
+        }
+        
+        if (HMAC_Init_ex(ctx, key, key_size, EVP_sha256(), NULL) < 0) {
+            HMAC_CTX_free(ctx);
+            return NULL;
+        }
+        
+        return ctx;
+    }
+    
+    void openssl_HMAC_free(HMAC_CTX* ctx)
+    {
+        HMAC_CTX_free(ctx);
+    }
+    
     #define RFC2409_PRIME_1024 \
             "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD1" \
             "29024E088A67CC74020BBEA63B139B22514A08798E3404DD" \
@@ -158,14 +255,7 @@ namespace _srs_internal
     void SrsDH::close()
     {
         if (pdh != NULL) {
-            if (pdh->p != NULL) {
-                BN_free(pdh->p);
-                pdh->p = NULL;
-            }
-            if (pdh->g != NULL) {
-                BN_free(pdh->g);
-                pdh->g = NULL;
-            }
+            // the p and g are owned and freed by DH.
             DH_free(pdh);
             pdh = NULL;
         }
@@ -181,7 +271,9 @@ namespace _srs_internal
             }
             
             if (ensure_128bytes_public_key) {
-                int32_t key_size = BN_num_bytes(pdh->pub_key);
+                const BIGNUM* pub_key = NULL;
+                DH_get0_key(pdh, &pub_key, NULL);
+                int32_t key_size = BN_num_bytes(pub_key);
                 if (key_size != 128) {
                     srs_warn("regenerate 128B key, current=%dB", key_size);
                     continue;
@@ -200,13 +292,15 @@ namespace _srs_internal
         
         // copy public key to bytes.
         // sometimes, the key_size is 127, seems ok.
-        int32_t key_size = BN_num_bytes(pdh->pub_key);
+        const BIGNUM* pub_key = NULL;
+        DH_get0_key(pdh, &pub_key, NULL);
+        int32_t key_size = BN_num_bytes(pub_key);
         srs_assert(key_size > 0);
         
         // maybe the key_size is 127, but dh will write all 128bytes pkey,
         // so, donot need to set/initialize the pkey.
         // @see https://github.com/ossrs/srs/issues/165
-        key_size = BN_bn2bin(pdh->pub_key, (unsigned char*)pkey);
+        key_size = BN_bn2bin(pub_key, (unsigned char*)pkey);
         srs_assert(key_size > 0);
         
         // output the size of public key.
@@ -231,12 +325,9 @@ namespace _srs_internal
         // maybe the key_size is 127, but dh will write all 128bytes skey,
         // so, donot need to set/initialize the skey.
         // @see https://github.com/ossrs/srs/issues/165
+        // @remark never log here, for it maybe computed in the pthread of pool.
         int32_t key_size = DH_compute_key((unsigned char*)skey, ppk, pdh);
         
-        if (key_size < ppkey_size) {
-            srs_warn("shared key size=%d, ppk_size=%d", key_size, ppkey_size);
-        }
-        
         if (key_size < 0 || key_size > skey_size) {
             ret = ERROR_OpenSslComputeSharedKey;
         } else {
@@ -254,8 +345,6 @@ namespace _srs_internal
     {
         int ret = ERROR_SUCCESS;
         
-        int32_t bits_count = 1024;
-        
         close();
         
         //1. Create the DH
@@ -265,28 +354,48 @@ namespace _srs_internal
         }
     
         //2. Create his internal p and g
-        if ((pdh->p = BN_new()) == NULL) {
+        BIGNUM* p = NULL;
+        BIGNUM* g = NULL;
+        if ((p = BN_new()) == NULL) {
             ret = ERROR_OpenSslCreateP; 
             return ret;
         }
-        if ((pdh->g = BN_new()) == NULL) {
+        if ((g = BN_new()) == NULL) {
+            BN_free(p);
             ret = ERROR_OpenSslCreateG; 
             return ret;
         }
     
         //3. initialize p and g, @see ./test/ectest.c:260
-        if (!BN_hex2bn(&pdh->p, RFC2409_PRIME_1024)) {
+        if (!BN_hex2bn(&p, RFC2409_PRIME_1024)) {
+            BN_free(p);
+            BN_free(g);
             ret = ERROR_OpenSslParseP1024; 
             return ret;
         }
         // @see ./test/bntest.c:1764
-        if (!BN_set_word(pdh->g, 2)) {
+        if (!BN_set_word(g, 2)) {
+            BN_free(p);
+            BN_free(g);
+            ret = ERROR_OpenSslSetG;
+            return ret;
+        }
+        
+        // the p and g are owned by DH when set.
+        if (!DH_set0_pqg(pdh, p, NULL, g)) {
+            BN_free(p);
+            BN_free(g);
             ret = ERROR_OpenSslSetG;
             return ret;
         }
     
         // 4. Set the key length
-        pdh->length = bits_count;
+        // @remark the openssl 3.0+ requires the length of private key less than the p,
+        //      so use the default length, which is the bits of p minus one.
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+        int32_t bits_count = 1024;
+        DH_set_length(pdh, bits_count);
+#endif
     
         // 5. Generate private and public key
         // @see ./test/dhtest.c:152
@@ -298,6 +407,16 @@ namespace _srs_internal
         return ret;
     }
     
+    ISrsHandshakePool::ISrsHandshakePool()
+    {
+    }
+    
+    ISrsHandshakePool::~ISrsHandshakePool()
+    {
+    }
+    
+    ISrsHandshakePool* _srs_handshake_pool = NULL;
+    
     key_block::key_block()
     {
         offset = (int32_t)rand();
@@ -524,20 +643,37 @@ namespace _srs_internal
     {
         int ret = ERROR_SUCCESS;
 
-        SrsDH dh;
+        // fetch the pre-generated key from pool.
+        SrsDH* dh = NULL;
+        if (_srs_handshake_pool) {
+            dh = _srs_handshake_pool->fetch_dh();
+        }
         
         // ensure generate 128bytes public key.
-        if ((ret = dh.initialize(true)) != ERROR_SUCCESS) {
-            return ret;
+        if (!dh) {
+            dh = new SrsDH();
+            if ((ret = dh->initialize(true)) != ERROR_SUCCESS) {
+                srs_freep(dh);
+                return ret;
+            }
         }
+        SrsAutoFree(SrsDH, dh);
         
         // directly generate the public key.
         // @see: https://github.com/ossrs/srs/issues/148
         int pkey_size = 128;
-        if ((ret = dh.copy_shared_key(c1->get_key(), 128, key.key, pkey_size)) != ERROR_SUCCESS) {
+        if (_srs_handshake_pool) {
+            ret = _srs_handshake_pool->compute_shared_key(dh, c1->get_key(), 128, key.key, pkey_size);
+        } else {
+            ret = dh->copy_shared_key(c1->get_key(), 128, key.key, pkey_size);
+        }
+        if (ret != ERROR_SUCCESS) {
             srs_error("calc s1 key failed. ret=%d", ret);
             return ret;
         }
+        if (pkey_size < 128) {
+            srs_warn("shared key size=%d, ppk_size=%d", pkey_size, 128);
+        }
 
         // although the public key is always 128bytes, but the share key maybe not.
         // we just ignore the actual key size, but if need to use the key, must use the actual size.
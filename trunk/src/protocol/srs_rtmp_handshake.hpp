@@ -48,6 +48,12 @@ namespace _srs_internal
     extern u_int8_t SrsGenuineFPKey[];
     int openssl_HMACsha256(const void* key, int key_size, const void* data, int data_size, void* digest);
     int openssl_generate_key(char* public_key, int32_t size);
+    /**
+    * create the HMAC context of sha256 initialized with key, NULL when failed.
+    * @remark user must free it by openssl_HMAC_free.
+    */
+    HMAC_CTX* openssl_HMAC_new(const void* key, int key_size);
+    void openssl_HMAC_free(HMAC_CTX* ctx);
     
     /**
     * the DH wrapper.
@@ -90,6 +96,38 @@ namespace _srs_internal
     private:
         virtual int do_initialize();
     };
+    
+    /**
+    * the hook of the complex handshake of server, to fetch the DH keys generated
+    * in advance, to compute the DH shared key and cache the HMAC of genuine keys,
+    * for example, the pool of server which generates keys by pthread.
+    * @remark it's NULL in librtmp, the handshake generates and computes in place.
+    */
+    class ISrsHandshakePool
+    {
+    public:
+        ISrsHandshakePool();
+        virtual ~ISrsHandshakePool();
+    public:
+        /**
+        * fetch a DH with the 128bytes public key generated.
+        * @return NULL when pool is empty, user should generate it.
+        * @remark user must free the DH.
+        */
+        virtual SrsDH* fetch_dh() = 0;
+        /**
+        * compute the DH shared key, @see SrsDH::copy_shared_key().
+        */
+        virtual int compute_shared_key(SrsDH* dh, const char* ppkey, int32_t ppkey_size, char* skey, int32_t& skey_size) = 0;
+        /**
+        * get the HMAC context of the key, which is initialized once.
+        * @return NULL to use a temporary context.
+        */
+        virtual HMAC_CTX* hmac(const void* key, int key_size) = 0;
+    };
+    
+    // the hook for the complex handshake of server, NULL when disabled.
+    extern ISrsHandshakePool* _srs_handshake_pool;
     /**
     * the schema type.
     */
@@ -29,37 +29,29 @@ SrsMessageArray::SrsMessageArray(int max_msgs)
 {
     srs_assert(max_msgs > 0);
     
+    objs = new SrsSharedPtrMessage[max_msgs];
     msgs = new SrsSharedPtrMessage*[max_msgs];
     max = max_msgs;
     
-    zero(max_msgs);
+    for (int i = 0; i < max_msgs; i++) {
+        msgs[i] = &objs[i];
+    }
 }
 
 SrsMessageArray::~SrsMessageArray()
 {
-    // we just free the msgs itself,
-    // both delete and delete[] is ok,
-    // for each msg in msgs is already freed by send_and_free_messages.
+    // the msg objects release the msgs not freed.
+    srs_freepa(objs);
     srs_freepa(msgs);
 }
 
 void SrsMessageArray::free(int count)
 {
-    // initialize
+    srs_assert(count <= max);
+    
     for (int i = 0; i < count; i++) {
         SrsSharedPtrMessage* msg = msgs[i];
-        srs_freep(msg);
-        
-        msgs[i] = NULL;
-    }
-}
-
-void SrsMessageArray::zero(int count)
-{
-    // initialize
-    for (int i = 0; i < count; i++) {
-        msgs[i] = NULL;
+        msg->release();
     }
 }
 
-
@@ -36,40 +36,42 @@ class SrsSharedPtrMessage;
 * the class to auto free the shared ptr message array.
 * when need to get some messages, for instance, from Consumer queue,
 * create a message array, whose msgs can used to accept the msgs,
-* then send each message and set to NULL.
+* then send all messages and free them.
 *
-* @remark: user must free all msgs in array, for the SRS2.0 protocol stack
-*       provides an api to send messages, @see send_and_free_messages
+* @remark the msg objects are allocated once when array created and reused,
+*       the queue moves the msgs to these objects, @see SrsMessageQueue.dump_packets,
+*       and the free() only release the reference of payload, so the msg object
+*       is never allocated or deleted when dump and send msgs.
+* @remark: user must free all msgs in array after sent, for the SRS2.0 protocol stack
+*       provides an api to send messages, @see send_messages
 */
 class SrsMessageArray
 {
 public:
     /**
-    * when user already send the msg in msgs, please set to NULL,
-    * for instance, msg= msgs.msgs[i], msgs.msgs[i]=NULL, send(msg),
-    * where send(msg) will always send and free it.
+    * the reusable msgs, user should never delete or set them to NULL,
+    * but free them after sent, @see free().
     */
     SrsSharedPtrMessage** msgs;
     int max;
+private:
+    // the msg objects of msgs.
+    SrsSharedPtrMessage* objs;
 public:
     /**
-    * create msg array, initialize array to NULL ptrs.
+    * create msg array, initialize array to empty msgs.
     */
     SrsMessageArray(int max_msgs);
     /**
-    * free the msgs not sent out(not NULL).
+    * free the msgs not sent out.
     */
     virtual ~SrsMessageArray();
 public:
     /**
-    * free specified count of messages.
+    * free specified count of messages,
+    * release the payload and reset the msg to empty for reuse.
     */
     virtual void free(int count);
-private:
-    /**
-    * zero initialize the message array.
-    */
-    virtual void zero(int count);
 };
 
 #endif
@@ -459,6 +459,29 @@ int SrsProtocol::do_send_messages(SrsSharedPtrMessage** msgs, int nb_msgs)
             continue;
         }
     
+        // use the chunk iovs shared by all consumers when cached,
+        // which avoid to generate the chunk headers for each consumer.
+        iovec* msg_iovs = NULL;
+        int nb_msg_iovs = 0;
+        if (msg->chunk_iovs(out_chunk_size, &msg_iovs, &nb_msg_iovs)) {
+            // realloc the iovs if exceed, keep 2 iovs for next chunk.
+            if (iov_index + nb_msg_iovs > nb_out_iovs - 2) {
+                int nb_required = iov_index + nb_msg_iovs + 2;
+                srs_warn("resize iovs %d => %d, max_msgs=%d", 
+                    nb_out_iovs, nb_required + SRS_CONSTS_IOVS_MAX, 
+                    SRS_PERF_MW_MSGS);
+                
+                nb_out_iovs = nb_required + SRS_CONSTS_IOVS_MAX;
+                int realloc_size = sizeof(iovec) * nb_out_iovs;
+                out_iovs = (iovec*)realloc(out_iovs, realloc_size);
+            }
+            
+            memcpy(out_iovs + iov_index, msg_iovs, sizeof(iovec) * nb_msg_iovs);
+            iov_index += nb_msg_iovs;
+            iovs = out_iovs + iov_index;
+            continue;
+        }
+        
         // p set to current write position,
         // it's ok when payload is NULL and size is 0.
         char* p = msg->payload;
@@ -857,6 +880,20 @@ int SrsProtocol::send_and_free_message(SrsSharedPtrMessage* msg, int stream_id)
 }
 
 int SrsProtocol::send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id)
+{
+    // donot use the auto free to free the msg,
+    // for performance issue.
+    int ret = send_messages(msgs, nb_msgs, stream_id);
+    
+    for (int i = 0; i < nb_msgs; i++) {
+        SrsSharedPtrMessage* msg = msgs[i];
+        srs_freep(msg);
+    }
+    
+    return ret;
+}
+
+int SrsProtocol::send_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id)
 {
     // always not NULL msg.
     srs_assert(msgs);
@@ -877,15 +914,8 @@ int SrsProtocol::send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs,
         }
     }
     
-    // donot use the auto free to free the msg,
-    // for performance issue.
     int ret = do_send_messages(msgs, nb_msgs);
     
-    for (int i = 0; i < nb_msgs; i++) {
-        SrsSharedPtrMessage* msg = msgs[i];
-        srs_freep(msg);
-    }
-    
     // donot flush when send failed
     if (ret != ERROR_SUCCESS) {
         return ret;
@@ -1981,6 +2011,11 @@ int SrsRtmpClient::send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msg
     return protocol->send_and_free_messages(msgs, nb_msgs, stream_id);
 }
 
+int SrsRtmpClient::send_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id)
+{
+    return protocol->send_messages(msgs, nb_msgs, stream_id);
+}
+
 int SrsRtmpClient::send_and_free_packet(SrsPacket* packet, int stream_id)
 {
     return protocol->send_and_free_packet(packet, stream_id);
@@ -2419,6 +2454,11 @@ int SrsRtmpServer::send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msg
     return protocol->send_and_free_messages(msgs, nb_msgs, stream_id);
 }
 
+int SrsRtmpServer::send_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id)
+{
+    return protocol->send_messages(msgs, nb_msgs, stream_id);
+}
+
 int SrsRtmpServer::send_and_free_packet(SrsPacket* packet, int stream_id)
 {
     return protocol->send_and_free_packet(packet, stream_id);
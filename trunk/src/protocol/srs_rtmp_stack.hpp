@@ -356,6 +356,15 @@ public:
     */
     virtual int send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id);
     /**
+    * send the RTMP messages but never free them,
+    * user should free the msgs after sent, for instance, the reusable msgs
+    * of SrsMessageArray, @see SrsMessageArray.free()
+    * @param msgs, the msgs to send out, never be NULL.
+    * @param nb_msgs, the size of msgs to send out.
+    * @param stream_id, the stream id of packet to send over, 0 for control message.
+    */
+    virtual int send_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id);
+    /**
     * send the RTMP packet and always free it.
     * user must never free or use the packet after this method,
     * for it will always free the packet.
@@ -713,6 +722,15 @@ public:
      * @param stream_id, the stream id of packet to send over, 0 for control message.
      */
     virtual int send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id);
+    /**
+     * send the RTMP messages but never free them,
+     * user should free the msgs after sent, for instance, the reusable msgs
+     * of SrsMessageArray, @see SrsMessageArray.free()
+     * @param msgs, the msgs to send out, never be NULL.
+     * @param nb_msgs, the size of msgs to send out.
+     * @param stream_id, the stream id of packet to send over, 0 for control message.
+     */
+    virtual int send_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id);
     /**
      * send the RTMP packet and always free it.
      * user must never free or use the packet after this method,
@@ -899,6 +917,15 @@ public:
      *       @see https://github.com/ossrs/srs/issues/194
      */
     virtual int send_and_free_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id);
+    /**
+     * send the RTMP messages but never free them,
+     * user should free the msgs after sent, for instance, the reusable msgs
+     * of SrsMessageArray, @see SrsMessageArray.free()
+     * @param msgs, the msgs to send out, never be NULL.
+     * @param nb_msgs, the size of msgs to send out.
+     * @param stream_id, the stream id of packet to send over, 0 for control message.
+     */
+    virtual int send_messages(SrsSharedPtrMessage** msgs, int nb_msgs, int stream_id);
     /**
      * send the RTMP packet and always free it.
      * user must never free or use the packet after this method,
@@ -28,7 +28,10 @@ using namespace std;
 #include <srs_kernel_consts.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_app_source.hpp>
+#include <srs_app_worker.hpp>
 #include <srs_core_performance.hpp>
+#include <srs_app_security.hpp>
+#include <srs_app_utility.hpp>
 
 MockSrsConfigBuffer::MockSrsConfigBuffer(string buf)
 {
@@ -1828,6 +1831,101 @@ VOID TEST(ConfigMainTest, CheckConf_pithy_print)
     }
 }
 
+VOID TEST(ConfigMainTest, CheckConf_workers)
+{
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF));
+        EXPECT_EQ(0, conf.get_workers());
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"workers 4;"));
+        EXPECT_EQ(4, conf.get_workers());
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS != conf.parse(_MIN_OK_CONF"workers -1;"));
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS != conf.parse(_MIN_OK_CONF"workerss 4;"));
+    }
+    
+    // the hls in ram is not shared by workers.
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"workers 4; vhost v{hls{hls_storage disk;}}"));
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS != conf.parse(_MIN_OK_CONF"workers 4; vhost v{hls{hls_storage ram;}}"));
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS != conf.parse(_MIN_OK_CONF"workers 4; vhost v{hls{hls_storage both;}}"));
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"vhost v{hls{hls_storage both;}}"));
+    }
+}
+
+/**
+* the released slots of stream directory are reused by new streams,
+* so the pin works for more streams than the slots.
+*/
+VOID TEST(ConfigWorkerTest, StreamDirectoryReuse)
+{
+    SrsStreamDirectory dir;
+    EXPECT_TRUE(ERROR_SUCCESS == dir.initialize());
+    
+    // the stream owned by worker 1 is busy for others.
+    EXPECT_TRUE(ERROR_SUCCESS == dir.claim("__defaultVhost__/live/pinned", 1));
+    EXPECT_TRUE(ERROR_SYSTEM_STREAM_BUSY == dir.claim("__defaultVhost__/live/pinned", 0));
+    
+    for (int i = 0; i < SRS_WORKER_MAX_STREAMS * 2; i++) {
+        std::stringstream ss;
+        ss << "__defaultVhost__/live/livestream-" << i;
+        std::string url = ss.str();
+        
+        EXPECT_TRUE(ERROR_SUCCESS == dir.claim(url, 0));
+        EXPECT_EQ(0, dir.owner(url));
+        EXPECT_TRUE(ERROR_SYSTEM_STREAM_BUSY == dir.claim(url, 2));
+        
+        dir.release(url, 0);
+        EXPECT_EQ(-1, dir.owner(url));
+    }
+    
+    EXPECT_EQ(1, dir.owner("__defaultVhost__/live/pinned"));
+    EXPECT_TRUE(ERROR_SYSTEM_STREAM_BUSY == dir.claim("__defaultVhost__/live/pinned", 0));
+    
+    // the released stream claimed again, by other worker.
+    EXPECT_TRUE(ERROR_SUCCESS == dir.claim("__defaultVhost__/live/livestream-0", 2));
+    EXPECT_EQ(2, dir.owner("__defaultVhost__/live/livestream-0"));
+    
+    // when all slots are owned, publish without pin.
+    dir.release_all(2);
+    for (int i = 0; i < SRS_WORKER_MAX_STREAMS - 1; i++) {
+        std::stringstream ss;
+        ss << "__defaultVhost__/live/owned-" << i;
+        EXPECT_TRUE(ERROR_SUCCESS == dir.claim(ss.str(), 3));
+    }
+    EXPECT_TRUE(ERROR_SUCCESS == dir.claim("__defaultVhost__/live/overflow", 3));
+    EXPECT_EQ(-1, dir.owner("__defaultVhost__/live/overflow"));
+    
+    // the slots are reused when released by worker.
+    dir.release_all(3);
+    EXPECT_TRUE(ERROR_SUCCESS == dir.claim("__defaultVhost__/live/overflow", 3));
+    EXPECT_EQ(3, dir.owner("__defaultVhost__/live/overflow"));
+}
+
 VOID TEST(ConfigMainTest, CheckConf_vhost_ingest_id)
 {
     MockSrsConfig conf;
@@ -1836,5 +1934,110 @@ VOID TEST(ConfigMainTest, CheckConf_vhost_ingest_id)
     EXPECT_TRUE(ERROR_SUCCESS != conf.parse(_MIN_OK_CONF"vhost v{ingest{} ingest{}}"));
 }
 
+VOID TEST(ConfigMainTest, CheckConf_rate_limit)
+{
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF));
+        EXPECT_FALSE(conf.get_rate_limit_enabled());
+        EXPECT_EQ(10, conf.get_rate_limit_connect_rate());
+        EXPECT_EQ(20, conf.get_rate_limit_connect_burst());
+        EXPECT_EQ(5, conf.get_rate_limit_play_rate());
+        EXPECT_EQ(10, conf.get_rate_limit_play_burst());
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"rate_limit{enabled on; connect_rate 0.5; connect_burst 2; play_rate 1; play_burst 3;}"));
+        EXPECT_TRUE(conf.get_rate_limit_enabled());
+        EXPECT_EQ(0.5, conf.get_rate_limit_connect_rate());
+        EXPECT_EQ(2, conf.get_rate_limit_connect_burst());
+        EXPECT_EQ(1, conf.get_rate_limit_play_rate());
+        EXPECT_EQ(3, conf.get_rate_limit_play_burst());
+    }
+    
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(ERROR_SUCCESS != conf.parse(_MIN_OK_CONF"rate_limit{connect 10;}"));
+    }
+}
+
+/**
+* the loopback and local ips are never limited, for the workers, edge,
+* forward and http api of server connect from local.
+*/
+VOID TEST(ConfigMainTest, RateLimitExemptLocal)
+{
+    MockSrsConfig conf;
+    EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"rate_limit{enabled on; connect_rate 0.1; connect_burst 1; play_rate 0.1; play_burst 1;}"));
+    
+    SrsConfig* prev = _srs_config;
+    _srs_config = &conf;
+    
+    SrsRateLimiter limiter;
+    
+    // the remote ip is limited.
+    EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect("1.2.3.4"));
+    EXPECT_TRUE(ERROR_SYSTEM_RATE_LIMIT == limiter.on_connect("1.2.3.4"));
+    EXPECT_TRUE(ERROR_SUCCESS == limiter.on_play("1.2.3.4"));
+    EXPECT_TRUE(ERROR_SYSTEM_RATE_LIMIT == limiter.on_play("1.2.3.4"));
+    EXPECT_EQ(1, limiter.nb_connect_drops);
+    EXPECT_EQ(1, limiter.nb_play_drops);
+    
+    // the loopback is never limited.
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect("127.0.0.1"));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect("127.0.1.2"));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect("::1"));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect("::ffff:127.0.0.1"));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_play("127.0.0.1"));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_play("::1"));
+    }
+    
+    // the local ips of server are never limited.
+    vector<string>& ips = srs_get_local_ipv4_ips();
+    for (int i = 0; i < (int)ips.size(); i++) {
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect(ips[i]));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_connect(ips[i]));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_play(ips[i]));
+        EXPECT_TRUE(ERROR_SUCCESS == limiter.on_play(ips[i]));
+    }
+    EXPECT_EQ(1, limiter.nb_connect_drops);
+    EXPECT_EQ(1, limiter.nb_play_drops);
+    
+    _srs_config = prev;
+}
+
+VOID TEST(ConfigMainTest, CheckConf_vhost_security_compiled)
+{
+    MockSrsConfig conf;
+    EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"vhost v{security{enabled on; "
+        "allow play all; deny play 10.0.0.0/8; allow publish 192.168.1.10; "
+        "allow publish 2001:db8::/32; deny publish 192.168.1.10/33;}}"));
+    
+    SrsVhostConfig* vconf = conf.get_vhost_config("v");
+    EXPECT_TRUE(vconf->security_enabled);
+    
+    SrsSecurityRules* rules = vconf->security_rules;
+    EXPECT_TRUE(rules->allow_play.match("1.2.3.4"));
+    EXPECT_TRUE(rules->allow_play.match("::1"));
+    EXPECT_TRUE(rules->deny_play.match("10.1.2.3"));
+    EXPECT_TRUE(rules->deny_play.match("::ffff:10.1.2.3"));
+    EXPECT_FALSE(rules->deny_play.match("11.1.2.3"));
+    
+    EXPECT_TRUE(rules->allow_publish.match("192.168.1.10"));
+    EXPECT_FALSE(rules->allow_publish.match("192.168.1.11"));
+    EXPECT_TRUE(rules->allow_publish.match("2001:db8::1"));
+    EXPECT_FALSE(rules->allow_publish.match("2001:db9::1"));
+    
+    // the invalid rule is ignored.
+    EXPECT_TRUE(rules->deny_publish.empty());
+    
+    // the vhost without security.
+    vconf = conf.get_vhost_config("__defaultVhost__");
+    EXPECT_FALSE(vconf->security_enabled);
+    EXPECT_TRUE(vconf->security_rules->allow_play.empty());
+}
+
 #endif
 
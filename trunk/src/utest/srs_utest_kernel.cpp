@@ -30,6 +30,18 @@ using namespace std;
 #include <srs_kernel_utility.hpp>
 #include <srs_protocol_utility.hpp>
 #include <srs_kernel_buffer.hpp>
+#include <srs_kernel_ts.hpp>
+#include <srs_kernel_stream.hpp>
+#include <srs_kernel_pool.hpp>
+#include <srs_kernel_balance.hpp>
+#include <srs_core_autofree.hpp>
+#include <srs_core_performance.hpp>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 #define MAX_MOCK_DATA_SIZE 1024 * 1024
 
@@ -85,6 +97,11 @@ int MockSrsFileWriter::write(void* buf, size_t count, ssize_t* pnwrite)
     return ret;
 }
 
+int MockSrsFileWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
+{
+    return write_iovs(iov, iovcnt, pnwrite);
+}
+
 void MockSrsFileWriter::mock_reset_offset()
 {
     offset = 0;
@@ -537,6 +554,61 @@ VOID TEST(KernelFlvTest, FlvEncoderWriteVideo)
     EXPECT_TRUE(srs_bytes_equals(pts, fs.data + 11 + 8, 4));
 }
 
+/**
+* test the flv tag shared by players with the same timestamp.
+*/
+VOID TEST(KernelFlvTest, FlvSharedTag)
+{
+#if SRS_PERF_FLV_TAG_CACHE > 0
+    // 11bytes tag header
+    char tag_header[] = {
+        (char)9, // TagType UB [5], 9 = video
+        (char)0x00, (char)0x00, (char)0x08, // DataSize UI24 Length of the message.
+        (char)0x00, (char)0x00, (char)0x30, // Timestamp UI24 Time in milliseconds at which the data in this tag applies.
+        (char)0x00, // TimestampExtended UI8
+        (char)0x00, (char)0x00, (char)0x00, // StreamID UI24 Always 0.
+    };
+    char pts[] = { (char)0x00, (char)0x00, (char)0x00, (char)19 };
+    
+    SrsMessageHeader header;
+    header.initialize_video(8, 0x30, 1);
+    
+    SrsSharedPtrMessage msg;
+    ASSERT_TRUE(ERROR_SUCCESS == msg.create(&header, new char[8], 8));
+    
+    char* h = NULL;
+    char* p = NULL;
+    ASSERT_TRUE(msg.flv_tag(&h, &p));
+    EXPECT_TRUE(srs_bytes_equals(tag_header, h, 11));
+    EXPECT_TRUE(srs_bytes_equals(pts, p, 4));
+    
+    // the copy with the same timestamp use the same tag.
+    SrsSharedPtrMessage* copy = msg.copy();
+    SrsAutoFree(SrsSharedPtrMessage, copy);
+    
+    char* h1 = NULL;
+    char* p1 = NULL;
+    ASSERT_TRUE(copy->flv_tag(&h1, &p1));
+    EXPECT_EQ(h, h1);
+    EXPECT_EQ(p, p1);
+    
+    // the copy with other timestamp use new tag.
+    copy->timestamp = 0x01000030;
+    ASSERT_TRUE(copy->flv_tag(&h1, &p1));
+    EXPECT_NE(h, h1);
+    EXPECT_EQ(p, p1);
+    EXPECT_EQ(0x01, h1[7]);
+    
+    // the cache is full.
+    for (int i = 0; i < SRS_PERF_FLV_TAG_CACHE - 2; i++) {
+        copy->timestamp = i;
+        EXPECT_TRUE(copy->flv_tag(&h1, &p1));
+    }
+    copy->timestamp = 0x100;
+    EXPECT_FALSE(copy->flv_tag(&h1, &p1));
+#endif
+}
+
 /**
 * test the flv encoder,
 * calc the tag size.
@@ -1429,6 +1501,150 @@ VOID TEST(KernelStreamTest, StreamWriteBytes)
     EXPECT_EQ(0x19, s.read_1bytes());
 }
 
+/**
+* test the ts context encoder, 
+* the PSI and PES packets of frame are muxed in buffer and written together.
+*/
+VOID TEST(KernelTsTest, TsContextEncodeFrame)
+{
+    MockSrsFileWriter fs;
+    EXPECT_TRUE(ERROR_SUCCESS == fs.open(""));
+    
+    SrsTsContext ctx;
+    
+    char payload[1000];
+    memset(payload, 0x01, sizeof(payload));
+    
+    SrsTsMessage msg;
+    msg.sid = SrsTsPESStreamIdVideoCommon;
+    msg.dts = msg.pts = 90000;
+    msg.payload->append(payload, sizeof(payload));
+    
+    EXPECT_TRUE(ERROR_SUCCESS == ctx.encode(&fs, &msg, SrsCodecVideoAVC, SrsCodecAudioAAC));
+    
+    // PAT, PMT and 6 PES packets for 1000 bytes.
+    ASSERT_EQ(8 * 188, fs.offset);
+    for (int i = 0; i < fs.offset; i += 188) {
+        EXPECT_EQ(0x47, fs.data[i]);
+    }
+    
+    // without PSI for the codec not changed.
+    fs.mock_reset_offset();
+    EXPECT_TRUE(ERROR_SUCCESS == ctx.encode(&fs, &msg, SrsCodecVideoAVC, SrsCodecAudioAAC));
+    ASSERT_EQ(6 * 188, fs.offset);
+}
+
+/**
+* test the ts context encoder, 
+* the large frame is flushed when packets buffer is full.
+*/
+VOID TEST(KernelTsTest, TsContextEncodeLargeFrame)
+{
+    MockSrsFileWriter fs;
+    EXPECT_TRUE(ERROR_SUCCESS == fs.open(""));
+    
+    SrsTsContext ctx;
+    
+    // about 3 times of the packets buffer.
+    int size = 184 * SRS_PERF_TS_WRITE_PACKETS * 3;
+    char* payload = new char[size];
+    SrsAutoFreeA(char, payload);
+    memset(payload, 0x01, size);
+    
+    SrsTsMessage msg;
+    msg.sid = SrsTsPESStreamIdVideoCommon;
+    msg.dts = msg.pts = 90000;
+    msg.payload->append(payload, size);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == ctx.encode(&fs, &msg, SrsCodecVideoAVC, SrsCodecAudioAAC));
+    
+    ASSERT_EQ(0, fs.offset % 188);
+    ASSERT_TRUE(fs.offset > size);
+    for (int i = 0; i < fs.offset; i += 188) {
+        EXPECT_EQ(0x47, fs.data[i]);
+    }
+    
+    // the continuity counter of video pid is continuous.
+    int cc = -1;
+    for (int i = 2 * 188; i < fs.offset; i += 188) {
+        int ncc = fs.data[i + 3] & 0x0f;
+        if (cc >= 0) {
+            EXPECT_EQ((cc + 1) & 0x0f, ncc);
+        }
+        cc = ncc;
+    }
+}
+
+/**
+* the file writer which fails to write, to mock the disk full.
+*/
+class MockErrorFileWriter : public MockSrsFileWriter
+{
+public:
+    int error;
+public:
+    MockErrorFileWriter() {
+        error = ERROR_SUCCESS;
+    }
+    virtual ~MockErrorFileWriter() {
+    }
+public:
+    virtual int write(void* buf, size_t count, ssize_t* pnwrite) {
+        if (error != ERROR_SUCCESS) {
+            return error;
+        }
+        return MockSrsFileWriter::write(buf, count, pnwrite);
+    }
+};
+
+/**
+* test the ts context encoder, 
+* the packets are dropped when failed, and the PAT/PMT is written for next frame.
+*/
+VOID TEST(KernelTsTest, TsContextEncodeFailed)
+{
+    MockErrorFileWriter fs;
+    EXPECT_TRUE(ERROR_SUCCESS == fs.open(""));
+    
+    SrsTsContext ctx;
+    
+    // flush the packets buffer in the frame, which failed.
+    int size = 184 * SRS_PERF_TS_WRITE_PACKETS * 2;
+    char* payload = new char[size];
+    SrsAutoFreeA(char, payload);
+    memset(payload, 0x01, size);
+    
+    if (true) {
+        SrsTsMessage msg;
+        msg.sid = SrsTsPESStreamIdVideoCommon;
+        msg.dts = msg.pts = 90000;
+        msg.payload->append(payload, size);
+        
+        fs.error = ERROR_SYSTEM_FILE_WRITE;
+        EXPECT_TRUE(ERROR_SUCCESS != ctx.encode(&fs, &msg, SrsCodecVideoAVC, SrsCodecAudioAAC));
+        EXPECT_EQ(0, fs.offset);
+    }
+    
+    // PAT, PMT and 6 PES packets for 1000 bytes, without the dropped packets.
+    if (true) {
+        SrsTsMessage msg;
+        msg.sid = SrsTsPESStreamIdVideoCommon;
+        msg.dts = msg.pts = 90000;
+        msg.payload->append(payload, 1000);
+        
+        fs.error = ERROR_SUCCESS;
+        EXPECT_TRUE(ERROR_SUCCESS == ctx.encode(&fs, &msg, SrsCodecVideoAVC, SrsCodecAudioAAC));
+        ASSERT_EQ(8 * 188, fs.offset);
+        for (int i = 0; i < fs.offset; i += 188) {
+            EXPECT_EQ(0x47, fs.data[i]);
+        }
+        
+        // the first packet is PAT, pid 0.
+        EXPECT_EQ(0x00, fs.data[1] & 0x1f);
+        EXPECT_EQ(0x00, fs.data[2]);
+    }
+}
+
 /**
 * test the kernel utility, time
 */
@@ -1511,5 +1727,410 @@ VOID TEST(KernelUtilityTest, UtilityString)
     EXPECT_TRUE(srs_string_ends_with("Hello", "lo"));
 }
 
+/**
+* find the start code by check each byte, the same as before.
+*/
+char* mock_avc_find_annexb(char* p, char* end, int* pnb_start_code)
+{
+    SrsBuffer stream;
+    stream.initialize(p, (int)(end - p));
+    while (!stream.empty()) {
+        if (srs_avc_startswith_annexb(&stream, pnb_start_code)) {
+            return stream.data() + stream.pos();
+        }
+        stream.skip(1);
+    }
+    *pnb_start_code = 0;
+    return end;
+}
+
+VOID TEST(KernelUtilityTest, UtilityAvcFindAnnexb)
+{
+    if (true) {
+        char data[] = {0x00, 0x00, 0x01, 0x67, 0x00, 0x00, 0x00, 0x01, 0x68, 0x00, 0x00, 0x02};
+        char* end = data + sizeof(data);
+        
+        int nb_start_code = 0;
+        EXPECT_EQ(data, srs_avc_find_annexb(data, end, &nb_start_code));
+        EXPECT_EQ(3, nb_start_code);
+        EXPECT_EQ(data + 4, srs_avc_find_annexb(data + 3, end, &nb_start_code));
+        EXPECT_EQ(4, nb_start_code);
+        EXPECT_EQ(end, srs_avc_find_annexb(data + 8, end, &nb_start_code));
+        EXPECT_EQ(0, nb_start_code);
+        
+        char* nalus[4];
+        int sizes[4];
+        EXPECT_EQ(2, srs_avc_split_annexb(data, sizeof(data), nalus, sizes, 4));
+        EXPECT_EQ(data + 3, nalus[0]);
+        EXPECT_EQ(1, sizes[0]);
+        EXPECT_EQ(data + 8, nalus[1]);
+        EXPECT_EQ(4, sizes[1]);
+        
+        // not starts with start code.
+        EXPECT_EQ(0, srs_avc_split_annexb(data + 3, sizeof(data) - 3, nalus, sizes, 4));
+    }
+    
+    // the random frames, the start codes at any position, for the SIMD blocks.
+    srand(0);
+    for (int i = 0; i < 1000; i++) {
+        char data[256];
+        int size = rand() % (int)sizeof(data);
+        for (int j = 0; j < size; j++) {
+            // more zeros and ones, to make start codes.
+            int v = rand() % 8;
+            data[j] = (char)(v < 3? 0x00 : (v < 4? 0x01 : rand()));
+        }
+        
+        char* end = data + size;
+        for (char* p = data; p < end; p++) {
+            int nb_expect = 0, nb_actual = 0;
+            char* expect = mock_avc_find_annexb(p, end, &nb_expect);
+            char* actual = srs_avc_find_annexb(p, end, &nb_actual);
+            ASSERT_EQ(expect, actual);
+            ASSERT_EQ(nb_expect, nb_actual);
+        }
+    }
+}
+
+extern unsigned int __mpegts_crc32(const u_int8_t *data, int len);
+extern u_int32_t __crc32_ieee(u_int32_t init, const u_int8_t* buf, size_t nb_buf);
+
+/**
+* test the crc32 of mpegts and IEEE, against the byte-at-a-time crc32.
+*/
+VOID TEST(KernelUtilityTest, UtilityCrc32)
+{
+    // the check values of "123456789".
+    EXPECT_EQ((u_int32_t)0x0376e6e7, srs_crc32_mpegts("123456789", 9));
+    EXPECT_EQ(0xcbf43926, srs_crc32_ieee("123456789", 9));
+    EXPECT_EQ(0xffffffff, srs_crc32_mpegts("", 0));
+    EXPECT_EQ((u_int32_t)0x00000000, srs_crc32_ieee("", 0));
+    
+    std::string kernel = srs_crc32_ieee_kernel();
+    EXPECT_TRUE(kernel == "pclmul" || kernel == "armv8" || kernel == "slice8");
+    
+    // all sizes and alignments, for the tail of slicing and folding.
+    u_int8_t data[1200];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (u_int8_t)rand();
+    }
+    for (int offset = 0; offset < 8; offset++) {
+        for (int size = 0; size < (int)sizeof(data) - offset; size++) {
+            u_int8_t* p = data + offset;
+            ASSERT_EQ(__mpegts_crc32(p, size), srs_crc32_mpegts(p, size));
+            ASSERT_EQ(__crc32_ieee(0, p, size), srs_crc32_ieee(p, size));
+            ASSERT_EQ(__crc32_ieee(0x12345678, p, size), srs_crc32_ieee(p, size, 0x12345678));
+        }
+    }
+}
+
+/**
+* test the incremental crc32 is same to the crc32 of whole buffer.
+*/
+VOID TEST(KernelUtilityTest, UtilityCrc32Incremental)
+{
+    u_int8_t data[4096];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (u_int8_t)rand();
+    }
+    
+    for (int i = 0; i < 100; i++) {
+        int size = rand() % sizeof(data);
+        
+        SrsCrc32Ieee crc;
+        u_int32_t previous = 0;
+        for (int pos = 0; pos < size;) {
+            int nb = rand() % 300;
+            nb = srs_min(size - pos, nb);
+            crc.update(data + pos, nb);
+            previous = srs_crc32_ieee(data + pos, nb, previous);
+            pos += nb;
+        }
+        
+        u_int32_t expect = __crc32_ieee(0, data, size);
+        ASSERT_EQ(expect, crc.value());
+        ASSERT_EQ(expect, previous);
+    }
+}
+
+/**
+* test the message pool reuse the freed buffers and objects.
+*/
+VOID TEST(KernelPoolTest, MessagePool)
+{
+    SrsMessagePool pool(1024 * 1024);
+    
+    // the buffer reused by size class.
+    char* p = pool.alloc(100);
+    memset(p, 0x0f, 100);
+    pool.free(p);
+    EXPECT_EQ(1, pool.nb_allocs);
+    EXPECT_TRUE(pool.cached_bytes > 0);
+    
+    char* p1 = pool.alloc(128);
+    EXPECT_EQ(p, p1);
+    EXPECT_EQ(1, pool.nb_reuses);
+    EXPECT_EQ(0, pool.cached_bytes);
+    
+    // not the same size class.
+    char* p2 = pool.alloc(129);
+    EXPECT_NE(p1, p2);
+    EXPECT_EQ(1, pool.nb_reuses);
+    pool.free(p1);
+    pool.free(p2);
+    
+    // too large to cache.
+    char* p3 = pool.alloc(2 * 1024 * 1024);
+    EXPECT_EQ(1, pool.nb_oversizes);
+    int64_t cached = pool.cached_bytes;
+    pool.free(p3);
+    EXPECT_EQ(cached, pool.cached_bytes);
+    
+    // the object reused by size.
+    void* o = pool.alloc_object(48);
+    pool.free_object(o, 48);
+    EXPECT_EQ(o, pool.alloc_object(48));
+    EXPECT_EQ(1, pool.nb_object_reuses);
+    pool.free_object(o, 48);
+}
+
+/**
+* test the message pool never cache more than max bytes.
+*/
+VOID TEST(KernelPoolTest, MessagePoolMaxCached)
+{
+    SrsMessagePool pool(2048);
+    
+    char* p = pool.alloc(1000);
+    char* p1 = pool.alloc(1000);
+    pool.free(p);
+    EXPECT_TRUE(pool.cached_bytes > 0);
+    EXPECT_TRUE(pool.cached_bytes <= 2048);
+    
+    int64_t cached = pool.cached_bytes;
+    pool.free(p1);
+    EXPECT_EQ(cached, pool.cached_bytes);
+    
+    // the buffer alloc when pool disabled, freed by srs_pool_free.
+    char* p2 = srs_pool_alloc(10);
+    srs_pool_free(p2);
+}
+
+VOID TEST(KernelBalanceTest, RoundRobinEject)
+{
+    std::vector<std::string> servers;
+    servers.push_back("lb-rr-0:1935");
+    servers.push_back("lb-rr-1:1935");
+    servers.push_back("lb-rr-2:1935");
+    
+    SrsLbRoundRobin lb;
+    EXPECT_STREQ("lb-rr-0:1935", lb.select(servers).c_str());
+    EXPECT_STREQ("lb-rr-1:1935", lb.select(servers).c_str());
+    
+    // the failed server is skipped.
+    lb.on_failure();
+    EXPECT_STREQ("lb-rr-2:1935", lb.select(servers).c_str());
+    EXPECT_STREQ("lb-rr-0:1935", lb.select(servers).c_str());
+    EXPECT_STREQ("lb-rr-2:1935", lb.select(servers).c_str());
+    EXPECT_EQ(2, (int)lb.current());
+    
+    // the backoff doubles for continuous failures.
+    SrsLbUpstream* u = SrsLbUpstreams::instance()->fetch("lb-rr-1:1935");
+    int64_t now = srs_update_system_time_ms();
+    EXPECT_FALSE(u->available(now));
+    u->on_failure(now);
+    EXPECT_EQ(2, u->nb_failures);
+    EXPECT_TRUE(u->eject_until >= now + 10000);
+    
+    u->on_success(10);
+    EXPECT_TRUE(u->available(now));
+    EXPECT_EQ(0, u->nb_failures);
+}
+
+VOID TEST(KernelBalanceTest, ConsistentHash)
+{
+    std::vector<std::string> servers;
+    servers.push_back("lb-hash-0:1935");
+    servers.push_back("lb-hash-1:1935");
+    servers.push_back("lb-hash-2:1935");
+    servers.push_back("lb-hash-3:1935");
+    
+    // the streams are spread, and the same stream always selects the same server.
+    std::map<std::string, int> nb_streams;
+    for (int i = 0; i < 64; i++) {
+        std::string url = "/live/livestream" + srs_int2str(i);
+        
+        SrsLbConsistentHash lb(url);
+        std::string server = lb.select(servers);
+        EXPECT_STREQ(server.c_str(), lb.select(servers).c_str());
+        nb_streams[server]++;
+    }
+    EXPECT_EQ(4, (int)nb_streams.size());
+    
+    // only the streams of the ejected server move.
+    SrsLbUpstream* u = SrsLbUpstreams::instance()->fetch("lb-hash-1:1935");
+    u->on_failure(srs_update_system_time_ms());
+    for (int i = 0; i < 64; i++) {
+        std::string url = "/live/livestream" + srs_int2str(i);
+        
+        SrsLbConsistentHash lb(url);
+        std::string server = lb.select(servers);
+        EXPECT_STRNE("lb-hash-1:1935", server.c_str());
+        
+        SrsLbConsistentHash ref(url);
+        u->eject_until = 0;
+        std::string expect = ref.select(servers);
+        u->on_failure(srs_update_system_time_ms());
+        if (expect != "lb-hash-1:1935") {
+            EXPECT_STREQ(expect.c_str(), server.c_str());
+        }
+    }
+}
+
+VOID TEST(KernelBalanceTest, LeastStreamsAndLatency)
+{
+    std::vector<std::string> servers;
+    servers.push_back("lb-load-0:1935");
+    servers.push_back("lb-load-1:1935");
+    
+    // the streams are spread to the servers.
+    SrsLbLeastStreams s0, s1, s2;
+    EXPECT_STREQ("lb-load-0:1935", s0.select(servers).c_str());
+    EXPECT_STREQ("lb-load-1:1935", s1.select(servers).c_str());
+    EXPECT_STREQ("lb-load-0:1935", s2.select(servers).c_str());
+    EXPECT_EQ(2, SrsLbUpstreams::instance()->fetch("lb-load-0:1935")->nb_streams);
+    
+    s0.on_close();
+    s2.on_close();
+    s1.on_close();
+    EXPECT_EQ(0, SrsLbUpstreams::instance()->fetch("lb-load-0:1935")->nb_streams);
+    EXPECT_EQ(0, SrsLbUpstreams::instance()->fetch("lb-load-1:1935")->nb_streams);
+    
+    // the far server is avoided, until the near one is overloaded.
+    SrsLbUpstreams::instance()->fetch("lb-load-0:1935")->on_success(200);
+    SrsLbUpstreams::instance()->fetch("lb-load-1:1935")->on_success(20);
+    EXPECT_EQ(200, (int)SrsLbUpstreams::instance()->fetch("lb-load-0:1935")->latency);
+    
+    std::vector<SrsLbLatency*> lbs;
+    for (int i = 0; i < 10; i++) {
+        SrsLbLatency* lb = new SrsLbLatency();
+        lbs.push_back(lb);
+        
+        std::string server = lb->select(servers);
+        if (i < 9) {
+            EXPECT_STREQ("lb-load-1:1935", server.c_str());
+        } else {
+            EXPECT_STREQ("lb-load-0:1935", server.c_str());
+        }
+    }
+    for (int i = 0; i < (int)lbs.size(); i++) {
+        srs_freep(lbs[i]);
+    }
+    EXPECT_EQ(0, SrsLbUpstreams::instance()->fetch("lb-load-1:1935")->nb_streams);
+    
+    // the ewma of latency.
+    SrsLbUpstreams::instance()->fetch("lb-load-1:1935")->on_success(120);
+    EXPECT_EQ(50, (int)SrsLbUpstreams::instance()->fetch("lb-load-1:1935")->latency);
+}
+
+// the fifo to write by SrsFileWriter, drained by signal handler.
+#define MOCK_FIFO_SIZE 300 * 1024
+static int mock_fifo_fd = -1;
+static char mock_fifo_data[MOCK_FIFO_SIZE];
+static volatile int mock_fifo_size = 0;
+
+static void mock_fifo_drain(int /*signo*/)
+{
+    ssize_t nread;
+    while (mock_fifo_size < MOCK_FIFO_SIZE
+        && (nread = ::read(mock_fifo_fd, mock_fifo_data + mock_fifo_size, MOCK_FIFO_SIZE - mock_fifo_size)) > 0
+    ) {
+        mock_fifo_size += (int)nread;
+    }
+}
+
+/**
+ * the writev to the full fifo is interrupted by signal and partially
+ * written, then the left bytes must be written.
+ */
+VOID TEST(KernelFileTest, WritevPartial)
+{
+    std::string path = "/tmp/srs-utest-writev-" + srs_int2str(getpid()) + ".fifo";
+    ASSERT_TRUE(0 == ::mkfifo(path.c_str(), S_IRUSR|S_IWUSR));
+    
+    mock_fifo_fd = ::open(path.c_str(), O_RDONLY|O_NONBLOCK);
+    ASSERT_TRUE(mock_fifo_fd > 0);
+    mock_fifo_size = 0;
+    
+    // the fifo buffers 64KB, so the writev of 3x100KB blocks, then the
+    // timer drains the fifo and interrupts the writev with partial bytes.
+    char* data = new char[MOCK_FIFO_SIZE];
+    for (int i = 0; i < MOCK_FIFO_SIZE; i++) {
+        data[i] = (char)(i % 251);
+    }
+    
+    iovec iovs[3];
+    for (int i = 0; i < 3; i++) {
+        iovs[i].iov_base = data + i * (MOCK_FIFO_SIZE / 3);
+        iovs[i].iov_len = MOCK_FIFO_SIZE / 3;
+    }
+    
+    struct sigaction sa, osa;
+    memset(&sa, 0, sizeof(struct sigaction));
+    sa.sa_handler = mock_fifo_drain;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, &osa);
+    
+    itimerval tv, otv;
+    tv.it_interval.tv_sec = tv.it_value.tv_sec = 0;
+    tv.it_interval.tv_usec = tv.it_value.tv_usec = 1000;
+    setitimer(ITIMER_REAL, &tv, &otv);
+    
+    if (true) {
+        SrsFileWriter writer;
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(path));
+        
+        ssize_t nwrite = 0;
+        EXPECT_TRUE(ERROR_SUCCESS == writer.writev(iovs, 3, &nwrite));
+        EXPECT_EQ(MOCK_FIFO_SIZE, (int)nwrite);
+        
+        writer.close();
+    }
+    
+    setitimer(ITIMER_REAL, &otv, NULL);
+    sigaction(SIGALRM, &osa, NULL);
+    
+    mock_fifo_drain(0);
+    EXPECT_EQ(MOCK_FIFO_SIZE, mock_fifo_size);
+    EXPECT_TRUE(0 == memcmp(data, mock_fifo_data, MOCK_FIFO_SIZE));
+    
+    ::close(mock_fifo_fd);
+    ::unlink(path.c_str());
+    srs_freepa(data);
+}
+
+/**
+ * the writers which override write, write the iovs one by one.
+ */
+VOID TEST(KernelFileTest, WritevByWrite)
+{
+    MockSrsFileWriter writer;
+    EXPECT_TRUE(ERROR_SUCCESS == writer.open(""));
+    
+    iovec iovs[3];
+    iovs[0].iov_base = (char*)"hello";
+    iovs[0].iov_len = 5;
+    iovs[1].iov_base = (char*)"";
+    iovs[1].iov_len = 0;
+    iovs[2].iov_base = (char*)" world";
+    iovs[2].iov_len = 6;
+    
+    ssize_t nwrite = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == writer.writev(iovs, 3, &nwrite));
+    EXPECT_EQ(11, (int)nwrite);
+    EXPECT_EQ(11, (int)writer.tellg());
+    EXPECT_TRUE(0 == memcmp("hello world", writer.data, 11));
+}
+
 #endif
 
@@ -28,11 +28,38 @@ using namespace std;
 #include <srs_core_autofree.hpp>
 #include <srs_protocol_utility.hpp>
 #include <srs_rtmp_msg_array.hpp>
+#include <srs_http_stack.hpp>
 #include <srs_rtmp_stack.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_app_st.hpp>
 #include <srs_protocol_amf0.hpp>
 #include <srs_rtmp_stack.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_app_dns.hpp>
+#include <srs_app_http_client.hpp>
+#include <srs_app_hls.hpp>
+#include <srs_app_http_stream.hpp>
+#include <srs_app_http_conn.hpp>
+#include <srs_app_source.hpp>
+#include <srs_app_async_io.hpp>
+#include <srs_app_log.hpp>
+#include <srs_app_handshake.hpp>
+#include <srs_app_config.hpp>
+#include <srs_kernel_pool.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_app_statistic.hpp>
+#include <srs_core_performance.hpp>
+#include <srs_kernel_ts.hpp>
+#include <srs_app_mpegts_udp.hpp>
+#include <srs_app_caster_publisher.hpp>
+#include <srs_utest_config.hpp>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 MockEmptyIO::MockEmptyIO()
 {
@@ -264,6 +291,60 @@ VOID TEST(ProtocolHandshakeTest, DHKey)
     EXPECT_FALSE(srs_bytes_equals(pub_key1, pub_key2, 128));
 }
 
+// the pool generate the DH keys by pthread, and cache the HMAC of genuine keys.
+VOID TEST(ProtocolHandshakeTest, HandshakePool)
+{
+    SrsHandshakePool pool;
+    ASSERT_EQ(ERROR_SUCCESS, pool.initialize(4, NULL));
+    
+    // wait for the pthread to generate keys.
+    _srs_internal::SrsDH* dh = NULL;
+    for (int i = 0; i < 300 && !dh; i++) {
+        if ((dh = pool.fetch_dh()) == NULL) {
+            usleep(10 * 1000);
+        }
+    }
+    ASSERT_TRUE(dh != NULL);
+    SrsAutoFree(_srs_internal::SrsDH, dh);
+    EXPECT_EQ(1, pool.nb_hits);
+    
+    char pkey[128];
+    int32_t pkey_size = 128;
+    ASSERT_EQ(ERROR_SUCCESS, dh->copy_public_key(pkey, pkey_size));
+    ASSERT_EQ(128, pkey_size);
+    
+    // the shared key of pool is same to peer.
+    _srs_internal::SrsDH peer;
+    ASSERT_EQ(ERROR_SUCCESS, peer.initialize(true));
+    
+    char ppkey[128];
+    int32_t ppkey_size = 128;
+    ASSERT_EQ(ERROR_SUCCESS, peer.copy_public_key(ppkey, ppkey_size));
+    
+    char skey[128], expect_skey[128];
+    int32_t skey_size = 128, expect_skey_size = 128;
+    ASSERT_EQ(ERROR_SUCCESS, pool.compute_shared_key(dh, ppkey, ppkey_size, skey, skey_size));
+    ASSERT_EQ(ERROR_SUCCESS, peer.copy_shared_key(pkey, pkey_size, expect_skey, expect_skey_size));
+    ASSERT_EQ(expect_skey_size, skey_size);
+    EXPECT_TRUE(srs_bytes_equals(skey, expect_skey, skey_size));
+    
+    // the digest by the cached HMAC is same to the digest by key.
+    char expect_digest[32], digest[32];
+    ASSERT_EQ(ERROR_SUCCESS, openssl_HMACsha256(SrsGenuineFMSKey, 36, ppkey, 128, expect_digest));
+    
+    _srs_handshake_pool = &pool;
+    for (int i = 0; i < 2; i++) {
+        memset(digest, 0, sizeof(digest));
+        EXPECT_EQ(ERROR_SUCCESS, openssl_HMACsha256(SrsGenuineFMSKey, 36, ppkey, 128, digest));
+        EXPECT_TRUE(srs_bytes_equals(digest, expect_digest, 32));
+    }
+    EXPECT_TRUE(pool.hmac(SrsGenuineFMSKey, 36) != NULL);
+    EXPECT_TRUE(pool.hmac(expect_digest, 32) == NULL);
+    _srs_handshake_pool = NULL;
+    
+    pool.stop();
+}
+
 // flash will sendout a c0c1 encrypt by ssl.
 VOID TEST(ProtocolHandshakeTest, VerifyFPC0C1)
 {
@@ -499,27 +580,120 @@ VOID TEST(ProtocolMsgArrayTest, MessageArray)
     if (true) {
         SrsMessageArray arr(3);
         
-        arr.msgs[0] = msg.copy();
+        msg.copy_to(arr.msgs[0]);
         EXPECT_EQ(1, msg.count());
         
-        arr.msgs[1] = msg.copy();
+        msg.copy_to(arr.msgs[1]);
         EXPECT_EQ(2, msg.count());
         
-        arr.msgs[2] = msg.copy();
+        msg.copy_to(arr.msgs[2]);
         EXPECT_EQ(3, msg.count());
     }
-    EXPECT_EQ(3, msg.count());
+    EXPECT_EQ(0, msg.count());
     
     if (true) {
         SrsMessageArray arr(3);
         
-        arr.msgs[0] = msg.copy();
-        EXPECT_EQ(4, msg.count());
+        msg.copy_to(arr.msgs[0]);
+        EXPECT_EQ(1, msg.count());
+        
+        msg.copy_to(arr.msgs[2]);
+        EXPECT_EQ(2, msg.count());
+        
+        arr.free(1);
+        EXPECT_EQ(1, msg.count());
+        EXPECT_TRUE(NULL == arr.msgs[0]->payload);
         
-        arr.msgs[2] = msg.copy();
-        EXPECT_EQ(5, msg.count());
+        // the msg object is reusable.
+        msg.copy_to(arr.msgs[0]);
+        EXPECT_EQ(2, msg.count());
+        EXPECT_TRUE(payload == arr.msgs[0]->payload);
     }
-    EXPECT_EQ(5, msg.count());
+    EXPECT_EQ(0, msg.count());
+}
+
+/**
+* copy, move and release the shared ptr message without alloc.
+*/
+VOID TEST(ProtocolMsgArrayTest, SharedMessageCopyMove)
+{
+    SrsMessageHeader header;
+    header.timestamp = 100;
+    SrsSharedPtrMessage msg;
+    char* payload = new char[1024];
+    EXPECT_TRUE(ERROR_SUCCESS == msg.create(&header, payload, 1024));
+    
+    SrsSharedPtrMessage a;
+    msg.copy_to(&a);
+    EXPECT_EQ(1, msg.count());
+    EXPECT_EQ(100, a.timestamp);
+    EXPECT_EQ(1024, a.size);
+    EXPECT_TRUE(payload == a.payload);
+    
+    // copy to the msg which refer to the same payload.
+    a.timestamp = 200;
+    msg.copy_to(&a);
+    EXPECT_EQ(1, msg.count());
+    EXPECT_EQ(100, a.timestamp);
+    
+    // move never change the ref-count.
+    SrsSharedPtrMessage b;
+    a.move_to(&b);
+    EXPECT_EQ(1, msg.count());
+    EXPECT_TRUE(NULL == a.payload);
+    EXPECT_EQ(0, a.size);
+    EXPECT_TRUE(payload == b.payload);
+    
+    b.release();
+    EXPECT_EQ(0, msg.count());
+    EXPECT_TRUE(NULL == b.payload);
+    
+    // release an empty msg is ok.
+    a.release();
+    EXPECT_EQ(0, msg.count());
+}
+
+/**
+* match the longest pattern by the radix tree of http mux.
+*/
+VOID TEST(ProtocolHttpTest, HttpMuxTreeMatch)
+{
+    SrsHttpMuxEntry root, api, v1, flv, flv2, vhost;
+    SrsHttpMuxTree tree;
+    
+    tree.insert("/", &root);
+    tree.insert("/api/", &api);
+    tree.insert("/api/v1/", &v1);
+    tree.insert("/live/livestream.flv", &flv);
+    tree.insert("/live/livestream2.flv", &flv2);
+    tree.insert("ossrs.net/live/livestream.flv", &vhost);
+    
+    EXPECT_TRUE(&root == tree.match("/"));
+    EXPECT_TRUE(&root == tree.match("/favicon.ico"));
+    EXPECT_TRUE(&root == tree.match("/api"));
+    EXPECT_TRUE(&api == tree.match("/api/"));
+    EXPECT_TRUE(&api == tree.match("/api/v2/versions"));
+    EXPECT_TRUE(&v1 == tree.match("/api/v1/versions"));
+    EXPECT_TRUE(&flv == tree.match("/live/livestream.flv"));
+    EXPECT_TRUE(&flv2 == tree.match("/live/livestream2.flv"));
+    EXPECT_TRUE(&root == tree.match("/live/livestream.fl"));
+    EXPECT_TRUE(&root == tree.match("/live/livestream.flvx"));
+    EXPECT_TRUE(&vhost == tree.match("ossrs.net/live/livestream.flv"));
+    EXPECT_TRUE(NULL == tree.match("ossrs.net/live/livestream2.flv"));
+    
+    // the disabled entry is ignored, fallback to shorter pattern.
+    v1.enabled = false;
+    EXPECT_TRUE(&api == tree.match("/api/v1/versions"));
+    flv.enabled = false;
+    EXPECT_TRUE(&root == tree.match("/live/livestream.flv"));
+    flv.enabled = true;
+    EXPECT_TRUE(&flv == tree.match("/live/livestream.flv"));
+    
+    // overwrite the entry of pattern, split the node of exists pattern.
+    tree.insert("/live/livestream.flv", &flv2);
+    tree.insert("/live/", &api);
+    EXPECT_TRUE(&flv2 == tree.match("/live/livestream.flv"));
+    EXPECT_TRUE(&api == tree.match("/live/livestream.fl"));
 }
 
 /**
@@ -4609,6 +4783,49 @@ VOID TEST(ProtocolStackTest, ProtocolSendVMessage)
     EXPECT_EQ(16, bio.out_buffer.length());
 }
 
+/**
+* send a video message in multiple chunks to consumers,
+* the chunk iovs is shared by consumers with the same timestamp.
+*/
+VOID TEST(ProtocolStackTest, ProtocolSendVMessageSharedChunks)
+{
+    char data[1000];
+    memset(data, 0x01, sizeof(data));
+    
+    SrsCommonMessage* msg = new SrsCommonMessage();
+    msg->header.initialize_video(sizeof(data), 0x10, 1);
+    msg->size = sizeof(data);
+    msg->payload = new char[msg->size];
+    memcpy(msg->payload, data, msg->size);
+    
+    SrsSharedPtrMessage m;
+    ASSERT_TRUE(ERROR_SUCCESS == m.create(msg));
+    srs_freep(msg);
+    
+    // default out chunk size is 128, so 8 chunks, 1 c0 and 7 c3.
+    MockBufferIO bio0;
+    SrsProtocol proto0(&bio0);
+    EXPECT_TRUE(ERROR_SUCCESS == proto0.send_and_free_message(m.copy(), 1));
+    EXPECT_EQ(12 + 7 + 1000, bio0.out_buffer.length());
+    
+    MockBufferIO bio1;
+    SrsProtocol proto1(&bio1);
+    EXPECT_TRUE(ERROR_SUCCESS == proto1.send_and_free_message(m.copy(), 1));
+    EXPECT_EQ(bio0.out_buffer.length(), bio1.out_buffer.length());
+    EXPECT_TRUE(srs_bytes_equals(bio0.out_buffer.bytes(), bio1.out_buffer.bytes(), bio0.out_buffer.length()));
+    
+    // the consumer with different timestamp.
+    MockBufferIO bio2;
+    SrsProtocol proto2(&bio2);
+    SrsSharedPtrMessage* copy = m.copy();
+    copy->timestamp = 0x20;
+    EXPECT_TRUE(ERROR_SUCCESS == proto2.send_and_free_message(copy, 1));
+    EXPECT_EQ(12 + 7 + 1000, bio2.out_buffer.length());
+    EXPECT_EQ(0x10, bio0.out_buffer.bytes()[3]);
+    EXPECT_EQ(0x20, bio2.out_buffer.bytes()[3]);
+    EXPECT_TRUE(srs_bytes_equals(bio0.out_buffer.bytes() + 4, bio2.out_buffer.bytes() + 4, bio0.out_buffer.length() - 4));
+}
+
 /**
 * send a SrsCallPacket packet
 */
@@ -5437,5 +5654,1922 @@ VOID TEST(ProtocolRTMPTest, RTMPHandshakeBytes)
     EXPECT_TRUE(bytes.s0s1s2 != NULL);
 }
 
+// the type of msg for queue.
+#define MOCK_MSG_METADATA 0
+#define MOCK_MSG_VIDEO_SH 1
+#define MOCK_MSG_AUDIO_SH 2
+#define MOCK_MSG_KEYFRAME 3
+#define MOCK_MSG_INTER 4
+#define MOCK_MSG_AUDIO 5
+
+/**
+ * enqueue the msg of type with timestamp to queue.
+ */
+int mock_enqueue_msg(SrsMessageQueue* queue, int type, int64_t timestamp, bool* is_overflow = NULL)
+{
+    int ret = ERROR_SUCCESS;
+    
+    char* payload = new char[5];
+    memset(payload, 0, 5);
+    
+    SrsMessageHeader header;
+    if (type == MOCK_MSG_METADATA) {
+        payload[0] = 0x02;
+        header.initialize_amf0_script(5, 1);
+    } else if (type == MOCK_MSG_AUDIO_SH || type == MOCK_MSG_AUDIO) {
+        payload[0] = (char)0xaf;
+        payload[1] = (type == MOCK_MSG_AUDIO_SH)? 0x00 : 0x01;
+        header.initialize_audio(5, (u_int32_t)timestamp, 1);
+    } else {
+        payload[0] = (type == MOCK_MSG_INTER)? 0x27 : 0x17;
+        payload[1] = (type == MOCK_MSG_VIDEO_SH)? 0x00 : 0x01;
+        header.initialize_video(5, (u_int32_t)timestamp, 1);
+    }
+    
+    SrsSharedPtrMessage msg;
+    if ((ret = msg.create(&header, payload, 5)) != ERROR_SUCCESS) {
+        srs_freepa(payload);
+        return ret;
+    }
+    msg.timestamp = timestamp;
+    
+    return queue->enqueue(&msg, is_overflow);
+}
+
+/**
+ * the shrink cuts the queue at the keyframe, and keeps the sequence headers.
+ */
+VOID TEST(ProtocolQueueTest, ShrinkAtKeyframe)
+{
+    SrsMessageQueue queue(true);
+    queue.set_queue_size(2);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_METADATA, 0));
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_VIDEO_SH, 0));
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO_SH, 0));
+    
+    // the gop is 1s, overflow and cut at 1100ms when video of 2100ms enqueued.
+    bool is_overflow = false;
+    for (int64_t t = 0; t <= 2100; t += 100) {
+        int type = (t % 1000 == 0)? MOCK_MSG_KEYFRAME : MOCK_MSG_INTER;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, type, t, &is_overflow));
+        EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO, t));
+    }
+    EXPECT_TRUE(is_overflow);
+    EXPECT_EQ(1000, queue.duration());
+    
+    SrsMessageArray arr(64);
+    int count = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == queue.dump_packets(arr.max, arr.msgs, count));
+    EXPECT_EQ(0, queue.size());
+    
+    // the sequence headers and metadata are kept, at the cut time.
+    ASSERT_EQ(3 + 11 + 2, count);
+    EXPECT_FALSE(arr.msgs[0]->is_av());
+    EXPECT_TRUE(arr.msgs[1]->is_video());
+    EXPECT_TRUE(SrsFlvCodec::video_is_sequence_header(arr.msgs[1]->payload, arr.msgs[1]->size));
+    EXPECT_TRUE(arr.msgs[2]->is_audio());
+    EXPECT_TRUE(SrsFlvCodec::audio_is_sequence_header(arr.msgs[2]->payload, arr.msgs[2]->size));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(1100, arr.msgs[i]->timestamp);
+    }
+    
+    // the video starts at the keyframe, the audio after the cut time.
+    int nb_videos = 0;
+    for (int i = 3; i < count; i++) {
+        SrsSharedPtrMessage* msg = arr.msgs[i];
+        if (msg->is_video()) {
+            if (nb_videos++ == 0) {
+                EXPECT_TRUE(SrsFlvCodec::video_is_keyframe(msg->payload, msg->size));
+                EXPECT_EQ(2000, msg->timestamp);
+            }
+        } else {
+            EXPECT_TRUE(msg->timestamp >= 1100);
+        }
+    }
+    EXPECT_EQ(2, nb_videos);
+    
+    arr.free(count);
+}
+
+/**
+ * the shrink drops the video util next keyframe, when no keyframe after cut time.
+ */
+VOID TEST(ProtocolQueueTest, ShrinkWaitKeyframe)
+{
+    SrsMessageQueue queue(true);
+    queue.set_queue_size(2);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_VIDEO_SH, 0));
+    
+    // the gop is larger than queue, no keyframe after the cut time.
+    for (int64_t t = 0; t <= 2100; t += 100) {
+        int type = (t == 0)? MOCK_MSG_KEYFRAME : MOCK_MSG_INTER;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, type, t));
+        EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO, t));
+    }
+    
+    // the video sh and audios after cut time.
+    EXPECT_EQ(1 + 11, queue.size());
+    
+    // the inter frames are dropped, the audio is flowing.
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_INTER, 2200));
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO, 2200));
+    EXPECT_EQ(1 + 12, queue.size());
+    
+    // resume at the next keyframe.
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_KEYFRAME, 2300));
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_INTER, 2400));
+    EXPECT_EQ(1 + 12 + 2, queue.size());
+    
+    SrsMessageArray arr(64);
+    int count = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == queue.dump_packets(arr.max, arr.msgs, count));
+    ASSERT_EQ(15, count);
+    
+    int nb_videos = 0;
+    for (int i = 1; i < count; i++) {
+        SrsSharedPtrMessage* msg = arr.msgs[i];
+        if (msg->is_video()) {
+            EXPECT_TRUE(msg->timestamp >= 2300);
+            nb_videos++;
+        }
+    }
+    EXPECT_EQ(2, nb_videos);
+    
+    arr.free(count);
+}
+
+/**
+ * the queue of pure audio stream is shrinked by the cut time.
+ */
+VOID TEST(ProtocolQueueTest, ShrinkPureAudio)
+{
+    SrsMessageQueue queue(true);
+    queue.set_queue_size(2);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO_SH, 0));
+    
+    bool is_overflow = false;
+    for (int64_t t = 0; t <= 2100; t += 100) {
+        EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO, t, &is_overflow));
+    }
+    EXPECT_TRUE(is_overflow);
+    EXPECT_EQ(1 + 11, queue.size());
+    EXPECT_EQ(1000, queue.duration());
+    
+    // the queue never exceed the queue size.
+    for (int64_t t = 2200; t <= 10000; t += 100) {
+        EXPECT_TRUE(ERROR_SUCCESS == mock_enqueue_msg(&queue, MOCK_MSG_AUDIO, t));
+        EXPECT_TRUE(queue.duration() <= 2000);
+    }
+    
+    SrsMessageArray arr(64);
+    int count = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == queue.dump_packets(arr.max, arr.msgs, count));
+    ASSERT_TRUE(count > 1);
+    EXPECT_TRUE(SrsFlvCodec::audio_is_sequence_header(arr.msgs[0]->payload, arr.msgs[0]->size));
+    EXPECT_EQ(10000, arr.msgs[count - 1]->timestamp);
+    
+    arr.free(count);
+}
+
+/**
+ * build the response of query, with the A record ip and ttl.
+ */
+int mock_dns_response(char* query, int nb_query, int rcode, u_int32_t ip, int ttl, char* buf)
+{
+    memcpy(buf, query, nb_query);
+    
+    SrsBuffer stream;
+    stream.initialize(buf, 512);
+    stream.skip(2);
+    stream.write_2bytes(0x8180 | rcode);
+    stream.skip(2);
+    stream.write_2bytes(rcode? 0:1);
+    stream.skip(nb_query - stream.pos());
+    
+    if (rcode) {
+        return stream.pos();
+    }
+    
+    // the pointer to the name of question.
+    stream.write_2bytes(0xc00c);
+    stream.write_2bytes(1);
+    stream.write_2bytes(1);
+    stream.write_4bytes(ttl);
+    stream.write_2bytes(4);
+    stream.write_4bytes(ip);
+    
+    return stream.pos();
+}
+
+VOID TEST(ProtocolDnsTest, EncodeDecode)
+{
+    char query[512];
+    int nb_query = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_encode_query(0x1234, "www.ossrs.net", query, sizeof(query), &nb_query));
+    EXPECT_EQ(12 + 15 + 4, nb_query);
+    EXPECT_EQ(0x12, (u_int8_t)query[0]);
+    EXPECT_EQ(0x34, (u_int8_t)query[1]);
+    EXPECT_EQ(3, query[12]);
+    EXPECT_TRUE(0 == memcmp(query + 13, "www", 3));
+    EXPECT_EQ(5, query[16]);
+    EXPECT_EQ(0, query[26]);
+    
+    // the host without label.
+    EXPECT_TRUE(ERROR_SUCCESS != srs_dns_encode_query(0x1234, "", query, sizeof(query), &nb_query));
+    EXPECT_TRUE(ERROR_SUCCESS != srs_dns_encode_query(0x1234, "...", query, sizeof(query), &nb_query));
+    EXPECT_TRUE(ERROR_SUCCESS != srs_dns_encode_query(0x1234, ".", query, sizeof(query), &nb_query));
+    EXPECT_TRUE(ERROR_SUCCESS != srs_dns_encode_query(0x1234, "www..net", query, sizeof(query), &nb_query));
+    EXPECT_TRUE(ERROR_SUCCESS != srs_dns_encode_query(0x1234, ".ossrs.net", query, sizeof(query), &nb_query));
+    EXPECT_TRUE(ERROR_SUCCESS != srs_dns_encode_query(0x1234, "ossrs.net..", query, sizeof(query), &nb_query));
+    
+    // the fully qualified host, strip the trailing dot.
+    char fqdn[512];
+    int nb_fqdn = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_encode_query(0x1234, "www.ossrs.net.", fqdn, sizeof(fqdn), &nb_fqdn));
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_encode_query(0x1234, "www.ossrs.net", query, sizeof(query), &nb_query));
+    ASSERT_EQ(nb_query, nb_fqdn);
+    EXPECT_TRUE(0 == memcmp(query, fqdn, nb_query));
+    
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_encode_query(0x1234, "www.ossrs.net", query, sizeof(query), &nb_query));
+    
+    char buf[512];
+    int nb_buf = mock_dns_response(query, nb_query, 0, 0x01020304, 300, buf);
+    
+    std::string ip;
+    int ttl = 0;
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    EXPECT_STREQ("1.2.3.4", ip.c_str());
+    EXPECT_EQ(300, ttl);
+    
+    // the question is case insensitive, and the trailing dot is stripped.
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_decode_response(0x1234, "WWW.ossrs.NET.", buf, nb_buf, ip, &ttl));
+    
+    // the question not match, for example, the spoofed response.
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_PACKET == srs_dns_decode_response(0x1234, "ossrs.net", buf, nb_buf, ip, &ttl));
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_PACKET == srs_dns_decode_response(0x1234, "www.ossrs.com", buf, nb_buf, ip, &ttl));
+    
+    // the type of question is AAAA.
+    buf[nb_query - 3] = 28;
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_PACKET == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    buf[nb_query - 3] = 1;
+    
+    // no question.
+    buf[5] = 0;
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_PACKET == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    buf[5] = 1;
+    EXPECT_TRUE(ERROR_SUCCESS == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    
+    // the id not match.
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_PACKET == srs_dns_decode_response(0x1235, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    // the truncated response.
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESPONSE == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf - 1, ip, &ttl));
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_PACKET == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, 10, ip, &ttl));
+    
+    // host not found.
+    nb_buf = mock_dns_response(query, nb_query, 3, 0, 0, buf);
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESOLVE == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    
+    // server failure.
+    nb_buf = mock_dns_response(query, nb_query, 2, 0, 0, buf);
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESPONSE == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+    
+    // query refused.
+    nb_buf = mock_dns_response(query, nb_query, 5, 0, 0, buf);
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESPONSE == srs_dns_decode_response(0x1234, "www.ossrs.net", buf, nb_buf, ip, &ttl));
+}
+
+/**
+ * the id of query is random, never sequential.
+ */
+VOID TEST(ProtocolDnsTest, RandomId)
+{
+    int nb_sequential = 0;
+    u_int16_t prev = srs_dns_random_id();
+    for (int i = 0; i < 16; i++) {
+        u_int16_t id = srs_dns_random_id();
+        if (id == (u_int16_t)(prev + 1)) {
+            nb_sequential++;
+        }
+        prev = id;
+    }
+    EXPECT_TRUE(nb_sequential < 16);
+}
+
+/**
+ * the stub dns server, answer the stub.ossrs.net, server failure for
+ * the fail.ossrs.net and not found for others.
+ */
+struct MockDnsServer
+{
+    st_netfd_t stfd;
+    int nb_queries;
+    bool quit;
+};
+
+void* mock_dns_server_cycle(void* arg)
+{
+    MockDnsServer* server = (MockDnsServer*)arg;
+    
+    while (!server->quit) {
+        char query[512];
+        sockaddr_in from;
+        int nb_from = sizeof(sockaddr_in);
+        int nread = st_recvfrom(server->stfd, query, sizeof(query), (sockaddr*)&from, &nb_from, 10 * 1000);
+        if (nread <= 0) {
+            continue;
+        }
+        server->nb_queries++;
+        
+        // delay to make the queries in flight.
+        st_usleep(10 * 1000);
+        
+        char buf[512];
+        int rcode = 3;
+        if (nread > 16 && 0 == memcmp(query + 13, "stub", 4)) {
+            rcode = 0;
+        } else if (nread > 16 && 0 == memcmp(query + 13, "fail", 4)) {
+            rcode = 2;
+        }
+        int nb_buf = mock_dns_response(query, nread, rcode, 0x0a000001, 60, buf);
+        st_sendto(server->stfd, buf, nb_buf, (sockaddr*)&from, nb_from, ST_UTIME_NO_TIMEOUT);
+    }
+    
+    return NULL;
+}
+
+struct MockDnsClient
+{
+    SrsDnsResolver* resolver;
+    std::string host;
+    std::string ip;
+    int ret;
+};
+
+void* mock_dns_client_cycle(void* arg)
+{
+    MockDnsClient* client = (MockDnsClient*)arg;
+    client->ret = client->resolver->resolve(client->host, client->ip);
+    return NULL;
+}
+
+VOID TEST(ProtocolDnsTest, ResolveByStubServer)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    EXPECT_TRUE(fd > 0);
+    
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    EXPECT_TRUE(0 == ::bind(fd, (sockaddr*)&addr, sizeof(addr)));
+    
+    socklen_t nb_addr = sizeof(addr);
+    EXPECT_TRUE(0 == getsockname(fd, (sockaddr*)&addr, &nb_addr));
+    
+    MockDnsServer server;
+    server.stfd = st_netfd_open_socket(fd);
+    server.nb_queries = 0;
+    server.quit = false;
+    st_thread_t trd = st_thread_create(mock_dns_server_cycle, &server, 1, 0);
+    
+    std::vector<std::string> servers;
+    servers.push_back("127.0.0.1:" + srs_int2str(ntohs(addr.sin_port)));
+    std::map<std::string, std::string> hosts;
+    hosts["static.ossrs.net"] = "10.0.0.2";
+    
+    SrsDnsResolver resolver;
+    resolver.initialize(servers, hosts);
+    
+    std::string ip;
+    EXPECT_TRUE(ERROR_SUCCESS == resolver.resolve("10.0.0.3", ip));
+    EXPECT_STREQ("10.0.0.3", ip.c_str());
+    EXPECT_TRUE(ERROR_SUCCESS == resolver.resolve("static.ossrs.net", ip));
+    EXPECT_STREQ("10.0.0.2", ip.c_str());
+    EXPECT_EQ(0, server.nb_queries);
+    
+    // the clients resolve the same host in a query.
+    MockDnsClient c0, c1;
+    c0.resolver = c1.resolver = &resolver;
+    c0.host = c1.host = "stub.ossrs.net";
+    st_thread_t t0 = st_thread_create(mock_dns_client_cycle, &c0, 1, 0);
+    st_thread_t t1 = st_thread_create(mock_dns_client_cycle, &c1, 1, 0);
+    st_thread_join(t0, NULL);
+    st_thread_join(t1, NULL);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == c0.ret);
+    EXPECT_TRUE(ERROR_SUCCESS == c1.ret);
+    EXPECT_STREQ("10.0.0.1", c0.ip.c_str());
+    EXPECT_STREQ("10.0.0.1", c1.ip.c_str());
+    EXPECT_EQ(1, server.nb_queries);
+    EXPECT_EQ(1, resolver.nb_coalesced);
+    
+    // hit the cache.
+    EXPECT_TRUE(ERROR_SUCCESS == resolver.resolve("stub.ossrs.net", ip));
+    EXPECT_STREQ("10.0.0.1", ip.c_str());
+    EXPECT_EQ(1, server.nb_queries);
+    EXPECT_EQ(1, resolver.nb_hits);
+    
+    // the host not found is cached.
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESOLVE == resolver.resolve("none.ossrs.net", ip));
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESOLVE == resolver.resolve("none.ossrs.net", ip));
+    EXPECT_EQ(2, server.nb_queries);
+    EXPECT_EQ(1, resolver.nb_negative_hits);
+    
+    // the server failure fails at once, never wait for timeout.
+    int64_t starttime = srs_update_system_time_ms();
+    EXPECT_TRUE(ERROR_SYSTEM_DNS_RESPONSE == resolver.resolve("fail.ossrs.net", ip));
+    EXPECT_TRUE(srs_update_system_time_ms() - starttime < SRS_DNS_QUERY_TIMEOUT_US / 1000);
+    EXPECT_EQ(3, server.nb_queries);
+    
+    server.quit = true;
+    st_thread_join(trd, NULL);
+    srs_close_stfd(server.stfd);
+}
+
+struct MockHttpServer
+{
+    st_netfd_t stfd;
+    int nb_accepts;
+    int nb_requests;
+    // the number of requests to close without response.
+    int nb_drops;
+    // the number of requests to close with part of response.
+    int nb_breaks;
+    bool quit;
+};
+
+void* mock_http_conn_cycle(void* arg)
+{
+    std::pair<MockHttpServer*, st_netfd_t>* conn = (std::pair<MockHttpServer*, st_netfd_t>*)arg;
+    MockHttpServer* server = conn->first;
+    st_netfd_t stfd = conn->second;
+    srs_freep(conn);
+    
+    // response each request, the request is small enough to read in a packet.
+    for (;;) {
+        char buf[1024];
+        int nread = st_read(stfd, buf, sizeof(buf), ST_UTIME_NO_TIMEOUT);
+        if (nread <= 0) {
+            break;
+        }
+        server->nb_requests++;
+        
+        if (server->nb_drops > 0) {
+            server->nb_drops--;
+            break;
+        }
+        
+        if (server->nb_breaks > 0) {
+            server->nb_breaks--;
+            const char* res = "HTTP/1.1 200 OK\r\nContent-";
+            st_write(stfd, res, strlen(res), ST_UTIME_NO_TIMEOUT);
+            break;
+        }
+        
+        const char* res = "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\n0";
+        st_write(stfd, res, strlen(res), ST_UTIME_NO_TIMEOUT);
+    }
+    
+    srs_close_stfd(stfd);
+    return NULL;
+}
+
+void* mock_http_server_cycle(void* arg)
+{
+    MockHttpServer* server = (MockHttpServer*)arg;
+    
+    while (!server->quit) {
+        st_netfd_t stfd = st_accept(server->stfd, NULL, NULL, 10 * 1000);
+        if (!stfd) {
+            continue;
+        }
+        server->nb_accepts++;
+        
+        std::pair<MockHttpServer*, st_netfd_t>* conn = new std::pair<MockHttpServer*, st_netfd_t>(server, stfd);
+        st_thread_create(mock_http_conn_cycle, conn, 0, 0);
+    }
+    
+    return NULL;
+}
+
+int mock_http_post(int port)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsHttpClient http;
+    if ((ret = http.initialize("127.0.0.1", port)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    ISrsHttpMessage* msg = NULL;
+    if ((ret = http.post("/api/v1/clients", "{}", &msg)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    SrsAutoFree(ISrsHttpMessage, msg);
+    
+    std::string res;
+    if ((ret = msg->body_read_all(res)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    http.recycle(msg);
+    
+    return res == "0"? ERROR_SUCCESS : ERROR_HTTP_DATA_INVALID;
+}
+
+VOID TEST(ProtocolHttpTest, ClientPoolReuse)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_TRUE(fd > 0);
+    
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    EXPECT_TRUE(0 == ::bind(fd, (sockaddr*)&addr, sizeof(addr)));
+    EXPECT_TRUE(0 == ::listen(fd, 10));
+    
+    socklen_t nb_addr = sizeof(addr);
+    EXPECT_TRUE(0 == getsockname(fd, (sockaddr*)&addr, &nb_addr));
+    int port = ntohs(addr.sin_port);
+    
+    MockHttpServer server;
+    server.stfd = st_netfd_open_socket(fd);
+    server.nb_accepts = 0;
+    server.nb_requests = 0;
+    server.nb_drops = server.nb_breaks = 0;
+    server.quit = false;
+    st_thread_t trd = st_thread_create(mock_http_server_cycle, &server, 1, 0);
+    
+    SrsHttpClientPool* pool = SrsHttpClientPool::instance();
+    int64_t nb_reuses = pool->nb_reuses;
+    
+    // the clients reuse the keep-alive connection one by one.
+    EXPECT_TRUE(ERROR_SUCCESS == mock_http_post(port));
+    EXPECT_TRUE(ERROR_SUCCESS == mock_http_post(port));
+    EXPECT_TRUE(ERROR_SUCCESS == mock_http_post(port));
+    EXPECT_EQ(1, server.nb_accepts);
+    EXPECT_EQ(3, server.nb_requests);
+    EXPECT_EQ(2, pool->nb_reuses - nb_reuses);
+    
+    // the closed connection is broken, so the client connects again.
+    SrsTcpClient* idle = pool->acquire("127.0.0.1", port);
+    EXPECT_TRUE(idle != NULL);
+    EXPECT_FALSE(idle->is_broken());
+    idle->close();
+    EXPECT_TRUE(idle->is_broken());
+    srs_freep(idle);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == mock_http_post(port));
+    EXPECT_EQ(2, server.nb_accepts);
+    EXPECT_EQ(4, server.nb_requests);
+    
+    // the reused connection closed before response, retry by a new connection.
+    server.nb_drops = 1;
+    EXPECT_TRUE(ERROR_SUCCESS == mock_http_post(port));
+    EXPECT_EQ(3, server.nb_accepts);
+    EXPECT_EQ(6, server.nb_requests);
+    
+    // the reused connection closed with part of response, never retry,
+    // for the server already handled the request.
+    server.nb_breaks = 1;
+    EXPECT_TRUE(ERROR_SUCCESS != mock_http_post(port));
+    EXPECT_EQ(3, server.nb_accepts);
+    EXPECT_EQ(7, server.nb_requests);
+    
+    server.quit = true;
+    st_thread_join(trd, NULL);
+    srs_close_stfd(server.stfd);
+}
+
+#ifdef SRS_AUTO_HTTP_SERVER
+/**
+* the remuxed chunks are dumped to the msgs of array by ref-count,
+* which never alloc message objects for viewers.
+*/
+VOID TEST(ProtocolHttpTest, RemuxDumpChunks)
+{
+    SrsConfig conf;
+    _srs_config = &conf;
+    
+    SrsMessagePool pool(1024 * 1024);
+    _srs_message_pool = &pool;
+    
+    if (true) {
+        SrsRequest req;
+        req.vhost = "__defaultVhost__";
+        
+        SrsBufferCache cache(NULL, &req);
+        cache.set_remux(".mp3");
+        
+        SrsMp3StreamEncoder enc;
+        SrsBufferChunkWriter writer;
+        EXPECT_TRUE(ERROR_SUCCESS == enc.initialize(&writer, &cache));
+        writer.flush();
+        
+        // the mp3 frames, each remuxed to a chunk.
+        SrsSharedPtrMessage msgs[3];
+        SrsSharedPtrMessage* pmsgs[3];
+        for (int i = 0; i < 3; i++) {
+            char* payload = new char[4];
+            payload[0] = 0x2f;
+            payload[1] = (char)0xff;
+            payload[2] = (char)0xfb;
+            payload[3] = (char)i;
+            
+            SrsMessageHeader header;
+            header.initialize_audio(4, 10 * i, 1);
+            EXPECT_TRUE(ERROR_SUCCESS == msgs[i].create(&header, payload, 4));
+            pmsgs[i] = &msgs[i];
+        }
+        EXPECT_TRUE(ERROR_SUCCESS == cache.remux_messages(&enc, &writer, pmsgs, 3));
+        
+        int64_t nb_objects = pool.nb_objects;
+        int64_t nb_object_reuses = pool.nb_object_reuses;
+        
+        // dump twice to the same array, the viewer sends and frees them.
+        SrsMessageArray arr(8);
+        for (int i = 0; i < 2; i++) {
+            int64_t cursor = 0;
+            int count = 0;
+            EXPECT_TRUE(ERROR_SUCCESS == cache.dump_chunks(&cursor, &arr, count));
+            EXPECT_EQ(3, count);
+            EXPECT_EQ(3, cursor);
+            EXPECT_EQ(1, arr.msgs[0]->count());
+            EXPECT_EQ(3, arr.msgs[0]->size);
+            EXPECT_EQ(20, arr.msgs[2]->timestamp);
+            
+            arr.free(count);
+        }
+        EXPECT_EQ(nb_objects, pool.nb_objects);
+        EXPECT_EQ(nb_object_reuses, pool.nb_object_reuses);
+        
+        // the cursor at the end, nothing to dump.
+        int64_t cursor = 3;
+        int count = 0;
+        EXPECT_TRUE(ERROR_SUCCESS == cache.dump_chunks(&cursor, &arr, count));
+        EXPECT_EQ(0, count);
+    }
+    
+    _srs_message_pool = NULL;
+    _srs_config = NULL;
+}
 #endif
 
+#if defined(SRS_AUTO_HTTP_CORE) && defined(SRS_PERF_HTTP_SENDFILE)
+/**
+ * the file to send, the bytes are the index mod 251.
+ */
+int mock_sendfile_open(std::string path, int size)
+{
+    std::string data;
+    for (int i = 0; i < size; i++) {
+        data.append(1, (char)(i % 251));
+    }
+    
+    int fd = ::open(path.c_str(), O_CREAT|O_RDWR|O_TRUNC, S_IRUSR|S_IWUSR);
+    if (fd > 0 && ::write(fd, data.data(), size) != size) {
+        ::close(fd);
+        return -1;
+    }
+    ::unlink(path.c_str());
+    ::lseek(fd, 0, SEEK_SET);
+    
+    return fd;
+}
+
+/**
+ * read the bytes in socket, never block.
+ */
+std::string mock_sendfile_read(int fd)
+{
+    std::string data;
+    
+    char buf[4096];
+    ssize_t nread;
+    while ((nread = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        data.append(buf, nread);
+    }
+    
+    return data;
+}
+
+std::string mock_sendfile_body(int offset, int size)
+{
+    std::string data;
+    for (int i = offset; i < offset + size; i++) {
+        data.append(1, (char)(i % 251));
+    }
+    return data;
+}
+
+/**
+ * the file is sent as the body of content-length response.
+ */
+VOID TEST(ProtocolHttpTest, SendfileContentLength)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    int fds[2];
+    ASSERT_TRUE(0 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    st_netfd_t stfd = st_netfd_open_socket(fds[0]);
+    
+    std::string path = "/tmp/srs-utest-sendfile-" + srs_int2str(getpid()) + ".ts";
+    int fd = mock_sendfile_open(path, 1000);
+    ASSERT_TRUE(fd > 0);
+    
+    if (true) {
+        SrsStSocket skt(stfd);
+        SrsHttpResponseWriter w(&skt);
+        w.header()->set_content_length(600);
+        
+        EXPECT_TRUE(ERROR_SUCCESS == w.sendfile(fd, 100, 500));
+        EXPECT_TRUE(ERROR_SUCCESS == w.sendfile(fd, 900, 100));
+        
+        // the offset of file is not changed.
+        EXPECT_EQ(0, (int)::lseek(fd, 0, SEEK_CUR));
+        
+        std::string res = mock_sendfile_read(fds[1]);
+        size_t pos = res.find("\r\n\r\n");
+        ASSERT_TRUE(pos != std::string::npos);
+        EXPECT_TRUE(mock_sendfile_body(100, 500) + mock_sendfile_body(900, 100) == res.substr(pos + 4));
+        
+        // exceed the content length.
+        EXPECT_TRUE(ERROR_HTTP_CONTENT_LENGTH == w.sendfile(fd, 0, 1));
+    }
+    
+    if (true) {
+        SrsStSocket skt(stfd);
+        SrsHttpResponseWriter w(&skt);
+        w.header()->set_content_length(500);
+        
+        EXPECT_TRUE(ERROR_SUCCESS == w.sendfile(fd, 100, 500));
+        
+        std::string res = mock_sendfile_read(fds[1]);
+        size_t pos = res.find("\r\n\r\n");
+        ASSERT_TRUE(pos != std::string::npos);
+        
+        std::string header = res.substr(0, pos + 4);
+        EXPECT_TRUE(header.find("HTTP/1.1 200 OK\r\n") == 0);
+        EXPECT_TRUE(header.find("Content-Length: 500\r\n") != std::string::npos);
+        EXPECT_TRUE(header.find("Transfer-Encoding") == std::string::npos);
+        EXPECT_TRUE(mock_sendfile_body(100, 500) == res.substr(pos + 4));
+    }
+    
+    ::close(fd);
+    srs_close_stfd(stfd);
+    ::close(fds[1]);
+}
+
+/**
+ * the file is sent as a chunk of chunked response.
+ */
+VOID TEST(ProtocolHttpTest, SendfileChunked)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    int fds[2];
+    ASSERT_TRUE(0 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    st_netfd_t stfd = st_netfd_open_socket(fds[0]);
+    
+    std::string path = "/tmp/srs-utest-sendfile-" + srs_int2str(getpid()) + ".ts";
+    int fd = mock_sendfile_open(path, 1000);
+    ASSERT_TRUE(fd > 0);
+    
+    if (true) {
+        SrsStSocket skt(stfd);
+        SrsHttpResponseWriter w(&skt);
+        
+        EXPECT_TRUE(ERROR_SUCCESS == w.sendfile(fd, 100, 500));
+        // the empty file is ignored, never send the eof chunk.
+        EXPECT_TRUE(ERROR_SUCCESS == w.sendfile(fd, 600, 0));
+        EXPECT_TRUE(ERROR_SUCCESS == w.sendfile(fd, 990, 10));
+        
+        std::string res = mock_sendfile_read(fds[1]);
+        size_t pos = res.find("\r\n\r\n");
+        ASSERT_TRUE(pos != std::string::npos);
+        
+        std::string header = res.substr(0, pos + 4);
+        EXPECT_TRUE(header.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+        EXPECT_TRUE(header.find("Content-Length") == std::string::npos);
+        
+        std::string body = "1f4\r\n" + mock_sendfile_body(100, 500) + "\r\n"
+            + "a\r\n" + mock_sendfile_body(990, 10) + "\r\n";
+        EXPECT_TRUE(body == res.substr(pos + 4));
+    }
+    
+    ::close(fd);
+    srs_close_stfd(stfd);
+    ::close(fds[1]);
+}
+
+/**
+ * the reader of socket, in st.
+ */
+struct MockSendfileReader
+{
+    st_netfd_t stfd;
+    int size;
+    std::string data;
+};
+
+void* mock_sendfile_reader_cycle(void* arg)
+{
+    MockSendfileReader* reader = (MockSendfileReader*)arg;
+    
+    char buf[4096];
+    while ((int)reader->data.length() < reader->size) {
+        ssize_t nread = st_read(reader->stfd, buf, sizeof(buf), ST_UTIME_NO_TIMEOUT);
+        if (nread <= 0) {
+            break;
+        }
+        reader->data.append(buf, nread);
+    }
+    
+    return NULL;
+}
+
+/**
+ * the socket is not writable when the file exceeds the buffer of socket,
+ * the sendfile waits in st until writable, or timeout.
+ */
+VOID TEST(ProtocolHttpTest, SendfileEagain)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    int size = 4 * 1024 * 1024;
+    std::string path = "/tmp/srs-utest-sendfile-" + srs_int2str(getpid()) + ".ts";
+    int fd = mock_sendfile_open(path, size);
+    ASSERT_TRUE(fd > 0);
+    
+    // the reader in st drains the socket.
+    if (true) {
+        int fds[2];
+        ASSERT_TRUE(0 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        st_netfd_t stfd = st_netfd_open_socket(fds[0]);
+        
+        MockSendfileReader reader;
+        reader.stfd = st_netfd_open_socket(fds[1]);
+        reader.size = size;
+        st_thread_t trd = st_thread_create(mock_sendfile_reader_cycle, &reader, 1, 0);
+        
+        SrsStSocket skt(stfd);
+        skt.set_send_timeout(3 * 1000 * 1000);
+        
+        ssize_t nwrite = 0;
+        EXPECT_TRUE(ERROR_SUCCESS == skt.sendfile(fd, 0, size, &nwrite));
+        EXPECT_EQ(size, (int)nwrite);
+        EXPECT_EQ(size, (int)skt.get_send_bytes());
+        
+        st_thread_join(trd, NULL);
+        EXPECT_TRUE(mock_sendfile_body(0, size) == reader.data);
+        
+        srs_close_stfd(stfd);
+        srs_close_stfd(reader.stfd);
+    }
+    
+    // timeout when the socket is never read.
+    if (true) {
+        int fds[2];
+        ASSERT_TRUE(0 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        st_netfd_t stfd = st_netfd_open_socket(fds[0]);
+        
+        SrsStSocket skt(stfd);
+        skt.set_send_timeout(100 * 1000);
+        
+        ssize_t nwrite = 0;
+        EXPECT_TRUE(ERROR_SOCKET_TIMEOUT == skt.sendfile(fd, 0, size, &nwrite));
+        EXPECT_TRUE(nwrite > 0 && nwrite < size);
+        
+        srs_close_stfd(stfd);
+        ::close(fds[1]);
+    }
+    
+    ::close(fd);
+}
+#endif
+
+/**
+ * the mock task of async io, record the id when called.
+ */
+class MockAsyncIoTask : public ISrsAsyncIoTask
+{
+public:
+    std::vector<int>* calls;
+    int id;
+    int ret;
+public:
+    MockAsyncIoTask(std::vector<int>* c, int i, int r = ERROR_SUCCESS) {
+        calls = c;
+        id = i;
+        ret = r;
+    }
+    virtual ~MockAsyncIoTask() {
+    }
+public:
+    virtual int call() {
+        calls->push_back(id);
+        return ret;
+    }
+    virtual std::string to_string() {
+        return "mock";
+    }
+};
+
+/**
+ * read the whole file to string, empty when not exists.
+ */
+std::string mock_read_file(std::string path)
+{
+    std::string data;
+    
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) {
+        return data;
+    }
+    
+    char buf[4096];
+    size_t nread;
+    while ((nread = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        data.append(buf, nread);
+    }
+    fclose(fp);
+    
+    return data;
+}
+
+/**
+ * the tasks of a key are executed in order, by the same worker.
+ */
+VOID TEST(ProtocolAsyncIoTest, ExecuteInOrder)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    SrsAsyncIo io;
+    EXPECT_TRUE(ERROR_SUCCESS == io.initialize(2));
+    
+    int k0 = SrsAsyncIo::alloc_key();
+    int k1 = SrsAsyncIo::alloc_key();
+    EXPECT_EQ(k0 + 1, k1);
+    
+    std::vector<int> c0, c1;
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(ERROR_SUCCESS == io.execute(k0, new MockAsyncIoTask(&c0, i)));
+        // the failed task is logged, never return to caller.
+        EXPECT_TRUE(ERROR_SUCCESS == io.execute(k1, new MockAsyncIoTask(&c1, i, ERROR_SYSTEM_FILE_WRITE)));
+    }
+    EXPECT_EQ(100, io.sequence(k0));
+    EXPECT_EQ(100, io.sequence(k1));
+    
+    io.wait(k0, io.sequence(k0));
+    io.wait(k1, io.sequence(k1));
+    
+    ASSERT_EQ(100, (int)c0.size());
+    ASSERT_EQ(100, (int)c1.size());
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(i, c0.at(i));
+        EXPECT_EQ(i, c1.at(i));
+    }
+    
+    io.stop();
+}
+
+/**
+ * when no workers, the tasks are executed in st directly.
+ */
+VOID TEST(ProtocolAsyncIoTest, ExecuteInSt)
+{
+    SrsAsyncIo io;
+    EXPECT_TRUE(ERROR_SUCCESS == io.initialize(0));
+    
+    int key = SrsAsyncIo::alloc_key();
+    
+    std::vector<int> calls;
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new MockAsyncIoTask(&calls, 1)));
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new MockAsyncIoTask(&calls, 2, ERROR_SYSTEM_FILE_WRITE)));
+    ASSERT_EQ(2, (int)calls.size());
+    EXPECT_EQ(2, calls.at(1));
+    
+    // the error is kept for key, fetched once.
+    EXPECT_TRUE(ERROR_SYSTEM_FILE_WRITE == io.fetch_error(key));
+    EXPECT_TRUE(ERROR_SUCCESS == io.fetch_error(key));
+    
+    EXPECT_EQ(0, io.sequence(key));
+    io.wait(key, io.sequence(key));
+}
+
+/**
+ * the file written by worker, then renamed and unlinked in order.
+ */
+VOID TEST(ProtocolAsyncIoTest, WriteRenameUnlink)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    SrsAsyncIo io;
+    EXPECT_TRUE(ERROR_SUCCESS == io.initialize(2));
+    _srs_async_io = &io;
+    
+    std::string tmp = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + ".tmp";
+    std::string path = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + ".ts";
+    
+    int key = SrsAsyncIo::alloc_key();
+    if (true) {
+        SrsAsyncFileWriter writer(key);
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(tmp));
+        EXPECT_TRUE(writer.is_open());
+        
+        EXPECT_TRUE(ERROR_SUCCESS == writer.write((void*)"hello", 5, NULL));
+        
+        iovec iovs[2];
+        iovs[0].iov_base = (char*)" ";
+        iovs[0].iov_len = 1;
+        iovs[1].iov_base = (char*)"world";
+        iovs[1].iov_len = 5;
+        ssize_t nwrite = 0;
+        EXPECT_TRUE(ERROR_SUCCESS == writer.writev(iovs, 2, &nwrite));
+        EXPECT_EQ(6, (int)nwrite);
+        EXPECT_EQ(11, writer.tellg());
+        
+        writer.close();
+        EXPECT_FALSE(writer.is_open());
+    }
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new SrsAsyncIoRenameTask(tmp, path)));
+    
+    io.wait(key, io.sequence(key));
+    EXPECT_STREQ("hello world", mock_read_file(path).c_str());
+    EXPECT_TRUE(::access(tmp.c_str(), F_OK) != 0);
+    
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new SrsAsyncIoUnlinkTask(path)));
+    io.wait(key, io.sequence(key));
+    EXPECT_TRUE(::access(path.c_str(), F_OK) != 0);
+    
+    io.stop();
+    _srs_async_io = NULL;
+}
+
+/**
+ * the stop of async io flushes all submitted tasks, then write in st.
+ */
+VOID TEST(ProtocolAsyncIoTest, FlushOnStop)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    SrsAsyncIo io;
+    EXPECT_TRUE(ERROR_SUCCESS == io.initialize(1));
+    _srs_async_io = &io;
+    
+    std::string path = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + ".flv";
+    
+    char buf[1000];
+    memset(buf, 0x09, sizeof(buf));
+    
+    int key = SrsAsyncIo::alloc_key();
+    if (true) {
+        SrsAsyncFileWriter writer(key);
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(path));
+        for (int i = 0; i < 1000; i++) {
+            EXPECT_TRUE(ERROR_SUCCESS == writer.write(buf, sizeof(buf), NULL));
+        }
+        writer.close();
+    }
+    
+    // all tasks are executed when stop, never wait.
+    io.stop();
+    
+    struct stat st;
+    EXPECT_TRUE(0 == ::stat(path.c_str(), &st));
+    EXPECT_EQ(1000 * 1000, (int)st.st_size);
+    
+    // the task is executed in st after stop.
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new SrsAsyncIoUnlinkTask(path)));
+    EXPECT_TRUE(::access(path.c_str(), F_OK) != 0);
+    
+    _srs_async_io = NULL;
+}
+
+/**
+ * the task blocks the worker util a byte read from pipe.
+ */
+class MockAsyncIoBlockTask : public ISrsAsyncIoTask
+{
+public:
+    int fd;
+public:
+    MockAsyncIoBlockTask(int f) {
+        fd = f;
+    }
+    virtual ~MockAsyncIoBlockTask() {
+    }
+public:
+    virtual int call() {
+        char v = 0;
+        ssize_t nread = ::read(fd, &v, 1);
+        (void)nread;
+        return ERROR_SUCCESS;
+    }
+    virtual std::string to_string() {
+        return "block";
+    }
+};
+
+/**
+ * when disk stalls, the write over the pending bytes of worker is dropped,
+ * and the following writes of file are dropped.
+ */
+VOID TEST(ProtocolAsyncIoTest, DropWhenFull)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    SrsAsyncIo io;
+    EXPECT_TRUE(ERROR_SUCCESS == io.initialize(1));
+    _srs_async_io = &io;
+    
+    int fds[2];
+    ASSERT_TRUE(0 == pipe(fds));
+    
+    std::string path = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + ".ts";
+    
+    char* buf = new char[SRS_PERF_ASYNC_IO_BUFFER];
+    SrsAutoFreeA(char, buf);
+    memset(buf, 0x47, SRS_PERF_ASYNC_IO_BUFFER);
+    
+    int key = SrsAsyncIo::alloc_key();
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new MockAsyncIoBlockTask(fds[0])));
+    if (true) {
+        SrsAsyncFileWriter writer(key);
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(path));
+        
+        // each write is submit to the stalled worker.
+        int nb_writes = SRS_PERF_ASYNC_IO_MAX_PENDING / SRS_PERF_ASYNC_IO_BUFFER;
+        for (int i = 0; i < nb_writes; i++) {
+            EXPECT_TRUE(ERROR_SUCCESS == writer.write(buf, SRS_PERF_ASYNC_IO_BUFFER, NULL));
+        }
+        
+        // the worker is full, drop it.
+        EXPECT_TRUE(ERROR_SYSTEM_ASYNC_IO_FULL == writer.write(buf, SRS_PERF_ASYNC_IO_BUFFER, NULL));
+        
+        // the file is broken, drop the following writes.
+        EXPECT_TRUE(ERROR_SUCCESS == writer.write(buf, SRS_PERF_ASYNC_IO_BUFFER, NULL));
+        writer.close();
+    }
+    
+    // resume the worker, the queued writes are written.
+    EXPECT_TRUE(1 == ::write(fds[1], "x", 1));
+    io.wait(key, io.sequence(key));
+    
+    struct stat st;
+    EXPECT_TRUE(0 == ::stat(path.c_str(), &st));
+    EXPECT_EQ(SRS_PERF_ASYNC_IO_MAX_PENDING, (int)st.st_size);
+    
+    // the pending bytes are released, write again.
+    if (true) {
+        SrsAsyncFileWriter writer(key);
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(path));
+        EXPECT_TRUE(ERROR_SUCCESS == writer.write(buf, SRS_PERF_ASYNC_IO_BUFFER, NULL));
+        writer.close();
+    }
+    io.wait(key, io.sequence(key));
+    EXPECT_TRUE(0 == ::stat(path.c_str(), &st));
+    EXPECT_EQ(SRS_PERF_ASYNC_IO_BUFFER, (int)st.st_size);
+    
+    ::unlink(path.c_str());
+    ::close(fds[0]);
+    ::close(fds[1]);
+    
+    io.stop();
+    _srs_async_io = NULL;
+}
+
+/**
+ * the error of open and rename in worker is returned by the next write,
+ * while the error of unlink is ignored.
+ */
+VOID TEST(ProtocolAsyncIoTest, ReportError)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    SrsAsyncIo io;
+    EXPECT_TRUE(ERROR_SUCCESS == io.initialize(2));
+    _srs_async_io = &io;
+    
+    std::string path = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + ".ts";
+    std::string none = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + "/none.ts";
+    
+    int key = SrsAsyncIo::alloc_key();
+    if (true) {
+        SrsAsyncFileWriter writer(key);
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(none));
+        io.wait(key, io.sequence(key));
+        
+        EXPECT_TRUE(ERROR_SYSTEM_FILE_OPENE == writer.write((void*)"hello", 5, NULL));
+        EXPECT_TRUE(ERROR_SUCCESS == writer.write((void*)"hello", 5, NULL));
+        writer.close();
+    }
+    
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new SrsAsyncIoUnlinkTask(none)));
+    io.wait(key, io.sequence(key));
+    EXPECT_TRUE(ERROR_SUCCESS == io.fetch_error(key));
+    
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(key, new SrsAsyncIoRenameTask(none, path)));
+    io.wait(key, io.sequence(key));
+    if (true) {
+        SrsAsyncFileWriter writer(key);
+        EXPECT_TRUE(ERROR_SUCCESS == writer.open(path));
+        EXPECT_TRUE(ERROR_SYSTEM_FILE_RENAME == writer.write((void*)"hello", 5, NULL));
+        writer.close();
+    }
+    
+    // the error of other key is not fetched.
+    int other = SrsAsyncIo::alloc_key();
+    EXPECT_TRUE(ERROR_SUCCESS == io.execute(other, new SrsAsyncIoRenameTask(none, path)));
+    io.wait(other, io.sequence(other));
+    EXPECT_TRUE(ERROR_SUCCESS == io.fetch_error(key));
+    EXPECT_TRUE(ERROR_SYSTEM_FILE_RENAME == io.fetch_error(other));
+    
+    ::unlink(path.c_str());
+    
+    io.stop();
+    _srs_async_io = NULL;
+}
+
+#if !defined(SRS_OSX) && SRS_PERF_ASYNC_IO_WRITEBACK > 0
+/**
+ * write the bytes at offset of file by task, in the thread of test.
+ */
+int mock_async_io_write(SrsAsyncIoFile* file, int64_t offset, int size)
+{
+    char* buf = new char[size];
+    memset(buf, 0x0f, size);
+    
+    SrsAsyncIoWriteTask task(file, offset, buf, size);
+    return task.call();
+}
+
+/**
+ * the dirty pages are written back every SRS_PERF_ASYNC_IO_WRITEBACK bytes,
+ * and the pages written back last time are dropped when dontneed.
+ */
+VOID TEST(ProtocolAsyncIoTest, Writeback)
+{
+    std::string path = "/tmp/srs-utest-aio-" + srs_int2str(getpid()) + ".flv";
+    int wb = SRS_PERF_ASYNC_IO_WRITEBACK;
+    
+    // the dvr drops the pages once on disk.
+    if (true) {
+        SrsAsyncIoFile* file = new SrsAsyncIoFile(path, false);
+        file->dontneed = true;
+        
+        SrsAsyncIoOpenTask open(file);
+        EXPECT_TRUE(ERROR_SUCCESS == open.call());
+        
+        // never write back under the threshold.
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, 0, 100));
+        EXPECT_EQ(100, file->written);
+        EXPECT_EQ(0, file->synced);
+        EXPECT_EQ(0, file->dropped);
+        
+        // start to write back, nothing to drop.
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, 100, wb));
+        EXPECT_EQ(wb + 100, file->written);
+        EXPECT_EQ(wb + 100, file->synced);
+        EXPECT_EQ(0, file->dropped);
+        
+        // drop the pages written back last time.
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, wb + 100, wb));
+        EXPECT_EQ(2 * wb + 100, file->written);
+        EXPECT_EQ(2 * wb + 100, file->synced);
+        EXPECT_EQ(wb + 100, file->dropped);
+        
+        // the rewrite of metadata never moves the end.
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, 13, 100));
+        EXPECT_EQ(2 * wb + 100, file->written);
+        
+        // write back and drop all when closing, the task frees the file.
+        SrsAsyncIoCloseTask close(file);
+        EXPECT_TRUE(ERROR_SUCCESS == close.call());
+        EXPECT_EQ(2 * wb + 100, file->synced);
+        EXPECT_EQ(2 * wb + 100, file->dropped);
+    }
+    
+    // the hls keeps the pages for players, in append mode.
+    if (true) {
+        SrsAsyncIoFile* file = new SrsAsyncIoFile(path, true);
+        
+        SrsAsyncIoOpenTask open(file);
+        EXPECT_TRUE(ERROR_SUCCESS == open.call());
+        
+        // the append file starts from the end of file.
+        int64_t start = 2 * wb + 100;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, start, 100));
+        EXPECT_EQ(start + 100, file->written);
+        EXPECT_EQ(start, file->synced);
+        EXPECT_EQ(start, file->dropped);
+        
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, start + 100, wb));
+        EXPECT_TRUE(ERROR_SUCCESS == mock_async_io_write(file, start + wb + 100, wb));
+        EXPECT_EQ(start + 2 * wb + 100, file->synced);
+        EXPECT_EQ(start, file->dropped);
+        
+        SrsAsyncIoCloseTask close(file);
+        EXPECT_TRUE(ERROR_SUCCESS == close.call());
+        EXPECT_EQ(start, file->dropped);
+    }
+    
+    ::unlink(path.c_str());
+}
+#endif
+
+/**
+* the log in ring is dropped and counted when full, and the ring wraps
+* to drain the logs in order.
+*/
+VOID TEST(ProtocolAsyncLogTest, RingWrapAndDrop)
+{
+    std::string path = "/tmp/srs-utest-log-" + srs_int2str(getpid()) + ".log";
+    ::unlink(path.c_str());
+    
+    SrsAsyncLogWriter writer(64);
+    writer.reopen(path);
+    EXPECT_TRUE(writer.is_open());
+    
+    // hold the lock, so the pthread never drains the ring.
+    writer.before_fork();
+    
+    std::string expect;
+    for (int i = 0; i < 6; i++) {
+        std::string line = std::string(9, (char)('a' + i)) + "\n";
+        EXPECT_TRUE(writer.write((char*)line.data(), (int)line.length()));
+        expect += line;
+    }
+    
+    // the ring is full, drop the line.
+    EXPECT_FALSE(writer.write((char*)"zzzzzzzzz\n", 10));
+    EXPECT_EQ(6, writer.nb_lines);
+    EXPECT_EQ(60, writer.nb_bytes);
+    EXPECT_EQ(1, writer.nb_drops);
+    
+    writer.after_fork_parent();
+    writer.stop();
+    EXPECT_STREQ(expect.c_str(), mock_read_file(path).c_str());
+    
+    // the ring wraps, from the offset 60 of 64.
+    for (int i = 0; i < 5; i++) {
+        std::string line = std::string(9, (char)('A' + i)) + "\n";
+        EXPECT_TRUE(writer.write((char*)line.data(), (int)line.length()));
+        expect += line;
+        writer.stop();
+    }
+    EXPECT_EQ(11, writer.nb_lines);
+    EXPECT_EQ(1, writer.nb_drops);
+    EXPECT_STREQ(expect.c_str(), mock_read_file(path).c_str());
+    
+    // reopen the file, the pthread is running.
+    std::string rpath = path + ".1";
+    ::unlink(rpath.c_str());
+    EXPECT_TRUE(writer.write((char*)"0123456789", 10));
+    writer.reopen(rpath);
+    EXPECT_TRUE(writer.write((char*)"abcdefghij", 10));
+    writer.stop();
+    
+    std::string all = mock_read_file(path) + mock_read_file(rpath);
+    EXPECT_STREQ((expect + "0123456789abcdefghij").c_str(), all.c_str());
+    
+    writer.reopen("");
+    EXPECT_FALSE(writer.is_open());
+    
+    ::unlink(path.c_str());
+    ::unlink(rpath.c_str());
+}
+
+#ifdef SRS_AUTO_HLS
+VOID TEST(ProtocolHttpTest, HlsRamStore)
+{
+    SrsHlsRamStore store;
+    
+    // the file larger than a chunk.
+    SrsHlsRamFile* ts = new SrsHlsRamFile();
+    char buf[1024];
+    memset(buf, 0x47, sizeof(buf));
+    for (int i = 0; i < SRS_PERF_HLS_RAM_CHUNK / 1024 + 1; i++) {
+        ts->append(buf, sizeof(buf));
+    }
+    EXPECT_EQ(SRS_PERF_HLS_RAM_CHUNK + 1024, ts->size());
+    EXPECT_EQ(2, ts->nb_chunks());
+    
+    store.put("/live/livestream-0.ts", ts, 1024 * 1024);
+    EXPECT_TRUE(store.exists("/live/livestream-0.ts"));
+    EXPECT_FALSE(store.exists("/live/livestream-1.ts"));
+    
+    // the viewer shares the chunks, never copied.
+    SrsHlsRamFile* viewer = store.fetch("/live/livestream-0.ts");
+    ASSERT_TRUE(viewer != NULL);
+    EXPECT_TRUE(NULL == store.fetch("/live/livestream-1.ts"));
+    EXPECT_EQ(1, store.nb_hits);
+    EXPECT_EQ(1, store.nb_misses);
+    
+    iovec iovs[2];
+    EXPECT_EQ(2, viewer->chunks_to_iovs(iovs));
+    EXPECT_EQ(SRS_PERF_HLS_RAM_CHUNK, (int)iovs[0].iov_len);
+    EXPECT_EQ(1024, (int)iovs[1].iov_len);
+    EXPECT_EQ(0x47, ((char*)iovs[1].iov_base)[1023]);
+    
+    // the file removed from store, but still alive for viewer.
+    store.remove("/live/livestream-0.ts");
+    EXPECT_FALSE(store.exists("/live/livestream-0.ts"));
+    EXPECT_EQ(0, store.size());
+    EXPECT_EQ(0x47, ((char*)iovs[0].iov_base)[0]);
+    srs_freep(viewer);
+    
+    // evict the least recently used when exceed budget.
+    for (int i = 0; i < 3; i++) {
+        SrsHlsRamFile* file = new SrsHlsRamFile();
+        file->append(buf, sizeof(buf));
+        
+        std::stringstream ss;
+        ss << "/live/livestream-" << i << ".ts";
+        store.put(ss.str(), file, 2048);
+        
+        // touch the first one, which is recently used.
+        file = store.fetch("/live/livestream-0.ts");
+        srs_freep(file);
+    }
+    EXPECT_EQ(2048, store.size());
+    EXPECT_EQ(1, store.nb_evicts);
+    EXPECT_TRUE(store.exists("/live/livestream-0.ts"));
+    EXPECT_FALSE(store.exists("/live/livestream-1.ts"));
+    EXPECT_TRUE(store.exists("/live/livestream-2.ts"));
+}
+
+/**
+ * the hls muxer is created without the global async io.
+ */
+VOID TEST(ProtocolHttpTest, HlsMuxerWithoutAsyncIo)
+{
+    EXPECT_TRUE(NULL == _srs_async_io);
+    
+    SrsHlsMuxer* m0 = new SrsHlsMuxer();
+    SrsHlsMuxer* m1 = new SrsHlsMuxer();
+    EXPECT_EQ(0, m0->sequence_no());
+    srs_freep(m0);
+    srs_freep(m1);
+}
+#endif
+
+/**
+* the json writer escapes the string, and dumps same json as the tree.
+*/
+VOID TEST(ProtocolJsonTest, JsonWriter)
+{
+    SrsJsonWriter w;
+    
+    w.object_start();
+    w.field_integer("code", 0);
+    w.field_str("name", "a\"b\\c\n\x01");
+    w.key("clients");
+    w.array_start();
+    w.integer(-1);
+    w.boolean(true);
+    w.null();
+    w.array_start();
+    w.array_end();
+    w.object_start();
+    w.object_end();
+    w.array_end();
+    w.field_number("alive", 1.5);
+    w.object_end();
+    
+    EXPECT_STREQ("{\"code\":0,\"name\":\"a\\\"b\\\\c\\n\\u0001\",\"clients\":[-1,true,null,[],{}],\"alive\":1.500000}",
+        w.dumps().c_str());
+    
+    // reset to write a new json, and grow the buffer.
+    char* prev = w.bytes();
+    w.reset();
+    EXPECT_EQ(0, w.length());
+    
+    w.array_start();
+    for (int i = 0; i < 1000; i++) {
+        w.integer(i);
+    }
+    w.array_end();
+    EXPECT_NE(prev, w.bytes());
+    EXPECT_EQ('[', w.bytes()[0]);
+    EXPECT_EQ(']', w.bytes()[w.length() - 1]);
+    EXPECT_EQ(0, memcmp("[0,1,2,", w.bytes(), 7));
+    
+    // the json tree, dumps by writer.
+    SrsJsonObject* obj = SrsJsonAny::object();
+    SrsAutoFree(SrsJsonObject, obj);
+    
+    obj->set("code", SrsJsonAny::integer(0));
+    SrsJsonArray* arr = SrsJsonAny::array();
+    obj->set("data", arr);
+    arr->append(SrsJsonAny::str("srs"));
+    arr->append(SrsJsonAny::boolean(false));
+    arr->append(SrsJsonAny::object());
+    EXPECT_STREQ("{\"code\":0,\"data\":[\"srs\",false,{}]}", obj->dumps().c_str());
+    
+    w.reset();
+    w.any(obj);
+    EXPECT_EQ(obj->dumps(), w.dumps());
+    
+    // the dumps of writer can be loads.
+    std::string json = w.dumps();
+    SrsJsonAny* any = SrsJsonAny::loads((char*)json.c_str());
+    SrsAutoFree(SrsJsonAny, any);
+    ASSERT_TRUE(any && any->is_object());
+    EXPECT_EQ(0, any->to_object()->ensure_property_integer("code")->to_integer());
+}
+
+/**
+* dumps the page of clients, and parse the ids of clients.
+*/
+int mock_dumps_clients(int cursor, int count, int* pnext, std::vector<int>& ids)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsJsonWriter w;
+    if ((ret = SrsStatistic::instance()->dumps_clients(&w, cursor, count, pnext)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    std::string json = w.dumps();
+    SrsJsonAny* any = SrsJsonAny::loads((char*)json.c_str());
+    SrsAutoFree(SrsJsonAny, any);
+    if (!any || !any->is_array()) {
+        return ERROR_JSON_LOADS;
+    }
+    
+    SrsJsonArray* arr = any->to_array();
+    for (int i = 0; i < arr->count(); i++) {
+        ids.push_back((int)arr->at(i)->to_object()->ensure_property_integer("id")->to_integer());
+    }
+    
+    return ret;
+}
+
+/**
+* the clients are dumped by page, which seeks to the cursor by id,
+* the next is -1 for the last page, and the count is clamped.
+*/
+VOID TEST(ProtocolJsonTest, DumpsClientsByCursor)
+{
+    SrsStatistic* stat = SrsStatistic::instance();
+    
+    SrsRequest req;
+    req.vhost = "__defaultVhost__";
+    req.app = "live";
+    req.stream = "livestream";
+    
+    // the ids are even, over the max clients of a page.
+    int base = 10000000;
+    int nb_clients = SRS_PERF_API_CLIENTS_MAX + 200;
+    for (int i = 0; i < nb_clients; i++) {
+        EXPECT_TRUE(ERROR_SUCCESS == stat->on_client(base + i * 2, &req, NULL, SrsRtmpConnPlay));
+    }
+    
+    // the first page.
+    if (true) {
+        int next = 0;
+        std::vector<int> ids;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_dumps_clients(base, 10, &next, ids));
+        ASSERT_EQ(10, (int)ids.size());
+        EXPECT_EQ(base, ids[0]);
+        EXPECT_EQ(base + 18, ids[9]);
+        EXPECT_EQ(base + 20, next);
+    }
+    
+    // seek to the first client not less than cursor.
+    if (true) {
+        int next = 0;
+        std::vector<int> ids;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_dumps_clients(base + 21, 2, &next, ids));
+        ASSERT_EQ(2, (int)ids.size());
+        EXPECT_EQ(base + 22, ids[0]);
+        EXPECT_EQ(base + 24, ids[1]);
+        EXPECT_EQ(base + 26, next);
+    }
+    
+    // the last page, without next.
+    if (true) {
+        int next = 0;
+        std::vector<int> ids;
+        int last = base + (nb_clients - 1) * 2;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_dumps_clients(last - 4, 10, &next, ids));
+        ASSERT_EQ(3, (int)ids.size());
+        EXPECT_EQ(last, ids[2]);
+        EXPECT_EQ(-1, next);
+    }
+    
+    // the count is clamped to the max clients of a page.
+    if (true) {
+        int next = 0;
+        std::vector<int> ids;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_dumps_clients(base, nb_clients, &next, ids));
+        ASSERT_EQ(SRS_PERF_API_CLIENTS_MAX, (int)ids.size());
+        EXPECT_EQ(base + SRS_PERF_API_CLIENTS_MAX * 2, next);
+    }
+    
+    // the negative count dumps nothing.
+    if (true) {
+        int next = 0;
+        std::vector<int> ids;
+        EXPECT_TRUE(ERROR_SUCCESS == mock_dumps_clients(base, -1, &next, ids));
+        EXPECT_EQ(0, (int)ids.size());
+        EXPECT_EQ(base, next);
+    }
+    
+    for (int i = 0; i < nb_clients; i++) {
+        stat->on_disconnect(base + i * 2);
+    }
+}
+#endif
+
+#ifdef SRS_AUTO_STREAM_CASTER
+/**
+ * the log to count the warnings.
+ */
+class MockWarnLog : public MockEmptyLog
+{
+public:
+    int nb_warns;
+public:
+    MockWarnLog() : MockEmptyLog(SrsLogLevel::Disabled) {
+        nb_warns = 0;
+    }
+    virtual ~MockWarnLog() {
+    }
+public:
+    virtual void warn(const char* /*tag*/, int /*context_id*/, const char* /*fmt*/, ...) {
+        nb_warns++;
+    }
+};
+
+/**
+ * the caster to collect the ts packets, never publish.
+ */
+class MockMpegtsOverUdp : public SrsMpegtsOverUdp
+{
+public:
+    std::vector<std::string> packets;
+public:
+    MockMpegtsOverUdp() : SrsMpegtsOverUdp(NULL, NULL) {
+    }
+    virtual ~MockMpegtsOverUdp() {
+    }
+private:
+    virtual int on_ts_packet(char* p) {
+        packets.push_back(std::string(p, SRS_TS_PACKET_SIZE));
+        return ERROR_SUCCESS;
+    }
+};
+
+/**
+ * the ts packet split in udp packets is completed by the next udp packet,
+ * and the garbage without sync byte is dropped.
+ */
+VOID TEST(ProtocolMpegtsUdpTest, SplitPacket)
+{
+    SrsConfig conf;
+    _srs_config = &conf;
+    
+    MockWarnLog log;
+    ISrsLog* olog = _srs_log;
+    _srs_log = &log;
+    
+    sockaddr_in from;
+    memset(&from, 0, sizeof(sockaddr_in));
+    
+    // three ts packets, the first byte is sync byte, the second is the index.
+    char ts[SRS_TS_PACKET_SIZE * 3];
+    memset(ts, 0xff, sizeof(ts));
+    for (int i = 0; i < 3; i++) {
+        ts[i * SRS_TS_PACKET_SIZE] = 0x47;
+        ts[i * SRS_TS_PACKET_SIZE + 1] = (char)i;
+    }
+    
+    if (true) {
+        MockMpegtsOverUdp caster;
+        
+        // a packet split across udp packets.
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, ts, 100));
+        EXPECT_EQ(0, (int)caster.packets.size());
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, ts + 100, SRS_TS_PACKET_SIZE * 2 - 100));
+        ASSERT_EQ(2, (int)caster.packets.size());
+        EXPECT_EQ(0, caster.packets.at(0)[1]);
+        EXPECT_EQ(1, caster.packets.at(1)[1]);
+        EXPECT_EQ(0, log.nb_warns);
+    }
+    
+    if (true) {
+        MockMpegtsOverUdp caster;
+        
+        // the split packet completes exactly at the end of udp packet.
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, ts, 100));
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, ts + 100, SRS_TS_PACKET_SIZE - 100));
+        ASSERT_EQ(1, (int)caster.packets.size());
+        EXPECT_EQ(0, log.nb_warns);
+        
+        // the following udp packets are aligned.
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, ts + SRS_TS_PACKET_SIZE, SRS_TS_PACKET_SIZE * 2));
+        ASSERT_EQ(3, (int)caster.packets.size());
+        EXPECT_EQ(2, caster.packets.at(2)[1]);
+        EXPECT_EQ(0, log.nb_warns);
+    }
+    
+    if (true) {
+        MockMpegtsOverUdp caster;
+        
+        // the garbage without sync byte is dropped.
+        char garbage[32];
+        memset(garbage, 0xff, sizeof(garbage));
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, garbage, sizeof(garbage)));
+        EXPECT_EQ(0, (int)caster.packets.size());
+        EXPECT_EQ(1, log.nb_warns);
+        
+        // resync to the sync byte after garbage.
+        std::string data = std::string(garbage, 10) + std::string(ts, SRS_TS_PACKET_SIZE * 2);
+        EXPECT_TRUE(ERROR_SUCCESS == caster.on_udp_packet(&from, (char*)data.data(), (int)data.length()));
+        ASSERT_EQ(2, (int)caster.packets.size());
+        EXPECT_EQ(0, caster.packets.at(0)[1]);
+        EXPECT_EQ(1, caster.packets.at(1)[1]);
+        EXPECT_EQ(1, log.nb_warns);
+    }
+    
+    _srs_log = olog;
+    _srs_config = NULL;
+}
+
+/**
+ * the handler of source to count the publish.
+ */
+class MockSourceHandler : public ISrsSourceHandler
+{
+public:
+    int nb_publish;
+    int nb_unpublish;
+public:
+    MockSourceHandler() {
+        nb_publish = nb_unpublish = 0;
+    }
+    virtual ~MockSourceHandler() {
+    }
+public:
+    virtual int on_publish(SrsSource* /*s*/, SrsRequest* /*r*/) {
+        nb_publish++;
+        return ERROR_SUCCESS;
+    }
+    virtual void on_unpublish(SrsSource* /*s*/, SrsRequest* /*r*/) {
+        nb_unpublish++;
+    }
+};
+
+/**
+ * the caster publisher to check whether the url is local.
+ */
+class MockCasterPublisher : public SrsCasterPublisher
+{
+public:
+    MockCasterPublisher(ISrsSourceHandler* h) : SrsCasterPublisher(h, NULL) {
+    }
+    virtual ~MockCasterPublisher() {
+    }
+public:
+    virtual bool is_local(std::string url) {
+        SrsRequest r;
+        srs_parse_rtmp_url(url, r.tcUrl, r.stream);
+        srs_discovery_tc_url(r.tcUrl, r.schema, r.host, r.vhost, r.app, r.port, r.param);
+        r.strip();
+        return SrsCasterPublisher::is_local(&r);
+    }
+};
+
+/**
+ * the url is local when the host is local ip and the port is rtmp listen,
+ * and never for the edge vhost.
+ */
+VOID TEST(ProtocolCasterTest, IsLocal)
+{
+    MockSrsConfig conf;
+    _srs_config = &conf;
+    
+    ASSERT_TRUE(ERROR_SUCCESS == conf.parse("listen 1935 127.0.0.1:1936; "
+        "vhost edge.com{mode remote; origin 127.0.0.1:1937;}"));
+    
+    if (true) {
+        MockCasterPublisher publisher(NULL);
+        EXPECT_TRUE(publisher.is_local("rtmp://127.0.0.1/live/livestream"));
+        EXPECT_TRUE(publisher.is_local("rtmp://127.0.0.1:1935/live/livestream"));
+        EXPECT_TRUE(publisher.is_local("rtmp://localhost:1935/live/livestream"));
+        EXPECT_TRUE(publisher.is_local("rtmp://127.0.0.1:1936/live/livestream"));
+        EXPECT_TRUE(publisher.is_local("rtmp://127.0.0.1:1935/live?vhost=other.com/livestream"));
+        
+        // the port is not rtmp listen.
+        EXPECT_FALSE(publisher.is_local("rtmp://127.0.0.1:1937/live/livestream"));
+        // the host is not local ip.
+        EXPECT_FALSE(publisher.is_local("rtmp://192.0.2.1:1935/live/livestream"));
+        EXPECT_FALSE(publisher.is_local("rtmp://ossrs.net:1935/live/livestream"));
+        // the edge proxy the publish to origin.
+        EXPECT_FALSE(publisher.is_local("rtmp://127.0.0.1:1935/live?vhost=edge.com/livestream"));
+    }
+    
+    // the listen of local ip only.
+    if (true) {
+        MockSrsConfig conf;
+        _srs_config = &conf;
+        ASSERT_TRUE(ERROR_SUCCESS == conf.parse("listen 192.0.2.1:1935;"));
+        
+        MockCasterPublisher publisher(NULL);
+        EXPECT_FALSE(publisher.is_local("rtmp://127.0.0.1:1935/live/livestream"));
+    }
+    
+    _srs_config = NULL;
+}
+
+/**
+ * the local publish checks the security and vhost as the rtmp publish,
+ * and the kickoff by api expires the publish.
+ */
+VOID TEST(ProtocolCasterTest, LocalPublish)
+{
+    EXPECT_TRUE(0 == st_init());
+    
+    std::string url = "rtmp://127.0.0.1:1935/live/livestream";
+    
+    // the vhost is disabled.
+    if (true) {
+        MockSrsConfig conf;
+        _srs_config = &conf;
+        ASSERT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"vhost __defaultVhost__{enabled off;}"));
+        
+        MockSourceHandler handler;
+        SrsCasterPublisher publisher(&handler, NULL);
+        EXPECT_TRUE(ERROR_RTMP_VHOST_NOT_FOUND == publisher.connect(url, 0, 0));
+        EXPECT_FALSE(publisher.connected());
+    }
+    
+    // the publish is denied by security.
+    if (true) {
+        MockSrsConfig conf;
+        _srs_config = &conf;
+        ASSERT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"vhost __defaultVhost__{security{enabled on; allow publish 10.0.0.0/8;}}"));
+        
+        MockSourceHandler handler;
+        SrsCasterPublisher publisher(&handler, NULL);
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.connect(url, 0, 0));
+        EXPECT_TRUE(publisher.connected());
+        EXPECT_TRUE(ERROR_SYSTEM_SECURITY == publisher.publish());
+        EXPECT_EQ(0, handler.nb_publish);
+    }
+    
+    // the publish is allowed, and kickoff by api.
+    if (true) {
+        MockSrsConfig conf;
+        _srs_config = &conf;
+        ASSERT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"vhost __defaultVhost__{security{enabled on; allow publish 127.0.0.1;}}"));
+        
+        MockSourceHandler handler;
+        SrsCasterPublisher publisher(&handler, NULL);
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.connect(url, 0, 0));
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.publish());
+        EXPECT_EQ(1, handler.nb_publish);
+        
+        SrsSharedPtrMessage* msg = NULL;
+        char* data = new char[4];
+        data[0] = (char)0xaf; data[1] = 0x01; data[2] = data[3] = 0;
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.rtmp_create_msg(SrsCodecFlvTagAudio, 0, data, 4, &msg));
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.send_and_free_message(msg));
+        
+        // the api kickoff the client by its stat.
+        SrsStatisticClient* client = SrsStatistic::instance()->find_client(_srs_context->get_id());
+        ASSERT_TRUE(client != NULL);
+        ASSERT_TRUE(client->conn == &publisher);
+        client->conn->expire();
+        EXPECT_FALSE(publisher.connected());
+        
+        data = new char[4];
+        data[0] = (char)0xaf; data[1] = 0x01; data[2] = data[3] = 0;
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.rtmp_create_msg(SrsCodecFlvTagAudio, 0, data, 4, &msg));
+        EXPECT_TRUE(ERROR_USER_DISCONNECT == publisher.send_and_free_message(msg));
+        
+        // republish when connect again.
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.connect(url, 0, 0));
+        EXPECT_EQ(1, handler.nb_unpublish);
+        EXPECT_TRUE(publisher.connected());
+        EXPECT_TRUE(ERROR_SUCCESS == publisher.publish());
+        EXPECT_EQ(2, handler.nb_publish);
+        
+        publisher.close();
+        EXPECT_EQ(2, handler.nb_unpublish);
+        EXPECT_TRUE(NULL == SrsStatistic::instance()->find_client(_srs_context->get_id()));
+    }
+    
+    SrsSource::destroy();
+    _srs_config = NULL;
+}
+#endif
@@ -916,5 +916,32 @@ VOID TEST(ConfigReloadTest, ReloadVhostIngestUpdated)
     handler.reset();
 }
 
+VOID TEST(ConfigReloadTest, ReloadVhostConfig)
+{
+    MockSrsReloadConfig conf;
+    
+    EXPECT_TRUE(ERROR_SUCCESS == conf.parse(_MIN_OK_CONF"vhost a{}"));
+    
+    SrsVhostConfig* vconf = conf.get_vhost_config("a");
+    EXPECT_TRUE(vconf == conf.get_vhost_config("a"));
+    EXPECT_TRUE(vconf->exists);
+    EXPECT_TRUE(vconf->enabled);
+    EXPECT_FALSE(vconf->reduce_sequence_header);
+    EXPECT_TRUE(vconf->parse_sps);
+    EXPECT_EQ(conf.get_dvr_wait_keyframe("a"), vconf->dvr_wait_keyframe);
+    
+    // the snapshot is updated in place when reload.
+    EXPECT_TRUE(ERROR_SUCCESS == conf.do_reload(_MIN_OK_CONF"vhost a{play{reduce_sequence_header on;} publish{parse_sps off;}}"));
+    EXPECT_TRUE(vconf == conf.get_vhost_config("a"));
+    EXPECT_TRUE(vconf->reduce_sequence_header);
+    EXPECT_FALSE(vconf->parse_sps);
+    
+    // the snapshot is kept when vhost removed.
+    EXPECT_TRUE(ERROR_SUCCESS == conf.do_reload(_MIN_OK_CONF"vhost b{}"));
+    EXPECT_TRUE(vconf == conf.get_vhost_config("a"));
+    EXPECT_FALSE(vconf->exists);
+    EXPECT_FALSE(vconf->reduce_sequence_header);
+}
+
 #endif
 